@@ -0,0 +1,252 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Portable implementation of AES-GCM (NIST SP 800-38D), reference code.
+//
+//----------------------------------------------------------------------------
+
+#include "AESGCM.h"
+
+namespace {
+    // Reduction of the 4 bits which are shifted out, in 4-bit GHASH multiplication.
+    const uint64_t last4[16] = {
+        0x0000, 0x1C20, 0x3840, 0x2460, 0x7080, 0x6CA0, 0x48C0, 0x54E0,
+        0xE100, 0xFD20, 0xD940, 0xC560, 0x9180, 0x8DA0, 0xA9C0, 0xB5E0,
+    };
+
+    // Increment the 32 least significant bits of a counter block (inc32).
+    inline void inc32(uint8_t* cb)
+    {
+        PutUInt32(cb + 12, GetUInt32(cb + 12) + 1);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+AESGCM::AESGCM() :
+    AES(),
+    _HL(),
+    _HH()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Schedule a new key, precompute the multiplication table of H = E(0).
+//----------------------------------------------------------------------------
+
+bool AESGCM::setKey(const void* key, size_t key_length)
+{
+    uint8_t h[BLOCK_SIZE];
+    bzero(h, sizeof(h));
+    if (!AES::setKey(key, key_length) || !AES::encrypt(h, sizeof(h), h, sizeof(h), nullptr)) {
+        return false;
+    }
+
+    // Table entry 8 is H, entries 4, 2, 1 are H.x, H.x^2, H.x^3 (bit-reflected order).
+    uint64_t vh = GetUInt64(h);
+    uint64_t vl = GetUInt64(h + 8);
+    _HL[0] = _HH[0] = 0;
+    _HL[8] = vl;
+    _HH[8] = vh;
+    for (int i = 4; i > 0; i >>= 1) {
+        const uint64_t t = (vl & 1) * TS_UCONST64(0xE100000000000000);
+        vl = (vh << 63) | (vl >> 1);
+        vh = (vh >> 1) ^ t;
+        _HL[i] = vl;
+        _HH[i] = vh;
+    }
+
+    // Other entries are linear combinations.
+    for (int i = 2; i <= 8; i *= 2) {
+        for (int j = 1; j < i; ++j) {
+            _HH[i + j] = _HH[i] ^ _HH[j];
+            _HL[i + j] = _HL[i] ^ _HL[j];
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Multiply a block by H, 4 bits at a time.
+//----------------------------------------------------------------------------
+
+void AESGCM::gmult(uint8_t* x) const
+{
+    uint8_t lo = x[15] & 0x0F;
+    uint64_t zh = _HH[lo];
+    uint64_t zl = _HL[lo];
+
+    for (int i = 15; i >= 0; --i) {
+        lo = x[i] & 0x0F;
+        const uint8_t hi = (x[i] >> 4) & 0x0F;
+        if (i != 15) {
+            const uint8_t rem = uint8_t(zl & 0x0F);
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ (last4[rem] << 48) ^ _HH[lo];
+            zl ^= _HL[lo];
+        }
+        const uint8_t rem = uint8_t(zl & 0x0F);
+        zl = (zh << 60) | (zl >> 4);
+        zh = (zh >> 4) ^ (last4[rem] << 48) ^ _HH[hi];
+        zl ^= _HL[hi];
+    }
+
+    PutUInt64(x, zh);
+    PutUInt64(x + 8, zl);
+}
+
+
+//----------------------------------------------------------------------------
+// Accumulate data into GHASH, the last partial block is zero-padded.
+//----------------------------------------------------------------------------
+
+void AESGCM::ghash(uint8_t* x, const uint8_t* data, size_t size) const
+{
+    while (size > 0) {
+        const size_t n = std::min(size, BLOCK_SIZE);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] ^= data[i];
+        }
+        gmult(x);
+        data += n;
+        size -= n;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Compute the initial counter block J0.
+//----------------------------------------------------------------------------
+
+void AESGCM::initCounter(uint8_t* j0, const uint8_t* iv, size_t iv_length) const
+{
+    bzero(j0, BLOCK_SIZE);
+    if (iv_length == IV_SIZE) {
+        // J0 = IV || 0^31 || 1
+        ::memcpy(j0, iv, IV_SIZE);
+        j0[15] = 1;
+    }
+    else {
+        // J0 = GHASH(IV || 0^s+64 || [len(IV)]64)
+        ghash(j0, iv, iv_length);
+        uint8_t len[BLOCK_SIZE];
+        bzero(len, 8);
+        PutUInt64(len + 8, uint64_t(iv_length) * 8);
+        ghash(j0, len, sizeof(len));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt or decrypt in CTR mode, starting at inc32(J0).
+//----------------------------------------------------------------------------
+
+void AESGCM::ctr(const uint8_t* j0, const uint8_t* in, uint8_t* out, size_t size)
+{
+    uint8_t cb[BLOCK_SIZE];
+    uint8_t ks[BLOCK_SIZE];
+    ::memcpy(cb, j0, sizeof(cb));
+
+    while (size > 0) {
+        inc32(cb);
+        AES::encrypt(cb, sizeof(cb), ks, sizeof(ks), nullptr);
+        const size_t n = std::min(size, BLOCK_SIZE);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = in[i] ^ ks[i];
+        }
+        in += n;
+        out += n;
+        size -= n;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Compute the tag: E(J0) xor GHASH(... || [len(A)]64 || [len(C)]64)
+//----------------------------------------------------------------------------
+
+void AESGCM::finalTag(uint8_t* tag, const uint8_t* x, const uint8_t* j0, size_t aad_length, size_t data_length)
+{
+    uint8_t s[BLOCK_SIZE];
+    uint8_t len[BLOCK_SIZE];
+    ::memcpy(s, x, sizeof(s));
+    PutUInt64(len, uint64_t(aad_length) * 8);
+    PutUInt64(len + 8, uint64_t(data_length) * 8);
+    ghash(s, len, sizeof(len));
+
+    AES::encrypt(j0, BLOCK_SIZE, tag, BLOCK_SIZE, nullptr);
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        tag[i] ^= s[i];
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Authenticated encryption.
+//----------------------------------------------------------------------------
+
+bool AESGCM::seal(const void* iv, size_t iv_length, const void* aad, size_t aad_length,
+                  const void* plain, size_t plain_length, void* cipher, void* tag, size_t tag_length)
+{
+    if (iv_length == 0 || tag_length == 0 || tag_length > TAG_SIZE) {
+        return false;
+    }
+
+    uint8_t j0[BLOCK_SIZE];
+    uint8_t x[BLOCK_SIZE];
+    uint8_t t[TAG_SIZE];
+    initCounter(j0, reinterpret_cast<const uint8_t*>(iv), iv_length);
+
+    ctr(j0, reinterpret_cast<const uint8_t*>(plain), reinterpret_cast<uint8_t*>(cipher), plain_length);
+
+    bzero(x, sizeof(x));
+    ghash(x, reinterpret_cast<const uint8_t*>(aad), aad_length);
+    ghash(x, reinterpret_cast<const uint8_t*>(cipher), plain_length);
+    finalTag(t, x, j0, aad_length, plain_length);
+    ::memcpy(tag, t, tag_length);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Authenticated decryption.
+//----------------------------------------------------------------------------
+
+bool AESGCM::open(const void* iv, size_t iv_length, const void* aad, size_t aad_length,
+                  const void* cipher, size_t cipher_length, void* plain, const void* tag, size_t tag_length)
+{
+    if (iv_length == 0 || tag_length == 0 || tag_length > TAG_SIZE) {
+        return false;
+    }
+
+    uint8_t j0[BLOCK_SIZE];
+    uint8_t x[BLOCK_SIZE];
+    uint8_t t[TAG_SIZE];
+    initCounter(j0, reinterpret_cast<const uint8_t*>(iv), iv_length);
+
+    bzero(x, sizeof(x));
+    ghash(x, reinterpret_cast<const uint8_t*>(aad), aad_length);
+    ghash(x, reinterpret_cast<const uint8_t*>(cipher), cipher_length);
+    finalTag(t, x, j0, aad_length, cipher_length);
+
+    // Constant-time comparison of the tags.
+    const uint8_t* expected = reinterpret_cast<const uint8_t*>(tag);
+    uint8_t diff = 0;
+    for (size_t i = 0; i < tag_length; ++i) {
+        diff |= t[i] ^ expected[i];
+    }
+    if (diff != 0) {
+        return false;
+    }
+
+    ctr(j0, reinterpret_cast<const uint8_t*>(cipher), reinterpret_cast<uint8_t*>(plain), cipher_length);
+    return true;
+}
@@ -0,0 +1,46 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Portable implementation of AES-GCM (NIST SP 800-38D), reference code.
+// GHASH uses 4-bit tables (Shoup's method).
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "AES.h"
+
+class AESGCM: public AES
+{
+ public:
+    AESGCM();                                 //!< Constructor.
+    static constexpr size_t TAG_SIZE = 16;    //!< Maximum authentication tag size in bytes.
+    static constexpr size_t IV_SIZE = 12;     //!< Recommended IV size in bytes.
+
+    bool setKey(const void* key, size_t key_length);
+
+    // Authenticated encryption: the cipher buffer has the same size as the plain text.
+    bool seal(const void* iv, size_t iv_length, const void* aad, size_t aad_length,
+              const void* plain, size_t plain_length, void* cipher, void* tag, size_t tag_length = TAG_SIZE);
+
+    // Authenticated decryption: return false if the tag does not match.
+    bool open(const void* iv, size_t iv_length, const void* aad, size_t aad_length,
+              const void* cipher, size_t cipher_length, void* plain, const void* tag, size_t tag_length = TAG_SIZE);
+
+ private:
+    uint64_t _HL[16];   // Precomputed multiples of H, low 64 bits.
+    uint64_t _HH[16];   // Precomputed multiples of H, high 64 bits.
+
+    // Multiply a 16-byte block by H, in place.
+    void gmult(uint8_t* x) const;
+    // Accumulate data (zero-padded to complete blocks) into GHASH.
+    void ghash(uint8_t* x, const uint8_t* data, size_t size) const;
+    // Compute the initial counter block J0 from the IV.
+    void initCounter(uint8_t* j0, const uint8_t* iv, size_t iv_length) const;
+    // Encrypt or decrypt data in CTR mode, starting at counter inc32(J0).
+    void ctr(const uint8_t* j0, const uint8_t* in, uint8_t* out, size_t size);
+    // Compute the tag from the final GHASH and J0.
+    void finalTag(uint8_t* tag, const uint8_t* x, const uint8_t* j0, size_t aad_length, size_t data_length);
+};
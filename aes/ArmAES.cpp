@@ -22,11 +22,23 @@ ArmAES::ArmAES() :
     _kbits(0),
     _Nr(0),
     _eK(),
-    _dK()
+    _dK(),
+    _portable()
 {
 }
 
 
+//----------------------------------------------------------------------------
+// Check if the AES instructions are present.
+//----------------------------------------------------------------------------
+
+bool ArmAES::accelerated()
+{
+    static const bool accel = HasCPUFeatures(CPU_AES);
+    return accel;
+}
+
+
 //----------------------------------------------------------------------------
 // Precomputed tables for AES
 //----------------------------------------------------------------------------
@@ -965,10 +977,14 @@ bool ArmAES::setKey(const void* key_, size_t key_length)
         return false;
     }
 
-    // Expected number of rounds for key size
+    // Expected number of rounds for key size, also records that a key is set in portable mode.
     _Nr = int(10 + ((key_length / 8) - 2) * 2);
     _kbits = key_length * 8;
 
+    if (!accelerated()) {
+        return _portable.setKey(key_, key_length);
+    }
+
     int i, j;
     uint32_t temp;
     uint32_t *rk;
@@ -1131,8 +1147,22 @@ bool ArmAES::encrypt(const void* plain, size_t plain_length, void* cipher, size_
     if (plain_length != BLOCK_SIZE || cipher_maxsize < BLOCK_SIZE) {
         return false;
     }
+    if (!accelerated()) {
+        return _portable.encrypt(plain, plain_length, cipher, cipher_maxsize, cipher_length);
+    }
+
+    encryptBlockArm(reinterpret_cast<const uint8_t*>(plain), reinterpret_cast<uint8_t*>(cipher));
 
-    uint8x16_t B = vld1q_u8(reinterpret_cast<const uint8_t*>(plain));
+    if (cipher_length != nullptr) {
+        *cipher_length = BLOCK_SIZE;
+    }
+
+    return true;
+}
+
+TARGET_AES void ArmAES::encryptBlockArm(const uint8_t* in, uint8_t* out) const
+{
+    uint8x16_t B = vld1q_u8(in);
     B = vaesmcq_u8(vaeseq_u8(B, _aeK[0]));
     B = vaesmcq_u8(vaeseq_u8(B, _aeK[1]));
     B = vaesmcq_u8(vaeseq_u8(B, _aeK[2]));
@@ -1157,13 +1187,7 @@ bool ArmAES::encrypt(const void* plain, size_t plain_length, void* cipher, size_
             B = veorq_u8(vaeseq_u8(B, _aeK[13]), _aeK[14]);
         }
     }
-    vst1q_u8(reinterpret_cast<uint8_t*>(cipher), B);
-
-    if (cipher_length != nullptr) {
-        *cipher_length = BLOCK_SIZE;
-    }
-
-    return true;
+    vst1q_u8(out, B);
 }
 
 
@@ -1176,8 +1200,22 @@ bool ArmAES::decrypt(const void* cipher, size_t cipher_length, void* plain, size
     if (cipher_length != BLOCK_SIZE || plain_maxsize < BLOCK_SIZE) {
         return false;
     }
+    if (!accelerated()) {
+        return _portable.decrypt(cipher, cipher_length, plain, plain_maxsize, plain_length);
+    }
+
+    decryptBlockArm(reinterpret_cast<const uint8_t*>(cipher), reinterpret_cast<uint8_t*>(plain));
+
+    if (plain_length != nullptr) {
+        *plain_length = BLOCK_SIZE;
+    }
 
-    uint8x16_t B = vld1q_u8(reinterpret_cast<const uint8_t*>(cipher));
+    return true;
+}
+
+TARGET_AES void ArmAES::decryptBlockArm(const uint8_t* in, uint8_t* out) const
+{
+    uint8x16_t B = vld1q_u8(in);
     B = vaesimcq_u8(vaesdq_u8(B, _adK[0]));
     B = vaesimcq_u8(vaesdq_u8(B, _adK[1]));
     B = vaesimcq_u8(vaesdq_u8(B, _adK[2]));
@@ -1202,11 +1240,129 @@ bool ArmAES::decrypt(const void* cipher, size_t cipher_length, void* plain, size
             B = veorq_u8(vaesdq_u8(B, _adK[13]), _adK[14]);
         }
     }
-    vst1q_u8(reinterpret_cast<uint8_t*>(plain), B);
+    vst1q_u8(out, B);
+}
 
-    if (plain_length != nullptr) {
-        *plain_length = BLOCK_SIZE;
+
+//----------------------------------------------------------------------------
+// Bulk encryption in ECB mode, 8 independent blocks in flight.
+//----------------------------------------------------------------------------
+
+bool ArmAES::encryptBlocks(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length)
+{
+    // Reject an object without key (_Nr is zero).
+    if (_Nr == 0 || plain_length % BLOCK_SIZE != 0 || cipher_maxsize < plain_length) {
+        return false;
+    }
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(plain);
+    uint8_t* out = reinterpret_cast<uint8_t*>(cipher);
+    const size_t count = plain_length / BLOCK_SIZE;
+
+    if (accelerated()) {
+        encryptBlocksArm(in, out, count);
+    }
+    else {
+        for (size_t i = 0; i < count; ++i) {
+            _portable.encrypt(in + i * BLOCK_SIZE, BLOCK_SIZE, out + i * BLOCK_SIZE, BLOCK_SIZE, nullptr);
+        }
+    }
+
+    if (cipher_length != nullptr) {
+        *cipher_length = plain_length;
+    }
+    return true;
+}
+
+TARGET_AES void ArmAES::encryptBlocksArm(const uint8_t* in, uint8_t* out, size_t count) const
+{
+    while (count >= PARALLEL_BLOCKS) {
+        uint8x16_t b0 = vld1q_u8(in);
+        uint8x16_t b1 = vld1q_u8(in + 16);
+        uint8x16_t b2 = vld1q_u8(in + 32);
+        uint8x16_t b3 = vld1q_u8(in + 48);
+        uint8x16_t b4 = vld1q_u8(in + 64);
+        uint8x16_t b5 = vld1q_u8(in + 80);
+        uint8x16_t b6 = vld1q_u8(in + 96);
+        uint8x16_t b7 = vld1q_u8(in + 112);
+        encrypt8(b0, b1, b2, b3, b4, b5, b6, b7);
+        vst1q_u8(out, b0);
+        vst1q_u8(out + 16, b1);
+        vst1q_u8(out + 32, b2);
+        vst1q_u8(out + 48, b3);
+        vst1q_u8(out + 64, b4);
+        vst1q_u8(out + 80, b5);
+        vst1q_u8(out + 96, b6);
+        vst1q_u8(out + 112, b7);
+        in += PARALLEL_BLOCKS * BLOCK_SIZE;
+        out += PARALLEL_BLOCKS * BLOCK_SIZE;
+        count -= PARALLEL_BLOCKS;
+    }
+    while (count-- > 0) {
+        vst1q_u8(out, encrypt1(vld1q_u8(in)));
+        in += BLOCK_SIZE;
+        out += BLOCK_SIZE;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Bulk decryption in ECB mode, 8 independent blocks in flight.
+//----------------------------------------------------------------------------
+
+bool ArmAES::decryptBlocks(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize, size_t* plain_length)
+{
+    // Reject an object without key (_Nr is zero).
+    if (_Nr == 0 || cipher_length % BLOCK_SIZE != 0 || plain_maxsize < cipher_length) {
+        return false;
+    }
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(cipher);
+    uint8_t* out = reinterpret_cast<uint8_t*>(plain);
+    const size_t count = cipher_length / BLOCK_SIZE;
+
+    if (accelerated()) {
+        decryptBlocksArm(in, out, count);
+    }
+    else {
+        for (size_t i = 0; i < count; ++i) {
+            _portable.decrypt(in + i * BLOCK_SIZE, BLOCK_SIZE, out + i * BLOCK_SIZE, BLOCK_SIZE, nullptr);
+        }
     }
 
+    if (plain_length != nullptr) {
+        *plain_length = cipher_length;
+    }
     return true;
 }
+
+TARGET_AES void ArmAES::decryptBlocksArm(const uint8_t* in, uint8_t* out, size_t count) const
+{
+    while (count >= PARALLEL_BLOCKS) {
+        uint8x16_t b0 = vld1q_u8(in);
+        uint8x16_t b1 = vld1q_u8(in + 16);
+        uint8x16_t b2 = vld1q_u8(in + 32);
+        uint8x16_t b3 = vld1q_u8(in + 48);
+        uint8x16_t b4 = vld1q_u8(in + 64);
+        uint8x16_t b5 = vld1q_u8(in + 80);
+        uint8x16_t b6 = vld1q_u8(in + 96);
+        uint8x16_t b7 = vld1q_u8(in + 112);
+        decrypt8(b0, b1, b2, b3, b4, b5, b6, b7);
+        vst1q_u8(out, b0);
+        vst1q_u8(out + 16, b1);
+        vst1q_u8(out + 32, b2);
+        vst1q_u8(out + 48, b3);
+        vst1q_u8(out + 64, b4);
+        vst1q_u8(out + 80, b5);
+        vst1q_u8(out + 96, b6);
+        vst1q_u8(out + 112, b7);
+        in += PARALLEL_BLOCKS * BLOCK_SIZE;
+        out += PARALLEL_BLOCKS * BLOCK_SIZE;
+        count -= PARALLEL_BLOCKS;
+    }
+    while (count-- > 0) {
+        vst1q_u8(out, decrypt1(vld1q_u8(in)));
+        in += BLOCK_SIZE;
+        out += BLOCK_SIZE;
+    }
+}
@@ -9,7 +9,7 @@
 //----------------------------------------------------------------------------
 
 #pragma once
-#include "platform.h"
+#include "AES.h"
 #include <arm_neon.h>
 
 class ArmAES
@@ -23,10 +23,32 @@ class ArmAES
     static constexpr size_t MAX_ROUNDS = 14;      //!< AES maximum number of rounds.
     static constexpr size_t DEFAULT_ROUNDS = 10;  //!< AES default number of rounds, actually depends on key size.
 
+    // Check if the AES instructions are present, detected once at run time.
+    // When they are not, setKey(), encrypt(), decrypt(), encryptBlocks() and
+    // decryptBlocks() use the portable implementation in class AES.
+    static bool accelerated();
+
     bool setKey(const void* key, size_t key_length);
     bool encrypt(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length);
     bool decrypt(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize, size_t* plain_length);
 
+    // Bulk encryption and decryption in ECB mode, any number of complete blocks.
+    // Independent blocks are interleaved to keep the AES pipeline busy.
+    static constexpr size_t PARALLEL_BLOCKS = 8;  //!< Number of blocks which are processed in parallel.
+    bool encryptBlocks(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length = nullptr);
+    bool decryptBlocks(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize, size_t* plain_length = nullptr);
+
+ protected:
+    // Encrypt or decrypt blocks in registers, for use by the chaining modes.
+    // They use the AES instructions and must be called from TARGET_AES functions
+    // only, after checking accelerated().
+    uint8x16_t encrypt1(uint8x16_t b) const TARGET_AES;
+    uint8x16_t decrypt1(uint8x16_t b) const TARGET_AES;
+    void encrypt8(uint8x16_t& b0, uint8x16_t& b1, uint8x16_t& b2, uint8x16_t& b3,
+                  uint8x16_t& b4, uint8x16_t& b5, uint8x16_t& b6, uint8x16_t& b7) const TARGET_AES;
+    void decrypt8(uint8x16_t& b0, uint8x16_t& b1, uint8x16_t& b2, uint8x16_t& b3,
+                  uint8x16_t& b4, uint8x16_t& b5, uint8x16_t& b6, uint8x16_t& b7) const TARGET_AES;
+
  private:
     size_t     _kbits;
     int        _Nr;      // Number of rounds
@@ -34,4 +56,90 @@ class ArmAES
     uint32_t   _dK[60];  // Scheduled decryption keys
     uint8x16_t _aeK[15];
     uint8x16_t _adK[15];
+    AES        _portable;  // Fallback when the AES instructions are not present.
+
+    // Implementation using the AES instructions, one block or any number of blocks.
+    void encryptBlockArm(const uint8_t* in, uint8_t* out) const TARGET_AES;
+    void decryptBlockArm(const uint8_t* in, uint8_t* out) const TARGET_AES;
+    void encryptBlocksArm(const uint8_t* in, uint8_t* out, size_t count) const TARGET_AES;
+    void decryptBlocksArm(const uint8_t* in, uint8_t* out, size_t count) const TARGET_AES;
 };
+
+
+//----------------------------------------------------------------------------
+// Inline implementation of the register-level block operations.
+// All rounds but the last one use AESE+AESMC (AESD+AESIMC) which are
+// fused by most Arm64 cores. The last round uses a final XOR.
+//----------------------------------------------------------------------------
+
+inline __attribute__((always_inline)) TARGET_AES uint8x16_t ArmAES::encrypt1(uint8x16_t b) const
+{
+    const int last = _Nr - 1;
+    for (int r = 0; r < last; ++r) {
+        b = vaesmcq_u8(vaeseq_u8(b, _aeK[r]));
+    }
+    return veorq_u8(vaeseq_u8(b, _aeK[last]), _aeK[_Nr]);
+}
+
+inline __attribute__((always_inline)) TARGET_AES uint8x16_t ArmAES::decrypt1(uint8x16_t b) const
+{
+    const int last = _Nr - 1;
+    for (int r = 0; r < last; ++r) {
+        b = vaesimcq_u8(vaesdq_u8(b, _adK[r]));
+    }
+    return veorq_u8(vaesdq_u8(b, _adK[last]), _adK[_Nr]);
+}
+
+inline __attribute__((always_inline)) TARGET_AES void ArmAES::encrypt8(uint8x16_t& b0, uint8x16_t& b1, uint8x16_t& b2, uint8x16_t& b3,
+                                                                       uint8x16_t& b4, uint8x16_t& b5, uint8x16_t& b6, uint8x16_t& b7) const
+{
+    const int last = _Nr - 1;
+    for (int r = 0; r < last; ++r) {
+        const uint8x16_t k = _aeK[r];
+        b0 = vaesmcq_u8(vaeseq_u8(b0, k));
+        b1 = vaesmcq_u8(vaeseq_u8(b1, k));
+        b2 = vaesmcq_u8(vaeseq_u8(b2, k));
+        b3 = vaesmcq_u8(vaeseq_u8(b3, k));
+        b4 = vaesmcq_u8(vaeseq_u8(b4, k));
+        b5 = vaesmcq_u8(vaeseq_u8(b5, k));
+        b6 = vaesmcq_u8(vaeseq_u8(b6, k));
+        b7 = vaesmcq_u8(vaeseq_u8(b7, k));
+    }
+    const uint8x16_t k = _aeK[last];
+    const uint8x16_t kl = _aeK[_Nr];
+    b0 = veorq_u8(vaeseq_u8(b0, k), kl);
+    b1 = veorq_u8(vaeseq_u8(b1, k), kl);
+    b2 = veorq_u8(vaeseq_u8(b2, k), kl);
+    b3 = veorq_u8(vaeseq_u8(b3, k), kl);
+    b4 = veorq_u8(vaeseq_u8(b4, k), kl);
+    b5 = veorq_u8(vaeseq_u8(b5, k), kl);
+    b6 = veorq_u8(vaeseq_u8(b6, k), kl);
+    b7 = veorq_u8(vaeseq_u8(b7, k), kl);
+}
+
+inline __attribute__((always_inline)) TARGET_AES void ArmAES::decrypt8(uint8x16_t& b0, uint8x16_t& b1, uint8x16_t& b2, uint8x16_t& b3,
+                                                                       uint8x16_t& b4, uint8x16_t& b5, uint8x16_t& b6, uint8x16_t& b7) const
+{
+    const int last = _Nr - 1;
+    for (int r = 0; r < last; ++r) {
+        const uint8x16_t k = _adK[r];
+        b0 = vaesimcq_u8(vaesdq_u8(b0, k));
+        b1 = vaesimcq_u8(vaesdq_u8(b1, k));
+        b2 = vaesimcq_u8(vaesdq_u8(b2, k));
+        b3 = vaesimcq_u8(vaesdq_u8(b3, k));
+        b4 = vaesimcq_u8(vaesdq_u8(b4, k));
+        b5 = vaesimcq_u8(vaesdq_u8(b5, k));
+        b6 = vaesimcq_u8(vaesdq_u8(b6, k));
+        b7 = vaesimcq_u8(vaesdq_u8(b7, k));
+    }
+    const uint8x16_t k = _adK[last];
+    const uint8x16_t kl = _adK[_Nr];
+    b0 = veorq_u8(vaesdq_u8(b0, k), kl);
+    b1 = veorq_u8(vaesdq_u8(b1, k), kl);
+    b2 = veorq_u8(vaesdq_u8(b2, k), kl);
+    b3 = veorq_u8(vaesdq_u8(b3, k), kl);
+    b4 = veorq_u8(vaesdq_u8(b4, k), kl);
+    b5 = veorq_u8(vaesdq_u8(b5, k), kl);
+    b6 = veorq_u8(vaesdq_u8(b6, k), kl);
+    b7 = veorq_u8(vaesdq_u8(b7, k), kl);
+}
@@ -0,0 +1,246 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// AES in CBC (cipher block chaining) mode using Arm64 instructions.
+//
+//----------------------------------------------------------------------------
+
+#include "ArmAESCBC.h"
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ArmAESCBC::ArmAESCBC(Padding padding) :
+    ArmAES(),
+    _padding(padding),
+    _iv(vdupq_n_u8(0))
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Set the initialization vector.
+//----------------------------------------------------------------------------
+
+bool ArmAESCBC::setIV(const void* iv, size_t iv_length)
+{
+    if (iv_length != BLOCK_SIZE) {
+        return false;
+    }
+    _iv = vld1q_u8(reinterpret_cast<const uint8_t*>(iv));
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt complete blocks. Each block depends on the previous one.
+//----------------------------------------------------------------------------
+
+TARGET_AES uint8x16_t ArmAESCBC::encryptChain(uint8x16_t prev, const uint8_t* in, uint8_t* out, size_t count) const
+{
+    while (count-- > 0) {
+        prev = encrypt1(veorq_u8(vld1q_u8(in), prev));
+        vst1q_u8(out, prev);
+        in += BLOCK_SIZE;
+        out += BLOCK_SIZE;
+    }
+    return prev;
+}
+
+
+//----------------------------------------------------------------------------
+// Decrypt complete blocks. The decryptions are independent, 8 blocks are
+// decrypted in parallel, then XOR'ed with the previous cipher blocks.
+//----------------------------------------------------------------------------
+
+TARGET_AES uint8x16_t ArmAESCBC::decryptChain(uint8x16_t prev, const uint8_t* in, uint8_t* out, size_t count) const
+{
+    while (count >= PARALLEL_BLOCKS) {
+        // Cipher text is loaded first, input and output may overlap.
+        const uint8x16_t c0 = vld1q_u8(in);
+        const uint8x16_t c1 = vld1q_u8(in + 16);
+        const uint8x16_t c2 = vld1q_u8(in + 32);
+        const uint8x16_t c3 = vld1q_u8(in + 48);
+        const uint8x16_t c4 = vld1q_u8(in + 64);
+        const uint8x16_t c5 = vld1q_u8(in + 80);
+        const uint8x16_t c6 = vld1q_u8(in + 96);
+        const uint8x16_t c7 = vld1q_u8(in + 112);
+        uint8x16_t b0 = c0, b1 = c1, b2 = c2, b3 = c3, b4 = c4, b5 = c5, b6 = c6, b7 = c7;
+        decrypt8(b0, b1, b2, b3, b4, b5, b6, b7);
+        vst1q_u8(out, veorq_u8(b0, prev));
+        vst1q_u8(out + 16, veorq_u8(b1, c0));
+        vst1q_u8(out + 32, veorq_u8(b2, c1));
+        vst1q_u8(out + 48, veorq_u8(b3, c2));
+        vst1q_u8(out + 64, veorq_u8(b4, c3));
+        vst1q_u8(out + 80, veorq_u8(b5, c4));
+        vst1q_u8(out + 96, veorq_u8(b6, c5));
+        vst1q_u8(out + 112, veorq_u8(b7, c6));
+        prev = c7;
+        in += PARALLEL_BLOCKS * BLOCK_SIZE;
+        out += PARALLEL_BLOCKS * BLOCK_SIZE;
+        count -= PARALLEL_BLOCKS;
+    }
+    while (count-- > 0) {
+        const uint8x16_t c = vld1q_u8(in);
+        vst1q_u8(out, veorq_u8(decrypt1(c), prev));
+        prev = c;
+        in += BLOCK_SIZE;
+        out += BLOCK_SIZE;
+    }
+    return prev;
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt the last cipher block (or the IV) into a mask for the residue.
+//----------------------------------------------------------------------------
+
+TARGET_AES void ArmAESCBC::residueMask(uint8x16_t prev, uint8_t* mask) const
+{
+    vst1q_u8(mask, encrypt1(prev));
+}
+
+
+//----------------------------------------------------------------------------
+// Encryption.
+//----------------------------------------------------------------------------
+
+bool ArmAESCBC::encrypt(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length)
+{
+    if (!accelerated()) {
+        return false;
+    }
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(plain);
+    uint8_t* out = reinterpret_cast<uint8_t*>(cipher);
+    const size_t count = plain_length / BLOCK_SIZE;
+    const size_t residue = plain_length % BLOCK_SIZE;
+    size_t out_length = plain_length;
+
+    switch (_padding) {
+        case NO_PADDING: {
+            if (residue != 0 || cipher_maxsize < plain_length) {
+                return false;
+            }
+            encryptChain(_iv, in, out, count);
+            break;
+        }
+        case PKCS7_PADDING: {
+            // Always add a padding, a complete block when the size is a multiple of the block size.
+            out_length = (count + 1) * BLOCK_SIZE;
+            if (cipher_maxsize < out_length) {
+                return false;
+            }
+            uint8_t last[BLOCK_SIZE];
+            ::memcpy(last, in + count * BLOCK_SIZE, residue);
+            ::memset(last + residue, int(BLOCK_SIZE - residue), BLOCK_SIZE - residue);
+            const uint8x16_t prev = encryptChain(_iv, in, out, count);
+            encryptChain(prev, last, out + count * BLOCK_SIZE, 1);
+            break;
+        }
+        case RESIDUE_PADDING: {
+            // The residue is XOR'ed with the encryption of the last cipher block (or the IV).
+            if (cipher_maxsize < plain_length) {
+                return false;
+            }
+            const uint8x16_t prev = encryptChain(_iv, in, out, count);
+            if (residue > 0) {
+                uint8_t mask[BLOCK_SIZE];
+                residueMask(prev, mask);
+                in += count * BLOCK_SIZE;
+                out += count * BLOCK_SIZE;
+                for (size_t i = 0; i < residue; ++i) {
+                    out[i] = in[i] ^ mask[i];
+                }
+            }
+            break;
+        }
+        default: {
+            return false;
+        }
+    }
+
+    if (cipher_length != nullptr) {
+        *cipher_length = out_length;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Decryption.
+//----------------------------------------------------------------------------
+
+bool ArmAESCBC::decrypt(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize, size_t* plain_length)
+{
+    if (!accelerated()) {
+        return false;
+    }
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(cipher);
+    uint8_t* out = reinterpret_cast<uint8_t*>(plain);
+    const size_t count = cipher_length / BLOCK_SIZE;
+    const size_t residue = cipher_length % BLOCK_SIZE;
+    size_t out_length = cipher_length;
+
+    switch (_padding) {
+        case NO_PADDING: {
+            if (residue != 0 || plain_maxsize < cipher_length) {
+                return false;
+            }
+            decryptChain(_iv, in, out, count);
+            break;
+        }
+        case PKCS7_PADDING: {
+            // Decrypt and check the last block first, nothing is written on invalid padding.
+            if (residue != 0 || count == 0) {
+                return false;
+            }
+            uint8_t last[BLOCK_SIZE];
+            const uint8x16_t prev = count > 1 ? vld1q_u8(in + (count - 2) * BLOCK_SIZE) : _iv;
+            decryptChain(prev, in + (count - 1) * BLOCK_SIZE, last, 1);
+            const size_t pad = last[BLOCK_SIZE - 1];
+            uint8_t bad = pad == 0 || pad > BLOCK_SIZE;
+            for (size_t i = BLOCK_SIZE - std::min(pad, BLOCK_SIZE); i < BLOCK_SIZE; ++i) {
+                bad |= last[i] ^ uint8_t(pad);
+            }
+            out_length = cipher_length - pad;
+            if (bad != 0 || plain_maxsize < out_length) {
+                return false;
+            }
+            decryptChain(_iv, in, out, count - 1);
+            ::memcpy(out + (count - 1) * BLOCK_SIZE, last, BLOCK_SIZE - pad);
+            break;
+        }
+        case RESIDUE_PADDING: {
+            if (plain_maxsize < cipher_length) {
+                return false;
+            }
+            // Get the mask for the residue before overwriting the cipher text (in-place decryption).
+            uint8_t mask[BLOCK_SIZE];
+            if (residue > 0) {
+                residueMask(count > 0 ? vld1q_u8(in + (count - 1) * BLOCK_SIZE) : _iv, mask);
+            }
+            decryptChain(_iv, in, out, count);
+            in += count * BLOCK_SIZE;
+            out += count * BLOCK_SIZE;
+            for (size_t i = 0; i < residue; ++i) {
+                out[i] = in[i] ^ mask[i];
+            }
+            break;
+        }
+        default: {
+            return false;
+        }
+    }
+
+    if (plain_length != nullptr) {
+        *plain_length = out_length;
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// AES in CBC (cipher block chaining) mode using Arm64 instructions.
+// Each call to encrypt() or decrypt() processes a complete message from the IV.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "ArmAES.h"
+
+class ArmAESCBC: public ArmAES
+{
+ public:
+    // Processing of the last block.
+    enum Padding {
+        NO_PADDING,       //!< The message size must be a multiple of the block size.
+        PKCS7_PADDING,    //!< PKCS#7 padding (RFC 5652), the cipher text is 1 to 16 bytes longer.
+        RESIDUE_PADDING,  //!< Residue termination (ANSI/SCTE 52, DVS 042), the cipher text has the same size.
+    };
+
+    ArmAESCBC(Padding padding = NO_PADDING);  //!< Constructor.
+
+    void setPadding(Padding padding) { _padding = padding; }
+    Padding padding() const { return _padding; }
+
+    // Set the initialization vector. Must be called after setKey(), before the first encryption.
+    bool setIV(const void* iv, size_t iv_length);
+
+    // Encryption is serial. Decryption processes 8 blocks in parallel.
+    // Return false if the AES instructions are not present (see accelerated()).
+    bool encrypt(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length = nullptr);
+    bool decrypt(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize, size_t* plain_length = nullptr);
+
+ private:
+    Padding    _padding;
+    uint8x16_t _iv;
+
+    // Encrypt or decrypt complete blocks, return the last cipher block (next chaining value).
+    uint8x16_t encryptChain(uint8x16_t prev, const uint8_t* in, uint8_t* out, size_t count) const TARGET_AES;
+    uint8x16_t decryptChain(uint8x16_t prev, const uint8_t* in, uint8_t* out, size_t count) const TARGET_AES;
+    // Encrypt one block into a mask for the residue.
+    void residueMask(uint8x16_t prev, uint8_t* mask) const TARGET_AES;
+};
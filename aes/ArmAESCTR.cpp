@@ -0,0 +1,162 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// AES in CTR (counter) mode using Arm64 instructions.
+//
+//----------------------------------------------------------------------------
+
+#include "ArmAESCTR.h"
+
+namespace {
+
+    // Swap a 128-bit big-endian counter block into a native 128-bit integer
+    // (low 64 bits in lane 0, high 64 bits in lane 1). The operation is its
+    // own inverse and is used in both directions.
+    inline __attribute__((always_inline)) uint8x16_t swapCounter(uint8x16_t b)
+    {
+        return vrev64q_u8(vextq_u8(b, b, 8));
+    }
+
+    // Add a small value (lane 0 of inc, lane 1 is zero) to a native 128-bit counter.
+    // When the low lane wraps around, it becomes smaller than its initial value,
+    // the comparison result is all ones (-1) and is subtracted from the high lane.
+    inline __attribute__((always_inline)) uint64x2_t addCounter(uint64x2_t ctr, uint64x2_t inc)
+    {
+        const uint64x2_t sum = vaddq_u64(ctr, inc);
+        const uint64x2_t carry = vcltq_u64(sum, ctr);
+        return vsubq_u64(sum, vextq_u64(vdupq_n_u64(0), carry, 1));
+    }
+
+    // Get the counter block at a given offset from the native counter.
+    inline __attribute__((always_inline)) uint8x16_t counterBlock(uint64x2_t ctr, uint64x2_t inc)
+    {
+        return swapCounter(vreinterpretq_u8_u64(addCounter(ctr, inc)));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ArmAESCTR::ArmAESCTR() :
+    ArmAES(),
+    _counter(vdupq_n_u64(0)),
+    _ks(),
+    _ks_used(BLOCK_SIZE)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Set the initial counter block.
+//----------------------------------------------------------------------------
+
+bool ArmAESCTR::setIV(const void* iv, size_t iv_length)
+{
+    if (iv_length != BLOCK_SIZE) {
+        return false;
+    }
+    _counter = vreinterpretq_u64_u8(swapCounter(vld1q_u8(reinterpret_cast<const uint8_t*>(iv))));
+    _ks_used = BLOCK_SIZE;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Encryption and decryption, same operation.
+//----------------------------------------------------------------------------
+
+bool ArmAESCTR::encrypt(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length)
+{
+    if (!accelerated() || cipher_maxsize < plain_length) {
+        return false;
+    }
+    process(reinterpret_cast<const uint8_t*>(plain), reinterpret_cast<uint8_t*>(cipher), plain_length);
+    if (cipher_length != nullptr) {
+        *cipher_length = plain_length;
+    }
+    return true;
+}
+
+bool ArmAESCTR::decrypt(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize, size_t* plain_length)
+{
+    return encrypt(cipher, cipher_length, plain, plain_maxsize, plain_length);
+}
+
+
+//----------------------------------------------------------------------------
+// Apply the key stream on any amount of data.
+//----------------------------------------------------------------------------
+
+TARGET_AES void ArmAESCTR::process(const uint8_t* in, uint8_t* out, size_t size)
+{
+    // Use the rest of the previous key stream block.
+    while (_ks_used < BLOCK_SIZE && size > 0) {
+        *out++ = *in++ ^ _ks[_ks_used++];
+        --size;
+    }
+
+    // Generate 8 counter blocks at a time, the 8 encryptions are interleaved.
+    if (size >= PARALLEL_BLOCKS * BLOCK_SIZE) {
+        const uint64x2_t zero = vdupq_n_u64(0);
+        const uint64x2_t one = vsetq_lane_u64(1, zero, 0);
+        const uint64x2_t two = vsetq_lane_u64(2, zero, 0);
+        const uint64x2_t three = vsetq_lane_u64(3, zero, 0);
+        const uint64x2_t four = vsetq_lane_u64(4, zero, 0);
+        const uint64x2_t five = vsetq_lane_u64(5, zero, 0);
+        const uint64x2_t six = vsetq_lane_u64(6, zero, 0);
+        const uint64x2_t seven = vsetq_lane_u64(7, zero, 0);
+        const uint64x2_t eight = vsetq_lane_u64(8, zero, 0);
+        uint64x2_t ctr = _counter;
+
+        do {
+            uint8x16_t k0 = swapCounter(vreinterpretq_u8_u64(ctr));
+            uint8x16_t k1 = counterBlock(ctr, one);
+            uint8x16_t k2 = counterBlock(ctr, two);
+            uint8x16_t k3 = counterBlock(ctr, three);
+            uint8x16_t k4 = counterBlock(ctr, four);
+            uint8x16_t k5 = counterBlock(ctr, five);
+            uint8x16_t k6 = counterBlock(ctr, six);
+            uint8x16_t k7 = counterBlock(ctr, seven);
+            ctr = addCounter(ctr, eight);
+            encrypt8(k0, k1, k2, k3, k4, k5, k6, k7);
+            vst1q_u8(out, veorq_u8(vld1q_u8(in), k0));
+            vst1q_u8(out + 16, veorq_u8(vld1q_u8(in + 16), k1));
+            vst1q_u8(out + 32, veorq_u8(vld1q_u8(in + 32), k2));
+            vst1q_u8(out + 48, veorq_u8(vld1q_u8(in + 48), k3));
+            vst1q_u8(out + 64, veorq_u8(vld1q_u8(in + 64), k4));
+            vst1q_u8(out + 80, veorq_u8(vld1q_u8(in + 80), k5));
+            vst1q_u8(out + 96, veorq_u8(vld1q_u8(in + 96), k6));
+            vst1q_u8(out + 112, veorq_u8(vld1q_u8(in + 112), k7));
+            in += PARALLEL_BLOCKS * BLOCK_SIZE;
+            out += PARALLEL_BLOCKS * BLOCK_SIZE;
+            size -= PARALLEL_BLOCKS * BLOCK_SIZE;
+        } while (size >= PARALLEL_BLOCKS * BLOCK_SIZE);
+
+        _counter = ctr;
+    }
+
+    // Remaining blocks, one at a time.
+    const uint64x2_t one = vsetq_lane_u64(1, vdupq_n_u64(0), 0);
+    while (size >= BLOCK_SIZE) {
+        const uint8x16_t k = encrypt1(swapCounter(vreinterpretq_u8_u64(_counter)));
+        _counter = addCounter(_counter, one);
+        vst1q_u8(out, veorq_u8(vld1q_u8(in), k));
+        in += BLOCK_SIZE;
+        out += BLOCK_SIZE;
+        size -= BLOCK_SIZE;
+    }
+
+    // Last partial block, keep the rest of the key stream for the next call.
+    if (size > 0) {
+        vst1q_u8(_ks, encrypt1(swapCounter(vreinterpretq_u8_u64(_counter))));
+        _counter = addCounter(_counter, one);
+        for (_ks_used = 0; _ks_used < size; ++_ks_used) {
+            out[_ks_used] = in[_ks_used] ^ _ks[_ks_used];
+        }
+    }
+}
@@ -0,0 +1,36 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// AES in CTR (counter) mode using Arm64 instructions.
+// The counter block is a 128-bit big-endian integer (NIST SP 800-38A).
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "ArmAES.h"
+
+class ArmAESCTR: public ArmAES
+{
+ public:
+    ArmAESCTR();  //!< Constructor.
+
+    // Set the initial counter block. Must be called after setKey(), before the first encryption.
+    bool setIV(const void* iv, size_t iv_length);
+
+    // Encryption and decryption are identical in CTR mode, any data size is allowed.
+    // Successive calls continue the same key stream, including in the middle of a block.
+    // Return false if the AES instructions are not present (see accelerated()).
+    bool encrypt(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length = nullptr);
+    bool decrypt(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize, size_t* plain_length = nullptr);
+
+ private:
+    uint64x2_t _counter;          // Next counter block as a native 128-bit integer (low 64 bits in lane 0).
+    uint8_t    _ks[BLOCK_SIZE];   // Last generated key stream block.
+    size_t     _ks_used;          // Number of already used bytes in _ks.
+
+    // Encrypt or decrypt any amount of data.
+    void process(const uint8_t* in, uint8_t* out, size_t size) TARGET_AES;
+};
@@ -0,0 +1,452 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// AES-GCM (NIST SP 800-38D) using Arm64 instructions.
+//
+// GHASH representation: a 16-byte block is fully byte-reversed, so that the
+// coefficient of x^127 is bit 0 of the 128-bit integer. The multiplicand H
+// is premultiplied by x^-1 so that the product of two reflected values needs
+// no extra shift. The 256-bit product is reduced modulo the GHASH polynomial
+// with two PMULL by 0xC200000000000000 (the reflected low terms).
+//
+//----------------------------------------------------------------------------
+
+#include "ArmAESGCM.h"
+
+namespace {
+
+    // Carry-less multiplications of 64-bit lanes: low x low, high x high.
+    inline __attribute__((always_inline)) TARGET_AES uint64x2_t pmullLow(uint64x2_t a, uint64x2_t b)
+    {
+        return vreinterpretq_u64_p128(vmull_p64((poly64_t)vgetq_lane_u64(a, 0), (poly64_t)vgetq_lane_u64(b, 0)));
+    }
+
+    inline __attribute__((always_inline)) TARGET_AES uint64x2_t pmullHigh(uint64x2_t a, uint64x2_t b)
+    {
+        return vreinterpretq_u64_p128(vmull_high_p64(vreinterpretq_p64_u64(a), vreinterpretq_p64_u64(b)));
+    }
+
+    // Convert between a data block and the GHASH representation (same operation in both directions).
+    inline __attribute__((always_inline)) uint64x2_t reflect(uint8x16_t b)
+    {
+        b = vrev64q_u8(b);
+        return vreinterpretq_u64_u8(vextq_u8(b, b, 8));
+    }
+
+    inline __attribute__((always_inline)) uint8x16_t unreflect(uint64x2_t x)
+    {
+        const uint8x16_t b = vrev64q_u8(vreinterpretq_u8_u64(x));
+        return vextq_u8(b, b, 8);
+    }
+
+    // Accumulate the Karatsuba partial products of u x h into lo, mid, hi.
+    // Products can be accumulated over several blocks before a single reduction.
+    inline __attribute__((always_inline)) TARGET_AES void mulAcc(uint64x2_t& lo, uint64x2_t& mid, uint64x2_t& hi, uint64x2_t u, uint64x2_t h, uint64x2_t hk)
+    {
+        lo = veorq_u64(lo, pmullLow(u, h));
+        hi = veorq_u64(hi, pmullHigh(u, h));
+        mid = veorq_u64(mid, pmullLow(veorq_u64(u, vextq_u64(u, u, 1)), hk));
+    }
+
+    // Reduce the accumulated 256-bit product into a 128-bit value.
+    inline __attribute__((always_inline)) TARGET_AES uint64x2_t reduce(uint64x2_t lo, uint64x2_t mid, uint64x2_t hi)
+    {
+        const uint64x2_t zero = vdupq_n_u64(0);
+        const uint64x2_t poly = vdupq_n_u64(TS_UCONST64(0xC200000000000000));
+
+        // Complete Karatsuba: Z = hi:lo with the middle 128 bits added.
+        mid = veorq_u64(mid, veorq_u64(lo, hi));
+        lo = veorq_u64(lo, vextq_u64(zero, mid, 1));
+        hi = veorq_u64(hi, vextq_u64(mid, zero, 1));
+
+        // First folding of the lowest 64 bits, then second folding.
+        uint64x2_t m = veorq_u64(vextq_u64(lo, hi, 1), pmullLow(lo, poly));
+        m = veorq_u64(m, vextq_u64(zero, lo, 1));
+        const uint64x2_t r = veorq_u64(vzip2q_u64(m, hi), pmullLow(m, poly));
+        return veorq_u64(r, vextq_u64(zero, m, 1));
+    }
+
+    // Multiply a value by a power of H.
+    inline __attribute__((always_inline)) TARGET_AES uint64x2_t gmul(uint64x2_t x, uint64x2_t h, uint64x2_t hk)
+    {
+        uint64x2_t lo = vdupq_n_u64(0);
+        uint64x2_t mid = vdupq_n_u64(0);
+        uint64x2_t hi = vdupq_n_u64(0);
+        mulAcc(lo, mid, hi, x, h, hk);
+        return reduce(lo, mid, hi);
+    }
+
+    // Build a counter block from the 32-bit native counter representation.
+    inline __attribute__((always_inline)) uint8x16_t counterBlock(uint32x4_t ctr, uint32x4_t inc)
+    {
+        return vrev32q_u8(vreinterpretq_u8_u32(vaddq_u32(ctr, inc)));
+    }
+
+    // Increment values for the 32-bit counter (lane 3).
+    inline __attribute__((always_inline)) uint32x4_t increment(uint32_t n)
+    {
+        return vsetq_lane_u32(n, vdupq_n_u32(0), 3);
+    }
+}
+
+// Aggregated GHASH on 8 blocks: x = (x ^ b0).H^8 ^ b1.H^7 ^ ... ^ b7.H
+#define GHASH8(x, b0, b1, b2, b3, b4, b5, b6, b7)                       \
+    do {                                                                \
+        uint64x2_t lo = vdupq_n_u64(0);                                 \
+        uint64x2_t mid = vdupq_n_u64(0);                                \
+        uint64x2_t hi = vdupq_n_u64(0);                                 \
+        mulAcc(lo, mid, hi, veorq_u64(x, reflect(b0)), _H[7], _Hk[7]);  \
+        mulAcc(lo, mid, hi, reflect(b1), _H[6], _Hk[6]);                \
+        mulAcc(lo, mid, hi, reflect(b2), _H[5], _Hk[5]);                \
+        mulAcc(lo, mid, hi, reflect(b3), _H[4], _Hk[4]);                \
+        mulAcc(lo, mid, hi, reflect(b4), _H[3], _Hk[3]);                \
+        mulAcc(lo, mid, hi, reflect(b5), _H[2], _Hk[2]);                \
+        mulAcc(lo, mid, hi, reflect(b6), _H[1], _Hk[1]);                \
+        mulAcc(lo, mid, hi, reflect(b7), _H[0], _Hk[0]);                \
+        x = reduce(lo, mid, hi);                                        \
+    } while (false)
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ArmAESGCM::ArmAESGCM() :
+    ArmAES(),
+    _H(),
+    _Hk()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Check if the AES and PMULL instructions are present.
+//----------------------------------------------------------------------------
+
+bool ArmAESGCM::accelerated()
+{
+    static const bool accel = HasCPUFeatures(CPU_AES | CPU_PMULL);
+    return accel;
+}
+
+
+//----------------------------------------------------------------------------
+// Schedule a new key, precompute the powers of H = E(0).
+//----------------------------------------------------------------------------
+
+bool ArmAESGCM::setKey(const void* key, size_t key_length)
+{
+    if (!accelerated() || !ArmAES::setKey(key, key_length)) {
+        return false;
+    }
+    initPowers();
+    return true;
+}
+
+TARGET_AES void ArmAESGCM::initPowers()
+{
+    // Reflected H, then H.x^-1: 128-bit left shift, reduced when the top bit is shifted out.
+    const uint64x2_t h = reflect(encrypt1(vdupq_n_u8(0)));
+    uint64_t l = vgetq_lane_u64(h, 0);
+    uint64_t u = vgetq_lane_u64(h, 1);
+    const uint64_t carry = u >> 63;
+    u = (u << 1) | (l >> 63);
+    l <<= 1;
+    u ^= carry * TS_UCONST64(0xC200000000000000);
+    l ^= carry;
+    _H[0] = vcombine_u64(vcreate_u64(l), vcreate_u64(u));
+    _Hk[0] = vdupq_n_u64(l ^ u);
+
+    // H^n = H^(n-1) x H, each power is in reflected form, then shifted the same way.
+    uint64x2_t p = h;
+    for (size_t i = 1; i < PARALLEL_BLOCKS; ++i) {
+        p = gmul(p, _H[0], _Hk[0]);
+        l = vgetq_lane_u64(p, 0);
+        u = vgetq_lane_u64(p, 1);
+        const uint64_t c = u >> 63;
+        u = (u << 1) | (l >> 63);
+        l <<= 1;
+        u ^= c * TS_UCONST64(0xC200000000000000);
+        l ^= c;
+        _H[i] = vcombine_u64(vcreate_u64(l), vcreate_u64(u));
+        _Hk[i] = vdupq_n_u64(l ^ u);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Accumulate data into GHASH, the last partial block is zero-padded.
+//----------------------------------------------------------------------------
+
+TARGET_AES uint64x2_t ArmAESGCM::ghash(uint64x2_t x, const uint8_t* data, size_t size) const
+{
+    while (size >= PARALLEL_BLOCKS * BLOCK_SIZE) {
+        GHASH8(x, vld1q_u8(data), vld1q_u8(data + 16), vld1q_u8(data + 32), vld1q_u8(data + 48),
+               vld1q_u8(data + 64), vld1q_u8(data + 80), vld1q_u8(data + 96), vld1q_u8(data + 112));
+        data += PARALLEL_BLOCKS * BLOCK_SIZE;
+        size -= PARALLEL_BLOCKS * BLOCK_SIZE;
+    }
+    while (size >= BLOCK_SIZE) {
+        x = gmul(veorq_u64(x, reflect(vld1q_u8(data))), _H[0], _Hk[0]);
+        data += BLOCK_SIZE;
+        size -= BLOCK_SIZE;
+    }
+    if (size > 0) {
+        uint8_t last[BLOCK_SIZE];
+        bzero(last, sizeof(last));
+        ::memcpy(last, data, size);
+        x = gmul(veorq_u64(x, reflect(vld1q_u8(last))), _H[0], _Hk[0]);
+    }
+    return x;
+}
+
+
+//----------------------------------------------------------------------------
+// Compute the initial counter block J0.
+//----------------------------------------------------------------------------
+
+TARGET_AES uint8x16_t ArmAESGCM::initCounter(const uint8_t* iv, size_t iv_length) const
+{
+    uint8_t j0[BLOCK_SIZE];
+    bzero(j0, sizeof(j0));
+    if (iv_length == IV_SIZE) {
+        // J0 = IV || 0^31 || 1
+        ::memcpy(j0, iv, IV_SIZE);
+        j0[15] = 1;
+        return vld1q_u8(j0);
+    }
+    else {
+        // J0 = GHASH(IV || 0^s+64 || [len(IV)]64)
+        PutUInt64(j0 + 8, uint64_t(iv_length) * 8);
+        const uint64x2_t x = ghash(ghash(vdupq_n_u64(0), iv, iv_length), j0, sizeof(j0));
+        return unreflect(x);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt in CTR mode and accumulate the cipher text in GHASH.
+//----------------------------------------------------------------------------
+
+TARGET_AES uint64x2_t ArmAESGCM::encryptHash(uint64x2_t x, uint8x16_t j0, const uint8_t* in, uint8_t* out, size_t size) const
+{
+    // Counter block as 32-bit native integers, the GCM counter is in lane 3.
+    uint32x4_t ctr = vreinterpretq_u32_u8(vrev32q_u8(j0));
+
+    if (size >= PARALLEL_BLOCKS * BLOCK_SIZE) {
+        const uint32x4_t one = increment(1);
+        const uint32x4_t two = increment(2);
+        const uint32x4_t three = increment(3);
+        const uint32x4_t four = increment(4);
+        const uint32x4_t five = increment(5);
+        const uint32x4_t six = increment(6);
+        const uint32x4_t seven = increment(7);
+        const uint32x4_t eight = increment(8);
+
+        do {
+            uint8x16_t b0 = counterBlock(ctr, one);
+            uint8x16_t b1 = counterBlock(ctr, two);
+            uint8x16_t b2 = counterBlock(ctr, three);
+            uint8x16_t b3 = counterBlock(ctr, four);
+            uint8x16_t b4 = counterBlock(ctr, five);
+            uint8x16_t b5 = counterBlock(ctr, six);
+            uint8x16_t b6 = counterBlock(ctr, seven);
+            uint8x16_t b7 = counterBlock(ctr, eight);
+            ctr = vaddq_u32(ctr, eight);
+            encrypt8(b0, b1, b2, b3, b4, b5, b6, b7);
+            b0 = veorq_u8(vld1q_u8(in), b0);
+            b1 = veorq_u8(vld1q_u8(in + 16), b1);
+            b2 = veorq_u8(vld1q_u8(in + 32), b2);
+            b3 = veorq_u8(vld1q_u8(in + 48), b3);
+            b4 = veorq_u8(vld1q_u8(in + 64), b4);
+            b5 = veorq_u8(vld1q_u8(in + 80), b5);
+            b6 = veorq_u8(vld1q_u8(in + 96), b6);
+            b7 = veorq_u8(vld1q_u8(in + 112), b7);
+            vst1q_u8(out, b0);
+            vst1q_u8(out + 16, b1);
+            vst1q_u8(out + 32, b2);
+            vst1q_u8(out + 48, b3);
+            vst1q_u8(out + 64, b4);
+            vst1q_u8(out + 80, b5);
+            vst1q_u8(out + 96, b6);
+            vst1q_u8(out + 112, b7);
+            GHASH8(x, b0, b1, b2, b3, b4, b5, b6, b7);
+            in += PARALLEL_BLOCKS * BLOCK_SIZE;
+            out += PARALLEL_BLOCKS * BLOCK_SIZE;
+            size -= PARALLEL_BLOCKS * BLOCK_SIZE;
+        } while (size >= PARALLEL_BLOCKS * BLOCK_SIZE);
+    }
+
+    // Remaining blocks, one at a time.
+    const uint32x4_t one = increment(1);
+    while (size >= BLOCK_SIZE) {
+        ctr = vaddq_u32(ctr, one);
+        const uint8x16_t c = veorq_u8(vld1q_u8(in), encrypt1(vrev32q_u8(vreinterpretq_u8_u32(ctr))));
+        vst1q_u8(out, c);
+        x = gmul(veorq_u64(x, reflect(c)), _H[0], _Hk[0]);
+        in += BLOCK_SIZE;
+        out += BLOCK_SIZE;
+        size -= BLOCK_SIZE;
+    }
+
+    // Last partial block, zero-padded in GHASH.
+    if (size > 0) {
+        uint8_t last[BLOCK_SIZE];
+        ctr = vaddq_u32(ctr, one);
+        vst1q_u8(last, encrypt1(vrev32q_u8(vreinterpretq_u8_u32(ctr))));
+        for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+            last[i] = i < size ? (out[i] = in[i] ^ last[i]) : 0;
+        }
+        x = gmul(veorq_u64(x, reflect(vld1q_u8(last))), _H[0], _Hk[0]);
+    }
+    return x;
+}
+
+
+//----------------------------------------------------------------------------
+// Accumulate the cipher text in GHASH and decrypt in CTR mode.
+//----------------------------------------------------------------------------
+
+TARGET_AES uint64x2_t ArmAESGCM::decryptHash(uint64x2_t x, uint8x16_t j0, const uint8_t* in, uint8_t* out, size_t size) const
+{
+    uint32x4_t ctr = vreinterpretq_u32_u8(vrev32q_u8(j0));
+
+    if (size >= PARALLEL_BLOCKS * BLOCK_SIZE) {
+        const uint32x4_t one = increment(1);
+        const uint32x4_t two = increment(2);
+        const uint32x4_t three = increment(3);
+        const uint32x4_t four = increment(4);
+        const uint32x4_t five = increment(5);
+        const uint32x4_t six = increment(6);
+        const uint32x4_t seven = increment(7);
+        const uint32x4_t eight = increment(8);
+
+        do {
+            // Cipher text is loaded first, input and output may overlap.
+            const uint8x16_t c0 = vld1q_u8(in);
+            const uint8x16_t c1 = vld1q_u8(in + 16);
+            const uint8x16_t c2 = vld1q_u8(in + 32);
+            const uint8x16_t c3 = vld1q_u8(in + 48);
+            const uint8x16_t c4 = vld1q_u8(in + 64);
+            const uint8x16_t c5 = vld1q_u8(in + 80);
+            const uint8x16_t c6 = vld1q_u8(in + 96);
+            const uint8x16_t c7 = vld1q_u8(in + 112);
+            uint8x16_t b0 = counterBlock(ctr, one);
+            uint8x16_t b1 = counterBlock(ctr, two);
+            uint8x16_t b2 = counterBlock(ctr, three);
+            uint8x16_t b3 = counterBlock(ctr, four);
+            uint8x16_t b4 = counterBlock(ctr, five);
+            uint8x16_t b5 = counterBlock(ctr, six);
+            uint8x16_t b6 = counterBlock(ctr, seven);
+            uint8x16_t b7 = counterBlock(ctr, eight);
+            ctr = vaddq_u32(ctr, eight);
+            encrypt8(b0, b1, b2, b3, b4, b5, b6, b7);
+            GHASH8(x, c0, c1, c2, c3, c4, c5, c6, c7);
+            vst1q_u8(out, veorq_u8(c0, b0));
+            vst1q_u8(out + 16, veorq_u8(c1, b1));
+            vst1q_u8(out + 32, veorq_u8(c2, b2));
+            vst1q_u8(out + 48, veorq_u8(c3, b3));
+            vst1q_u8(out + 64, veorq_u8(c4, b4));
+            vst1q_u8(out + 80, veorq_u8(c5, b5));
+            vst1q_u8(out + 96, veorq_u8(c6, b6));
+            vst1q_u8(out + 112, veorq_u8(c7, b7));
+            in += PARALLEL_BLOCKS * BLOCK_SIZE;
+            out += PARALLEL_BLOCKS * BLOCK_SIZE;
+            size -= PARALLEL_BLOCKS * BLOCK_SIZE;
+        } while (size >= PARALLEL_BLOCKS * BLOCK_SIZE);
+    }
+
+    const uint32x4_t one = increment(1);
+    while (size >= BLOCK_SIZE) {
+        const uint8x16_t c = vld1q_u8(in);
+        ctr = vaddq_u32(ctr, one);
+        x = gmul(veorq_u64(x, reflect(c)), _H[0], _Hk[0]);
+        vst1q_u8(out, veorq_u8(c, encrypt1(vrev32q_u8(vreinterpretq_u8_u32(ctr)))));
+        in += BLOCK_SIZE;
+        out += BLOCK_SIZE;
+        size -= BLOCK_SIZE;
+    }
+
+    if (size > 0) {
+        uint8_t last[BLOCK_SIZE];
+        uint8_t ks[BLOCK_SIZE];
+        bzero(last, sizeof(last));
+        ::memcpy(last, in, size);
+        ctr = vaddq_u32(ctr, one);
+        vst1q_u8(ks, encrypt1(vrev32q_u8(vreinterpretq_u8_u32(ctr))));
+        x = gmul(veorq_u64(x, reflect(vld1q_u8(last))), _H[0], _Hk[0]);
+        for (size_t i = 0; i < size; ++i) {
+            out[i] = last[i] ^ ks[i];
+        }
+    }
+    return x;
+}
+
+
+//----------------------------------------------------------------------------
+// Compute the tag: E(J0) xor GHASH(... || [len(A)]64 || [len(C)]64)
+//----------------------------------------------------------------------------
+
+TARGET_AES void ArmAESGCM::finalTag(uint8_t* tag, uint64x2_t x, uint8x16_t j0, size_t aad_length, size_t data_length) const
+{
+    uint8_t len[BLOCK_SIZE];
+    PutUInt64(len, uint64_t(aad_length) * 8);
+    PutUInt64(len + 8, uint64_t(data_length) * 8);
+    x = ghash(x, len, sizeof(len));
+    vst1q_u8(tag, veorq_u8(unreflect(x), encrypt1(j0)));
+}
+
+
+//----------------------------------------------------------------------------
+// Authenticated encryption.
+//----------------------------------------------------------------------------
+
+bool ArmAESGCM::seal(const void* iv, size_t iv_length, const void* aad, size_t aad_length,
+                     const void* plain, size_t plain_length, void* cipher, void* tag, size_t tag_length)
+{
+    if (!accelerated() || iv_length == 0 || tag_length == 0 || tag_length > TAG_SIZE) {
+        return false;
+    }
+
+    uint8_t t[TAG_SIZE];
+    const uint8x16_t j0 = initCounter(reinterpret_cast<const uint8_t*>(iv), iv_length);
+    uint64x2_t x = ghash(vdupq_n_u64(0), reinterpret_cast<const uint8_t*>(aad), aad_length);
+    x = encryptHash(x, j0, reinterpret_cast<const uint8_t*>(plain), reinterpret_cast<uint8_t*>(cipher), plain_length);
+    finalTag(t, x, j0, aad_length, plain_length);
+    ::memcpy(tag, t, tag_length);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Authenticated decryption.
+//----------------------------------------------------------------------------
+
+bool ArmAESGCM::open(const void* iv, size_t iv_length, const void* aad, size_t aad_length,
+                     const void* cipher, size_t cipher_length, void* plain, const void* tag, size_t tag_length)
+{
+    if (!accelerated() || iv_length == 0 || tag_length == 0 || tag_length > TAG_SIZE) {
+        return false;
+    }
+
+    uint8_t t[TAG_SIZE];
+    const uint8x16_t j0 = initCounter(reinterpret_cast<const uint8_t*>(iv), iv_length);
+    uint64x2_t x = ghash(vdupq_n_u64(0), reinterpret_cast<const uint8_t*>(aad), aad_length);
+    x = decryptHash(x, j0, reinterpret_cast<const uint8_t*>(cipher), reinterpret_cast<uint8_t*>(plain), cipher_length);
+    finalTag(t, x, j0, aad_length, cipher_length);
+
+    // Constant-time comparison of the tags. On failure, the decrypted data are erased.
+    const uint8_t* expected = reinterpret_cast<const uint8_t*>(tag);
+    uint8_t diff = 0;
+    for (size_t i = 0; i < tag_length; ++i) {
+        diff |= t[i] ^ expected[i];
+    }
+    if (diff != 0) {
+        bzero(plain, cipher_length);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,54 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// AES-GCM (NIST SP 800-38D) using Arm64 instructions.
+// The CTR encryption uses AESE/AESMC on 8 blocks in parallel and GHASH uses
+// PMULL with precomputed powers of H (one reduction per group of 8 blocks).
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "ArmAES.h"
+
+class ArmAESGCM: public ArmAES
+{
+ public:
+    ArmAESGCM();                              //!< Constructor.
+    static constexpr size_t TAG_SIZE = 16;    //!< Maximum authentication tag size in bytes.
+    static constexpr size_t IV_SIZE = 12;     //!< Recommended IV size in bytes.
+
+    // Check if the AES and PMULL instructions are present. When they are not,
+    // setKey(), seal() and open() return false. Use AESGCM instead.
+    static bool accelerated();
+
+    bool setKey(const void* key, size_t key_length);
+
+    // Authenticated encryption: the cipher buffer has the same size as the plain text.
+    bool seal(const void* iv, size_t iv_length, const void* aad, size_t aad_length,
+              const void* plain, size_t plain_length, void* cipher, void* tag, size_t tag_length = TAG_SIZE);
+
+    // Authenticated decryption: return false if the tag does not match.
+    bool open(const void* iv, size_t iv_length, const void* aad, size_t aad_length,
+              const void* cipher, size_t cipher_length, void* plain, const void* tag, size_t tag_length = TAG_SIZE);
+
+ private:
+    // Powers of H in GHASH representation (byte-reversed, multiplied by x^-1).
+    // _H[i] is H^(i+1). _Hk[i] contains the XOR of the two halves of _H[i] (Karatsuba).
+    uint64x2_t _H[PARALLEL_BLOCKS];
+    uint64x2_t _Hk[PARALLEL_BLOCKS];
+
+    // Precompute the powers of H after scheduling the key.
+    void initPowers() TARGET_AES;
+    // Compute the initial counter block J0 from the IV.
+    uint8x16_t initCounter(const uint8_t* iv, size_t iv_length) const TARGET_AES;
+    // Accumulate data (zero-padded to complete blocks) into GHASH.
+    uint64x2_t ghash(uint64x2_t x, const uint8_t* data, size_t size) const TARGET_AES;
+    // Encrypt or decrypt in CTR mode, fused with GHASH on the cipher text.
+    uint64x2_t encryptHash(uint64x2_t x, uint8x16_t j0, const uint8_t* in, uint8_t* out, size_t size) const TARGET_AES;
+    uint64x2_t decryptHash(uint64x2_t x, uint8x16_t j0, const uint8_t* in, uint8_t* out, size_t size) const TARGET_AES;
+    // Compute the tag from the final GHASH and J0.
+    void finalTag(uint8_t* tag, uint64x2_t x, uint8x16_t j0, size_t aad_length, size_t data_length) const TARGET_AES;
+};
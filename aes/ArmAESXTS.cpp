@@ -0,0 +1,239 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// AES in XTS mode (IEEE 1619, NIST SP 800-38E) using Arm64 instructions.
+//
+//----------------------------------------------------------------------------
+
+#include "ArmAESXTS.h"
+
+namespace {
+
+    // Multiply a tweak by x in GF(2^128). The tweak is a 128-bit little-endian
+    // integer: shift left by one bit in both lanes, the top bit of lane 0 moves
+    // to lane 1 and the top bit of lane 1 is reduced as x^7+x^2+x+1 (0x87) in
+    // lane 0. The arithmetic shift turns the top bit of each lane into a mask.
+    inline __attribute__((always_inline)) uint8x16_t nextTweak(uint8x16_t t, uint64x2_t poly)
+    {
+        const uint64x2_t v = vreinterpretq_u64_u8(t);
+        const uint64x2_t top = vreinterpretq_u64_s64(vshrq_n_s64(vreinterpretq_s64_u64(v), 63));
+        return vreinterpretq_u8_u64(veorq_u64(vshlq_n_u64(v, 1), vandq_u64(vextq_u64(top, top, 1), poly)));
+    }
+
+    // Reduction constant for nextTweak(): 0x87 in lane 0, carry 1 in lane 1.
+    inline __attribute__((always_inline)) uint64x2_t tweakPoly()
+    {
+        return vcombine_u64(vcreate_u64(0x87), vcreate_u64(1));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ArmAESXTS::ArmAESXTS() :
+    ArmAES(),
+    _tweak_key(),
+    _tweak(vdupq_n_u8(0))
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Schedule the two keys.
+//----------------------------------------------------------------------------
+
+bool ArmAESXTS::setKey(const void* key, size_t key_length)
+{
+    // Validate the complete key first, the two AES keys cannot fail after this.
+    const uint8_t* key8 = reinterpret_cast<const uint8_t*>(key);
+    const size_t half = key_length / 2;
+    if (key == nullptr || (key_length != 32 && key_length != 64) || ::memcmp(key8, key8 + half, half) == 0) {
+        return false;
+    }
+    return ArmAES::setKey(key8, half) && _tweak_key.setKey(key8 + half, half);
+}
+
+
+//----------------------------------------------------------------------------
+// Set the tweak of the next data unit.
+//----------------------------------------------------------------------------
+
+bool ArmAESXTS::setIV(const void* iv, size_t iv_length)
+{
+    if (iv_length != BLOCK_SIZE) {
+        return false;
+    }
+    _tweak = vld1q_u8(reinterpret_cast<const uint8_t*>(iv));
+    return true;
+}
+
+void ArmAESXTS::setSector(uint64_t sector)
+{
+    // Assume little endian.
+    _tweak = vreinterpretq_u8_u64(vcombine_u64(vcreate_u64(sector), vcreate_u64(0)));
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt one data unit.
+//----------------------------------------------------------------------------
+
+bool ArmAESXTS::encrypt(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length)
+{
+    if (!accelerated() || plain_length < BLOCK_SIZE || cipher_maxsize < plain_length) {
+        return false;
+    }
+    encryptUnit(reinterpret_cast<const uint8_t*>(plain), reinterpret_cast<uint8_t*>(cipher), plain_length);
+    if (cipher_length != nullptr) {
+        *cipher_length = plain_length;
+    }
+    return true;
+}
+
+TARGET_AES void ArmAESXTS::encryptUnit(const uint8_t* in, uint8_t* out, size_t length)
+{
+    const size_t residue = length % BLOCK_SIZE;
+    size_t count = length / BLOCK_SIZE - (residue > 0 ? 1 : 0);
+    const uint64x2_t poly = tweakPoly();
+
+    // Encrypted tweak of the first block.
+    uint8_t buf[BLOCK_SIZE];
+    vst1q_u8(buf, _tweak);
+    _tweak_key.encrypt(buf, sizeof(buf), buf, sizeof(buf), nullptr);
+    uint8x16_t t = vld1q_u8(buf);
+
+    while (count >= PARALLEL_BLOCKS) {
+        const uint8x16_t t0 = t;
+        const uint8x16_t t1 = nextTweak(t0, poly);
+        const uint8x16_t t2 = nextTweak(t1, poly);
+        const uint8x16_t t3 = nextTweak(t2, poly);
+        const uint8x16_t t4 = nextTweak(t3, poly);
+        const uint8x16_t t5 = nextTweak(t4, poly);
+        const uint8x16_t t6 = nextTweak(t5, poly);
+        const uint8x16_t t7 = nextTweak(t6, poly);
+        t = nextTweak(t7, poly);
+        uint8x16_t b0 = veorq_u8(vld1q_u8(in), t0);
+        uint8x16_t b1 = veorq_u8(vld1q_u8(in + 16), t1);
+        uint8x16_t b2 = veorq_u8(vld1q_u8(in + 32), t2);
+        uint8x16_t b3 = veorq_u8(vld1q_u8(in + 48), t3);
+        uint8x16_t b4 = veorq_u8(vld1q_u8(in + 64), t4);
+        uint8x16_t b5 = veorq_u8(vld1q_u8(in + 80), t5);
+        uint8x16_t b6 = veorq_u8(vld1q_u8(in + 96), t6);
+        uint8x16_t b7 = veorq_u8(vld1q_u8(in + 112), t7);
+        encrypt8(b0, b1, b2, b3, b4, b5, b6, b7);
+        vst1q_u8(out, veorq_u8(b0, t0));
+        vst1q_u8(out + 16, veorq_u8(b1, t1));
+        vst1q_u8(out + 32, veorq_u8(b2, t2));
+        vst1q_u8(out + 48, veorq_u8(b3, t3));
+        vst1q_u8(out + 64, veorq_u8(b4, t4));
+        vst1q_u8(out + 80, veorq_u8(b5, t5));
+        vst1q_u8(out + 96, veorq_u8(b6, t6));
+        vst1q_u8(out + 112, veorq_u8(b7, t7));
+        in += PARALLEL_BLOCKS * BLOCK_SIZE;
+        out += PARALLEL_BLOCKS * BLOCK_SIZE;
+        count -= PARALLEL_BLOCKS;
+    }
+    while (count-- > 0) {
+        vst1q_u8(out, veorq_u8(encrypt1(veorq_u8(vld1q_u8(in), t)), t));
+        t = nextTweak(t, poly);
+        in += BLOCK_SIZE;
+        out += BLOCK_SIZE;
+    }
+
+    // Ciphertext stealing: the last complete block is encrypted first, its head becomes
+    // the final partial block and its tail completes the last plain text block.
+    if (residue > 0) {
+        vst1q_u8(buf, veorq_u8(encrypt1(veorq_u8(vld1q_u8(in), t)), t));
+        for (size_t i = 0; i < residue; ++i) {
+            const uint8_t p = in[BLOCK_SIZE + i];
+            out[BLOCK_SIZE + i] = buf[i];
+            buf[i] = p;
+        }
+        t = nextTweak(t, poly);
+        vst1q_u8(out, veorq_u8(encrypt1(veorq_u8(vld1q_u8(buf), t)), t));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Decrypt one data unit.
+//----------------------------------------------------------------------------
+
+bool ArmAESXTS::decrypt(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize, size_t* plain_length)
+{
+    if (!accelerated() || cipher_length < BLOCK_SIZE || plain_maxsize < cipher_length) {
+        return false;
+    }
+    decryptUnit(reinterpret_cast<const uint8_t*>(cipher), reinterpret_cast<uint8_t*>(plain), cipher_length);
+    if (plain_length != nullptr) {
+        *plain_length = cipher_length;
+    }
+    return true;
+}
+
+TARGET_AES void ArmAESXTS::decryptUnit(const uint8_t* in, uint8_t* out, size_t length)
+{
+    const size_t residue = length % BLOCK_SIZE;
+    size_t count = length / BLOCK_SIZE - (residue > 0 ? 1 : 0);
+    const uint64x2_t poly = tweakPoly();
+
+    uint8_t buf[BLOCK_SIZE];
+    vst1q_u8(buf, _tweak);
+    _tweak_key.encrypt(buf, sizeof(buf), buf, sizeof(buf), nullptr);
+    uint8x16_t t = vld1q_u8(buf);
+
+    while (count >= PARALLEL_BLOCKS) {
+        const uint8x16_t t0 = t;
+        const uint8x16_t t1 = nextTweak(t0, poly);
+        const uint8x16_t t2 = nextTweak(t1, poly);
+        const uint8x16_t t3 = nextTweak(t2, poly);
+        const uint8x16_t t4 = nextTweak(t3, poly);
+        const uint8x16_t t5 = nextTweak(t4, poly);
+        const uint8x16_t t6 = nextTweak(t5, poly);
+        const uint8x16_t t7 = nextTweak(t6, poly);
+        t = nextTweak(t7, poly);
+        uint8x16_t b0 = veorq_u8(vld1q_u8(in), t0);
+        uint8x16_t b1 = veorq_u8(vld1q_u8(in + 16), t1);
+        uint8x16_t b2 = veorq_u8(vld1q_u8(in + 32), t2);
+        uint8x16_t b3 = veorq_u8(vld1q_u8(in + 48), t3);
+        uint8x16_t b4 = veorq_u8(vld1q_u8(in + 64), t4);
+        uint8x16_t b5 = veorq_u8(vld1q_u8(in + 80), t5);
+        uint8x16_t b6 = veorq_u8(vld1q_u8(in + 96), t6);
+        uint8x16_t b7 = veorq_u8(vld1q_u8(in + 112), t7);
+        decrypt8(b0, b1, b2, b3, b4, b5, b6, b7);
+        vst1q_u8(out, veorq_u8(b0, t0));
+        vst1q_u8(out + 16, veorq_u8(b1, t1));
+        vst1q_u8(out + 32, veorq_u8(b2, t2));
+        vst1q_u8(out + 48, veorq_u8(b3, t3));
+        vst1q_u8(out + 64, veorq_u8(b4, t4));
+        vst1q_u8(out + 80, veorq_u8(b5, t5));
+        vst1q_u8(out + 96, veorq_u8(b6, t6));
+        vst1q_u8(out + 112, veorq_u8(b7, t7));
+        in += PARALLEL_BLOCKS * BLOCK_SIZE;
+        out += PARALLEL_BLOCKS * BLOCK_SIZE;
+        count -= PARALLEL_BLOCKS;
+    }
+    while (count-- > 0) {
+        vst1q_u8(out, veorq_u8(decrypt1(veorq_u8(vld1q_u8(in), t)), t));
+        t = nextTweak(t, poly);
+        in += BLOCK_SIZE;
+        out += BLOCK_SIZE;
+    }
+
+    // Ciphertext stealing: the tweaks of the last two blocks are used in reverse order.
+    if (residue > 0) {
+        const uint8x16_t tn = nextTweak(t, poly);
+        vst1q_u8(buf, veorq_u8(decrypt1(veorq_u8(vld1q_u8(in), tn)), tn));
+        for (size_t i = 0; i < residue; ++i) {
+            const uint8_t c = in[BLOCK_SIZE + i];
+            out[BLOCK_SIZE + i] = buf[i];
+            buf[i] = c;
+        }
+        vst1q_u8(out, veorq_u8(decrypt1(veorq_u8(vld1q_u8(buf), t)), t));
+    }
+}
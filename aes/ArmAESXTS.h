@@ -0,0 +1,43 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// AES in XTS mode (IEEE 1619, NIST SP 800-38E) using Arm64 instructions.
+// Each call to encrypt() or decrypt() processes one data unit (a sector).
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "ArmAES.h"
+
+class ArmAESXTS: public ArmAES
+{
+ public:
+    ArmAESXTS();  //!< Constructor.
+
+    // The key is the concatenation of the data key and the tweak key, 32 or 64 bytes
+    // for XTS-AES-128 or XTS-AES-256. The two halves must differ (IEEE 1619, FIPS 140).
+    // An invalid key is rejected without modification of the current keys.
+    bool setKey(const void* key, size_t key_length);
+
+    // Set the 16-byte tweak of the next data unit.
+    bool setIV(const void* iv, size_t iv_length);
+
+    // Set the tweak from a data unit (sector) number, as a 128-bit little-endian integer.
+    void setSector(uint64_t sector);
+
+    // Encrypt or decrypt one data unit, at least one block, any size (ciphertext stealing).
+    // Return false if the AES instructions are not present (see accelerated()).
+    bool encrypt(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length = nullptr);
+    bool decrypt(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize, size_t* plain_length = nullptr);
+
+ private:
+    ArmAES     _tweak_key;  // Key schedule of the tweak key (the data key is in the superclass).
+    uint8x16_t _tweak;      // Tweak of the next data unit, before encryption.
+
+    // Process one data unit, the size is already checked.
+    void encryptUnit(const uint8_t* in, uint8_t* out, size_t length) TARGET_AES;
+    void decryptUnit(const uint8_t* in, uint8_t* out, size_t length) TARGET_AES;
+};
@@ -11,6 +11,11 @@
 
 #include "AES.h"
 #include "ArmAES.h"
+#include "ArmAESCTR.h"
+#include "ArmAESCBC.h"
+#include "ArmAESXTS.h"
+#include "AESGCM.h"
+#include "ArmAESGCM.h"
 #include <ios>
 #include <iomanip>
 #include <iostream>
@@ -18,6 +23,7 @@
 #include <sys/resource.h>
 
 #define DEFAULT_ITERATIONS 10000000
+#define BULK_BLOCKS 4096  // 64 kB per call to encryptBlocks() or decryptBlocks()
 
 struct TestData {
     size_t  key_size;
@@ -77,6 +83,265 @@ uint64_t get_user_ms()
 }
 
 
+//----------------------------------------------------------------------------
+// Get the throughput in GB/s of a given amount of bytes in milliseconds.
+//----------------------------------------------------------------------------
+
+double get_gbps(uint64_t bytes, uint64_t ms)
+{
+    return ms > 0 ? double(bytes) / (double(ms) * 1000000.0) : 0.0;
+}
+
+
+//----------------------------------------------------------------------------
+// Check that all blocks of a bulk buffer are identical to a reference block.
+//----------------------------------------------------------------------------
+
+bool check_bulk(const uint8_t* buffer, const uint8_t* ref)
+{
+    for (size_t i = 0; i < BULK_BLOCKS; ++i) {
+        if (::memcmp(buffer + i * ArmAES::BLOCK_SIZE, ref, ArmAES::BLOCK_SIZE) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// CTR mode throughput by message size: ArmAES::encrypt() on one counter
+// block at a time versus ArmAESCTR, same amount of data for each size.
+//----------------------------------------------------------------------------
+
+void perf_ctr(const TestData* test, uint64_t total_bytes)
+{
+    static const size_t sizes[] = {16, 64, 188, 1024, 16384, 65536};
+    static uint8_t buffer[65536];
+    static const uint8_t iv[16] = {0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF};
+
+    ArmAES arm_aes;
+    ArmAESCTR arm_ctr;
+    arm_aes.setKey(test->key, test->key_size);
+    arm_ctr.setKey(test->key, test->key_size);
+
+    std::cout << "CTR mode AES-" << (test->key_size * 8) << " throughput (GB/s), ArmAES block by block / ArmAESCTR:" << std::endl;
+
+    for (size_t size : sizes) {
+        const int count = int(std::max<uint64_t>(1, total_bytes / size));
+        const uint64_t bytes = uint64_t(count) * size;
+
+        uint64_t start = get_user_ms();
+        for (int i = 0; i < count; ++i) {
+            uint8_t counter[16];
+            uint8_t ks[16];
+            ::memcpy(counter, iv, sizeof(counter));
+            for (size_t off = 0; off < size; off += ArmAES::BLOCK_SIZE) {
+                arm_aes.encrypt(counter, sizeof(counter), ks, sizeof(ks), nullptr);
+                for (size_t j = 0; j < ArmAES::BLOCK_SIZE && off + j < size; ++j) {
+                    buffer[off + j] ^= ks[j];
+                }
+                for (int j = 15; j >= 0 && ++counter[j] == 0; --j) {
+                }
+            }
+        }
+        const uint64_t time1 = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (int i = 0; i < count; ++i) {
+            arm_ctr.setIV(iv, sizeof(iv));
+            arm_ctr.encrypt(buffer, size, buffer, size);
+        }
+        const uint64_t time2 = get_user_ms() - start;
+
+        std::cout << "  " << std::setw(5) << size << " bytes: " << get_gbps(bytes, time1) << " / " << get_gbps(bytes, time2) << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+
+//----------------------------------------------------------------------------
+// CBC encryption and decryption throughput for various message sizes.
+//----------------------------------------------------------------------------
+
+void perf_cbc(const TestData* test, uint64_t total_bytes)
+{
+    static const size_t sizes[] = {16, 64, 188, 1024, 16384, 65536};
+    static uint8_t buffer[65536];
+    static const uint8_t iv[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F};
+
+    ArmAES arm_aes;
+    ArmAESCBC arm_cbc(ArmAESCBC::RESIDUE_PADDING);
+    arm_aes.setKey(test->key, test->key_size);
+    arm_cbc.setKey(test->key, test->key_size);
+    arm_cbc.setIV(iv, sizeof(iv));
+
+    std::cout << "CBC mode AES-" << (test->key_size * 8) << " throughput (GB/s), encrypt / decrypt, ArmAES block by block, ArmAESCBC:" << std::endl;
+
+    for (size_t size : sizes) {
+        // Block by block reference on complete blocks only.
+        const size_t blocks_size = size - size % ArmAES::BLOCK_SIZE;
+        const int count = int(std::max<uint64_t>(1, total_bytes / size));
+        const uint64_t bytes = uint64_t(count) * size;
+
+        uint64_t start = get_user_ms();
+        for (int i = 0; i < count; ++i) {
+            uint8_t block[16];
+            ::memcpy(block, iv, sizeof(block));
+            for (size_t off = 0; off < blocks_size; off += ArmAES::BLOCK_SIZE) {
+                for (size_t j = 0; j < ArmAES::BLOCK_SIZE; ++j) {
+                    block[j] ^= buffer[off + j];
+                }
+                arm_aes.encrypt(block, sizeof(block), block, sizeof(block), nullptr);
+                ::memcpy(buffer + off, block, sizeof(block));
+            }
+        }
+        const uint64_t time1e = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (int i = 0; i < count; ++i) {
+            uint8_t prev[16];
+            ::memcpy(prev, iv, sizeof(prev));
+            for (size_t off = 0; off < blocks_size; off += ArmAES::BLOCK_SIZE) {
+                uint8_t block[16];
+                arm_aes.decrypt(buffer + off, ArmAES::BLOCK_SIZE, block, sizeof(block), nullptr);
+                for (size_t j = 0; j < ArmAES::BLOCK_SIZE; ++j) {
+                    block[j] ^= prev[j];
+                }
+                ::memcpy(prev, buffer + off, sizeof(prev));
+                ::memcpy(buffer + off, block, sizeof(block));
+            }
+        }
+        const uint64_t time1d = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (int i = 0; i < count; ++i) {
+            arm_cbc.encrypt(buffer, size, buffer, size);
+        }
+        const uint64_t time2e = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (int i = 0; i < count; ++i) {
+            arm_cbc.decrypt(buffer, size, buffer, size);
+        }
+        const uint64_t time2d = get_user_ms() - start;
+
+        std::cout << "  " << std::setw(5) << size << " bytes: "
+                  << get_gbps(bytes, time1e) << " / " << get_gbps(bytes, time1d) << ", "
+                  << get_gbps(bytes, time2e) << " / " << get_gbps(bytes, time2d) << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+
+//----------------------------------------------------------------------------
+// XTS encryption and decryption of sectors of various sizes.
+//----------------------------------------------------------------------------
+
+void perf_xts(const TestData* test, uint64_t total_bytes)
+{
+    static const size_t sizes[] = {512, 1024, 2048, 4096};
+    static uint8_t buffer[4096];
+
+    // XTS key: data key from the test, tweak key derived from it.
+    uint8_t key[64];
+    for (size_t i = 0; i < test->key_size; ++i) {
+        key[i] = test->key[i];
+        key[test->key_size + i] = test->key[i] ^ 0x5A;
+    }
+    ArmAESXTS xts;
+    xts.setKey(key, 2 * test->key_size);
+
+    std::cout << "XTS mode AES-" << (test->key_size * 8) << ", ArmAESXTS, encrypt / decrypt:" << std::endl;
+
+    for (size_t size : sizes) {
+        const int count = int(std::max<uint64_t>(1, total_bytes / size));
+        const uint64_t bytes = uint64_t(count) * size;
+
+        uint64_t start = get_user_ms();
+        for (int i = 0; i < count; ++i) {
+            xts.setSector(uint64_t(i));
+            xts.encrypt(buffer, size, buffer, size);
+        }
+        const uint64_t time_e = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (int i = 0; i < count; ++i) {
+            xts.setSector(uint64_t(i));
+            xts.decrypt(buffer, size, buffer, size);
+        }
+        const uint64_t time_d = get_user_ms() - start;
+
+        std::cout << "  " << std::setw(4) << size << " bytes: "
+                  << (time_e > 0 ? uint64_t(count) * 1000 / time_e : 0) << " / "
+                  << (time_d > 0 ? uint64_t(count) * 1000 / time_d : 0) << " sectors/s, "
+                  << get_gbps(bytes, time_e) << " / " << get_gbps(bytes, time_d) << " GB/s" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+
+//----------------------------------------------------------------------------
+// GCM seal and open throughput for various message sizes.
+//----------------------------------------------------------------------------
+
+void perf_gcm(const TestData* test, uint64_t total_bytes)
+{
+    static const size_t sizes[] = {16, 64, 188, 1024, 16384, 65536};
+    static uint8_t plain[65536];
+    static uint8_t cipher[65536];
+    static uint8_t output[65536];
+    static const uint8_t iv[12] = {0xCA, 0xFE, 0xBA, 0xBE, 0xFA, 0xCE, 0xDB, 0xAD, 0xDE, 0xCA, 0xF8, 0x88};
+    static const uint8_t aad[20] = {0xFE, 0xED, 0xFA, 0xCE, 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED, 0xFA, 0xCE, 0xDE, 0xAD, 0xBE, 0xEF, 0xAB, 0xAD, 0xDA, 0xD2};
+    uint8_t tag[16];
+
+    AESGCM aes_gcm;
+    ArmAESGCM arm_gcm;
+    aes_gcm.setKey(test->key, test->key_size);
+    arm_gcm.setKey(test->key, test->key_size);
+
+    std::cout << "GCM mode AES-" << (test->key_size * 8) << " throughput (GB/s), seal / open, AESGCM, ArmAESGCM:" << std::endl;
+
+    for (size_t size : sizes) {
+        // The portable reference is much slower, use less data.
+        const int count = int(std::max<uint64_t>(1, total_bytes / size));
+        const int ref_count = std::max(1, count / 16);
+        const uint64_t bytes = uint64_t(count) * size;
+        const uint64_t ref_bytes = uint64_t(ref_count) * size;
+        bool ok = true;
+
+        uint64_t start = get_user_ms();
+        for (int i = 0; i < ref_count; ++i) {
+            aes_gcm.seal(iv, sizeof(iv), aad, sizeof(aad), plain, size, cipher, tag);
+        }
+        const uint64_t time1s = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (int i = 0; i < ref_count; ++i) {
+            ok = aes_gcm.open(iv, sizeof(iv), aad, sizeof(aad), cipher, size, output, tag) && ok;
+        }
+        const uint64_t time1o = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (int i = 0; i < count; ++i) {
+            arm_gcm.seal(iv, sizeof(iv), aad, sizeof(aad), plain, size, cipher, tag);
+        }
+        const uint64_t time2s = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (int i = 0; i < count; ++i) {
+            ok = arm_gcm.open(iv, sizeof(iv), aad, sizeof(aad), cipher, size, output, tag) && ok;
+        }
+        const uint64_t time2o = get_user_ms() - start;
+
+        std::cout << "  " << std::setw(5) << size << " bytes: "
+                  << get_gbps(ref_bytes, time1s) << " / " << get_gbps(ref_bytes, time1o) << ", "
+                  << get_gbps(bytes, time2s) << " / " << get_gbps(bytes, time2o)
+                  << (ok ? "" : " (open FAILED)") << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+
 //----------------------------------------------------------------------------
 // Program entry point.
 //----------------------------------------------------------------------------
@@ -85,11 +350,16 @@ int main(int argc, char* argv[])
 {
     const int iterations = argc > 1 ? std::atoi(argv[1]) : DEFAULT_ITERATIONS;
 
-    std::cout << std::endl << "AES performance test, " << iterations << " iterations per operation " << std::endl << std::endl;
+    std::cout << std::endl << "AES performance test, " << iterations << " iterations per operation " << std::endl;
+    std::cout << "ArmAES implementation: " << (ArmAES::accelerated() ? "Arm64 AES instructions" : "portable") << std::endl << std::endl;
 
     AES aes;
     ArmAES arm_aes;
     uint8_t output[16];
+    static uint8_t bulk_in[BULK_BLOCKS * ArmAES::BLOCK_SIZE];
+    static uint8_t bulk_out[BULK_BLOCKS * ArmAES::BLOCK_SIZE];
+    const int bulk_iterations = std::max(1, iterations / BULK_BLOCKS);
+    const uint64_t bulk_bytes = uint64_t(bulk_iterations) * sizeof(bulk_in);
 
     for (auto test = test_data; test->key_size > 0; ++test) {
 
@@ -150,7 +420,70 @@ int main(int argc, char* argv[])
 
         std::cout << "Performance ratio: encrypt: " << (time2e > 0 ? double(time1e) / double(time2e) : 0.0)
                   << ", decrypt: " << (time2d > 0 ? double(time1d) / double(time2d) : 0.0)
-                  << std::endl << std::endl;
+                  << std::endl;
+
+        // Same amount of data using the interleaved bulk interface.
+        for (size_t i = 0; i < BULK_BLOCKS; ++i) {
+            ::memcpy(bulk_in + i * ArmAES::BLOCK_SIZE, test->plain, ArmAES::BLOCK_SIZE);
+        }
+        start = get_user_ms();
+        for (int i = 0; i < bulk_iterations; ++i) {
+            arm_aes.encryptBlocks(bulk_in, sizeof(bulk_in), bulk_out, sizeof(bulk_out));
+        }
+        const uint64_t time3e = get_user_ms() - start;
+
+        if (check_bulk(bulk_out, test->cipher)) {
+            std::cout << "Class ArmAES: AES-" << (test->key_size * 8) << " encryptBlocks, time: " << time3e << " ms" << std::endl;
+        }
+        else {
+            std::cout << "Class ArmAES: AES-" << (test->key_size * 8) << " encryptBlocks FAILED" << std::endl;
+        }
+
+        for (size_t i = 0; i < BULK_BLOCKS; ++i) {
+            ::memcpy(bulk_in + i * ArmAES::BLOCK_SIZE, test->cipher, ArmAES::BLOCK_SIZE);
+        }
+        start = get_user_ms();
+        for (int i = 0; i < bulk_iterations; ++i) {
+            arm_aes.decryptBlocks(bulk_in, sizeof(bulk_in), bulk_out, sizeof(bulk_out));
+        }
+        const uint64_t time3d = get_user_ms() - start;
+
+        if (check_bulk(bulk_out, test->plain)) {
+            std::cout << "Class ArmAES: AES-" << (test->key_size * 8) << " decryptBlocks, time: " << time3d << " ms" << std::endl;
+        }
+        else {
+            std::cout << "Class ArmAES: AES-" << (test->key_size * 8) << " decryptBlocks FAILED" << std::endl;
+        }
+
+        const uint64_t bytes = uint64_t(iterations) * ArmAES::BLOCK_SIZE;
+        std::cout << "Throughput (GB/s): AES: " << get_gbps(bytes, time1e) << " / " << get_gbps(bytes, time1d)
+                  << ", ArmAES: " << get_gbps(bytes, time2e) << " / " << get_gbps(bytes, time2d)
+                  << ", ArmAES bulk: " << get_gbps(bulk_bytes, time3e) << " / " << get_gbps(bulk_bytes, time3d)
+                  << " (encrypt / decrypt)" << std::endl << std::endl;
+    }
+
+    // The modes are implemented only with the AES (and PMULL) instructions.
+    if (!ArmAES::accelerated()) {
+        std::cout << "No AES instructions, CTR, CBC, XTS and GCM not tested" << std::endl;
+        return EXIT_SUCCESS;
+    }
+    for (auto test = test_data; test->key_size > 0; ++test) {
+        perf_ctr(test, uint64_t(iterations) * ArmAES::BLOCK_SIZE);
+    }
+    for (auto test = test_data; test->key_size > 0; ++test) {
+        perf_cbc(test, uint64_t(iterations) * ArmAES::BLOCK_SIZE);
+    }
+    for (auto test = test_data; test->key_size > 0; ++test) {
+        if (test->key_size != 24) {  // XTS-AES-128 and XTS-AES-256 only
+            perf_xts(test, uint64_t(iterations) * ArmAES::BLOCK_SIZE);
+        }
+    }
+    if (!ArmAESGCM::accelerated()) {
+        std::cout << "No PMULL instructions, GCM not tested" << std::endl;
+        return EXIT_SUCCESS;
+    }
+    for (auto test = test_data; test->key_size > 0; ++test) {
+        perf_gcm(test, uint64_t(iterations) * ArmAES::BLOCK_SIZE);
     }
 
     return EXIT_SUCCESS;
@@ -11,6 +11,11 @@
 
 #include "AES.h"
 #include "ArmAES.h"
+#include "ArmAESCTR.h"
+#include "ArmAESCBC.h"
+#include "ArmAESXTS.h"
+#include "AESGCM.h"
+#include "ArmAESGCM.h"
 #include <ios>
 #include <iomanip>
 #include <iostream>
@@ -87,6 +92,659 @@ static const TestData test_data[] = {
     {0, {}, {}}
 };
 
+// Chaining mode test vectors from NIST SP 800-38A, same plain text for all keys.
+// CTR: F.5.1, F.5.3, F.5.5. CBC: F.2.1, F.2.3, F.2.5.
+struct ModeTestData {
+    size_t  key_size;
+    uint8_t key[32];
+    uint8_t cipher[64];
+};
+
+static const uint8_t ctr_iv[16] = {
+    0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF,
+};
+
+static const uint8_t mode_plain[64] = {
+    0x6B, 0xC1, 0xBE, 0xE2, 0x2E, 0x40, 0x9F, 0x96, 0xE9, 0x3D, 0x7E, 0x11, 0x73, 0x93, 0x17, 0x2A,
+    0xAE, 0x2D, 0x8A, 0x57, 0x1E, 0x03, 0xAC, 0x9C, 0x9E, 0xB7, 0x6F, 0xAC, 0x45, 0xAF, 0x8E, 0x51,
+    0x30, 0xC8, 0x1C, 0x46, 0xA3, 0x5C, 0xE4, 0x11, 0xE5, 0xFB, 0xC1, 0x19, 0x1A, 0x0A, 0x52, 0xEF,
+    0xF6, 0x9F, 0x24, 0x45, 0xDF, 0x4F, 0x9B, 0x17, 0xAD, 0x2B, 0x41, 0x7B, 0xE6, 0x6C, 0x37, 0x10,
+};
+
+static const ModeTestData ctr_test_data[] = {
+    {
+        16,
+        {0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C},
+        {0x87, 0x4D, 0x61, 0x91, 0xB6, 0x20, 0xE3, 0x26, 0x1B, 0xEF, 0x68, 0x64, 0x99, 0x0D, 0xB6, 0xCE,
+         0x98, 0x06, 0xF6, 0x6B, 0x79, 0x70, 0xFD, 0xFF, 0x86, 0x17, 0x18, 0x7B, 0xB9, 0xFF, 0xFD, 0xFF,
+         0x5A, 0xE4, 0xDF, 0x3E, 0xDB, 0xD5, 0xD3, 0x5E, 0x5B, 0x4F, 0x09, 0x02, 0x0D, 0xB0, 0x3E, 0xAB,
+         0x1E, 0x03, 0x1D, 0xDA, 0x2F, 0xBE, 0x03, 0xD1, 0x79, 0x21, 0x70, 0xA0, 0xF3, 0x00, 0x9C, 0xEE},
+    },
+    {
+        24,
+        {0x8E, 0x73, 0xB0, 0xF7, 0xDA, 0x0E, 0x64, 0x52, 0xC8, 0x10, 0xF3, 0x2B, 0x80, 0x90, 0x79, 0xE5,
+         0x62, 0xF8, 0xEA, 0xD2, 0x52, 0x2C, 0x6B, 0x7B},
+        {0x1A, 0xBC, 0x93, 0x24, 0x17, 0x52, 0x1C, 0xA2, 0x4F, 0x2B, 0x04, 0x59, 0xFE, 0x7E, 0x6E, 0x0B,
+         0x09, 0x03, 0x39, 0xEC, 0x0A, 0xA6, 0xFA, 0xEF, 0xD5, 0xCC, 0xC2, 0xC6, 0xF4, 0xCE, 0x8E, 0x94,
+         0x1E, 0x36, 0xB2, 0x6B, 0xD1, 0xEB, 0xC6, 0x70, 0xD1, 0xBD, 0x1D, 0x66, 0x56, 0x20, 0xAB, 0xF7,
+         0x4F, 0x78, 0xA7, 0xF6, 0xD2, 0x98, 0x09, 0x58, 0x5A, 0x97, 0xDA, 0xEC, 0x58, 0xC6, 0xB0, 0x50},
+    },
+    {
+        32,
+        {0x60, 0x3D, 0xEB, 0x10, 0x15, 0xCA, 0x71, 0xBE, 0x2B, 0x73, 0xAE, 0xF0, 0x85, 0x7D, 0x77, 0x81,
+         0x1F, 0x35, 0x2C, 0x07, 0x3B, 0x61, 0x08, 0xD7, 0x2D, 0x98, 0x10, 0xA3, 0x09, 0x14, 0xDF, 0xF4},
+        {0x60, 0x1E, 0xC3, 0x13, 0x77, 0x57, 0x89, 0xA5, 0xB7, 0xA7, 0xF5, 0x04, 0xBB, 0xF3, 0xD2, 0x28,
+         0xF4, 0x43, 0xE3, 0xCA, 0x4D, 0x62, 0xB5, 0x9A, 0xCA, 0x84, 0xE9, 0x90, 0xCA, 0xCA, 0xF5, 0xC5,
+         0x2B, 0x09, 0x30, 0xDA, 0xA2, 0x3D, 0xE9, 0x4C, 0xE8, 0x70, 0x17, 0xBA, 0x2D, 0x84, 0x98, 0x8D,
+         0xDF, 0xC9, 0xC5, 0x8D, 0xB6, 0x7A, 0xAD, 0xA6, 0x13, 0xC2, 0xDD, 0x08, 0x45, 0x79, 0x41, 0xA6},
+    },
+    {0, {}, {}}
+};
+
+static const uint8_t cbc_iv[16] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+};
+
+static const ModeTestData cbc_test_data[] = {
+    {
+        16,
+        {0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C},
+        {0x76, 0x49, 0xAB, 0xAC, 0x81, 0x19, 0xB2, 0x46, 0xCE, 0xE9, 0x8E, 0x9B, 0x12, 0xE9, 0x19, 0x7D,
+         0x50, 0x86, 0xCB, 0x9B, 0x50, 0x72, 0x19, 0xEE, 0x95, 0xDB, 0x11, 0x3A, 0x91, 0x76, 0x78, 0xB2,
+         0x73, 0xBE, 0xD6, 0xB8, 0xE3, 0xC1, 0x74, 0x3B, 0x71, 0x16, 0xE6, 0x9E, 0x22, 0x22, 0x95, 0x16,
+         0x3F, 0xF1, 0xCA, 0xA1, 0x68, 0x1F, 0xAC, 0x09, 0x12, 0x0E, 0xCA, 0x30, 0x75, 0x86, 0xE1, 0xA7},
+    },
+    {
+        24,
+        {0x8E, 0x73, 0xB0, 0xF7, 0xDA, 0x0E, 0x64, 0x52, 0xC8, 0x10, 0xF3, 0x2B, 0x80, 0x90, 0x79, 0xE5,
+         0x62, 0xF8, 0xEA, 0xD2, 0x52, 0x2C, 0x6B, 0x7B},
+        {0x4F, 0x02, 0x1D, 0xB2, 0x43, 0xBC, 0x63, 0x3D, 0x71, 0x78, 0x18, 0x3A, 0x9F, 0xA0, 0x71, 0xE8,
+         0xB4, 0xD9, 0xAD, 0xA9, 0xAD, 0x7D, 0xED, 0xF4, 0xE5, 0xE7, 0x38, 0x76, 0x3F, 0x69, 0x14, 0x5A,
+         0x57, 0x1B, 0x24, 0x20, 0x12, 0xFB, 0x7A, 0xE0, 0x7F, 0xA9, 0xBA, 0xAC, 0x3D, 0xF1, 0x02, 0xE0,
+         0x08, 0xB0, 0xE2, 0x79, 0x88, 0x59, 0x88, 0x81, 0xD9, 0x20, 0xA9, 0xE6, 0x4F, 0x56, 0x15, 0xCD},
+    },
+    {
+        32,
+        {0x60, 0x3D, 0xEB, 0x10, 0x15, 0xCA, 0x71, 0xBE, 0x2B, 0x73, 0xAE, 0xF0, 0x85, 0x7D, 0x77, 0x81,
+         0x1F, 0x35, 0x2C, 0x07, 0x3B, 0x61, 0x08, 0xD7, 0x2D, 0x98, 0x10, 0xA3, 0x09, 0x14, 0xDF, 0xF4},
+        {0xF5, 0x8C, 0x4C, 0x04, 0xD6, 0xE5, 0xF1, 0xBA, 0x77, 0x9E, 0xAB, 0xFB, 0x5F, 0x7B, 0xFB, 0xD6,
+         0x9C, 0xFC, 0x4E, 0x96, 0x7E, 0xDB, 0x80, 0x8D, 0x67, 0x9F, 0x77, 0x7B, 0xC6, 0x70, 0x2C, 0x7D,
+         0x39, 0xF2, 0x33, 0x69, 0xA9, 0xD9, 0xBA, 0xCF, 0xA5, 0x30, 0xE2, 0x63, 0x04, 0x23, 0x14, 0x61,
+         0xB2, 0xEB, 0x05, 0xE2, 0xC3, 0x9B, 0xE9, 0xFC, 0xDA, 0x6C, 0x19, 0x07, 0x8C, 0x6A, 0x9D, 0x1B},
+    },
+    {0, {}, {}}
+};
+
+// XTS test vectors from IEEE 1619-2007, vectors 2 and 15 (ciphertext stealing).
+struct XTSTestData {
+    size_t   key_size;
+    uint8_t  key[64];
+    uint64_t sector;
+    size_t   size;
+    uint8_t  plain[32];
+    uint8_t  cipher[32];
+};
+
+static const XTSTestData xts_test_data[] = {
+    {
+        32,
+        {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+         0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22},
+        0x3333333333,
+        32,
+        {0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44,
+         0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44, 0x44},
+        {0xC4, 0x54, 0x18, 0x5E, 0x6A, 0x16, 0x93, 0x6E, 0x39, 0x33, 0x40, 0x38, 0xAC, 0xEF, 0x83, 0x8B,
+         0xFB, 0x18, 0x6F, 0xFF, 0x74, 0x80, 0xAD, 0xC4, 0x28, 0x93, 0x82, 0xEC, 0xD6, 0xD3, 0x94, 0xF0},
+    },
+    {
+        32,
+        {0xFF, 0xFE, 0xFD, 0xFC, 0xFB, 0xFA, 0xF9, 0xF8, 0xF7, 0xF6, 0xF5, 0xF4, 0xF3, 0xF2, 0xF1, 0xF0,
+         0xBF, 0xBE, 0xBD, 0xBC, 0xBB, 0xBA, 0xB9, 0xB8, 0xB7, 0xB6, 0xB5, 0xB4, 0xB3, 0xB2, 0xB1, 0xB0},
+        0x123456789A,
+        17,
+        {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+         0x10},
+        {0x6C, 0x16, 0x25, 0xDB, 0x46, 0x71, 0x52, 0x2D, 0x3D, 0x75, 0x99, 0x60, 0x1D, 0xE7, 0xCA, 0x09,
+         0xED},
+    },
+    {0, {}, 0, 0, {}, {}}
+};
+
+// GCM test vectors, from the original GCM specification (test cases 2, 4, 6, 16).
+struct GCMTestData {
+    size_t  key_size;
+    uint8_t key[32];
+    size_t  iv_size;
+    uint8_t iv[60];
+    size_t  aad_size;
+    uint8_t aad[20];
+    size_t  size;
+    uint8_t plain[60];
+    uint8_t cipher[60];
+    uint8_t tag[16];
+};
+
+static const GCMTestData gcm_test_data[] = {
+    {
+        16,
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+        12,
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+        0,
+        {},
+        16,
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+        {0x03, 0x88, 0xDA, 0xCE, 0x60, 0xB6, 0xA3, 0x92, 0xF3, 0x28, 0xC2, 0xB9, 0x71, 0xB2, 0xFE, 0x78},
+        {0xAB, 0x6E, 0x47, 0xD4, 0x2C, 0xEC, 0x13, 0xBD, 0xF5, 0x3A, 0x67, 0xB2, 0x12, 0x57, 0xBD, 0xDF}
+    },
+    {
+        16,
+        {0xFE, 0xFF, 0xE9, 0x92, 0x86, 0x65, 0x73, 0x1C, 0x6D, 0x6A, 0x8F, 0x94, 0x67, 0x30, 0x83, 0x08},
+        12,
+        {0xCA, 0xFE, 0xBA, 0xBE, 0xFA, 0xCE, 0xDB, 0xAD, 0xDE, 0xCA, 0xF8, 0x88},
+        20,
+        {0xFE, 0xED, 0xFA, 0xCE, 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED, 0xFA, 0xCE, 0xDE, 0xAD, 0xBE, 0xEF,
+         0xAB, 0xAD, 0xDA, 0xD2},
+        60,
+        {0xD9, 0x31, 0x32, 0x25, 0xF8, 0x84, 0x06, 0xE5, 0xA5, 0x59, 0x09, 0xC5, 0xAF, 0xF5, 0x26, 0x9A,
+         0x86, 0xA7, 0xA9, 0x53, 0x15, 0x34, 0xF7, 0xDA, 0x2E, 0x4C, 0x30, 0x3D, 0x8A, 0x31, 0x8A, 0x72,
+         0x1C, 0x3C, 0x0C, 0x95, 0x95, 0x68, 0x09, 0x53, 0x2F, 0xCF, 0x0E, 0x24, 0x49, 0xA6, 0xB5, 0x25,
+         0xB1, 0x6A, 0xED, 0xF5, 0xAA, 0x0D, 0xE6, 0x57, 0xBA, 0x63, 0x7B, 0x39},
+        {0x42, 0x83, 0x1E, 0xC2, 0x21, 0x77, 0x74, 0x24, 0x4B, 0x72, 0x21, 0xB7, 0x84, 0xD0, 0xD4, 0x9C,
+         0xE3, 0xAA, 0x21, 0x2F, 0x2C, 0x02, 0xA4, 0xE0, 0x35, 0xC1, 0x7E, 0x23, 0x29, 0xAC, 0xA1, 0x2E,
+         0x21, 0xD5, 0x14, 0xB2, 0x54, 0x66, 0x93, 0x1C, 0x7D, 0x8F, 0x6A, 0x5A, 0xAC, 0x84, 0xAA, 0x05,
+         0x1B, 0xA3, 0x0B, 0x39, 0x6A, 0x0A, 0xAC, 0x97, 0x3D, 0x58, 0xE0, 0x91},
+        {0x5B, 0xC9, 0x4F, 0xBC, 0x32, 0x21, 0xA5, 0xDB, 0x94, 0xFA, 0xE9, 0x5A, 0xE7, 0x12, 0x1A, 0x47}
+    },
+    {
+        16,
+        {0xFE, 0xFF, 0xE9, 0x92, 0x86, 0x65, 0x73, 0x1C, 0x6D, 0x6A, 0x8F, 0x94, 0x67, 0x30, 0x83, 0x08},
+        60,
+        {0x93, 0x13, 0x22, 0x5D, 0xF8, 0x84, 0x06, 0xE5, 0x55, 0x90, 0x9C, 0x5A, 0xFF, 0x52, 0x69, 0xAA,
+         0x6A, 0x7A, 0x95, 0x38, 0x53, 0x4F, 0x7D, 0xA1, 0xE4, 0xC3, 0x03, 0xD2, 0xA3, 0x18, 0xA7, 0x28,
+         0xC3, 0xC0, 0xC9, 0x51, 0x56, 0x80, 0x95, 0x39, 0xFC, 0xF0, 0xE2, 0x42, 0x9A, 0x6B, 0x52, 0x54,
+         0x16, 0xAE, 0xDB, 0xF5, 0xA0, 0xDE, 0x6A, 0x57, 0xA6, 0x37, 0xB3, 0x9B},
+        20,
+        {0xFE, 0xED, 0xFA, 0xCE, 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED, 0xFA, 0xCE, 0xDE, 0xAD, 0xBE, 0xEF,
+         0xAB, 0xAD, 0xDA, 0xD2},
+        60,
+        {0xD9, 0x31, 0x32, 0x25, 0xF8, 0x84, 0x06, 0xE5, 0xA5, 0x59, 0x09, 0xC5, 0xAF, 0xF5, 0x26, 0x9A,
+         0x86, 0xA7, 0xA9, 0x53, 0x15, 0x34, 0xF7, 0xDA, 0x2E, 0x4C, 0x30, 0x3D, 0x8A, 0x31, 0x8A, 0x72,
+         0x1C, 0x3C, 0x0C, 0x95, 0x95, 0x68, 0x09, 0x53, 0x2F, 0xCF, 0x0E, 0x24, 0x49, 0xA6, 0xB5, 0x25,
+         0xB1, 0x6A, 0xED, 0xF5, 0xAA, 0x0D, 0xE6, 0x57, 0xBA, 0x63, 0x7B, 0x39},
+        {0x8C, 0xE2, 0x49, 0x98, 0x62, 0x56, 0x15, 0xB6, 0x03, 0xA0, 0x33, 0xAC, 0xA1, 0x3F, 0xB8, 0x94,
+         0xBE, 0x91, 0x12, 0xA5, 0xC3, 0xA2, 0x11, 0xA8, 0xBA, 0x26, 0x2A, 0x3C, 0xCA, 0x7E, 0x2C, 0xA7,
+         0x01, 0xE4, 0xA9, 0xA4, 0xFB, 0xA4, 0x3C, 0x90, 0xCC, 0xDC, 0xB2, 0x81, 0xD4, 0x8C, 0x7C, 0x6F,
+         0xD6, 0x28, 0x75, 0xD2, 0xAC, 0xA4, 0x17, 0x03, 0x4C, 0x34, 0xAE, 0xE5},
+        {0x61, 0x9C, 0xC5, 0xAE, 0xFF, 0xFE, 0x0B, 0xFA, 0x46, 0x2A, 0xF4, 0x3C, 0x16, 0x99, 0xD0, 0x50}
+    },
+    {
+        32,
+        {0xFE, 0xFF, 0xE9, 0x92, 0x86, 0x65, 0x73, 0x1C, 0x6D, 0x6A, 0x8F, 0x94, 0x67, 0x30, 0x83, 0x08,
+         0xFE, 0xFF, 0xE9, 0x92, 0x86, 0x65, 0x73, 0x1C, 0x6D, 0x6A, 0x8F, 0x94, 0x67, 0x30, 0x83, 0x08},
+        12,
+        {0xCA, 0xFE, 0xBA, 0xBE, 0xFA, 0xCE, 0xDB, 0xAD, 0xDE, 0xCA, 0xF8, 0x88},
+        20,
+        {0xFE, 0xED, 0xFA, 0xCE, 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED, 0xFA, 0xCE, 0xDE, 0xAD, 0xBE, 0xEF,
+         0xAB, 0xAD, 0xDA, 0xD2},
+        60,
+        {0xD9, 0x31, 0x32, 0x25, 0xF8, 0x84, 0x06, 0xE5, 0xA5, 0x59, 0x09, 0xC5, 0xAF, 0xF5, 0x26, 0x9A,
+         0x86, 0xA7, 0xA9, 0x53, 0x15, 0x34, 0xF7, 0xDA, 0x2E, 0x4C, 0x30, 0x3D, 0x8A, 0x31, 0x8A, 0x72,
+         0x1C, 0x3C, 0x0C, 0x95, 0x95, 0x68, 0x09, 0x53, 0x2F, 0xCF, 0x0E, 0x24, 0x49, 0xA6, 0xB5, 0x25,
+         0xB1, 0x6A, 0xED, 0xF5, 0xAA, 0x0D, 0xE6, 0x57, 0xBA, 0x63, 0x7B, 0x39},
+        {0x52, 0x2D, 0xC1, 0xF0, 0x99, 0x56, 0x7D, 0x07, 0xF4, 0x7F, 0x37, 0xA3, 0x2A, 0x84, 0x42, 0x7D,
+         0x64, 0x3A, 0x8C, 0xDC, 0xBF, 0xE5, 0xC0, 0xC9, 0x75, 0x98, 0xA2, 0xBD, 0x25, 0x55, 0xD1, 0xAA,
+         0x8C, 0xB0, 0x8E, 0x48, 0x59, 0x0D, 0xBB, 0x3D, 0xA7, 0xB0, 0x8B, 0x10, 0x56, 0x82, 0x88, 0x38,
+         0xC5, 0xF6, 0x1E, 0x63, 0x93, 0xBA, 0x7A, 0x0A, 0xBC, 0xC9, 0xF6, 0x62},
+        {0x76, 0xFC, 0x6E, 0xCE, 0x0F, 0x4E, 0x17, 0x68, 0xCD, 0xDF, 0x88, 0x53, 0xBB, 0x2D, 0x55, 0x1B}
+    },
+    {0, {}, 0, {}, 0, {}, 0, {}, {}, {}}
+};
+
+
+//----------------------------------------------------------------------------
+// Test bulk ECB encryption against the block-by-block encryption.
+// Use a number of blocks which is not a multiple of the interleave factor.
+//----------------------------------------------------------------------------
+
+bool test_bulk(ArmAES& arm_aes)
+{
+    constexpr size_t count = 3 * ArmAES::PARALLEL_BLOCKS + 3;
+    uint8_t plain[count * ArmAES::BLOCK_SIZE];
+    uint8_t cipher[count * ArmAES::BLOCK_SIZE];
+    uint8_t bulk[count * ArmAES::BLOCK_SIZE];
+
+    for (size_t i = 0; i < sizeof(plain); ++i) {
+        plain[i] = uint8_t(i * 7 + 3);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const size_t off = i * ArmAES::BLOCK_SIZE;
+        arm_aes.encrypt(plain + off, ArmAES::BLOCK_SIZE, cipher + off, ArmAES::BLOCK_SIZE, nullptr);
+    }
+
+    bzero(bulk, sizeof(bulk));
+    bool ok = arm_aes.encryptBlocks(plain, sizeof(plain), bulk, sizeof(bulk)) && ::memcmp(bulk, cipher, sizeof(cipher)) == 0;
+    ok = ok && arm_aes.decryptBlocks(bulk, sizeof(bulk), bulk, sizeof(bulk)) && ::memcmp(bulk, plain, sizeof(plain)) == 0;
+
+    // Without key, the bulk operations are rejected.
+    ArmAES no_key;
+    ok = ok && !no_key.encryptBlocks(plain, sizeof(plain), bulk, sizeof(bulk)) &&
+               !no_key.decryptBlocks(plain, sizeof(plain), bulk, sizeof(bulk));
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Test CTR mode on a long message, with a carry in the 128-bit counter.
+// The reference is computed block by block using a byte-wise counter.
+//----------------------------------------------------------------------------
+
+bool test_ctr_long(const ModeTestData* test)
+{
+    constexpr size_t size = 41 * ArmAES::BLOCK_SIZE + 7;
+    const uint8_t iv[16] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF9};
+    uint8_t counter[16];
+    uint8_t plain[size];
+    uint8_t ref[size];
+    uint8_t cipher[size];
+
+    ArmAES ecb;
+    ecb.setKey(test->key, test->key_size);
+    for (size_t i = 0; i < size; ++i) {
+        plain[i] = uint8_t(i * 13 + 1);
+    }
+    ::memcpy(counter, iv, sizeof(counter));
+    for (size_t off = 0; off < size; off += ArmAES::BLOCK_SIZE) {
+        uint8_t ks[16];
+        ecb.encrypt(counter, sizeof(counter), ks, sizeof(ks), nullptr);
+        for (size_t i = 0; i < ArmAES::BLOCK_SIZE && off + i < size; ++i) {
+            ref[off + i] = plain[off + i] ^ ks[i];
+        }
+        for (int i = 15; i >= 0 && ++counter[i] == 0; --i) {
+        }
+    }
+
+    // One single call, then chunks of various sizes.
+    ArmAESCTR ctr;
+    ctr.setKey(test->key, test->key_size);
+    ctr.setIV(iv, sizeof(iv));
+    bool ok = ctr.encrypt(plain, size, cipher, size) && ::memcmp(cipher, ref, size) == 0;
+
+    bzero(cipher, sizeof(cipher));
+    ctr.setIV(iv, sizeof(iv));
+    for (size_t off = 0, chunk = 1; off < size; off += chunk, chunk = chunk * 3 + 1) {
+        chunk = std::min(chunk, size - off);
+        ok = ctr.encrypt(plain + off, chunk, cipher + off, chunk) && ok;
+    }
+    return ok && ::memcmp(cipher, ref, size) == 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Test CTR mode on NIST vectors.
+//----------------------------------------------------------------------------
+
+void test_ctr()
+{
+    ArmAESCTR ctr;
+    uint8_t buf[64];
+
+    for (auto test = ctr_test_data; test->key_size > 0; ++test) {
+
+        bzero(buf, sizeof(buf));
+        ctr.setKey(test->key, test->key_size);
+        ctr.setIV(ctr_iv, sizeof(ctr_iv));
+        ctr.encrypt(mode_plain, sizeof(mode_plain), buf, sizeof(buf));
+        const bool enc_ok = ::memcmp(buf, test->cipher, sizeof(buf)) == 0;
+
+        // Several chunks, not aligned on blocks.
+        bzero(buf, sizeof(buf));
+        ctr.setIV(ctr_iv, sizeof(ctr_iv));
+        ctr.encrypt(mode_plain, 1, buf, 1);
+        ctr.encrypt(mode_plain + 1, 15, buf + 1, 15);
+        ctr.encrypt(mode_plain + 16, 17, buf + 16, 17);
+        ctr.encrypt(mode_plain + 33, 31, buf + 33, 31);
+        const bool chunks_ok = ::memcmp(buf, test->cipher, sizeof(buf)) == 0;
+
+        bzero(buf, sizeof(buf));
+        ctr.setIV(ctr_iv, sizeof(ctr_iv));
+        ctr.decrypt(test->cipher, sizeof(test->cipher), buf, sizeof(buf));
+        const bool dec_ok = ::memcmp(buf, mode_plain, sizeof(buf)) == 0;
+
+        std::cout << "Key: " << (test->key_size * 8)
+                  << " bits, ArmAESCTR encrypt: " << (enc_ok ? "passed" : "FAILED")
+                  << ", chunks: " << (chunks_ok ? "passed" : "FAILED")
+                  << ", decrypt: " << (dec_ok ? "passed" : "FAILED")
+                  << ", long: " << (test_ctr_long(test) ? "passed" : "FAILED")
+                  << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test CBC mode with padding on messages of many sizes, including the
+// 8-block decryption path. The reference is computed block by block.
+//----------------------------------------------------------------------------
+
+bool test_cbc_padding(const ModeTestData* test, ArmAESCBC::Padding padding)
+{
+    constexpr size_t max_size = 3 * ArmAES::PARALLEL_BLOCKS * ArmAES::BLOCK_SIZE + 37;
+    uint8_t plain[max_size];
+    uint8_t ref[max_size + ArmAES::BLOCK_SIZE];
+    uint8_t cipher[max_size + ArmAES::BLOCK_SIZE];
+
+    ArmAES ecb;
+    ArmAESCBC cbc(padding);
+    ecb.setKey(test->key, test->key_size);
+    cbc.setKey(test->key, test->key_size);
+    cbc.setIV(cbc_iv, sizeof(cbc_iv));
+    for (size_t i = 0; i < sizeof(plain); ++i) {
+        plain[i] = uint8_t(i * 13 + 1);
+    }
+
+    bool ok = true;
+    for (size_t size = 0; size <= max_size; size += size < 40 ? 1 : 23) {
+
+        // Reference: PKCS#7 pads the last block, residue is XOR'ed with E(last cipher block or IV).
+        const size_t count = size / ArmAES::BLOCK_SIZE;
+        const size_t residue = size % ArmAES::BLOCK_SIZE;
+        const size_t ref_size = padding == ArmAESCBC::PKCS7_PADDING ? (count + 1) * ArmAES::BLOCK_SIZE : size;
+        uint8_t prev[16];
+        ::memcpy(prev, cbc_iv, sizeof(prev));
+        for (size_t off = 0; off < ref_size; off += ArmAES::BLOCK_SIZE) {
+            uint8_t block[16];
+            if (off + ArmAES::BLOCK_SIZE <= size || padding == ArmAESCBC::PKCS7_PADDING) {
+                for (size_t i = 0; i < ArmAES::BLOCK_SIZE; ++i) {
+                    block[i] = prev[i] ^ (off + i < size ? plain[off + i] : uint8_t(ArmAES::BLOCK_SIZE - residue));
+                }
+                ecb.encrypt(block, sizeof(block), prev, sizeof(prev), nullptr);
+                ::memcpy(ref + off, prev, sizeof(prev));
+            }
+            else {
+                ecb.encrypt(prev, sizeof(prev), block, sizeof(block), nullptr);
+                for (size_t i = 0; i < residue; ++i) {
+                    ref[off + i] = plain[off + i] ^ block[i];
+                }
+            }
+        }
+
+        // Encryption, then in-place decryption.
+        size_t length = 0;
+        bzero(cipher, sizeof(cipher));
+        ok = cbc.encrypt(plain, size, cipher, sizeof(cipher), &length) && length == ref_size && ::memcmp(cipher, ref, ref_size) == 0 && ok;
+        ok = cbc.decrypt(cipher, ref_size, cipher, sizeof(cipher), &length) && length == size && ::memcmp(cipher, plain, size) == 0 && ok;
+    }
+
+    // Invalid PKCS#7 padding must be rejected.
+    if (padding == ArmAESCBC::PKCS7_PADDING) {
+        uint8_t out[sizeof(cipher)];
+        ok = cbc.encrypt(plain, 40, cipher, sizeof(cipher)) && ok;
+        cipher[30] ^= 0x01;  // corrupt the last padding byte through the chaining
+        ok = !cbc.decrypt(cipher, 48, out, sizeof(out)) && ok;
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Test CBC mode on NIST vectors.
+//----------------------------------------------------------------------------
+
+void test_cbc()
+{
+    ArmAESCBC cbc;
+    uint8_t buf[64];
+
+    for (auto test = cbc_test_data; test->key_size > 0; ++test) {
+
+        bzero(buf, sizeof(buf));
+        cbc.setKey(test->key, test->key_size);
+        cbc.setIV(cbc_iv, sizeof(cbc_iv));
+        cbc.encrypt(mode_plain, sizeof(mode_plain), buf, sizeof(buf));
+        const bool enc_ok = ::memcmp(buf, test->cipher, sizeof(buf)) == 0;
+
+        bzero(buf, sizeof(buf));
+        cbc.decrypt(test->cipher, sizeof(test->cipher), buf, sizeof(buf));
+        const bool dec_ok = ::memcmp(buf, mode_plain, sizeof(buf)) == 0;
+
+        std::cout << "Key: " << (test->key_size * 8)
+                  << " bits, ArmAESCBC encrypt: " << (enc_ok ? "passed" : "FAILED")
+                  << ", decrypt: " << (dec_ok ? "passed" : "FAILED")
+                  << ", PKCS#7: " << (test_cbc_padding(test, ArmAESCBC::PKCS7_PADDING) ? "passed" : "FAILED")
+                  << ", residue: " << (test_cbc_padding(test, ArmAESCBC::RESIDUE_PADDING) ? "passed" : "FAILED")
+                  << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// XTS reference helpers: encrypt one block with a tweak, multiply a tweak by x.
+//----------------------------------------------------------------------------
+
+void xts_block(ArmAES& key, const uint8_t* in, const uint8_t* tweak, uint8_t* out)
+{
+    uint8_t block[16];
+    for (size_t i = 0; i < ArmAES::BLOCK_SIZE; ++i) {
+        block[i] = in[i] ^ tweak[i];
+    }
+    key.encrypt(block, sizeof(block), block, sizeof(block), nullptr);
+    for (size_t i = 0; i < ArmAES::BLOCK_SIZE; ++i) {
+        out[i] = block[i] ^ tweak[i];
+    }
+}
+
+void xts_double(uint8_t* tweak)
+{
+    uint8_t carry = 0;
+    for (size_t i = 0; i < ArmAES::BLOCK_SIZE; ++i) {
+        const uint8_t next = tweak[i] >> 7;
+        tweak[i] = uint8_t(tweak[i] << 1) | carry;
+        carry = next;
+    }
+    tweak[0] ^= carry * 0x87;
+}
+
+
+//----------------------------------------------------------------------------
+// Test XTS mode on data units of many sizes, including the 8-block path
+// and ciphertext stealing. The reference is computed block by block.
+//----------------------------------------------------------------------------
+
+bool test_xts_long(size_t key_size)
+{
+    constexpr size_t max_size = 4 * ArmAES::PARALLEL_BLOCKS * ArmAES::BLOCK_SIZE + 15;
+    uint8_t key[64];
+    uint8_t plain[max_size];
+    uint8_t ref[max_size];
+    uint8_t cipher[max_size];
+
+    for (size_t i = 0; i < sizeof(key); ++i) {
+        key[i] = uint8_t(i * 3 + 5);
+    }
+    for (size_t i = 0; i < sizeof(plain); ++i) {
+        plain[i] = uint8_t(i * 13 + 1);
+    }
+    ArmAES data_key;
+    ArmAES tweak_key;
+    ArmAESXTS xts;
+    data_key.setKey(key, key_size / 2);
+    tweak_key.setKey(key + key_size / 2, key_size / 2);
+    xts.setKey(key, key_size);
+
+    bool ok = true;
+    uint64_t sector = 0x00FFFFFFFFFFFFF0;
+    for (size_t size = ArmAES::BLOCK_SIZE; size <= max_size; size += size < 48 ? 1 : 29, ++sector) {
+
+        // Reference, the tweak is the little-endian sector number.
+        uint8_t tweak[16];
+        bzero(tweak, sizeof(tweak));
+        for (size_t i = 0; i < 8; ++i) {
+            tweak[i] = uint8_t(sector >> (8 * i));
+        }
+        tweak_key.encrypt(tweak, sizeof(tweak), tweak, sizeof(tweak), nullptr);
+        const size_t residue = size % ArmAES::BLOCK_SIZE;
+        const size_t last = size - residue - (residue > 0 ? ArmAES::BLOCK_SIZE : 0);
+        for (size_t off = 0; off < last; off += ArmAES::BLOCK_SIZE) {
+            xts_block(data_key, plain + off, tweak, ref + off);
+            xts_double(tweak);
+        }
+        if (residue > 0) {
+            // Ciphertext stealing on the last complete block and the final partial block.
+            uint8_t cc[16];
+            xts_block(data_key, plain + last, tweak, cc);
+            xts_double(tweak);
+            ::memcpy(ref + last + ArmAES::BLOCK_SIZE, cc, residue);
+            ::memcpy(cc, plain + last + ArmAES::BLOCK_SIZE, residue);
+            xts_block(data_key, cc, tweak, ref + last);
+        }
+
+        // Encryption, then in-place decryption.
+        bzero(cipher, sizeof(cipher));
+        xts.setSector(sector);
+        ok = xts.encrypt(plain, size, cipher, sizeof(cipher)) && ::memcmp(cipher, ref, size) == 0 && ok;
+        ok = xts.decrypt(cipher, size, cipher, sizeof(cipher)) && ::memcmp(cipher, plain, size) == 0 && ok;
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Test XTS mode on IEEE 1619 vectors.
+//----------------------------------------------------------------------------
+
+void test_xts()
+{
+    ArmAESXTS xts;
+    uint8_t buf[32];
+
+    for (auto test = xts_test_data; test->key_size > 0; ++test) {
+
+        bzero(buf, sizeof(buf));
+        xts.setKey(test->key, test->key_size);
+        xts.setSector(test->sector);
+        xts.encrypt(test->plain, test->size, buf, sizeof(buf));
+        const bool enc_ok = ::memcmp(buf, test->cipher, test->size) == 0;
+
+        bzero(buf, sizeof(buf));
+        xts.decrypt(test->cipher, test->size, buf, sizeof(buf));
+        const bool dec_ok = ::memcmp(buf, test->plain, test->size) == 0;
+
+        std::cout << "Key: " << (test->key_size * 4)
+                  << " bits, size: " << test->size
+                  << ", ArmAESXTS encrypt: " << (enc_ok ? "passed" : "FAILED")
+                  << ", decrypt: " << (dec_ok ? "passed" : "FAILED")
+                  << std::endl;
+    }
+    for (size_t key_size : {32, 64}) {
+        std::cout << "Key: " << (key_size * 4)
+                  << " bits, ArmAESXTS long: " << (test_xts_long(key_size) ? "passed" : "FAILED")
+                  << std::endl;
+    }
+
+    // Invalid keys: two AES-192 keys, identical halves. The previous key remains.
+    const XTSTestData* test = xts_test_data;
+    uint8_t key[64];
+    for (size_t i = 0; i < sizeof(key); ++i) {
+        key[i] = uint8_t(i);
+    }
+    uint8_t same[32];
+    ::memset(same, 0x5A, sizeof(same));
+    bool ok = xts.setKey(test->key, test->key_size) && !xts.setKey(key, 48) && !xts.setKey(same, sizeof(same));
+    bzero(buf, sizeof(buf));
+    xts.setSector(test->sector);
+    ok = ok && xts.encrypt(test->plain, test->size, buf, sizeof(buf)) && ::memcmp(buf, test->cipher, test->size) == 0;
+    std::cout << "ArmAESXTS invalid keys: " << (ok ? "passed" : "FAILED") << std::endl;
+}
+
+
+//----------------------------------------------------------------------------
+// Test GCM seal and open on a test vector, with a valid and a corrupted tag.
+//----------------------------------------------------------------------------
+
+template <class GCM>
+bool test_gcm_vector(GCM& gcm, const GCMTestData* test)
+{
+    uint8_t buf[60];
+    uint8_t tag[16];
+
+    bzero(buf, sizeof(buf));
+    bzero(tag, sizeof(tag));
+    bool ok = gcm.setKey(test->key, test->key_size) &&
+              gcm.seal(test->iv, test->iv_size, test->aad, test->aad_size, test->plain, test->size, buf, tag) &&
+              ::memcmp(buf, test->cipher, test->size) == 0 &&
+              ::memcmp(tag, test->tag, sizeof(tag)) == 0;
+
+    bzero(buf, sizeof(buf));
+    ok = ok && gcm.open(test->iv, test->iv_size, test->aad, test->aad_size, test->cipher, test->size, buf, test->tag) &&
+         ::memcmp(buf, test->plain, test->size) == 0;
+
+    ::memcpy(tag, test->tag, sizeof(tag));
+    tag[5] ^= 0x10;
+    return ok && !gcm.open(test->iv, test->iv_size, test->aad, test->aad_size, test->cipher, test->size, buf, tag);
+}
+
+
+//----------------------------------------------------------------------------
+// Test ArmAESGCM against AESGCM on long messages, using the 8-block path,
+// partial blocks, truncated tags and in-place decryption.
+//----------------------------------------------------------------------------
+
+bool test_gcm_long(const GCMTestData* test)
+{
+    constexpr size_t max_size = 19 * ArmAES::BLOCK_SIZE + 5;
+    static const size_t sizes[] = {0, 1, 16, 127, 128, 129, 200, 256, max_size};
+    uint8_t aad[150];
+    uint8_t plain[max_size];
+    uint8_t cipher[max_size];
+    uint8_t ref[max_size];
+    uint8_t tag[16];
+    uint8_t ref_tag[16];
+
+    AESGCM aes;
+    ArmAESGCM arm;
+    aes.setKey(test->key, test->key_size);
+    arm.setKey(test->key, test->key_size);
+    for (size_t i = 0; i < sizeof(aad); ++i) {
+        aad[i] = uint8_t(i * 5 + 2);
+    }
+    for (size_t i = 0; i < sizeof(plain); ++i) {
+        plain[i] = uint8_t(i * 11 + 7);
+    }
+
+    bool ok = true;
+    for (size_t size : sizes) {
+        const size_t aad_size = size % sizeof(aad);
+        const size_t tag_size = size % 2 == 0 ? 16 : 12;
+        aes.seal(test->iv, test->iv_size, aad, aad_size, plain, size, ref, ref_tag, tag_size);
+        ok = arm.seal(test->iv, test->iv_size, aad, aad_size, plain, size, cipher, tag, tag_size) &&
+             ::memcmp(cipher, ref, size) == 0 && ::memcmp(tag, ref_tag, tag_size) == 0 &&
+             arm.open(test->iv, test->iv_size, aad, aad_size, cipher, size, cipher, tag, tag_size) &&
+             ::memcmp(cipher, plain, size) == 0 && ok;
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Test GCM mode on test vectors.
+//----------------------------------------------------------------------------
+
+void test_gcm()
+{
+    AESGCM aes;
+    ArmAESGCM arm;
+
+    for (auto test = gcm_test_data; test->key_size > 0; ++test) {
+        std::cout << "Key: " << (test->key_size * 8)
+                  << " bits, IV: " << test->iv_size
+                  << " bytes, AESGCM: " << (test_gcm_vector(aes, test) ? "passed" : "FAILED")
+                  << ", ArmAESGCM: " << (test_gcm_vector(arm, test) ? "passed" : "FAILED")
+                  << ", long: " << (test_gcm_long(test) ? "passed" : "FAILED")
+                  << std::endl;
+    }
+}
+
 
 //----------------------------------------------------------------------------
 // Program entry point.
@@ -100,6 +758,7 @@ int main(int argc, char* argv[])
     uint8_t cipher[16];
 
     std::cout << "sizeof(uint8x16_t) = " << sizeof(uint8x16_t) << " bytes" << std::endl;
+    std::cout << "ArmAES implementation: " << (ArmAES::accelerated() ? "Arm64 AES instructions" : "portable") << std::endl;
 
     for (auto test = test_data; test->key_size > 0; ++test) {
 
@@ -124,8 +783,24 @@ int main(int argc, char* argv[])
                   << ", decrypt: " << (dec_ok ? "passed" : "FAILED")
                   << ", ArmAES encrypt: " << (arm_enc_ok ? "passed" : "FAILED")
                   << ", decrypt: " << (arm_dec_ok ? "passed" : "FAILED")
+                  << ", bulk: " << (test_bulk(arm_aes) ? "passed" : "FAILED")
                   << std::endl;
     }
 
+    // The modes are implemented only with the AES (and PMULL) instructions.
+    if (ArmAES::accelerated()) {
+        test_ctr();
+        test_cbc();
+        test_xts();
+    }
+    else {
+        std::cout << std::endl << "No AES instructions, CTR, CBC and XTS not tested" << std::endl;
+    }
+    if (ArmAESGCM::accelerated()) {
+        test_gcm();
+    }
+    else {
+        std::cout << std::endl << "No AES or PMULL instructions, GCM not tested" << std::endl;
+    }
     return EXIT_SUCCESS;
 }
@@ -9,6 +9,9 @@
 //----------------------------------------------------------------------------
 
 #include "ArmCRC32.h"
+#include "ArmCRC32Chains.h"
+#include "CRC32.h"
+#include <arm_neon.h>
 
 // Arm Architecture Reference Manual, about the CRC32 instructions: "To align
 // with common usage, the bit order of the values is reversed as part of the
@@ -20,7 +23,7 @@ namespace {
 
     // Reverse all bits inside each individual byte of a 64-bit value.
     // Then, add the 64-bit result in the CRC32 computation.
-    inline __attribute__((always_inline)) void crcAdd64(uint32_t& fcs, uint64_t x)
+    inline __attribute__((always_inline)) TARGET_CRC void crcAdd64(uint32_t& fcs, uint64_t x)
     {
         asm("rbit   %1, %1\n"
             "rev    %1, %1\n"
@@ -29,62 +32,193 @@ namespace {
     }
 
     // Same thing on one byte only.
-    inline __attribute__((always_inline)) void crcAdd8(uint32_t& fcs, uint8_t x)
+    inline __attribute__((always_inline)) TARGET_CRC void crcAdd8(uint32_t& fcs, uint8_t x)
     {
         asm("rbit   %1, %1\n"
             "rev    %1, %1\n"
             "crc32b %w0, %w0, %w1"
             : "+r" (fcs) : "r" (uint64_t(x)));
     }
+
+    // Reverse the 32 bits of a value (RBIT is always present).
+    inline __attribute__((always_inline)) uint32_t reverseBits(uint32_t x)
+    {
+        uint32_t y;
+        asm("rbit %w0, %w1" : "=r" (y) : "r" (x));
+        return y;
+    }
+
+    // Instructions of the MPEG-2 CRC for the CRC32X chains. A bit-reversed CRC value is
+    // shifted by n bytes with k = x^(8n-32) mod P: the 63-bit product by k, as a big-endian
+    // 8-byte message, has the CRC (starting from zero) value.x^8n mod P.
+    struct MPEG2Instructions
+    {
+        static inline __attribute__((always_inline)) TARGET_CRC void add64(uint32_t& fcs, uint64_t x) { crcAdd64(fcs, x); }
+        static inline __attribute__((always_inline)) TARGET_CRC void add8(uint32_t& fcs, uint8_t x) { crcAdd8(fcs, x); }
+        static inline __attribute__((always_inline)) uint32_t toPoly(uint32_t fcs) { return reverseBits(fcs); }
+        static inline __attribute__((always_inline)) uint64_t fromProduct(uint64_t x) { return ByteSwap64(x); }
+        static const uint32_t SHIFT_1_BLOCK = 0xD6DE9FBA;   // n = 1024 bytes
+        static const uint32_t SHIFT_2_BLOCKS = 0xDEEBB80B;  // n = 2048 bytes
+    };
+
+    typedef ArmCRC32Chains<MPEG2Instructions> Chains;
+
+    // Multiplication in "Montgomery" form: returns a.b.x^32 mod P, using PMULL for the
+    // product and CRC32X for the reduction. With a' = a.x^-32, the product of a' and b'
+    // is (a.b)' and the product of a' and b is a.b.
+    inline __attribute__((always_inline)) TARGET_AES_CRC uint32_t montMultiply(uint32_t a, uint32_t b)
+    {
+        uint32_t r = 0;
+        crcAdd64(r, ByteSwap64(vgetq_lane_u64(vreinterpretq_u64_p128(vmull_p64((poly64_t)a, (poly64_t)b)), 0)));
+        return reverseBits(r);
+    }
+
+    // Constants for combine() in Montgomery form: x^-32 mod P (one) and x^-24 mod P (x^8).
+    const uint32_t mont_one = 0xCBF1ACDA;
+    const uint32_t mont_x8 = 0x876D81F8;
+
+    // Load 16 bytes as a 128-bit polynomial, the first byte has the highest degree.
+    inline __attribute__((always_inline)) uint64x2_t loadPoly(const uint8_t* p)
+    {
+        const uint8x16_t b = vrev64q_u8(vld1q_u8(p));
+        return vreinterpretq_u64_u8(vextq_u8(b, b, 8));
+    }
+
+    // Store a 128-bit polynomial as 16 bytes, reverse of loadPoly().
+    inline __attribute__((always_inline)) void storePoly(uint8_t* p, uint64x2_t x)
+    {
+        const uint8x16_t b = vrev64q_u8(vreinterpretq_u8_u64(x));
+        vst1q_u8(p, vextq_u8(b, b, 8));
+    }
+
+    // Multiply a 128-bit polynomial by x^D, modulo the CRC polynomial P, with
+    // k = { x^D mod P, x^(D+64) mod P }. The result has at most 95 bits.
+    inline __attribute__((always_inline)) TARGET_AES uint64x2_t foldPoly(uint64x2_t x, uint64x2_t k)
+    {
+        const uint64x2_t lo = vreinterpretq_u64_p128(vmull_p64((poly64_t)vgetq_lane_u64(x, 0), (poly64_t)vgetq_lane_u64(k, 0)));
+        const uint64x2_t hi = vreinterpretq_u64_p128(vmull_high_p64(vreinterpretq_p64_u64(x), vreinterpretq_p64_u64(k)));
+        return veorq_u64(lo, hi);
+    }
+
+    // Folding constants { x^D mod P, x^(D+64) mod P } for P = 0x104C11DB7.
+    // The first one is for D = 1024 (8 blocks of 128 bits in the main loop).
+    // The other ones for D = 128 * n, n = 7 down to 1 (final reduction).
+    const uint64_t fold_constants[8][2] = {
+        {0x567FDDEB, 0x10BD4D7C},  // D = 1024
+        {0x3A06A4C6, 0x2ECC3300},  // D = 896
+        {0x1D49ADA7, 0x7606EEEB},  // D = 768
+        {0xF91A84E2, 0xE2CA9D03},  // D = 640
+        {0xE6228B11, 0x8833794C},  // D = 512
+        {0x8C3828A8, 0x64BF7A9B},  // D = 384
+        {0x75BE46B7, 0x569700E5},  // D = 256
+        {0xE8A45605, 0xC5B9CD4C},  // D = 128
+    };
+}
+
+// Check if the CRC32 instructions are present.
+bool ArmCRC32::accelerated()
+{
+    static const bool accel = HasCPUFeatures(CPU_CRC32);
+    return accel;
+}
+
+// Check if large buffers are folded using PMULL.
+bool ArmCRC32::folding()
+{
+    static const bool fold = HasCPUFeatures(CPU_CRC32 | CPU_PMULL);
+    return fold;
+}
+
+// Combine the CRC of two consecutive buffers.
+uint32_t ArmCRC32::combine(uint32_t crc_a, uint32_t crc_b, size_t size_b)
+{
+    return folding() ? combineArm(crc_a, crc_b, size_b) : CRC32::combine(crc_a, crc_b, size_b);
+}
+
+// Same algorithm as CRC32::combine(), in Montgomery form.
+TARGET_AES_CRC uint32_t ArmCRC32::combineArm(uint32_t crc_a, uint32_t crc_b, size_t size_b)
+{
+    uint32_t power = mont_one;
+    uint32_t square = mont_x8;
+    for (size_t n = size_b; n != 0; n >>= 1) {
+        if ((n & 1) != 0) {
+            power = montMultiply(power, square);
+        }
+        square = montMultiply(square, square);
+    }
+    return montMultiply(crc_a ^ 0xFFFFFFFF, power) ^ crc_b;
 }
 
 // Get the accumulated CRC32 value.
 // Reverse the 32 bits in the result.
 uint32_t ArmCRC32::value() const
 {
-    uint32_t x;
-    asm("rbit %w0, %w1" : "=r" (x) : "r" (_fcs));
-    return x;
+    return reverseBits(_fcs);
 }
 
+// Without CRC32 instructions, use the portable code on the non-reversed value.
 void ArmCRC32::add(const void* data, size_t size)
 {
-    // Add 8-bit values until an address aligned on 8 bytes.
-    const uint8_t* cp8 = reinterpret_cast<const uint8_t*>(data);
-    while (size != 0 && (uint64_t(cp8) & 0x03) != 0) {
-        crcAdd8(_fcs, *cp8++);
-        --size;
+    if (accelerated()) {
+        const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
+        if (size >= FOLD_BYTES && size >= _fold_threshold && folding()) {
+            // The CRC of the folded 16 bytes, starting from zero, is the CRC of the complete blocks.
+            const size_t len = size - size % FOLD_BYTES;
+            uint8_t rest[16];
+            foldArm(in, len, value(), rest);
+            _fcs = 0;
+            Chains::addChain(_fcs, rest, sizeof(rest));
+            in += len;
+            size -= len;
+        }
+        Chains::add(_fcs, in, size, _interleave_threshold, _pmull_merge);
     }
-
-    // Add 64-bit values until an address aligned on 64 bytes.
-    const uint64_t* cp64 = reinterpret_cast<const uint64_t*>(cp8);
-    while (size >= 8 && (uint64_t(cp64) & 0x07) != 0) {
-        crcAdd64(_fcs, *cp64++);
-        size -= 8;
+    else {
+        CRC32 crc(value());
+        crc.add(data, size);
+        _fcs = reverseBits(crc.value());
     }
+}
 
-    // Add 8 * 64-bit values until less than 64 bytes (manual loop unroll).
-    while (size >= 64) {
-        crcAdd64(_fcs, *cp64++);
-        crcAdd64(_fcs, *cp64++);
-        crcAdd64(_fcs, *cp64++);
-        crcAdd64(_fcs, *cp64++);
-        crcAdd64(_fcs, *cp64++);
-        crcAdd64(_fcs, *cp64++);
-        crcAdd64(_fcs, *cp64++);
-        crcAdd64(_fcs, *cp64++);
-        size -= 64;
-    }
+// The MPEG-2 CRC is not reflected. The message M (init XOR'ed in the first 4 bytes) is a
+// polynomial, the first byte having the highest degree, and the CRC is M.x^32 mod P.
+// Any 128-bit block followed by D bits can be replaced by its product with x^D mod P,
+// without changing the CRC. Eight independent blocks are folded in parallel.
+TARGET_AES void ArmCRC32::foldArm(const uint8_t* data, size_t size, uint32_t init, uint8_t* rest)
+{
+    uint64x2_t x0 = loadPoly(data);
+    uint64x2_t x1 = loadPoly(data + 16);
+    uint64x2_t x2 = loadPoly(data + 32);
+    uint64x2_t x3 = loadPoly(data + 48);
+    uint64x2_t x4 = loadPoly(data + 64);
+    uint64x2_t x5 = loadPoly(data + 80);
+    uint64x2_t x6 = loadPoly(data + 96);
+    uint64x2_t x7 = loadPoly(data + 112);
+    x0 = veorq_u64(x0, vcombine_u64(vcreate_u64(0), vcreate_u64(uint64_t(init) << 32)));
+    data += FOLD_BYTES;
+    size -= FOLD_BYTES;
 
-    // Add 64-bit values until less than 8 bytes.
-    while (size >= 8) {
-        crcAdd64(_fcs, *cp64++);
-        size -= 8;
+    const uint64x2_t k = vld1q_u64(fold_constants[0]);
+    while (size >= FOLD_BYTES) {
+        x0 = veorq_u64(foldPoly(x0, k), loadPoly(data));
+        x1 = veorq_u64(foldPoly(x1, k), loadPoly(data + 16));
+        x2 = veorq_u64(foldPoly(x2, k), loadPoly(data + 32));
+        x3 = veorq_u64(foldPoly(x3, k), loadPoly(data + 48));
+        x4 = veorq_u64(foldPoly(x4, k), loadPoly(data + 64));
+        x5 = veorq_u64(foldPoly(x5, k), loadPoly(data + 80));
+        x6 = veorq_u64(foldPoly(x6, k), loadPoly(data + 96));
+        x7 = veorq_u64(foldPoly(x7, k), loadPoly(data + 112));
+        data += FOLD_BYTES;
+        size -= FOLD_BYTES;
     }
 
-    // Add remaining bytes.
-    cp8 = reinterpret_cast<const uint8_t*>(cp64);
-    while (size--) {
-        crcAdd8(_fcs, *cp8++);
-    }
+    // Fold the 8 blocks into the last one.
+    x7 = veorq_u64(x7, foldPoly(x0, vld1q_u64(fold_constants[1])));
+    x7 = veorq_u64(x7, foldPoly(x1, vld1q_u64(fold_constants[2])));
+    x7 = veorq_u64(x7, foldPoly(x2, vld1q_u64(fold_constants[3])));
+    x7 = veorq_u64(x7, foldPoly(x3, vld1q_u64(fold_constants[4])));
+    x7 = veorq_u64(x7, foldPoly(x4, vld1q_u64(fold_constants[5])));
+    x7 = veorq_u64(x7, foldPoly(x5, vld1q_u64(fold_constants[6])));
+    x7 = veorq_u64(x7, foldPoly(x6, vld1q_u64(fold_constants[7])));
+    storePoly(rest, x7);
 }
@@ -9,16 +9,52 @@
 //----------------------------------------------------------------------------
 
 #pragma once
-#include <cstdlib>
+#include "platform.h"
 #include <cinttypes>
 
 class ArmCRC32
 {
 public:
-    ArmCRC32(uint32_t init = 0xFFFFFFFF) : _fcs(init) {}
+    ArmCRC32(uint32_t init = 0xFFFFFFFF) : _fcs(init), _fold_threshold(FOLD_THRESHOLD), _interleave_threshold(INTERLEAVE_THRESHOLD), _pmull_merge(true) {}
     void reset(uint32_t init = 0xFFFFFFFF) { _fcs = init; }
     void add(const void* data, size_t size);
     uint32_t value() const;
+
+    // Check if the CRC32 instructions are present, detected once at run time.
+    // When they are not, add() uses the portable implementation of class CRC32.
+    static bool accelerated();
+
+    // Check if large buffers are folded using PMULL (requires PMULL and CRC32 instructions).
+    static bool folding();
+
+    // Buffers of at least this size are folded 128 bytes at a time using PMULL,
+    // then the tail is added using CRC32X. Use SIZE_MAX to disable the folding.
+    static const size_t FOLD_THRESHOLD = 256;
+    void setFoldThreshold(size_t size) { _fold_threshold = size; }
+
+    // Without folding, buffers of at least this size are split in 3 regions which are
+    // processed in 3 independent CRC32X chains, then combined. Use SIZE_MAX to disable.
+    static const size_t INTERLEAVE_THRESHOLD = 3 * 1024;
+    void setInterleaveThreshold(size_t size) { _interleave_threshold = size; }
+
+    // The 3 chains are merged using PMULL when present. Use false to merge them using
+    // a software carry-less multiplication (for comparison only).
+    void setPMULLMerge(bool on) { _pmull_merge = on; }
+
+    // Same as CRC32::combine(), using PMULL and CRC32X when present.
+    static uint32_t combine(uint32_t crc_a, uint32_t crc_b, size_t size_b);
+
 private:
-    uint32_t _fcs;
+    static const size_t FOLD_BYTES = 128;          // Bytes per folding iteration.
+    uint32_t _fcs;                                 // Bit-reversed CRC32 value.
+    size_t   _fold_threshold;
+    size_t   _interleave_threshold;
+    bool     _pmull_merge;
+
+    // Fold data (multiple of FOLD_BYTES) with the initial CRC into 16 bytes which
+    // have the same CRC, starting from zero. PMULL is part of the AES extension.
+    static void foldArm(const uint8_t* data, size_t size, uint32_t init, uint8_t* rest) TARGET_AES;
+
+    // Implementation of combine() using PMULL and CRC32X.
+    static uint32_t combineArm(uint32_t crc_a, uint32_t crc_b, size_t size_b) TARGET_AES_CRC;
 };
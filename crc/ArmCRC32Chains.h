@@ -0,0 +1,208 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// CRC32X chains, common to ArmCRC32 (MPEG-2) and ArmReflectedCRC32 (IEEE 802.3,
+// CRC-32C). Internal header, included by the implementations only.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "platform.h"
+#include <cinttypes>
+#include <arm_neon.h>
+
+// The template parameter is a policy class with the instructions of the variant:
+//
+//   static void add64(uint32_t& fcs, uint64_t x);   // Add 8 bytes, CRC32X or equivalent.
+//   static void add8(uint32_t& fcs, uint8_t x);     // Add one byte, CRC32B or equivalent.
+//   static uint32_t toPoly(uint32_t fcs);           // Accumulated value as a polynomial for clmul32().
+//   static uint64_t fromProduct(uint64_t x);        // Product of clmul32() as an 8-byte message.
+//   static const uint32_t SHIFT_1_BLOCK;            // Shift constant for INTERLEAVE_BLOCK bytes.
+//   static const uint32_t SHIFT_2_BLOCKS;           // Shift constant for 2 * INTERLEAVE_BLOCK bytes.
+//
+// The functions of the policy are inlined in the chains, with TARGET_CRC.
+//
+// The values of the 3 interleaved chains are merged with one PMULL per shift when
+// the instruction is present. Otherwise, clmul32() computes the product in software.
+
+template <class ARM>
+class ArmCRC32Chains
+{
+public:
+    static const size_t INTERLEAVE_BLOCK = 1024;   // Bytes per region in each interleaved iteration.
+
+    // Add data in one CRC32X chain. When the size is at least interleave_threshold (and
+    // 3 * INTERLEAVE_BLOCK), use 3 interleaved chains on the largest aligned part. The
+    // chains are merged using PMULL when present, unless pmull_merge is false.
+    static void add(uint32_t& fcs, const uint8_t* data, size_t size, size_t interleave_threshold, bool pmull_merge = true) TARGET_CRC;
+
+    // Add data using one CRC32X chain, 8 bytes per instruction.
+    static void addChain(uint32_t& fcs, const uint8_t* data, size_t size) TARGET_CRC;
+
+    // Check if the PMULL instruction is present, detected once at run time.
+    static bool pmull();
+
+    // Add data (8-byte aligned, multiple of 3 * INTERLEAVE_BLOCK) using 3 CRC32X chains,
+    // merged using a software carry-less multiplication or using PMULL.
+    static void addInterleaved(uint32_t& fcs, const uint8_t* data, size_t size) TARGET_CRC;
+    static void addInterleavedArm(uint32_t& fcs, const uint8_t* data, size_t size) TARGET_AES_CRC;
+
+    // Add one INTERLEAVE_BLOCK in each of the 3 chains.
+    static void addBlocks(uint32_t& fcs0, uint32_t& fcs1, uint32_t& fcs2, const uint64_t* cp64) TARGET_CRC;
+
+    // Shift a CRC value by n bytes, as if n zero bytes were added (k depends on n).
+    static uint32_t shift(uint32_t fcs, uint32_t k) TARGET_CRC;
+    static uint32_t shiftArm(uint32_t fcs, uint32_t k) TARGET_AES_CRC;
+
+    // Carry-less multiplication of two 32-bit polynomials (without PMULL).
+    static uint64_t clmul32(uint32_t a, uint32_t b);
+};
+
+
+//----------------------------------------------------------------------------
+// Template definitions.
+//----------------------------------------------------------------------------
+
+template <class ARM>
+TARGET_CRC void ArmCRC32Chains<ARM>::add(uint32_t& fcs, const uint8_t* data, size_t size, size_t interleave_threshold, bool pmull_merge)
+{
+    if (size >= 3 * INTERLEAVE_BLOCK && size >= interleave_threshold) {
+        // Align the address for the interleaved chains.
+        const size_t head = (8 - size_t(data) % 8) % 8;
+        addChain(fcs, data, head);
+        data += head;
+        size -= head;
+        const size_t len = size - size % (3 * INTERLEAVE_BLOCK);
+        if (pmull_merge && pmull()) {
+            addInterleavedArm(fcs, data, len);
+        }
+        else {
+            addInterleaved(fcs, data, len);
+        }
+        data += len;
+        size -= len;
+    }
+    addChain(fcs, data, size);
+}
+
+template <class ARM>
+TARGET_CRC void ArmCRC32Chains<ARM>::addChain(uint32_t& fcs, const uint8_t* data, size_t size)
+{
+    // Add 8-bit values until an address aligned on 8 bytes.
+    const uint8_t* cp8 = data;
+    while (size != 0 && (uint64_t(cp8) & 0x07) != 0) {
+        ARM::add8(fcs, *cp8++);
+        --size;
+    }
+
+    // Add 8 * 64-bit values until less than 64 bytes (manual loop unroll).
+    const uint64_t* cp64 = reinterpret_cast<const uint64_t*>(cp8);
+    while (size >= 64) {
+        ARM::add64(fcs, *cp64++);
+        ARM::add64(fcs, *cp64++);
+        ARM::add64(fcs, *cp64++);
+        ARM::add64(fcs, *cp64++);
+        ARM::add64(fcs, *cp64++);
+        ARM::add64(fcs, *cp64++);
+        ARM::add64(fcs, *cp64++);
+        ARM::add64(fcs, *cp64++);
+        size -= 64;
+    }
+
+    // Add 64-bit values until less than 8 bytes.
+    while (size >= 8) {
+        ARM::add64(fcs, *cp64++);
+        size -= 8;
+    }
+
+    // Add remaining bytes.
+    cp8 = reinterpret_cast<const uint8_t*>(cp64);
+    while (size--) {
+        ARM::add8(fcs, *cp8++);
+    }
+}
+
+template <class ARM>
+bool ArmCRC32Chains<ARM>::pmull()
+{
+    static const bool supported = HasCPUFeatures(CPU_PMULL);
+    return supported;
+}
+
+// Each iteration processes 3 consecutive regions in independent CRC32X chains to
+// hide the latency of the instruction. The CRC of the first region is computed from
+// the current value, the two others from zero. Since the CRC is linear, the final
+// value is the XOR of the 3 values, each one shifted by the size of the next regions.
+template <class ARM>
+inline __attribute__((always_inline)) TARGET_CRC void ArmCRC32Chains<ARM>::addBlocks(uint32_t& fcs0, uint32_t& fcs1, uint32_t& fcs2, const uint64_t* cp64)
+{
+    const size_t words = INTERLEAVE_BLOCK / 8;
+    for (size_t i = 0; i < words; ++i) {
+        ARM::add64(fcs0, cp64[i]);
+        ARM::add64(fcs1, cp64[words + i]);
+        ARM::add64(fcs2, cp64[2 * words + i]);
+    }
+}
+
+template <class ARM>
+TARGET_CRC void ArmCRC32Chains<ARM>::addInterleaved(uint32_t& fcs, const uint8_t* data, size_t size)
+{
+    const uint64_t* cp64 = reinterpret_cast<const uint64_t*>(data);
+    while (size >= 3 * INTERLEAVE_BLOCK) {
+        uint32_t fcs0 = fcs;
+        uint32_t fcs1 = 0;
+        uint32_t fcs2 = 0;
+        addBlocks(fcs0, fcs1, fcs2, cp64);
+        fcs = shift(fcs0, ARM::SHIFT_2_BLOCKS) ^ shift(fcs1, ARM::SHIFT_1_BLOCK) ^ fcs2;
+        cp64 += 3 * INTERLEAVE_BLOCK / 8;
+        size -= 3 * INTERLEAVE_BLOCK;
+    }
+}
+
+// Same thing, the shifts use one PMULL each instead of 32 steps of software multiplication.
+template <class ARM>
+TARGET_AES_CRC void ArmCRC32Chains<ARM>::addInterleavedArm(uint32_t& fcs, const uint8_t* data, size_t size)
+{
+    const uint64_t* cp64 = reinterpret_cast<const uint64_t*>(data);
+    while (size >= 3 * INTERLEAVE_BLOCK) {
+        uint32_t fcs0 = fcs;
+        uint32_t fcs1 = 0;
+        uint32_t fcs2 = 0;
+        addBlocks(fcs0, fcs1, fcs2, cp64);
+        fcs = shiftArm(fcs0, ARM::SHIFT_2_BLOCKS) ^ shiftArm(fcs1, ARM::SHIFT_1_BLOCK) ^ fcs2;
+        cp64 += 3 * INTERLEAVE_BLOCK / 8;
+        size -= 3 * INTERLEAVE_BLOCK;
+    }
+}
+
+// The product of the CRC value by the shift constant, as an 8-byte message, has the
+// CRC (starting from zero) of the value followed by n zero bytes. The policy gives the
+// bit order of the value and of the message.
+template <class ARM>
+TARGET_CRC uint32_t ArmCRC32Chains<ARM>::shift(uint32_t fcs, uint32_t k)
+{
+    uint32_t r = 0;
+    ARM::add64(r, ARM::fromProduct(clmul32(ARM::toPoly(fcs), k)));
+    return r;
+}
+
+template <class ARM>
+inline __attribute__((always_inline)) TARGET_AES_CRC uint32_t ArmCRC32Chains<ARM>::shiftArm(uint32_t fcs, uint32_t k)
+{
+    uint32_t r = 0;
+    ARM::add64(r, ARM::fromProduct(vgetq_lane_u64(vreinterpretq_u64_p128(vmull_p64((poly64_t)ARM::toPoly(fcs), (poly64_t)k)), 0)));
+    return r;
+}
+
+template <class ARM>
+uint64_t ArmCRC32Chains<ARM>::clmul32(uint32_t a, uint32_t b)
+{
+    uint64_t r = 0;
+    for (int i = 0; i < 32; ++i) {
+        r ^= (uint64_t(a) << i) & (0 - uint64_t((b >> i) & 1));
+    }
+    return r;
+}
@@ -0,0 +1,106 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Implementation of the reflected CRC32 variants using Arm64 instructions.
+//
+//----------------------------------------------------------------------------
+
+#include "ArmReflectedCRC32.h"
+#include "ArmCRC32Chains.h"
+
+// The CRC32 instructions implement the reflected CRC as defined in IEEE 802.3
+// (CRC32B to CRC32X) and the CRC-32C (CRC32CB to CRC32CX). Unlike the MPEG-2 CRC
+// in ArmCRC32, the data and the CRC value are used as is, without bit reversal.
+
+namespace {
+
+    // Add 8 bytes (little-endian 64-bit value) or one byte, for each variant.
+    template <bool CASTAGNOLI>
+    struct ArmInstructions;
+
+    template <>
+    struct ArmInstructions<false>
+    {
+        static inline __attribute__((always_inline)) TARGET_CRC void add64(uint32_t& fcs, uint64_t x)
+        {
+            asm("crc32x %w0, %w0, %1" : "+r" (fcs) : "r" (x));
+        }
+        static inline __attribute__((always_inline)) TARGET_CRC void add8(uint32_t& fcs, uint8_t x)
+        {
+            asm("crc32b %w0, %w0, %w1" : "+r" (fcs) : "r" (x));
+        }
+    };
+
+    template <>
+    struct ArmInstructions<true>
+    {
+        static inline __attribute__((always_inline)) TARGET_CRC void add64(uint32_t& fcs, uint64_t x)
+        {
+            asm("crc32cx %w0, %w0, %1" : "+r" (fcs) : "r" (x));
+        }
+        static inline __attribute__((always_inline)) TARGET_CRC void add8(uint32_t& fcs, uint8_t x)
+        {
+            asm("crc32cb %w0, %w0, %w1" : "+r" (fcs) : "r" (x));
+        }
+    };
+
+    // x^n mod P, reflected: x^0 is the most significant bit and a multiplication
+    // by x is a right shift. Computed at compile time.
+    constexpr uint32_t reflectedPower(uint32_t poly, size_t n)
+    {
+        uint32_t r = 0x80000000;
+        while (n-- > 0) {
+            r = (r >> 1) ^ ((r & 1) != 0 ? poly : 0);
+        }
+        return r;
+    }
+
+    // Instructions of a reflected variant for the CRC32X chains. The CRC value is shifted
+    // by n bytes with k = x^(8n-33) mod P: in reflected order, the 63-bit product of two
+    // values has an implicit factor x. The product, as a little-endian 8-byte message,
+    // has the CRC (starting from zero) value.x^8n mod P. No bit reversal is needed.
+    template <class POLICY>
+    struct ReflectedInstructions : public ArmInstructions<POLICY::CASTAGNOLI>
+    {
+        static inline __attribute__((always_inline)) uint32_t toPoly(uint32_t fcs) { return fcs; }
+        static inline __attribute__((always_inline)) uint64_t fromProduct(uint64_t x) { return x; }
+        static constexpr uint32_t SHIFT_1_BLOCK = reflectedPower(POLICY::POLY, 8 * 1024 - 33);   // n = 1024 bytes
+        static constexpr uint32_t SHIFT_2_BLOCKS = reflectedPower(POLICY::POLY, 8 * 2048 - 33);  // n = 2048 bytes
+    };
+}
+
+
+//----------------------------------------------------------------------------
+// Check if the CRC32 instructions are present.
+//----------------------------------------------------------------------------
+
+template <class POLICY>
+bool ArmReflectedCRC32<POLICY>::accelerated()
+{
+    static const bool accel = HasCPUFeatures(CPU_CRC32);
+    return accel;
+}
+
+
+//----------------------------------------------------------------------------
+// Add data to the CRC.
+//----------------------------------------------------------------------------
+
+template <class POLICY>
+void ArmReflectedCRC32<POLICY>::add(const void* data, size_t size)
+{
+    if (accelerated()) {
+        ArmCRC32Chains<ReflectedInstructions<POLICY>>::add(_fcs, reinterpret_cast<const uint8_t*>(data), size, _interleave_threshold);
+    }
+    else {
+        ReflectedCRC32<POLICY> crc(_fcs);
+        crc.add(data, size);
+        _fcs = ~crc.value();
+    }
+}
+
+template class ArmReflectedCRC32<CRC32IEEEPolicy>;
+template class ArmReflectedCRC32<CRC32CPolicy>;
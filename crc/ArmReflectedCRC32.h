@@ -0,0 +1,40 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Implementation of the reflected CRC32 variants using Arm64 instructions.
+// The bit order of the instructions is the native one, no reversal is needed.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "ReflectedCRC32.h"
+#include "platform.h"
+
+template <class POLICY>
+class ArmReflectedCRC32
+{
+public:
+    ArmReflectedCRC32(uint32_t init = 0xFFFFFFFF) : _fcs(init), _interleave_threshold(INTERLEAVE_THRESHOLD) {}
+    void reset(uint32_t init = 0xFFFFFFFF) { _fcs = init; }
+    void add(const void* data, size_t size);
+    uint32_t value() const { return ~_fcs; }
+
+    // Check if the CRC32 instructions are present, detected once at run time.
+    // When they are not, add() uses the portable implementation ReflectedCRC32.
+    static bool accelerated();
+
+    // Buffers of at least this size are split in 3 regions which are processed in
+    // 3 independent chains, then combined, as in ArmCRC32. Use SIZE_MAX to disable.
+    static const size_t INTERLEAVE_THRESHOLD = 3 * 1024;
+    void setInterleaveThreshold(size_t size) { _interleave_threshold = size; }
+
+private:
+    uint32_t _fcs;
+    size_t   _interleave_threshold;
+};
+
+typedef ArmReflectedCRC32<CRC32IEEEPolicy> ArmCRC32IEEE;
+typedef ArmReflectedCRC32<CRC32CPolicy> ArmCRC32C;
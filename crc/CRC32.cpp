@@ -9,78 +9,141 @@
 //----------------------------------------------------------------------------
 
 #include "CRC32.h"
+#include "platform.h"
+
+namespace {
+
+    // Tables for the MPEG-2 polynomial, generated at compile time. The first one is the
+    // classical byte table: t[0][i] is the CRC of byte i, starting from zero. The next
+    // ones are for slicing: t[k][i] is the CRC of byte i followed by k zero bytes.
+    struct SliceTables
+    {
+        uint32_t t[16][256];
+
+        constexpr SliceTables() : t()
+        {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i << 24;
+                for (int bit = 0; bit < 8; ++bit) {
+                    c = (c << 1) ^ ((c & 0x80000000) != 0 ? 0x04C11DB7 : 0);
+                }
+                t[0][i] = c;
+            }
+            for (int k = 1; k < 16; ++k) {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    t[k][i] = (t[k-1][i] << 8) ^ t[0][t[k-1][i] >> 24];
+                }
+            }
+        }
+    };
+
+    constexpr SliceTables tables;
+    const uint32_t (&tab)[16][256] = tables.t;
+
+    // Load 8 bytes as a big-endian 64-bit value: the first byte is the highest
+    // degree of the polynomial (assume a little-endian CPU).
+    inline __attribute__((always_inline)) uint64_t loadBE64(const uint8_t* p)
+    {
+        uint64_t x;
+        ::memcpy(&x, p, sizeof(x));
+        return ByteSwap64(x);
+    }
+
+    // CRC of 8 bytes with the first 4 ones already XOR'ed with the current CRC,
+    // as if followed by n zero bytes.
+    inline __attribute__((always_inline)) uint32_t slice8(uint64_t w, int n)
+    {
+        const uint32_t hi = uint32_t(w >> 32);
+        const uint32_t lo = uint32_t(w);
+        return tab[n + 7][hi >> 24] ^ tab[n + 6][(hi >> 16) & 0xFF] ^ tab[n + 5][(hi >> 8) & 0xFF] ^ tab[n + 4][hi & 0xFF] ^
+               tab[n + 3][lo >> 24] ^ tab[n + 2][(lo >> 16) & 0xFF] ^ tab[n + 1][(lo >> 8) & 0xFF] ^ tab[n][lo & 0xFF];
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Add data to the CRC.
+//----------------------------------------------------------------------------
 
 void CRC32::add(const void* data, size_t size)
 {
     const uint8_t* cp = reinterpret_cast<const uint8_t*>(data);
+    switch (_method) {
+        case SLICE_16:
+            addSlice16(cp, size);
+            break;
+        case SLICE_8:
+            addSlice8(cp, size);
+            break;
+        default:
+            addBytes(cp, size);
+            break;
+    }
+}
+
+void CRC32::addBytes(const uint8_t* cp, size_t size)
+{
     while (size-- > 0) {
-        _fcs = (_fcs << 8) ^ _fcstab_32[((_fcs >> 24) ^ (*cp++)) & 0xFF];
+        _fcs = (_fcs << 8) ^ tab[0][((_fcs >> 24) ^ (*cp++)) & 0xFF];
     }
 }
 
-const uint32_t CRC32::_fcstab_32[256] = {
-    0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9,
-    0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
-    0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61,
-    0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD,
-    0x4C11DB70, 0x48D0C6C7, 0x4593E01E, 0x4152FDA9,
-    0x5F15ADAC, 0x5BD4B01B, 0x569796C2, 0x52568B75,
-    0x6A1936C8, 0x6ED82B7F, 0x639B0DA6, 0x675A1011,
-    0x791D4014, 0x7DDC5DA3, 0x709F7B7A, 0x745E66CD,
-    0x9823B6E0, 0x9CE2AB57, 0x91A18D8E, 0x95609039,
-    0x8B27C03C, 0x8FE6DD8B, 0x82A5FB52, 0x8664E6E5,
-    0xBE2B5B58, 0xBAEA46EF, 0xB7A96036, 0xB3687D81,
-    0xAD2F2D84, 0xA9EE3033, 0xA4AD16EA, 0xA06C0B5D,
-    0xD4326D90, 0xD0F37027, 0xDDB056FE, 0xD9714B49,
-    0xC7361B4C, 0xC3F706FB, 0xCEB42022, 0xCA753D95,
-    0xF23A8028, 0xF6FB9D9F, 0xFBB8BB46, 0xFF79A6F1,
-    0xE13EF6F4, 0xE5FFEB43, 0xE8BCCD9A, 0xEC7DD02D,
-    0x34867077, 0x30476DC0, 0x3D044B19, 0x39C556AE,
-    0x278206AB, 0x23431B1C, 0x2E003DC5, 0x2AC12072,
-    0x128E9DCF, 0x164F8078, 0x1B0CA6A1, 0x1FCDBB16,
-    0x018AEB13, 0x054BF6A4, 0x0808D07D, 0x0CC9CDCA,
-    0x7897AB07, 0x7C56B6B0, 0x71159069, 0x75D48DDE,
-    0x6B93DDDB, 0x6F52C06C, 0x6211E6B5, 0x66D0FB02,
-    0x5E9F46BF, 0x5A5E5B08, 0x571D7DD1, 0x53DC6066,
-    0x4D9B3063, 0x495A2DD4, 0x44190B0D, 0x40D816BA,
-    0xACA5C697, 0xA864DB20, 0xA527FDF9, 0xA1E6E04E,
-    0xBFA1B04B, 0xBB60ADFC, 0xB6238B25, 0xB2E29692,
-    0x8AAD2B2F, 0x8E6C3698, 0x832F1041, 0x87EE0DF6,
-    0x99A95DF3, 0x9D684044, 0x902B669D, 0x94EA7B2A,
-    0xE0B41DE7, 0xE4750050, 0xE9362689, 0xEDF73B3E,
-    0xF3B06B3B, 0xF771768C, 0xFA325055, 0xFEF34DE2,
-    0xC6BCF05F, 0xC27DEDE8, 0xCF3ECB31, 0xCBFFD686,
-    0xD5B88683, 0xD1799B34, 0xDC3ABDED, 0xD8FBA05A,
-    0x690CE0EE, 0x6DCDFD59, 0x608EDB80, 0x644FC637,
-    0x7A089632, 0x7EC98B85, 0x738AAD5C, 0x774BB0EB,
-    0x4F040D56, 0x4BC510E1, 0x46863638, 0x42472B8F,
-    0x5C007B8A, 0x58C1663D, 0x558240E4, 0x51435D53,
-    0x251D3B9E, 0x21DC2629, 0x2C9F00F0, 0x285E1D47,
-    0x36194D42, 0x32D850F5, 0x3F9B762C, 0x3B5A6B9B,
-    0x0315D626, 0x07D4CB91, 0x0A97ED48, 0x0E56F0FF,
-    0x1011A0FA, 0x14D0BD4D, 0x19939B94, 0x1D528623,
-    0xF12F560E, 0xF5EE4BB9, 0xF8AD6D60, 0xFC6C70D7,
-    0xE22B20D2, 0xE6EA3D65, 0xEBA91BBC, 0xEF68060B,
-    0xD727BBB6, 0xD3E6A601, 0xDEA580D8, 0xDA649D6F,
-    0xC423CD6A, 0xC0E2D0DD, 0xCDA1F604, 0xC960EBB3,
-    0xBD3E8D7E, 0xB9FF90C9, 0xB4BCB610, 0xB07DABA7,
-    0xAE3AFBA2, 0xAAFBE615, 0xA7B8C0CC, 0xA379DD7B,
-    0x9B3660C6, 0x9FF77D71, 0x92B45BA8, 0x9675461F,
-    0x8832161A, 0x8CF30BAD, 0x81B02D74, 0x857130C3,
-    0x5D8A9099, 0x594B8D2E, 0x5408ABF7, 0x50C9B640,
-    0x4E8EE645, 0x4A4FFBF2, 0x470CDD2B, 0x43CDC09C,
-    0x7B827D21, 0x7F436096, 0x7200464F, 0x76C15BF8,
-    0x68860BFD, 0x6C47164A, 0x61043093, 0x65C52D24,
-    0x119B4BE9, 0x155A565E, 0x18197087, 0x1CD86D30,
-    0x029F3D35, 0x065E2082, 0x0B1D065B, 0x0FDC1BEC,
-    0x3793A651, 0x3352BBE6, 0x3E119D3F, 0x3AD08088,
-    0x2497D08D, 0x2056CD3A, 0x2D15EBE3, 0x29D4F654,
-    0xC5A92679, 0xC1683BCE, 0xCC2B1D17, 0xC8EA00A0,
-    0xD6AD50A5, 0xD26C4D12, 0xDF2F6BCB, 0xDBEE767C,
-    0xE3A1CBC1, 0xE760D676, 0xEA23F0AF, 0xEEE2ED18,
-    0xF0A5BD1D, 0xF464A0AA, 0xF9278673, 0xFDE69BC4,
-    0x89B8FD09, 0x8D79E0BE, 0x803AC667, 0x84FBDBD0,
-    0x9ABC8BD5, 0x9E7D9662, 0x933EB0BB, 0x97FFAD0C,
-    0xAFB010B1, 0xAB710D06, 0xA6322BDF, 0xA2F33668,
-    0xBCB4666D, 0xB8757BDA, 0xB5365D03, 0xB1F740B4
-};
+// The CRC is XOR'ed into the first 4 bytes of each 8-byte word. Each byte of the
+// word is then looked up in the table which matches its distance to the end.
+void CRC32::addSlice8(const uint8_t* cp, size_t size)
+{
+    uint32_t fcs = _fcs;
+    for (; size >= 8; size -= 8, cp += 8) {
+        fcs = slice8(loadBE64(cp) ^ (uint64_t(fcs) << 32), 0);
+    }
+    _fcs = fcs;
+    addBytes(cp, size);
+}
+
+// Same as slicing-by-8 with two words, the first one is followed by 8 bytes.
+// The two halves of the lookups are independent.
+void CRC32::addSlice16(const uint8_t* cp, size_t size)
+{
+    uint32_t fcs = _fcs;
+    for (; size >= 16; size -= 16, cp += 16) {
+        fcs = slice8(loadBE64(cp) ^ (uint64_t(fcs) << 32), 8) ^ slice8(loadBE64(cp + 8), 0);
+    }
+    _fcs = fcs;
+    addSlice8(cp, size);
+}
+
+
+//----------------------------------------------------------------------------
+// Combine the CRC of two consecutive buffers.
+//----------------------------------------------------------------------------
+
+uint32_t CRC32::multiply(uint32_t a, uint32_t b)
+{
+    // Carry-less product, at most 63 bits.
+    uint64_t p = 0;
+    for (int i = 0; i < 32; ++i) {
+        p ^= (uint64_t(a) << i) & (0 - uint64_t((b >> i) & 1));
+    }
+    // The high part is reduced as 4 zero bytes added to a CRC: high.x^32 mod P.
+    uint32_t high = uint32_t(p >> 32);
+    for (int i = 0; i < 4; ++i) {
+        high = (high << 8) ^ tab[0][high >> 24];
+    }
+    return high ^ uint32_t(p);
+}
+
+// The CRC of n bytes from an initial value I is I.x^8n + M.x^32 mod P. Therefore:
+// CRC(A|B) = CRC(A).x^8n + CRC(B) + 0xFFFFFFFF.x^8n, with n = size_b.
+// The power x^8n mod P is computed by square and multiply.
+uint32_t CRC32::combine(uint32_t crc_a, uint32_t crc_b, size_t size_b)
+{
+    uint32_t power = 1;      // x^0
+    uint32_t square = 0x100; // x^8, then x^16, x^32, etc.
+    for (size_t n = size_b; n != 0; n >>= 1) {
+        if ((n & 1) != 0) {
+            power = multiply(power, square);
+        }
+        square = multiply(square, square);
+    }
+    return multiply(crc_a ^ 0xFFFFFFFF, power) ^ crc_b;
+}
@@ -15,11 +15,36 @@
 class CRC32
 {
 public:
-    CRC32(uint32_t init = 0xFFFFFFFF) : _fcs(init) {}
+    // Table-driven algorithm. Slicing-by-N processes N bytes per iteration with
+    // N tables of 256 entries, using 64-bit loads. They are generated at compile time.
+    enum Method {
+        BYTEWISE,  //!< One byte per iteration, one table.
+        SLICE_8,   //!< Slicing-by-8.
+        SLICE_16,  //!< Slicing-by-16 (default).
+    };
+
+    CRC32(uint32_t init = 0xFFFFFFFF, Method method = SLICE_16) : _fcs(init), _method(method) {}
     void reset(uint32_t init = 0xFFFFFFFF) { _fcs = init; }
     void add(const void* data, size_t size);
     uint32_t value() const { return _fcs; }
+
+    void setMethod(Method method) { _method = method; }
+    Method method() const { return _method; }
+
+    // Combine the CRC of two consecutive buffers A and B into the CRC of A followed by B,
+    // without the data. Both CRC are computed from the default initial value.
+    // The complexity is O(log(size_b)).
+    static uint32_t combine(uint32_t crc_a, uint32_t crc_b, size_t size_b);
+
 private:
     uint32_t _fcs;
-    static const uint32_t _fcstab_32[256];
+    Method   _method;
+
+    // Add data using one method.
+    void addBytes(const uint8_t* data, size_t size);
+    void addSlice8(const uint8_t* data, size_t size);
+    void addSlice16(const uint8_t* data, size_t size);
+
+    // Multiply two polynomials modulo the CRC polynomial.
+    static uint32_t multiply(uint32_t a, uint32_t b);
 };
@@ -0,0 +1,72 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Portable implementation of the reflected CRC32 variants.
+//
+//----------------------------------------------------------------------------
+
+#include "ReflectedCRC32.h"
+#include <cstring>
+
+namespace {
+
+    // Slicing-by-8 tables for a reflected polynomial, generated at compile time.
+    // t[k][i] is the CRC of byte i followed by k zero bytes, starting from zero.
+    template <uint32_t POLY>
+    struct ReflectedTables
+    {
+        uint32_t t[8][256];
+
+        constexpr ReflectedTables() : t()
+        {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    c = (c >> 1) ^ ((c & 1) != 0 ? POLY : 0);
+                }
+                t[0][i] = c;
+            }
+            for (int k = 1; k < 8; ++k) {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    t[k][i] = (t[k-1][i] >> 8) ^ t[0][t[k-1][i] & 0xFF];
+                }
+            }
+        }
+    };
+
+    template <uint32_t POLY>
+    constexpr ReflectedTables<POLY> reflected_tables;
+}
+
+
+//----------------------------------------------------------------------------
+// Add data to the CRC. The first byte is the least significant one of a
+// little-endian 64-bit word, the CRC is XOR'ed into the first 4 bytes.
+//----------------------------------------------------------------------------
+
+template <class POLICY>
+void ReflectedCRC32<POLICY>::add(const void* data, size_t size)
+{
+    const uint32_t (&tab)[8][256] = reflected_tables<POLICY::POLY>.t;
+    const uint8_t* cp = reinterpret_cast<const uint8_t*>(data);
+    uint32_t fcs = _fcs;
+
+    // Assume a little-endian CPU.
+    for (; size >= 8; size -= 8, cp += 8) {
+        uint64_t w;
+        ::memcpy(&w, cp, sizeof(w));
+        w ^= fcs;
+        fcs = tab[7][w & 0xFF] ^ tab[6][(w >> 8) & 0xFF] ^ tab[5][(w >> 16) & 0xFF] ^ tab[4][(w >> 24) & 0xFF] ^
+              tab[3][(w >> 32) & 0xFF] ^ tab[2][(w >> 40) & 0xFF] ^ tab[1][(w >> 48) & 0xFF] ^ tab[0][w >> 56];
+    }
+    while (size-- > 0) {
+        fcs = (fcs >> 8) ^ tab[0][(fcs ^ *cp++) & 0xFF];
+    }
+    _fcs = fcs;
+}
+
+template class ReflectedCRC32<CRC32IEEEPolicy>;
+template class ReflectedCRC32<CRC32CPolicy>;
@@ -0,0 +1,45 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Portable implementation of the reflected CRC32 variants: IEEE 802.3
+// (Ethernet, zlib) and CRC-32C (Castagnoli: iSCSI, ext4, SCTP).
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include <cstdlib>
+#include <cinttypes>
+
+// Policies for the reflected CRC32 variants. The bits of each byte are processed
+// from the least significant one and the polynomial is bit-reversed. The initial
+// value is 0xFFFFFFFF and the final value is complemented.
+struct CRC32IEEEPolicy
+{
+    static const uint32_t POLY = 0xEDB88320;  // 0x04C11DB7, reversed
+    static const bool CASTAGNOLI = false;     // Arm64 instructions CRC32B, CRC32X
+};
+
+struct CRC32CPolicy
+{
+    static const uint32_t POLY = 0x82F63B78;  // 0x1EDC6F41, reversed
+    static const bool CASTAGNOLI = true;      // Arm64 instructions CRC32CB, CRC32CX
+};
+
+template <class POLICY>
+class ReflectedCRC32
+{
+public:
+    ReflectedCRC32(uint32_t init = 0xFFFFFFFF) : _fcs(init) {}
+    void reset(uint32_t init = 0xFFFFFFFF) { _fcs = init; }
+    void add(const void* data, size_t size);
+    uint32_t value() const { return ~_fcs; }
+
+private:
+    uint32_t _fcs;
+};
+
+typedef ReflectedCRC32<CRC32IEEEPolicy> CRC32IEEE;
+typedef ReflectedCRC32<CRC32CPolicy> CRC32C;
@@ -0,0 +1,224 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Validation of the CRC32 of MPEG-2 PSI/SI sections in a transport stream.
+//
+//----------------------------------------------------------------------------
+
+#include "TSSectionValidator.h"
+#include <algorithm>
+
+namespace {
+
+    // Size of the section header up to section_length, and total size of a section.
+    const size_t SHORT_HEADER_SIZE = 3;
+
+    inline size_t sectionSize(const uint8_t* header)
+    {
+        return SHORT_HEADER_SIZE + ((size_t(header[1] & 0x0F) << 8) | header[2]);
+    }
+}
+
+
+// Constants may be used by reference.
+const size_t  TSSectionValidator::PKT_SIZE;
+const uint8_t TSSectionValidator::SYNC_BYTE;
+const size_t  TSSectionValidator::MAX_SECTION_SIZE;
+
+
+//----------------------------------------------------------------------------
+// Constructor and reset.
+//----------------------------------------------------------------------------
+
+TSSectionValidator::TSSectionValidator() :
+    _pids(),
+    _crc(),
+    _packets(0),
+    _packet_errors(0),
+    _sections(0),
+    _crc_errors(0),
+    _short_sections(0),
+    _in_place(0)
+{
+}
+
+void TSSectionValidator::reset()
+{
+    _pids.clear();
+    _packets = _packet_errors = _sections = _crc_errors = _short_sections = _in_place = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Process a buffer of TS packets.
+//----------------------------------------------------------------------------
+
+bool TSSectionValidator::feed(const void* packets, size_t size)
+{
+    if (size % PKT_SIZE != 0) {
+        return false;
+    }
+    const uint8_t* pkt = reinterpret_cast<const uint8_t*>(packets);
+    for (const uint8_t* end = pkt + size; pkt < end; pkt += PKT_SIZE) {
+        processPacket(pkt);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Process one packet.
+//----------------------------------------------------------------------------
+
+void TSSectionValidator::processPacket(const uint8_t* pkt)
+{
+    _packets++;
+
+    // Packets with a transport error or scrambled are not usable.
+    if (pkt[0] != SYNC_BYTE || (pkt[1] & 0x80) != 0 || (pkt[3] & 0xC0) != 0) {
+        _packet_errors++;
+        return;
+    }
+
+    // Packets without payload do not increment the continuity counter.
+    const uint8_t afc = (pkt[3] >> 4) & 0x03;
+    if ((afc & 0x01) == 0) {
+        return;
+    }
+
+    const uint16_t pid = uint16_t((pkt[1] & 0x1F) << 8) | pkt[2];
+    const uint8_t cc = pkt[3] & 0x0F;
+    const bool pusi = (pkt[1] & 0x40) != 0;
+    PIDContext& ctx(_pids[pid]);
+
+    // Duplicate packets are ignored. On discontinuity, the section in progress is lost.
+    if (ctx.started && cc == ctx.cc) {
+        return;
+    }
+    if (ctx.started && cc != ((ctx.cc + 1) & 0x0F)) {
+        _packet_errors++;
+        ctx.section.clear();
+    }
+    ctx.started = true;
+    ctx.cc = cc;
+
+    // Locate the payload, after the adaptation field.
+    const uint8_t* data = pkt + 4;
+    size_t size = PKT_SIZE - 4;
+    if ((afc & 0x02) != 0) {
+        const size_t af_size = 1 + size_t(pkt[4]);
+        if (af_size >= size) {
+            _packet_errors++;
+            ctx.section.clear();
+            return;
+        }
+        data += af_size;
+        size -= af_size;
+    }
+
+    if (!pusi) {
+        // Only the continuation of a section in progress, if any, followed by stuffing.
+        if (!ctx.section.empty()) {
+            continueSection(ctx, data, size);
+        }
+        return;
+    }
+
+    // The pointer field gives the start of the first new section. The bytes before it
+    // are the end of the section in progress.
+    const size_t pointer = data[0];
+    data++;
+    size--;
+    if (pointer > size) {
+        _packet_errors++;
+        ctx.section.clear();
+        return;
+    }
+    if (!ctx.section.empty()) {
+        continueSection(ctx, data, pointer);
+        // A section which is still incomplete is truncated.
+        if (!ctx.section.empty()) {
+            _packet_errors++;
+            ctx.section.clear();
+        }
+    }
+    data += pointer;
+    size -= pointer;
+
+    // New sections, until stuffing or the end of the packet. The sections which
+    // are complete in this packet are checked in place, without copy.
+    while (size > 0 && data[0] != 0xFF) {
+        if (size >= SHORT_HEADER_SIZE && sectionSize(data) <= size) {
+            const size_t sec_size = sectionSize(data);
+            checkSection(data, sec_size);
+            _in_place++;
+            data += sec_size;
+            size -= sec_size;
+        }
+        else {
+            // The section continues in the next packets.
+            ctx.section.reserve(MAX_SECTION_SIZE);
+            continueSection(ctx, data, size);
+            break;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Add the next part of a section in progress.
+//----------------------------------------------------------------------------
+
+void TSSectionValidator::continueSection(PIDContext& ctx, const uint8_t* data, size_t size)
+{
+    size_t used = 0;
+
+    // Complete the header first to get the section size.
+    if (ctx.section.size() < SHORT_HEADER_SIZE) {
+        const size_t len = std::min(size, SHORT_HEADER_SIZE - ctx.section.size());
+        ctx.section.insert(ctx.section.end(), data, data + len);
+        used += len;
+        if (ctx.section.size() < SHORT_HEADER_SIZE) {
+            return;
+        }
+    }
+
+    const size_t sec_size = sectionSize(ctx.section.data());
+    if (sec_size > MAX_SECTION_SIZE) {
+        _packet_errors++;
+        ctx.section.clear();
+        return;
+    }
+    const size_t len = std::min(size - used, sec_size - ctx.section.size());
+    ctx.section.insert(ctx.section.end(), data + used, data + used + len);
+    used += len;
+
+    if (ctx.section.size() == sec_size) {
+        checkSection(ctx.section.data(), sec_size);
+        ctx.section.clear();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check a complete section. Long sections (section_syntax_indicator set) end
+// with a CRC32. The CRC32 of the complete section, including the CRC32, is zero.
+//----------------------------------------------------------------------------
+
+void TSSectionValidator::checkSection(const uint8_t* data, size_t size)
+{
+    if ((data[1] & 0x80) == 0) {
+        _short_sections++;
+    }
+    else {
+        _sections++;
+        _crc.reset();
+        _crc.add(data, size);
+        if (_crc.value() != 0) {
+            _crc_errors++;
+        }
+    }
+}
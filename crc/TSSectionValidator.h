@@ -0,0 +1,68 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Validation of the CRC32 of MPEG-2 PSI/SI sections in a transport stream.
+// Sections are reassembled by PID and checked using ArmCRC32.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "ArmCRC32.h"
+#include <unordered_map>
+#include <vector>
+
+class TSSectionValidator
+{
+public:
+    static const size_t  PKT_SIZE = 188;          // Size of a TS packet.
+    static const uint8_t SYNC_BYTE = 0x47;        // First byte of a TS packet.
+    static const size_t  MAX_SECTION_SIZE = 4096; // Size of a private section, including the header.
+
+    TSSectionValidator();
+
+    // Forget all sections in progress and reset the statistics.
+    void reset();
+
+    // Process a buffer of complete TS packets, in the order of the stream. A section may
+    // start in one call and end in a later one. Return false if the size is not a multiple
+    // of PKT_SIZE. Packets without a sync byte are counted as errors and skipped.
+    bool feed(const void* packets, size_t size);
+
+    // Statistics since the last reset.
+    uint64_t packets() const { return _packets; }             // Total number of packets.
+    uint64_t packetErrors() const { return _packet_errors; }  // Invalid packets, discontinuities.
+    uint64_t sections() const { return _sections; }           // Complete sections with a CRC32.
+    uint64_t crcErrors() const { return _crc_errors; }        // Sections with an invalid CRC32.
+    uint64_t shortSections() const { return _short_sections; }// Complete sections without CRC32.
+    uint64_t inPlaceSections() const { return _in_place; }    // Sections checked without copy.
+
+private:
+    // Reassembly state of a section on one PID.
+    struct PIDContext
+    {
+        uint8_t cc = 0;                // Last continuity counter.
+        bool    started = false;       // A packet was already received on this PID.
+        std::vector<uint8_t> section;  // Section in progress, empty if none.
+    };
+
+    std::unordered_map<uint16_t, PIDContext> _pids;
+    ArmCRC32 _crc;
+    uint64_t _packets;
+    uint64_t _packet_errors;
+    uint64_t _sections;
+    uint64_t _crc_errors;
+    uint64_t _short_sections;
+    uint64_t _in_place;
+
+    // Process one packet.
+    void processPacket(const uint8_t* pkt);
+
+    // Add the next part of a section in progress, the rest of the data is ignored.
+    void continueSection(PIDContext& ctx, const uint8_t* data, size_t size);
+
+    // Check a complete section.
+    void checkSection(const uint8_t* data, size_t size);
+};
@@ -0,0 +1,131 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Generation of synthetic MPEG-2 transport streams containing sections.
+//
+//----------------------------------------------------------------------------
+
+#include "TSStreamGenerator.h"
+#include "TSSectionValidator.h"
+#include "CRC32.h"
+#include <algorithm>
+
+namespace {
+    const size_t PAYLOAD_SIZE = TSSectionValidator::PKT_SIZE - 4;
+}
+
+
+//----------------------------------------------------------------------------
+// Build a long section with a valid CRC32.
+//----------------------------------------------------------------------------
+
+std::vector<uint8_t> TSStreamGenerator::longSection(uint8_t table_id, uint16_t table_id_ext, size_t size, uint32_t seed)
+{
+    size = std::max<size_t>(12, std::min(size, TSSectionValidator::MAX_SECTION_SIZE));
+    std::vector<uint8_t> sec(size);
+
+    // Header: section_syntax_indicator set, section_length, version 0, current.
+    sec[0] = table_id;
+    sec[1] = uint8_t(0xB0 | ((size - 3) >> 8));
+    sec[2] = uint8_t(size - 3);
+    sec[3] = uint8_t(table_id_ext >> 8);
+    sec[4] = uint8_t(table_id_ext);
+    sec[5] = 0xC1;
+    sec[6] = 0; // section_number
+    sec[7] = 0; // last_section_number
+
+    // Pseudo-random payload (linear congruential generator).
+    for (size_t i = 8; i < size - 4; ++i) {
+        seed = seed * 1103515245 + 12345;
+        sec[i] = uint8_t(seed >> 16);
+    }
+
+    CRC32 crc;
+    crc.add(sec.data(), size - 4);
+    const uint32_t value = crc.value();
+    sec[size - 4] = uint8_t(value >> 24);
+    sec[size - 3] = uint8_t(value >> 16);
+    sec[size - 2] = uint8_t(value >> 8);
+    sec[size - 1] = uint8_t(value);
+    return sec;
+}
+
+
+//----------------------------------------------------------------------------
+// Add a complete section on a PID.
+//----------------------------------------------------------------------------
+
+void TSStreamGenerator::addSection(uint16_t pid, const std::vector<uint8_t>& section)
+{
+    PIDSections& ps(_pids[pid]);
+    ps.starts.push_back(ps.data.size());
+    ps.data.insert(ps.data.end(), section.begin(), section.end());
+}
+
+
+//----------------------------------------------------------------------------
+// Packetize all sections.
+//----------------------------------------------------------------------------
+
+void TSStreamGenerator::packetize(std::vector<uint8_t>& packets) const
+{
+    // Packets of each PID.
+    std::vector<std::vector<uint8_t>> pid_packets;
+    for (const auto& it : _pids) {
+        const uint16_t pid = it.first;
+        const PIDSections& ps(it.second);
+        pid_packets.emplace_back();
+        std::vector<uint8_t>& out(pid_packets.back());
+        size_t pos = 0;
+        size_t next_start = 0;
+        uint8_t cc = 0;
+
+        while (pos < ps.data.size()) {
+            // Find the first section which starts at or after pos.
+            while (next_start < ps.starts.size() && ps.starts[next_start] < pos) {
+                next_start++;
+            }
+            const size_t start = next_start < ps.starts.size() ? ps.starts[next_start] : SIZE_MAX;
+
+            // With a pointer field, 183 bytes of payload remain. If the next section starts
+            // in the last byte, the previous one ends before and the byte is stuffing.
+            const bool pusi = start < pos + PAYLOAD_SIZE - 1;
+            const size_t capacity = pusi || start == pos + PAYLOAD_SIZE - 1 ? PAYLOAD_SIZE - 1 : PAYLOAD_SIZE;
+            const size_t len = std::min(capacity, ps.data.size() - pos);
+
+            const size_t offset = out.size();
+            out.resize(offset + TSSectionValidator::PKT_SIZE, 0xFF);
+            uint8_t* pkt = out.data() + offset;
+            pkt[0] = TSSectionValidator::SYNC_BYTE;
+            pkt[1] = uint8_t((pusi ? 0x40 : 0x00) | ((pid >> 8) & 0x1F));
+            pkt[2] = uint8_t(pid);
+            pkt[3] = uint8_t(0x10 | cc); // payload only
+            cc = (cc + 1) & 0x0F;
+            uint8_t* payload = pkt + 4;
+            if (pusi) {
+                *payload++ = uint8_t(start - pos);
+            }
+            std::copy(ps.data.begin() + pos, ps.data.begin() + pos + len, payload);
+            pos += len;
+        }
+    }
+
+    // Interleave the packets of all PID's, round robin.
+    packets.clear();
+    for (size_t index = 0; ; ++index) {
+        bool more = false;
+        for (const auto& pp : pid_packets) {
+            const size_t offset = index * TSSectionValidator::PKT_SIZE;
+            if (offset < pp.size()) {
+                packets.insert(packets.end(), pp.begin() + offset, pp.begin() + offset + TSSectionValidator::PKT_SIZE);
+                more = true;
+            }
+        }
+        if (!more) {
+            break;
+        }
+    }
+}
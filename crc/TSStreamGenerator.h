@@ -0,0 +1,43 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Generation of synthetic MPEG-2 transport streams containing sections,
+// for the tests of TSSectionValidator.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include <cstdlib>
+#include <cstdint>
+#include <cinttypes>
+#include <map>
+#include <vector>
+
+class TSStreamGenerator
+{
+public:
+    TSStreamGenerator() : _pids() {}
+
+    // Build a long section of the given total size (at least 12 bytes, at most 4096),
+    // with pseudo-random content and a valid CRC32.
+    static std::vector<uint8_t> longSection(uint8_t table_id, uint16_t table_id_ext, size_t size, uint32_t seed);
+
+    // Add a complete section on a PID.
+    void addSection(uint16_t pid, const std::vector<uint8_t>& section);
+
+    // Packetize all sections. Sections are packed back to back on each PID, the
+    // packets of the various PID's are interleaved. Return the packets in a buffer.
+    void packetize(std::vector<uint8_t>& packets) const;
+
+private:
+    // Sections of one PID.
+    struct PIDSections
+    {
+        std::vector<uint8_t> data;   // All sections, back to back.
+        std::vector<size_t>  starts; // Offsets of the start of each section.
+    };
+    std::map<uint16_t, PIDSections> _pids;
+};
@@ -11,10 +11,17 @@
 
 #include "CRC32.h"
 #include "ArmCRC32.h"
+#include "ArmReflectedCRC32.h"
 #include <ios>
 #include <iomanip>
 #include <iostream>
 #include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <initializer_list>
+#include <chrono>
+#include <thread>
 #include <sys/resource.h>
 
 #define DEFAULT_ITERATIONS 10000000
@@ -54,6 +61,237 @@ uint64_t get_user_ms()
 }
 
 
+//----------------------------------------------------------------------------
+// Get the throughput in GB/s of a given amount of bytes in milliseconds.
+//----------------------------------------------------------------------------
+
+double get_gbps(uint64_t bytes, uint64_t ms)
+{
+    return ms > 0 ? double(bytes) / (double(ms) * 1000000.0) : 0.0;
+}
+
+
+//----------------------------------------------------------------------------
+// Common tools for the throughput tests on various buffer sizes.
+//----------------------------------------------------------------------------
+
+static const size_t perf_buffer_sizes[] = {64, 128, 256, 512, 1024, 4096, 16384, 65536, 1024 * 1024, 8 * 1024 * 1024};
+
+// Build a buffer for the largest size.
+std::vector<uint8_t> perf_buffer()
+{
+    const auto& sizes(perf_buffer_sizes);
+    std::vector<uint8_t> data(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = test_data[i % sizeof(test_data)] ^ uint8_t(i >> 8);
+    }
+    return data;
+}
+
+// Add the same buffer a number of times in any CRC class, return the time in milliseconds.
+template <class CRC>
+uint64_t perf_one(CRC& crc, const uint8_t* data, size_t size, uint64_t count)
+{
+    const uint64_t start = get_user_ms();
+    for (uint64_t i = 0; i < count; ++i) {
+        crc.add(data, size);
+    }
+    return get_user_ms() - start;
+}
+
+// Display one line of results for one buffer size.
+void perf_line(size_t size, uint64_t bytes, std::initializer_list<uint64_t> times, bool same_crc)
+{
+    std::cout << "  " << std::setfill(' ') << std::setw(8) << size << " bytes: ";
+    const char* sep = "";
+    for (uint64_t time : times) {
+        std::cout << sep << get_gbps(bytes, time);
+        sep = " / ";
+    }
+    std::cout << (same_crc ? "" : " (different CRC)") << std::endl;
+}
+
+
+//----------------------------------------------------------------------------
+// Compare the CRC32X chain, the 3 interleaved chains (merged in software or
+// using PMULL) and the PMULL folding on various buffer sizes.
+//----------------------------------------------------------------------------
+
+void perf_sizes(uint64_t total_bytes)
+{
+    const std::vector<uint8_t> data(perf_buffer());
+
+    std::cout << std::endl << "ArmCRC32 throughput (GB/s), CRC32X chain / 3 chains, software merge / 3 chains, PMULL merge / PMULL folding" << std::endl;
+    for (size_t size : perf_buffer_sizes) {
+        const uint64_t count = std::max<uint64_t>(1, total_bytes / size);
+
+        ArmCRC32 c1;
+        c1.setFoldThreshold(SIZE_MAX);
+        c1.setInterleaveThreshold(SIZE_MAX);
+        ArmCRC32 c2;
+        c2.setFoldThreshold(SIZE_MAX);
+        c2.setInterleaveThreshold(0);
+        c2.setPMULLMerge(false);
+        ArmCRC32 c3;
+        c3.setFoldThreshold(SIZE_MAX);
+        c3.setInterleaveThreshold(0);
+        ArmCRC32 c4;
+        c4.setFoldThreshold(ArmCRC32::folding() ? 0 : SIZE_MAX);
+        const uint64_t time1 = perf_one(c1, data.data(), size, count);
+        const uint64_t time2 = perf_one(c2, data.data(), size, count);
+        const uint64_t time3 = perf_one(c3, data.data(), size, count);
+        const uint64_t time4 = perf_one(c4, data.data(), size, count);
+
+        perf_line(size, count * size, {time1, time2, time3, time4},
+                  c1.value() == c2.value() && c1.value() == c3.value() && c1.value() == c4.value());
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Compare the portable table methods with ArmCRC32 on various buffer sizes.
+//----------------------------------------------------------------------------
+
+void perf_methods(uint64_t total_bytes)
+{
+    const std::vector<uint8_t> data(perf_buffer());
+
+    // The portable code is much slower, use fewer bytes.
+    total_bytes /= 10;
+
+    std::cout << std::endl << "Throughput (GB/s), CRC32 byte-wise / slicing-by-8 / slicing-by-16 / ArmCRC32" << std::endl;
+    for (size_t size : perf_buffer_sizes) {
+        const uint64_t count = std::max<uint64_t>(1, total_bytes / size);
+
+        CRC32 c1(0xFFFFFFFF, CRC32::BYTEWISE);
+        CRC32 c2(0xFFFFFFFF, CRC32::SLICE_8);
+        CRC32 c3(0xFFFFFFFF, CRC32::SLICE_16);
+        ArmCRC32 c4;
+        const uint64_t time1 = perf_one(c1, data.data(), size, count);
+        const uint64_t time2 = perf_one(c2, data.data(), size, count);
+        const uint64_t time3 = perf_one(c3, data.data(), size, count);
+        const uint64_t time4 = perf_one(c4, data.data(), size, count);
+
+        perf_line(size, count * size, {time1, time2, time3, time4},
+                  c1.value() == c2.value() && c1.value() == c3.value() && c1.value() == c4.value());
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Compare the CRC32 variants, with the same Arm64 code structure: chain of
+// CRC32 instructions below 3 kB, 3 interleaved chains above. The MPEG-2 CRC
+// needs bit reversals, the reflected variants use the instructions as is.
+//----------------------------------------------------------------------------
+
+void perf_variants(uint64_t total_bytes)
+{
+    const std::vector<uint8_t> data(perf_buffer());
+
+    std::cout << std::endl << "Throughput (GB/s), ArmCRC32 (MPEG-2, no folding) / ArmCRC32IEEE / ArmCRC32C" << std::endl;
+    for (size_t size : perf_buffer_sizes) {
+        const uint64_t count = std::max<uint64_t>(1, total_bytes / size);
+
+        ArmCRC32 c1;
+        c1.setFoldThreshold(SIZE_MAX);
+        ArmCRC32IEEE c2;
+        ArmCRC32C c3;
+        const uint64_t time1 = perf_one(c1, data.data(), size, count);
+        const uint64_t time2 = perf_one(c2, data.data(), size, count);
+        const uint64_t time3 = perf_one(c3, data.data(), size, count);
+
+        perf_line(size, count * size, {time1, time2, time3}, true);
+    }
+
+    // The portable code is much slower, use fewer bytes.
+    total_bytes /= 10;
+
+    std::cout << std::endl << "Throughput (GB/s), portable CRC32 (slicing-by-16) / CRC32IEEE / CRC32C (slicing-by-8)" << std::endl;
+    for (size_t size : perf_buffer_sizes) {
+        const uint64_t count = std::max<uint64_t>(1, total_bytes / size);
+
+        CRC32 c1;
+        CRC32IEEE c2;
+        CRC32C c3;
+        const uint64_t time1 = perf_one(c1, data.data(), size, count);
+        const uint64_t time2 = perf_one(c2, data.data(), size, count);
+        const uint64_t time3 = perf_one(c3, data.data(), size, count);
+
+        perf_line(size, count * size, {time1, time2, time3}, true);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Split one large buffer in N slices, compute the CRC of each slice in its
+// own thread and combine the results, from 1 thread to all cores. The time
+// is the elapsed time, the user CPU time is the sum of all threads.
+//----------------------------------------------------------------------------
+
+void perf_threads(uint64_t total_bytes)
+{
+    const size_t size = 64 * 1024 * 1024;
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = test_data[i % sizeof(test_data)] ^ uint8_t(i >> 8);
+    }
+    const uint64_t passes = std::max<uint64_t>(1, total_bytes / size);
+    const size_t max_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    std::cout << std::endl << "ArmCRC32 on " << (size / (1024 * 1024)) << " MB split in N threads, "
+              << passes << " passes, up to " << max_threads << " threads" << std::endl;
+
+    // Powers of 2, then the number of cores.
+    std::vector<size_t> counts;
+    for (size_t count = 1; count < max_threads; count *= 2) {
+        counts.push_back(count);
+    }
+    counts.push_back(max_threads);
+
+    uint64_t time1 = 0;
+    uint32_t crc1 = 0;
+    for (size_t count : counts) {
+        const size_t slice = size / count;
+        std::vector<uint32_t> crcs(count);
+        std::vector<std::thread> threads;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < count; ++t) {
+            // The last slice gets the remainder.
+            const uint8_t* base = data.data() + t * slice;
+            const size_t length = t + 1 < count ? slice : size - t * slice;
+            threads.emplace_back([base, length, passes, &crcs, t]() {
+                ArmCRC32 c;
+                for (uint64_t p = 0; p < passes; ++p) {
+                    c.reset();
+                    c.add(base, length);
+                }
+                crcs[t] = c.value();
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+        uint32_t crc = crcs[0];
+        for (size_t t = 1; t < count; ++t) {
+            crc = ArmCRC32::combine(crc, crcs[t], t + 1 < count ? slice : size - t * slice);
+        }
+        const uint64_t time = uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+
+        if (count == 1) {
+            time1 = time;
+            crc1 = crc;
+        }
+        std::cout << "  " << std::setfill(' ') << std::setw(3) << count << " threads: "
+                  << get_gbps(passes * size, time) << " GB/s";
+        if (time > 0) {
+            std::cout << ", speedup: " << (double(time1) / double(time));
+        }
+        std::cout << (crc == crc1 ? "" : " (different CRC)") << std::endl;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Program entry point.
 //----------------------------------------------------------------------------
@@ -63,6 +301,7 @@ int main(int argc, char* argv[])
     const int iterations = argc > 1 ? std::atoi(argv[1]) : DEFAULT_ITERATIONS;
 
     std::cout << "CRC32 performance test, " << iterations << " iterations, " << sizeof(test_data) << " bytes" << std::endl;
+    std::cout << "ArmCRC32 implementation: " << (ArmCRC32::accelerated() ? "Arm64 CRC32 instructions" : "portable") << std::endl;
 
     CRC32 c1;
     uint64_t start = get_user_ms();
@@ -90,5 +329,12 @@ int main(int argc, char* argv[])
         std::cout << "Performance ratio: " << (double(time1) / double(time2)) << std::endl;
     }
 
+    perf_methods(uint64_t(iterations) * sizeof(test_data));
+    if (ArmCRC32::accelerated()) {
+        perf_sizes(uint64_t(iterations) * sizeof(test_data));
+        perf_variants(uint64_t(iterations) * sizeof(test_data));
+    }
+    perf_threads(uint64_t(iterations) * sizeof(test_data));
+
     return EXIT_SUCCESS;
 }
@@ -11,10 +11,14 @@
 
 #include "CRC32.h"
 #include "ArmCRC32.h"
+#include "ArmReflectedCRC32.h"
+#include "TSSectionValidator.h"
+#include "TSStreamGenerator.h"
 #include <ios>
 #include <iomanip>
 #include <iostream>
 #include <cstdlib>
+#include <algorithm>
 
 
 //----------------------------------------------------------------------------
@@ -25,7 +29,7 @@ void test(const std::string& title, const void* data, size_t size)
 {
     std::cout << std::endl << "-------- " << title << " --------" << std::endl << std::endl;
 
-    CRC32 c1;
+    CRC32 c1(0xFFFFFFFF, CRC32::BYTEWISE);
     c1.add(data, size);
 
     std::cout << "Class CRC32, one chunk:     CRC = 0x"
@@ -48,12 +52,185 @@ void test(const std::string& title, const void* data, size_t size)
 }
 
 
+//----------------------------------------------------------------------------
+// Test large buffers, where the PMULL folding or the interleaved chains are
+// used, with a misaligned start.
+//----------------------------------------------------------------------------
+
+void test_long(size_t size)
+{
+    uint8_t* data = new uint8_t[size + 1];
+    for (size_t i = 0; i <= size; ++i) {
+        data[i] = uint8_t(i * 7 + (i >> 8));
+    }
+
+    CRC32 c1(0xFFFFFFFF, CRC32::BYTEWISE);
+    c1.add(data + 1, size);
+
+    // Slicing-by-8 and by-16, in chunks which are not multiple of 8 bytes.
+    bool ok0 = true;
+    for (CRC32::Method method : {CRC32::SLICE_8, CRC32::SLICE_16}) {
+        CRC32 c0(0xFFFFFFFF, method);
+        c0.add(data + 1, size / 2 + 3);
+        c0.add(data + 1 + size / 2 + 3, size - size / 2 - 3);
+        ok0 = ok0 && c0.value() == c1.value();
+    }
+
+    ArmCRC32 c2;
+    c2.add(data + 1, size);
+    const bool ok1 = c2.value() == c1.value();
+
+    // Chunks of increasing sizes, below and above the folding threshold.
+    c2.reset();
+    size_t chunk = 1;
+    for (size_t pos = 0; pos < size; pos += chunk, chunk = chunk * 3 + 1) {
+        c2.add(data + 1 + pos, std::min(chunk, size - pos));
+    }
+    const bool ok2 = c2.value() == c1.value();
+
+    // Without folding, large buffers use the 3 interleaved CRC32X chains.
+    // Misaligned start (7-byte head before the chains) and aligned start.
+    // The chains are merged using PMULL when present, or in software.
+    ArmCRC32 c3;
+    c3.setFoldThreshold(SIZE_MAX);
+    c3.add(data + 1, size);
+    CRC32 c4(0xFFFFFFFF, CRC32::BYTEWISE);
+    c4.add(data, size);
+    ArmCRC32 c5;
+    c5.setFoldThreshold(SIZE_MAX);
+    c5.add(data, size);
+    ArmCRC32 c6;
+    c6.setFoldThreshold(SIZE_MAX);
+    c6.setPMULLMerge(false);
+    c6.add(data + 1, size);
+    const bool ok3 = c3.value() == c1.value() && c5.value() == c4.value() && c6.value() == c1.value();
+
+    std::cout << std::setfill(' ') << std::setw(7) << size << " bytes: CRC = 0x"
+              << std::hex << std::setw(8) << std::setfill('0') << c1.value() << std::dec
+              << ", slicing: " << (ok0 ? "passed" : "FAILED")
+              << ", ArmCRC32 one chunk: " << (ok1 ? "passed" : "FAILED")
+              << ", multiple chunks: " << (ok2 ? "passed" : "FAILED")
+              << ", interleaved: " << (ok3 ? "passed" : "FAILED") << std::endl;
+    delete[] data;
+}
+
+
+//----------------------------------------------------------------------------
+// Test the combination of the CRC of two parts of a buffer, split at various
+// points, including empty parts.
+//----------------------------------------------------------------------------
+
+void test_combine(size_t size)
+{
+    uint8_t* data = new uint8_t[size];
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = uint8_t(i * 13 + (i >> 8));
+    }
+
+    CRC32 c1;
+    c1.add(data, size);
+
+    bool ok1 = true;
+    bool ok2 = true;
+    for (size_t split : {size_t(0), size_t(1), size / 3, size / 2 + 5, size - 1, size}) {
+        split = std::min(split, size);
+        CRC32 a, b;
+        a.add(data, split);
+        b.add(data + split, size - split);
+        ok1 = ok1 && CRC32::combine(a.value(), b.value(), size - split) == c1.value();
+        ok2 = ok2 && ArmCRC32::combine(a.value(), b.value(), size - split) == c1.value();
+    }
+
+    std::cout << std::setfill(' ') << std::setw(7) << size << " bytes: CRC = 0x"
+              << std::hex << std::setw(8) << std::setfill('0') << c1.value() << std::dec
+              << ", CRC32::combine: " << (ok1 ? "passed" : "FAILED")
+              << ", ArmCRC32::combine: " << (ok2 ? "passed" : "FAILED") << std::endl;
+    delete[] data;
+}
+
+
+//----------------------------------------------------------------------------
+// Test the reflected variants: check value of "123456789", then compare the
+// portable and Arm64 implementations on large buffers, with or without
+// interleaved chains, in one or several chunks.
+//----------------------------------------------------------------------------
+
+template <class PORTABLE, class ARM>
+void test_reflected(const char* name, uint32_t check)
+{
+    const char* digits = "123456789";
+    PORTABLE p1;
+    p1.add(digits, 9);
+    ARM a1;
+    a1.add(digits, 9);
+    bool ok = p1.value() == check && a1.value() == check;
+
+    for (size_t size : {1, 7, 8, 100, 3072, 3079, 3080, 4133, 9216, 65536, 1000003}) {
+        uint8_t* data = new uint8_t[size + 1];
+        for (size_t i = 0; i <= size; ++i) {
+            data[i] = uint8_t(i * 7 + (i >> 8));
+        }
+        PORTABLE p2;
+        p2.add(data + 1, size);
+        ARM a2;
+        a2.add(data + 1, size);
+        ARM a3;
+        a3.setInterleaveThreshold(SIZE_MAX);
+        a3.add(data + 1, size / 3);
+        a3.add(data + 1 + size / 3, size - size / 3);
+        ok = ok && a2.value() == p2.value() && a3.value() == p2.value();
+        delete[] data;
+    }
+
+    std::cout << name << ": \"123456789\" CRC = 0x"
+              << std::hex << std::setw(8) << std::setfill('0') << p1.value() << std::dec
+              << ", large buffers: " << (ok ? "passed" : "FAILED") << std::endl;
+}
+
+
+//----------------------------------------------------------------------------
+// Test the validation of sections in a transport stream: sections of all
+// sizes on several PID's, some of them with an invalid CRC32.
+//----------------------------------------------------------------------------
+
+void test_ts()
+{
+    TSStreamGenerator gen;
+    size_t count = 0;
+    size_t corrupted = 0;
+    for (size_t size = 12; size <= TSSectionValidator::MAX_SECTION_SIZE; size += size < 400 ? 1 : 61) {
+        std::vector<uint8_t> sec(TSStreamGenerator::longSection(0x42, uint16_t(size), size, uint32_t(size)));
+        if (size % 17 == 0) {
+            sec[size / 2] ^= 0x01;
+            corrupted++;
+        }
+        gen.addSection(uint16_t(0x100 + size % 5), sec);
+        count++;
+    }
+    std::vector<uint8_t> stream;
+    gen.packetize(stream);
+
+    // Feed in two parts, the second one starts in the middle of sections.
+    const size_t half = (stream.size() / TSSectionValidator::PKT_SIZE / 2) * TSSectionValidator::PKT_SIZE;
+    TSSectionValidator val;
+    val.feed(stream.data(), half);
+    val.feed(stream.data() + half, stream.size() - half);
+    const bool ok = val.sections() == count && val.crcErrors() == corrupted && val.packetErrors() == 0;
+
+    std::cout << "TS packets: " << val.packets() << ", sections: " << val.sections() << "/" << count
+              << ", CRC errors: " << val.crcErrors() << "/" << corrupted
+              << ", in place: " << val.inPlaceSections() << ", " << (ok ? "passed" : "FAILED") << std::endl;
+}
+
+
 //----------------------------------------------------------------------------
 // Program entry point.
 //----------------------------------------------------------------------------
 
 int main(int argc, char* argv[])
 {
+    std::cout << "ArmCRC32 implementation: " << (ArmCRC32::accelerated() ? "Arm64 CRC32 instructions" : "portable") << std::endl;
+
     uint32_t zero = 0;
     test("00", &zero, 1);
     test("00 00", &zero, 2);
@@ -83,5 +260,22 @@ int main(int argc, char* argv[])
     test("3 bytes", data, 3);
     test("256 bytes", data, sizeof(data));
 
+    std::cout << std::endl << "-------- Large buffers, PMULL folding: " << (ArmCRC32::folding() ? "yes" : "no") << " --------" << std::endl << std::endl;
+    for (size_t size : {128, 255, 256, 383, 1000, 3072, 3079, 3080, 4133, 9216, 65536, 1000003}) {
+        test_long(size);
+    }
+
+    std::cout << std::endl << "-------- Combine CRC of two parts --------" << std::endl << std::endl;
+    for (size_t size : {1, 8, 100, 4133, 65536, 1000003}) {
+        test_combine(size);
+    }
+
+    std::cout << std::endl << "-------- Reflected variants --------" << std::endl << std::endl;
+    test_reflected<CRC32IEEE, ArmCRC32IEEE>("CRC-32 IEEE 802.3", 0xCBF43926);
+    test_reflected<CRC32C, ArmCRC32C>("CRC-32C Castagnoli", 0xE3069283);
+
+    std::cout << std::endl << "-------- Sections CRC32 in transport stream --------" << std::endl << std::endl;
+    test_ts();
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,114 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Performance test of the validation of sections CRC32 in a transport stream.
+// Specify the number of passes over the synthetic stream on the command line.
+//
+//----------------------------------------------------------------------------
+
+#include "TSSectionValidator.h"
+#include "TSStreamGenerator.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+#define DEFAULT_PASSES 20
+#define PID_COUNT      16
+#define SECTION_COUNT  2000  // per PID
+
+
+//----------------------------------------------------------------------------
+// Validate the stream in a number of passes, return the statistics.
+//----------------------------------------------------------------------------
+
+struct Stats
+{
+    uint64_t packets = 0;
+    uint64_t sections = 0;
+    uint64_t errors = 0;
+};
+
+void validate(const std::vector<uint8_t>* stream, int passes, Stats* stats)
+{
+    for (int i = 0; i < passes; ++i) {
+        // Restart from scratch on each pass, the continuity counters do not loop.
+        TSSectionValidator val;
+        val.feed(stream->data(), stream->size());
+        stats->packets += val.packets();
+        stats->sections += val.sections() + val.shortSections();
+        stats->errors += val.packetErrors() + val.crcErrors();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Run the validation in a number of threads, each on the complete stream.
+//----------------------------------------------------------------------------
+
+void perf_threads(const std::vector<uint8_t>& stream, int passes, size_t count)
+{
+    std::vector<Stats> stats(count);
+    std::vector<std::thread> threads;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        threads.emplace_back(validate, &stream, passes, &stats[i]);
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Stats total;
+    for (const auto& st : stats) {
+        total.packets += st.packets;
+        total.sections += st.sections;
+        total.errors += st.errors;
+    }
+    std::cout << "  " << count << (count > 1 ? " threads: " : " thread: ")
+              << (seconds > 0 ? uint64_t(double(total.sections) / seconds) : 0) << " sections/s, "
+              << (seconds > 0 ? uint64_t(double(total.packets) / seconds) : 0) << " packets/s, "
+              << (seconds > 0 ? double(total.packets * TSSectionValidator::PKT_SIZE) / (seconds * 1000000.0) : 0.0) << " MB/s"
+              << (total.errors > 0 ? ", ERRORS" : "") << std::endl;
+}
+
+
+//----------------------------------------------------------------------------
+// Program entry point.
+//----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    const int passes = argc > 1 ? std::atoi(argv[1]) : DEFAULT_PASSES;
+
+    // Mix of short sections, checked in place, and long ones, up to 4 kB.
+    TSStreamGenerator gen;
+    uint32_t seed = 1;
+    for (int i = 0; i < SECTION_COUNT; ++i) {
+        for (uint16_t pid = 0; pid < PID_COUNT; ++pid) {
+            seed = seed * 1103515245 + 12345;
+            const size_t size = (seed >> 16) % 4 != 0 ? 12 + (seed >> 8) % 160 : 200 + (seed >> 4) % 3897;
+            gen.addSection(0x100 + pid, TSStreamGenerator::longSection(0x80 + uint8_t(pid), uint16_t(i), size, seed));
+        }
+    }
+    std::vector<uint8_t> stream;
+    gen.packetize(stream);
+
+    std::cout << "TS sections CRC32 validation, " << PID_COUNT << " PID's, "
+              << (PID_COUNT * SECTION_COUNT) << " sections, " << (stream.size() / TSSectionValidator::PKT_SIZE)
+              << " packets, " << passes << " passes" << std::endl;
+    std::cout << "ArmCRC32 implementation: " << (ArmCRC32::accelerated() ? "Arm64 CRC32 instructions" : "portable") << std::endl;
+
+    perf_threads(stream, passes, 1);
+    const size_t max_threads = std::thread::hardware_concurrency();
+    if (max_threads > 1) {
+        perf_threads(stream, passes, max_threads);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,174 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Somme common definitions (see project TSDuck).
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#if defined(__linux__)
+#include <byteswap.h>
+#endif
+#if defined(__linux__) && defined(__aarch64__)
+#include <sys/auxv.h>
+#if !defined(HWCAP_SHA3)
+#define HWCAP_SHA3 (1 << 17)
+#endif
+#if !defined(HWCAP_SHA512)
+#define HWCAP_SHA512 (1 << 21)
+#endif
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+#define TS_CONST64(n)  (int64_t(n##LL))
+#define TS_UCONST64(n) (uint64_t(n##ULL))
+
+inline __attribute__((always_inline)) uint32_t ByteSwap32(uint32_t x)
+{
+#if defined(__aarch64__) || defined(__arm64__)
+    asm("rev %w0, %w0" : "+r" (x)); return x;
+#elif defined(__linux__)
+    return bswap_32(x);
+#else
+    return (x << 24) | ((x << 8) & 0x00FF0000) | ((x >> 8) & 0x0000FF00) | (x >> 24);
+#endif
+}
+
+inline __attribute__((always_inline)) uint64_t ByteSwap64(uint64_t x)
+{
+#if defined(__aarch64__) || defined(__arm64__)
+    asm("rev %0, %0" : "+r" (x)); return x;
+#elif defined(__linux__)
+    return bswap_64(x);
+#else
+    return
+        ((x << 56)) |
+        ((x << 40) & TS_UCONST64(0x00FF000000000000)) |
+        ((x << 24) & TS_UCONST64(0x0000FF0000000000)) |
+        ((x <<  8) & TS_UCONST64(0x000000FF00000000)) |
+        ((x >>  8) & TS_UCONST64(0x00000000FF000000)) |
+        ((x >> 24) & TS_UCONST64(0x0000000000FF0000)) |
+        ((x >> 40) & TS_UCONST64(0x000000000000FF00)) |
+        ((x >> 56));
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Run-time detection of Arm64 CPU features.
+//----------------------------------------------------------------------------
+
+// Functions using optional Arm64 instructions are compiled with a function-level
+// target attribute. No -march option is needed and the same binary runs on all
+// Arm64 CPUs. These functions must be called only when the feature is present.
+#if defined(__aarch64__) && defined(__clang__)
+    #define TARGET_AES  __attribute__((target("aes")))
+    #define TARGET_SHA2 __attribute__((target("sha2")))
+    #define TARGET_SHA3 __attribute__((target("sha3")))
+    #define TARGET_CRC  __attribute__((target("crc")))
+    #define TARGET_AES_CRC __attribute__((target("aes,crc")))
+#elif defined(__aarch64__) && defined(__GNUC__)
+    #define TARGET_AES  __attribute__((target("+crypto")))
+    #define TARGET_SHA2 __attribute__((target("+crypto")))
+    #define TARGET_SHA3 __attribute__((target("arch=armv8.2-a+sha3")))
+    #define TARGET_CRC  __attribute__((target("+crc")))
+    #define TARGET_AES_CRC __attribute__((target("+crypto+crc")))
+#else
+    #define TARGET_AES
+    #define TARGET_SHA2
+    #define TARGET_SHA3
+    #define TARGET_CRC
+    #define TARGET_AES_CRC
+#endif
+
+// Optional CPU features, as a bit mask.
+enum : uint32_t {
+    CPU_AES    = 0x0001,  // AESE, AESD, AESMC, AESIMC
+    CPU_PMULL  = 0x0002,  // PMULL, PMULL2 on 64-bit lanes
+    CPU_SHA1   = 0x0004,  // SHA1C, SHA1P, SHA1M, SHA1H, SHA1SU0, SHA1SU1
+    CPU_SHA2   = 0x0008,  // SHA256H, SHA256H2, SHA256SU0, SHA256SU1
+    CPU_SHA512 = 0x0010,  // SHA512H, SHA512H2, SHA512SU0, SHA512SU1
+    CPU_SHA3   = 0x0020,  // EOR3, RAX1, XAR, BCAX
+    CPU_CRC32  = 0x0040,  // CRC32B, CRC32H, CRC32W, CRC32X and CRC32C variants
+};
+
+// Detect the features of the current CPU.
+inline uint32_t DetectCPUFeatures()
+{
+    uint32_t features = 0;
+#if defined(__linux__) && defined(__aarch64__)
+    const unsigned long hwcap = ::getauxval(AT_HWCAP);
+    features |= (hwcap & HWCAP_AES) ? CPU_AES : 0;
+    features |= (hwcap & HWCAP_PMULL) ? CPU_PMULL : 0;
+    features |= (hwcap & HWCAP_SHA1) ? CPU_SHA1 : 0;
+    features |= (hwcap & HWCAP_SHA2) ? CPU_SHA2 : 0;
+    features |= (hwcap & HWCAP_SHA512) ? CPU_SHA512 : 0;
+    features |= (hwcap & HWCAP_SHA3) ? CPU_SHA3 : 0;
+    features |= (hwcap & HWCAP_CRC32) ? CPU_CRC32 : 0;
+#elif defined(__APPLE__) && defined(__aarch64__)
+    // AES, PMULL, SHA1 and SHA256 are present on all Apple Arm64 processors.
+    static const struct { const char* name; uint32_t flag; } sysctls[] = {
+        {"hw.optional.armv8_2_sha512", CPU_SHA512},
+        {"hw.optional.armv8_2_sha3", CPU_SHA3},
+        {"hw.optional.armv8_crc32", CPU_CRC32},
+    };
+    features = CPU_AES | CPU_PMULL | CPU_SHA1 | CPU_SHA2;
+    for (const auto& s : sysctls) {
+        int value = 0;
+        size_t size = sizeof(value);
+        if (::sysctlbyname(s.name, &value, &size, nullptr, 0) == 0 && value != 0) {
+            features |= s.flag;
+        }
+    }
+#endif
+    return features;
+}
+
+// Mask of allowed features from the environment variable ARM64_CPU_FEATURES.
+// This is a comma-separated list of feature names, "aes,pmull,sha1,sha2,sha512,sha3,crc32".
+// Any other value such as "none" disables all features and forces the portable code.
+inline uint32_t AllowedCPUFeatures()
+{
+    static const struct { const char* name; uint32_t flag; } names[] = {
+        {"aes", CPU_AES}, {"pmull", CPU_PMULL}, {"sha1", CPU_SHA1}, {"sha2", CPU_SHA2},
+        {"sha512", CPU_SHA512}, {"sha3", CPU_SHA3}, {"crc32", CPU_CRC32},
+    };
+    const char* env = ::getenv("ARM64_CPU_FEATURES");
+    if (env == nullptr) {
+        return ~uint32_t(0);
+    }
+    uint32_t mask = 0;
+    while (*env != '\0') {
+        const size_t len = ::strcspn(env, ",");
+        for (const auto& n : names) {
+            if (::strlen(n.name) == len && ::strncmp(env, n.name, len) == 0) {
+                mask |= n.flag;
+            }
+        }
+        env += len;
+        if (*env == ',') {
+            ++env;
+        }
+    }
+    return mask;
+}
+
+// Get the usable CPU features, detected once.
+inline uint32_t GetCPUFeatures()
+{
+    static const uint32_t features = DetectCPUFeatures() & AllowedCPUFeatures();
+    return features;
+}
+
+// Check if all specified features are usable.
+inline bool HasCPUFeatures(uint32_t features)
+{
+    return (GetCPUFeatures() & features) == features;
+}
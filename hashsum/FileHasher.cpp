@@ -0,0 +1,353 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Hash the content of files, from a memory mapping, using read() or using
+// a reader thread which reads the next chunks while the current one is hashed.
+//
+//----------------------------------------------------------------------------
+
+#include "FileHasher.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Constants may be used by reference.
+const size_t FileHasher::READ_BUFFER_SIZE;
+const size_t FileHasher::BUFFER_ALIGNMENT;
+const size_t FileHasher::DEFAULT_QUEUE_DEPTH;
+const size_t FileHasher::MAX_QUEUE_DEPTH;
+const size_t FileHasher::MAX_CHUNK_SIZE;
+
+namespace {
+    double elapsed(const std::chrono::steady_clock::time_point& start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+FileHasher::FileHasher() :
+    _chunk_size(READ_BUFFER_SIZE),
+    _queue_depth(DEFAULT_QUEUE_DEPTH),
+    _buffer(nullptr),
+    _buffer_count(0),
+    _chunk_sizes(),
+    _size(0),
+    _seconds(0.0),
+    _io_seconds(0.0),
+    _hash_seconds(0.0),
+    _mapped(false),
+    _error()
+{
+}
+
+FileHasher::~FileHasher()
+{
+    ::free(_buffer);
+}
+
+
+
+//----------------------------------------------------------------------------
+// Buffer parameters.
+//----------------------------------------------------------------------------
+
+void FileHasher::setChunkSize(size_t size)
+{
+    size = std::min(size, MAX_CHUNK_SIZE);
+    size = std::max<size_t>(1, (size + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT) * BUFFER_ALIGNMENT;
+    if (size != _chunk_size) {
+        // Reallocate on next use.
+        ::free(_buffer);
+        _buffer = nullptr;
+        _buffer_count = 0;
+        _chunk_size = size;
+    }
+}
+
+void FileHasher::setQueueDepth(size_t depth)
+{
+    _queue_depth = std::min(std::max<size_t>(2, depth), MAX_QUEUE_DEPTH);
+}
+
+// Allocate at least 'count' chunks, contiguous and aligned.
+bool FileHasher::allocate(size_t count)
+{
+    if (count > SIZE_MAX / _chunk_size) {
+        return setError("allocate", EOVERFLOW);
+    }
+    if (count > _buffer_count) {
+        ::free(_buffer);
+        _buffer = nullptr;
+        _buffer_count = 0;
+        void* buf = nullptr;
+        const int err = ::posix_memalign(&buf, BUFFER_ALIGNMENT, count * _chunk_size);
+        if (err != 0) {
+            return setError("posix_memalign", err);
+        }
+        _buffer = reinterpret_cast<uint8_t*>(buf);
+        _buffer_count = count;
+        _chunk_sizes.resize(count);
+    }
+    return true;
+}
+
+bool FileHasher::setError(const char* operation, int err)
+{
+    _error = std::string(operation) + ": " + ::strerror(err);
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Hash a file from its name.
+//----------------------------------------------------------------------------
+
+bool FileHasher::hashFile(const std::string& filename, Hasher& hasher, Mode mode)
+{
+    if (filename == "-") {
+        return hashFile(STDIN_FILENO, hasher, mode);
+    }
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        _size = 0;
+        _seconds = 0.0;
+        _mapped = false;
+        return setError("open", errno);
+    }
+    const bool ok = hashFile(fd, hasher, mode);
+    ::close(fd);
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Hash an open file.
+//----------------------------------------------------------------------------
+
+bool FileHasher::hashFile(int fd, Hasher& hasher, Mode mode)
+{
+    _size = 0;
+    _seconds = 0.0;
+    _io_seconds = 0.0;
+    _hash_seconds = 0.0;
+    _mapped = false;
+    _error.clear();
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+        return setError("fstat", errno);
+    }
+
+    // Only non-empty regular files can be mapped.
+    const auto start = std::chrono::steady_clock::now();
+    bool ok = false;
+    if (mode == MMAP && S_ISREG(st.st_mode) && st.st_size > 0) {
+        ok = hashMapped(fd, uint64_t(st.st_size), hasher);
+    }
+    else if (mode == ASYNC) {
+        ok = hashAsync(fd, hasher);
+    }
+    else {
+        ok = hashRead(fd, hasher);
+    }
+    _seconds = elapsed(start);
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Hash a regular file from a memory mapping, without copy.
+//----------------------------------------------------------------------------
+
+bool FileHasher::hashMapped(int fd, uint64_t size, Hasher& hasher)
+{
+    if (size > uint64_t(SIZE_MAX)) {
+        return setError("mmap", EFBIG);
+    }
+    void* addr = ::mmap(nullptr, size_t(size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        return setError("mmap", errno);
+    }
+
+    // The pages are accessed once, in sequence: aggressive read-ahead, then discarded.
+    // Transparent huge pages reduce the TLB misses (Linux only, ignored on failure).
+    ::madvise(addr, size_t(size), MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+    ::madvise(addr, size_t(size), MADV_HUGEPAGE);
+#endif
+
+    const bool ok = hasher.add(addr, size_t(size));
+    ::munmap(addr, size_t(size));
+    _mapped = true;
+    _size = size;
+    return ok || setError("hash", EINVAL);
+}
+
+
+//----------------------------------------------------------------------------
+// Fill a chunk, a pipe may return less than requested.
+//----------------------------------------------------------------------------
+
+ssize_t FileHasher::readChunk(int fd, uint8_t* chunk)
+{
+    size_t size = 0;
+    while (size < _chunk_size) {
+        const ssize_t insize = ::read(fd, chunk + size, _chunk_size - size);
+        if (insize == 0) {
+            break;
+        }
+        else if (insize < 0 && errno != EINTR) {
+            return -1;
+        }
+        else if (insize > 0) {
+            size += size_t(insize);
+        }
+    }
+    return ssize_t(size);
+}
+
+
+//----------------------------------------------------------------------------
+// Hash a file using read() in a large aligned buffer, for pipes and as reference.
+//----------------------------------------------------------------------------
+
+bool FileHasher::hashRead(int fd, Hasher& hasher)
+{
+    if (!allocate(1)) {
+        return false;
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    for (;;) {
+        auto start = std::chrono::steady_clock::now();
+        const ssize_t insize = readChunk(fd, _buffer);
+        _io_seconds += elapsed(start);
+        if (insize < 0) {
+            return setError("read", errno);
+        }
+        else if (insize == 0) {
+            return true;
+        }
+        start = std::chrono::steady_clock::now();
+        const bool ok = hasher.add(_buffer, size_t(insize));
+        _hash_seconds += elapsed(start);
+        if (!ok) {
+            return setError("hash", EINVAL);
+        }
+        _size += uint64_t(insize);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Hash a file using a reader thread and a ring of chunks. The reader fills
+// chunk n % depth when it has been hashed, the calling thread hashes chunk
+// n % depth when it has been filled. Nothing is allocated in the loop.
+//----------------------------------------------------------------------------
+
+bool FileHasher::hashAsync(int fd, Hasher& hasher)
+{
+    const size_t depth = _queue_depth;
+    if (!allocate(depth)) {
+        return false;
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    size_t filled = 0;      // Number of filled chunks since the beginning
+    size_t hashed = 0;      // Number of hashed chunks since the beginning
+    bool   eof = false;     // No more chunk from the reader (end of file or error)
+    bool   stop = false;    // Hash error, the reader shall stop
+    int    read_err = 0;    // Error in the reader
+
+    std::thread reader([&]() {
+        for (;;) {
+            {
+                // Wait for a free chunk.
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [&]() { return stop || filled - hashed < depth; });
+                if (stop) {
+                    return;
+                }
+            }
+            const size_t index = filled % depth;
+            const auto start = std::chrono::steady_clock::now();
+            const ssize_t insize = readChunk(fd, _buffer + index * _chunk_size);
+            const int err = errno;
+            _io_seconds += elapsed(start);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (insize > 0) {
+                    _chunk_sizes[index] = size_t(insize);
+                    filled++;
+                }
+                else {
+                    read_err = insize < 0 ? err : 0;
+                    eof = true;
+                }
+            }
+            cond.notify_all();
+            if (insize <= 0) {
+                return;
+            }
+        }
+    });
+
+    bool ok = true;
+    for (;;) {
+        size_t index = 0;
+        {
+            // Wait for a filled chunk.
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [&]() { return filled > hashed || eof; });
+            if (filled == hashed) {
+                break;
+            }
+            index = hashed % depth;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        ok = hasher.add(_buffer + index * _chunk_size, _chunk_sizes[index]);
+        _hash_seconds += elapsed(start);
+        _size += _chunk_sizes[index];
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            hashed++;
+            stop = !ok;
+        }
+        cond.notify_all();
+        if (!ok) {
+            break;
+        }
+    }
+    reader.join();
+
+    if (!ok) {
+        return setError("hash", EINVAL);
+    }
+    else if (read_err != 0) {
+        return setError("read", read_err);
+    }
+    return true;
+}
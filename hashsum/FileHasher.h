@@ -0,0 +1,85 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Hash the content of files, from a memory mapping, using read() or using
+// a reader thread which reads the next chunks while the current one is hashed.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "Hasher.h"
+#include <vector>
+
+class FileHasher
+{
+public:
+    // How the data are read:
+    // - MMAP: regular files are mapped in memory and add() is called directly on the
+    //   mapping, without copy. Other files (pipes, terminals) are read as with READ.
+    // - READ: read() in a large aligned buffer, one copy from the kernel.
+    // - ASYNC: double (or more) buffering. A reader thread fills a ring of chunks with
+    //   read() while the calling thread hashes the previous ones. The I/O and the hash
+    //   computation overlap, the throughput tends to the slowest of the two.
+    enum Mode {MMAP, READ, ASYNC};
+
+    static const size_t READ_BUFFER_SIZE = 1024 * 1024;  //!< Default chunk size.
+    static const size_t BUFFER_ALIGNMENT = 4096;         //!< Alignment of the chunks, page and cache line.
+    static const size_t DEFAULT_QUEUE_DEPTH = 4;         //!< Default number of chunks in ASYNC mode.
+    static const size_t MAX_QUEUE_DEPTH = 64;            //!< Maximum number of chunks in ASYNC mode.
+    static const size_t MAX_CHUNK_SIZE = 256 * 1024 * 1024;  //!< Maximum chunk size.
+
+    FileHasher();
+    ~FileHasher();
+
+    // Size of each read() (rounded up to BUFFER_ALIGNMENT, up to MAX_CHUNK_SIZE) and number
+    // of chunks in the ring (2 to MAX_QUEUE_DEPTH). Out of range values are clamped.
+    // The chunks are allocated once, on first use after a change of parameters.
+    void setChunkSize(size_t size);
+    void setQueueDepth(size_t depth);
+    size_t chunkSize() const { return _chunk_size; }
+    size_t queueDepth() const { return _queue_depth; }
+
+    // Hash a file (standard input if "-"), or an open file descriptor, using an initialized hasher.
+    // Return false on error, see error().
+    bool hashFile(const std::string& filename, Hasher& hasher, Mode mode = MMAP);
+    bool hashFile(int fd, Hasher& hasher, Mode mode = MMAP);
+
+    // Results of the last hashFile().
+    uint64_t size() const { return _size; }
+    double seconds() const { return _seconds; }
+    bool mapped() const { return _mapped; }
+    const std::string& error() const { return _error; }
+
+    // Time spent in read() and in the hash computation, with READ and ASYNC.
+    // In ASYNC mode, they overlap and the best possible time is the largest one.
+    double ioSeconds() const { return _io_seconds; }
+    double hashSeconds() const { return _hash_seconds; }
+
+private:
+    size_t      _chunk_size;    // Size of each chunk
+    size_t      _queue_depth;   // Number of chunks in ASYNC mode
+    uint8_t*    _buffer;        // All chunks, contiguous, allocated on first use
+    size_t      _buffer_count;  // Number of allocated chunks
+    std::vector<size_t> _chunk_sizes;  // Data size in each chunk, ASYNC mode
+    uint64_t    _size;          // Hashed bytes
+    double      _seconds;       // Elapsed time
+    double      _io_seconds;    // Time in read()
+    double      _hash_seconds;  // Time in hasher.add()
+    bool        _mapped;        // Hashed from a memory mapping
+    std::string _error;         // Last error message
+
+    FileHasher(const FileHasher&) = delete;
+    FileHasher& operator=(const FileHasher&) = delete;
+
+    bool hashMapped(int fd, uint64_t size, Hasher& hasher);
+    bool hashRead(int fd, Hasher& hasher);
+    bool hashAsync(int fd, Hasher& hasher);
+    bool allocate(size_t count);
+    bool setError(const char* operation, int err);
+
+    // Fill a chunk, up to its size or end of file. Return the size or -1 on error.
+    ssize_t readChunk(int fd, uint8_t* chunk);
+};
@@ -0,0 +1,74 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Common interface to the hash and CRC classes of the other modules.
+//
+//----------------------------------------------------------------------------
+
+#include "Hasher.h"
+#include "HasherSHA1.h"
+#include "HasherSHA256.h"
+#include "HasherSHA512.h"
+#include "HasherCRC32.h"
+#include "MultiHasher.h"
+
+// Constants may be used by reference.
+const size_t Hasher::MAX_HASH_SIZE;
+
+namespace {
+    const struct {
+        const char* name;
+        Hasher* (*create)();
+    } factories[] = {
+        {"sha1",   NewHasherSHA1},
+        {"sha256", NewHasherSHA256},
+        {"sha512", NewHasherSHA512},
+        {"sha512-256", NewHasherSHA512_256},
+        {"crc32",  NewHasherCRC32},
+        {"crc32mpeg2", NewHasherCRC32MPEG2},
+    };
+}
+
+std::unique_ptr<Hasher> Hasher::Create(const std::string& name)
+{
+    // A comma-separated list of names is a MultiHasher.
+    if (name.find(',') != std::string::npos) {
+        std::unique_ptr<MultiHasher> multi(new MultiHasher);
+        for (size_t start = 0; start != std::string::npos; ) {
+            const size_t end = name.find(',', start);
+            std::unique_ptr<Hasher> hasher(Create(name.substr(start, end == std::string::npos ? end : end - start)));
+            if (hasher == nullptr) {
+                return std::unique_ptr<Hasher>();
+            }
+            multi->addHasher(std::move(hasher));
+            start = end == std::string::npos ? end : end + 1;
+        }
+        return std::unique_ptr<Hasher>(std::move(multi));
+    }
+    for (const auto& fac : factories) {
+        if (name == fac.name) {
+            return std::unique_ptr<Hasher>(fac.create());
+        }
+    }
+    return std::unique_ptr<Hasher>();
+}
+
+const char* Hasher::Names()
+{
+    return "sha1, sha256, sha512, sha512-256, crc32, crc32mpeg2";
+}
+
+std::string Hasher::ToHex(const void* hash, size_t size)
+{
+    static const char digits[] = "0123456789abcdef";
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(hash);
+    std::string hex;
+    for (size_t i = 0; i < size; ++i) {
+        hex.push_back(digits[p[i] >> 4]);
+        hex.push_back(digits[p[i] & 0x0F]);
+    }
+    return hex;
+}
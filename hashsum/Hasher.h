@@ -0,0 +1,60 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Common interface to the hash and CRC classes of the other modules.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include <cstdlib>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Each module has its own platform.h. An adapter is compiled with the headers of
+// one module only, its header only declares a factory function (see HasherSHA1.h).
+class Hasher
+{
+public:
+    static const size_t MAX_HASH_SIZE = 64;  //!< Maximum hash size of a single algorithm.
+
+    virtual ~Hasher() {}
+    virtual const char* name() const = 0;
+    virtual size_t hashSize() const = 0;
+    virtual bool init() = 0;
+    virtual bool add(const void* data, size_t size) = 0;
+    virtual bool getHash(void* hash, size_t bufsize) = 0;
+
+    // Hexadecimal representation of a hash of this object (hashSize() bytes).
+    virtual std::string toHex(const void* hash) const { return ToHex(hash, hashSize()); }
+
+    // Create a hasher from its name: sha1, sha256, sha512, sha512-256, crc32, crc32mpeg2. Return null if
+    // unknown. A comma-separated list of names creates a MultiHasher (one pass, all hashes).
+    static std::unique_ptr<Hasher> Create(const std::string& name);
+
+    // Comma-separated list of all names.
+    static const char* Names();
+
+    // Hexadecimal representation of a hash.
+    static std::string ToHex(const void* hash, size_t size);
+};
+
+// Adapter for the classes with the init() / add() / getHash() interface.
+template <class HASH>
+class HashAdapter : public Hasher
+{
+public:
+    HashAdapter(const char* name) : _name(name), _hash() {}
+    virtual const char* name() const override { return _name; }
+    virtual size_t hashSize() const override { return HASH::HASH_SIZE; }
+    virtual bool init() override { return _hash.init(); }
+    virtual bool add(const void* data, size_t size) override { return _hash.add(data, size); }
+    virtual bool getHash(void* hash, size_t bufsize) override { return _hash.getHash(hash, bufsize); }
+
+private:
+    const char* _name;
+    HASH _hash;
+};
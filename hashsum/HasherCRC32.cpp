@@ -0,0 +1,55 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Hashers for the CRC32 classes (module crc): ArmCRC32IEEE, the CRC32 of zlib
+// and gzip, and ArmCRC32, the CRC32 of MPEG-2 sections.
+//
+//----------------------------------------------------------------------------
+
+#include "HasherCRC32.h"
+#include "ArmCRC32.h"
+#include "ArmReflectedCRC32.h"
+
+namespace {
+    // The CRC value is returned as a 4-byte big-endian hash.
+    template <class CRC>
+    class CRC32Adapter : public Hasher
+    {
+    public:
+        CRC32Adapter(const char* name) : _name(name), _crc() {}
+        virtual const char* name() const override { return _name; }
+        virtual size_t hashSize() const override { return 4; }
+        virtual bool init() override { _crc.reset(); return true; }
+        virtual bool add(const void* data, size_t size) override { _crc.add(data, size); return true; }
+        virtual bool getHash(void* hash, size_t bufsize) override
+        {
+            if (bufsize < 4) {
+                return false;
+            }
+            const uint32_t value = _crc.value();
+            uint8_t* p = reinterpret_cast<uint8_t*>(hash);
+            p[0] = uint8_t(value >> 24);
+            p[1] = uint8_t(value >> 16);
+            p[2] = uint8_t(value >> 8);
+            p[3] = uint8_t(value);
+            return true;
+        }
+
+    private:
+        const char* _name;
+        CRC _crc;
+    };
+}
+
+Hasher* NewHasherCRC32()
+{
+    return new CRC32Adapter<ArmCRC32IEEE>("crc32");
+}
+
+Hasher* NewHasherCRC32MPEG2()
+{
+    return new CRC32Adapter<ArmCRC32>("crc32mpeg2");
+}
@@ -0,0 +1,16 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Hashers for the CRC32 classes (module crc): ArmCRC32IEEE, the CRC32 of zlib
+// and gzip, and ArmCRC32, the CRC32 of MPEG-2 sections.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "Hasher.h"
+
+Hasher* NewHasherCRC32();
+Hasher* NewHasherCRC32MPEG2();
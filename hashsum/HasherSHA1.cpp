@@ -0,0 +1,17 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Hasher for class ArmSHA1 (module sha1).
+//
+//----------------------------------------------------------------------------
+
+#include "HasherSHA1.h"
+#include "ArmSHA1.h"
+
+Hasher* NewHasherSHA1()
+{
+    return new HashAdapter<ArmSHA1>("sha1");
+}
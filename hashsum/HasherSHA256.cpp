@@ -0,0 +1,17 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Hasher for class ArmSHA256 (module sha256).
+//
+//----------------------------------------------------------------------------
+
+#include "HasherSHA256.h"
+#include "ArmSHA256.h"
+
+Hasher* NewHasherSHA256()
+{
+    return new HashAdapter<ArmSHA256>("sha256");
+}
@@ -0,0 +1,14 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Hasher for class ArmSHA256 (module sha256).
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "Hasher.h"
+
+Hasher* NewHasherSHA256();
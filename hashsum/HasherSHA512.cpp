@@ -0,0 +1,22 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Hashers for classes ArmSHA512 and ArmSHA512_256 (module sha512).
+//
+//----------------------------------------------------------------------------
+
+#include "HasherSHA512.h"
+#include "ArmSHA512.h"
+
+Hasher* NewHasherSHA512()
+{
+    return new HashAdapter<ArmSHA512>("sha512");
+}
+
+Hasher* NewHasherSHA512_256()
+{
+    return new HashAdapter<ArmSHA512_256>("sha512-256");
+}
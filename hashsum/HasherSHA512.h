@@ -0,0 +1,15 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Hashers for classes ArmSHA512 and ArmSHA512_256 (module sha512).
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "Hasher.h"
+
+Hasher* NewHasherSHA512();
+Hasher* NewHasherSHA512_256();
@@ -0,0 +1,109 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Fused computation of several hashes or CRC's in one pass over the data.
+//
+//----------------------------------------------------------------------------
+
+#include "MultiHasher.h"
+#include <algorithm>
+#include <cstring>
+
+// Constants may be used by reference.
+const size_t MultiHasher::DEFAULT_TILE_SIZE;
+const size_t MultiHasher::TILE_ALIGNMENT;
+
+
+//----------------------------------------------------------------------------
+// Constructor and configuration.
+//----------------------------------------------------------------------------
+
+MultiHasher::MultiHasher(size_t tile_size) :
+    _tile_size(DEFAULT_TILE_SIZE),
+    _name(),
+    _hashers()
+{
+    setTileSize(tile_size);
+}
+
+void MultiHasher::setTileSize(size_t size)
+{
+    _tile_size = std::max<size_t>(1, (size + TILE_ALIGNMENT - 1) / TILE_ALIGNMENT) * TILE_ALIGNMENT;
+}
+
+void MultiHasher::addHasher(std::unique_ptr<Hasher> hasher)
+{
+    if (hasher != nullptr) {
+        _name += (_name.empty() ? "" : ",") + std::string(hasher->name());
+        _hashers.push_back(std::move(hasher));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Implementation of Hasher.
+//----------------------------------------------------------------------------
+
+size_t MultiHasher::hashSize() const
+{
+    size_t size = 0;
+    for (const auto& h : _hashers) {
+        size += h->hashSize();
+    }
+    return size;
+}
+
+bool MultiHasher::init()
+{
+    bool ok = true;
+    for (const auto& h : _hashers) {
+        ok = h->init() && ok;
+    }
+    return ok;
+}
+
+bool MultiHasher::add(const void* data, size_t size)
+{
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
+    bool ok = true;
+    while (size > 0) {
+        const size_t tile = std::min(size, _tile_size);
+        for (const auto& h : _hashers) {
+            ok = h->add(in, tile) && ok;
+        }
+        in += tile;
+        size -= tile;
+    }
+    return ok;
+}
+
+bool MultiHasher::getHash(void* hash, size_t bufsize)
+{
+    if (bufsize < hashSize()) {
+        return false;
+    }
+    // The hashers may store words in their output, use an aligned buffer for each of them.
+    uint8_t* out = reinterpret_cast<uint8_t*>(hash);
+    bool ok = true;
+    for (const auto& h : _hashers) {
+        uint64_t buf[MAX_HASH_SIZE / 8];
+        ok = h->getHash(buf, sizeof(buf)) && ok;
+        ::memcpy(out, buf, h->hashSize());
+        out += h->hashSize();
+    }
+    return ok;
+}
+
+std::string MultiHasher::toHex(const void* hash) const
+{
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(hash);
+    std::string hex;
+    for (const auto& h : _hashers) {
+        hex += (hex.empty() ? "" : " ") + h->toHex(in);
+        in += h->hashSize();
+    }
+    return hex;
+}
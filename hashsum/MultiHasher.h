@@ -0,0 +1,51 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Fused computation of several hashes or CRC's in one pass over the data.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "Hasher.h"
+#include <vector>
+
+// Computing a CRC32 then a SHA-256 of a large buffer reads it twice from memory.
+// A MultiHasher walks the buffer once, in tiles which fit in the L1 data cache.
+// Each tile is added to all hashers in sequence: the first one loads the tile
+// from memory, the others find it in the L1 cache. The hash of a MultiHasher is
+// the concatenation of the hashes, in the order of the hashers.
+class MultiHasher : public Hasher
+{
+public:
+    // The tile size is a multiple of the largest block size (128 bytes, SHA-512) so that
+    // the hashers compress complete blocks from the data, without copy, after the first tile.
+    static const size_t DEFAULT_TILE_SIZE = 16 * 1024;
+    static const size_t TILE_ALIGNMENT = 128;
+
+    MultiHasher(size_t tile_size = DEFAULT_TILE_SIZE);
+    void setTileSize(size_t size);
+    size_t tileSize() const { return _tile_size; }
+
+    // Add a hasher, all hashers are computed in the same pass.
+    void addHasher(std::unique_ptr<Hasher> hasher);
+    size_t count() const { return _hashers.size(); }
+    const Hasher& hasher(size_t index) const { return *_hashers[index]; }
+
+    // Implementation of Hasher.
+    virtual const char* name() const override { return _name.c_str(); }
+    virtual size_t hashSize() const override;
+    virtual bool init() override;
+    virtual bool add(const void* data, size_t size) override;
+    virtual bool getHash(void* hash, size_t bufsize) override;
+
+    // The hashes are separated by spaces.
+    virtual std::string toHex(const void* hash) const override;
+
+private:
+    size_t _tile_size;
+    std::string _name;  // Comma-separated names of the hashers
+    std::vector<std::unique_ptr<Hasher>> _hashers;
+};
@@ -0,0 +1,151 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// A shasum-style command, using the Arm64 implementations of the hash and
+// CRC classes on memory-mapped files.
+//
+//----------------------------------------------------------------------------
+
+#include "FileHasher.h"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+
+#define DEFAULT_ALGORITHM "sha256"
+
+
+//----------------------------------------------------------------------------
+// Command line syntax.
+//----------------------------------------------------------------------------
+
+void usage(const char* name)
+{
+    std::cerr << "usage: " << name << " [-a algo] [-r] [-p] [-q depth] [-s kbytes] [-c] [-v] [file ...]" << std::endl
+              << std::endl
+              << "  -a algo : " << Hasher::Names() << " (default: " << DEFAULT_ALGORITHM << ")" << std::endl
+              << "  -r : use read() instead of a memory mapping" << std::endl
+              << "  -p : use a reader thread, overlap read() and the hash computation" << std::endl
+              << "  -q depth : number of chunks with -p (default: " << FileHasher::DEFAULT_QUEUE_DEPTH << ")" << std::endl
+              << "  -s kbytes : chunk size with -r and -p (default: " << (FileHasher::READ_BUFFER_SIZE / 1024) << ")" << std::endl
+              << "  -c : hash each file with a memory mapping, read() and a reader thread, compare" << std::endl
+              << "  -v : display the throughput of each file on stderr" << std::endl
+              << std::endl
+              << "Without file or with '-', the standard input is hashed, using read()." << std::endl;
+    ::exit(EXIT_FAILURE);
+}
+
+
+//----------------------------------------------------------------------------
+// Get a positive size option, up to 1 GB (the FileHasher clamps the values).
+//----------------------------------------------------------------------------
+
+size_t get_size(const char* arg, const char* name)
+{
+    char* end = nullptr;
+    const long value = std::strtol(arg, &end, 10);
+    if (end == arg || *end != '\0' || value <= 0 || value > 1024 * 1024 * 1024) {
+        usage(name);
+    }
+    return size_t(value);
+}
+
+
+//----------------------------------------------------------------------------
+// Throughput in MB/s.
+//----------------------------------------------------------------------------
+
+double mbps(uint64_t size, double seconds)
+{
+    return seconds > 0 ? double(size) / (seconds * 1000000.0) : 0.0;
+}
+
+
+//----------------------------------------------------------------------------
+// Hash one file, return the hexadecimal hash, empty on error.
+//----------------------------------------------------------------------------
+
+std::string hash_file(FileHasher& fh, Hasher& hasher, const std::string& filename, FileHasher::Mode mode, bool verbose)
+{
+    std::vector<uint8_t> hash(hasher.hashSize());
+    if (!hasher.init() || !fh.hashFile(filename, hasher, mode) || !hasher.getHash(hash.data(), hash.size())) {
+        std::cerr << filename << ": " << fh.error() << std::endl;
+        return std::string();
+    }
+    if (verbose) {
+        static const char* const mode_names[] = {"mmap", "read", "async"};
+        std::cerr << filename << ": " << fh.size() << " bytes, " << (fh.mapped() ? "mmap" : mode_names[mode])
+                  << ", " << mbps(fh.size(), fh.seconds()) << " MB/s";
+        // With read(), also display the throughput of each stage. The best possible
+        // time is the sum of the two without reader thread, the largest one with it.
+        if (!fh.mapped() && fh.ioSeconds() > 0 && fh.hashSeconds() > 0) {
+            const double best = mode == FileHasher::ASYNC ? std::max(fh.ioSeconds(), fh.hashSeconds()) : fh.ioSeconds() + fh.hashSeconds();
+            std::cerr << " (read: " << mbps(fh.size(), fh.ioSeconds()) << " MB/s, hash: " << mbps(fh.size(), fh.hashSeconds())
+                      << " MB/s, " << int(100.0 * best / fh.seconds()) << "% of best)";
+        }
+        std::cerr << std::endl;
+    }
+    return hasher.toHex(hash.data());
+}
+
+
+//----------------------------------------------------------------------------
+// Program entry point.
+//----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    std::string algo(DEFAULT_ALGORITHM);
+    FileHasher::Mode mode = FileHasher::MMAP;
+    bool compare = false;
+    bool verbose = false;
+
+    int opt;
+    FileHasher fh;
+    while ((opt = ::getopt(argc, argv, "a:rpq:s:cv")) != -1) {
+        switch (opt) {
+            case 'a': algo = optarg; break;
+            case 'r': mode = FileHasher::READ; break;
+            case 'p': mode = FileHasher::ASYNC; break;
+            case 'q': fh.setQueueDepth(get_size(optarg, argv[0])); break;
+            case 's': fh.setChunkSize(get_size(optarg, argv[0]) * 1024); break;
+            case 'c': compare = verbose = true; break;
+            case 'v': verbose = true; break;
+            default: usage(argv[0]);
+        }
+    }
+    std::vector<std::string> files(argv + optind, argv + argc);
+    if (files.empty()) {
+        files.push_back("-");
+    }
+
+    std::unique_ptr<Hasher> hasher(Hasher::Create(algo));
+    if (hasher == nullptr) {
+        std::cerr << argv[0] << ": unknown algorithm " << algo << ", use one of " << Hasher::Names() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int status = EXIT_SUCCESS;
+    for (const auto& file : files) {
+        const std::string hex(hash_file(fh, *hasher, file, mode, verbose));
+        if (hex.empty()) {
+            status = EXIT_FAILURE;
+            continue;
+        }
+        // The mapped file is now in the page cache, the difference with read() is the copy.
+        if (compare && fh.mapped()) {
+            for (FileHasher::Mode other : {FileHasher::READ, FileHasher::ASYNC}) {
+                if (hash_file(fh, *hasher, file, other, verbose) != hex) {
+                    std::cerr << file << ": DIFFERENT HASH" << std::endl;
+                    status = EXIT_FAILURE;
+                }
+            }
+        }
+        std::cout << hex << "  " << file << std::endl;
+    }
+    return status;
+}
@@ -0,0 +1,160 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Performance test of the fused computation of the MPEG-2 CRC32 and SHA-256
+// (one pass in L1-sized tiles) versus two passes over the buffer. Then compare
+// SHA-256 and SHA-512/256 (same digest size) on messages of various sizes.
+// Specify the total number of megabytes per test on the command line.
+//
+//----------------------------------------------------------------------------
+
+#include "MultiHasher.h"
+#include <ios>
+#include <iomanip>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <sys/resource.h>
+
+#define DEFAULT_TOTAL_MB 4096
+
+
+//----------------------------------------------------------------------------
+// Get the CPU time in milliseconds in user space since the process started.
+//----------------------------------------------------------------------------
+
+uint64_t get_user_ms()
+{
+    ::rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) < 0) {
+        perror("getrusage");
+        ::exit(EXIT_FAILURE);
+    }
+    return uint64_t(usage.ru_utime.tv_sec) * 1000 + uint64_t(usage.ru_utime.tv_usec) / 1000;
+}
+
+
+//----------------------------------------------------------------------------
+// Hash a buffer a number of times, return the throughput in MB/s.
+//----------------------------------------------------------------------------
+
+uint64_t get_mbps(Hasher& hasher, const std::vector<uint8_t>& data, uint64_t loops, std::vector<uint8_t>& hash)
+{
+    hash.resize(hasher.hashSize());
+    const uint64_t start = get_user_ms();
+    for (uint64_t n = 0; n < loops; ++n) {
+        hasher.init();
+        hasher.add(data.data(), data.size());
+        hasher.getHash(hash.data(), hash.size());
+    }
+    const uint64_t ms = get_user_ms() - start;
+    return ms > 0 ? loops * data.size() / (ms * 1000) : 0;
+}
+
+// Sequential: the complete buffer in each hasher, one after the other.
+uint64_t get_mbps_sequential(const std::vector<uint8_t>& data, uint64_t loops, std::vector<uint8_t>& hash)
+{
+    std::unique_ptr<Hasher> crc(Hasher::Create("crc32mpeg2"));
+    std::unique_ptr<Hasher> sha(Hasher::Create("sha256"));
+    hash.resize(crc->hashSize() + sha->hashSize());
+    const uint64_t start = get_user_ms();
+    for (uint64_t n = 0; n < loops; ++n) {
+        crc->init();
+        sha->init();
+        crc->add(data.data(), data.size());
+        sha->add(data.data(), data.size());
+        crc->getHash(hash.data(), crc->hashSize());
+        sha->getHash(hash.data() + crc->hashSize(), sha->hashSize());
+    }
+    const uint64_t ms = get_user_ms() - start;
+    return ms > 0 ? loops * data.size() / (ms * 1000) : 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Compare SHA-256 and SHA-512/256 in the same table, each message is hashed
+// separately. Report the smallest size where SHA-512/256 is faster, if any.
+//----------------------------------------------------------------------------
+
+void perf_crossover(uint64_t total_mb)
+{
+    std::cout << std::endl << "SHA-256 vs SHA-512/256, " << total_mb << " MB per test, MB/s" << std::endl;
+    std::cout << "  message size: SHA-256 / SHA-512/256 (ratio)" << std::endl;
+
+    std::unique_ptr<Hasher> sha256(Hasher::Create("sha256"));
+    std::unique_ptr<Hasher> sha512_256(Hasher::Create("sha512-256"));
+    size_t crossover = 0;
+
+    for (size_t size : {64, 256, 1024, 4096, 16384, 65536, 1024 * 1024}) {
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = uint8_t(i * 7 + (i >> 12));
+        }
+        const uint64_t loops = std::max<uint64_t>(1, total_mb * 1024 * 1024 / size);
+
+        std::vector<uint8_t> hash;
+        const uint64_t mbps1 = get_mbps(*sha256, data, loops, hash);
+        const uint64_t mbps2 = get_mbps(*sha512_256, data, loops, hash);
+        if (crossover == 0 && mbps2 > mbps1) {
+            crossover = size;
+        }
+        std::cout << "  " << std::setw(7) << size << " bytes: " << mbps1 << " / " << mbps2;
+        if (mbps1 > 0) {
+            std::cout << " (" << std::fixed << std::setprecision(2) << double(mbps2) / double(mbps1) << ")";
+        }
+        std::cout << std::endl;
+    }
+    if (crossover == 0) {
+        std::cout << "  SHA-256 is faster on all sizes" << std::endl;
+    }
+    else {
+        std::cout << "  SHA-512/256 is faster from " << crossover << " bytes" << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Program entry point.
+//----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    const uint64_t total_mb = argc > 1 ? uint64_t(std::atoll(argv[1])) : DEFAULT_TOTAL_MB;
+    static const size_t tiles[] = {4096, 16384, 65536};
+
+    std::cout << "Fused MPEG-2 CRC32 and SHA-256, " << total_mb << " MB per test, MB/s" << std::endl;
+    std::cout << "  buffer size: sequential";
+    for (size_t tile : tiles) {
+        std::cout << " / " << (tile / 1024) << " kB tiles";
+    }
+    std::cout << std::endl;
+
+    // From L2-resident buffers to well beyond the last-level cache.
+    for (size_t size : {size_t(256 * 1024), size_t(4 * 1024 * 1024), size_t(64 * 1024 * 1024), size_t(512 * 1024 * 1024)}) {
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = uint8_t(i * 7 + (i >> 12));
+        }
+        const uint64_t loops = std::max<uint64_t>(1, total_mb * 1024 * 1024 / size);
+
+        std::vector<uint8_t> ref_hash;
+        std::vector<uint8_t> hash;
+        bool ok = true;
+        std::cout << "  " << std::setw(6) << (size / 1024) << " kB: " << get_mbps_sequential(data, loops, ref_hash);
+        for (size_t tile : tiles) {
+            MultiHasher multi(tile);
+            multi.addHasher(Hasher::Create("crc32mpeg2"));
+            multi.addHasher(Hasher::Create("sha256"));
+            std::cout << " / " << get_mbps(multi, data, loops, hash);
+            ok = ok && hash == ref_hash;
+        }
+        std::cout << (ok ? "" : " (INVALID HASH)") << std::endl;
+    }
+
+    perf_crossover(total_mb);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Test of FileHasher: the hash of a file must be the same from a memory mapping,
+// using read(), using a reader thread and from a pipe, and must match the hash
+// of the data in memory.
+//
+//----------------------------------------------------------------------------
+
+#include "FileHasher.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+// Known hashes of "abc".
+static const struct {
+    const char* name;
+    const char* hash;
+} known_abc[] = {
+    {"sha1",   "a9993e364706816aba3e25717850c26c9cd0d89d"},
+    {"sha256", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+    {"sha512", "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+               "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"},
+    {"sha512-256", "53048e2681941ef99b2e29b76b4c7dabe4c2d0c634fc6d46e0e2f13107e7af23"},
+    {"crc32",  "352441c2"},
+    {"crc32mpeg2", "9b73448c"},
+    {"crc32mpeg2,sha256,sha512",
+               "9b73448c"
+               "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"
+               "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+               "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"},
+};
+
+
+//----------------------------------------------------------------------------
+// Hash a file, or data in memory, return the hexadecimal hash.
+//----------------------------------------------------------------------------
+
+std::string hash_file(FileHasher& fh, Hasher& hasher, int fd, FileHasher::Mode mode)
+{
+    std::vector<uint8_t> hash(hasher.hashSize());
+    // Rewind regular files, a pipe is not seekable.
+    if (::lseek(fd, 0, SEEK_SET) < 0 && errno != ESPIPE) {
+        return "lseek error";
+    }
+    if (!hasher.init() || !fh.hashFile(fd, hasher, mode) || !hasher.getHash(hash.data(), hash.size())) {
+        return fh.error();
+    }
+    return Hasher::ToHex(hash.data(), hash.size());
+}
+
+// With a list of names, concatenate the hashes, computed separately.
+std::string hash_data(const std::string& names, const std::vector<uint8_t>& data)
+{
+    std::string hex;
+    for (size_t start = 0; start != std::string::npos; ) {
+        const size_t end = names.find(',', start);
+        std::unique_ptr<Hasher> hasher(Hasher::Create(names.substr(start, end == std::string::npos ? end : end - start)));
+        uint8_t hash[Hasher::MAX_HASH_SIZE];
+        hasher->init();
+        hasher->add(data.data(), data.size());
+        hasher->getHash(hash, sizeof(hash));
+        hex += Hasher::ToHex(hash, hasher->hashSize());
+        start = end == std::string::npos ? end : end + 1;
+    }
+    return hex;
+}
+
+// Hash the data from a pipe, written by another thread.
+std::string hash_pipe(FileHasher& fh, Hasher& hasher, const std::vector<uint8_t>& data, FileHasher::Mode mode)
+{
+    int fds[2];
+    if (::pipe(fds) < 0) {
+        return "pipe error";
+    }
+    std::thread writer([&data, fds]() {
+        for (size_t done = 0; done < data.size(); ) {
+            const ssize_t n = ::write(fds[1], data.data() + done, std::min<size_t>(data.size() - done, 100000));
+            if (n <= 0) {
+                break;
+            }
+            done += size_t(n);
+        }
+        ::close(fds[1]);
+    });
+    const std::string hex(hash_file(fh, hasher, fds[0], mode));
+    writer.join();
+    ::close(fds[0]);
+    return hex;
+}
+
+
+//----------------------------------------------------------------------------
+// Program entry point.
+//----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    char filename[] = "/tmp/hashsum_test_XXXXXX";
+    const int fd = ::mkstemp(filename);
+    if (fd < 0) {
+        perror("mkstemp");
+        return EXIT_FAILURE;
+    }
+    ::unlink(filename);
+
+    // Reader thread with the default parameters, then with small chunks in a short ring.
+    FileHasher fh;
+    FileHasher small;
+    small.setChunkSize(4096);
+    small.setQueueDepth(2);
+
+    std::vector<uint8_t> data;
+    for (size_t size : {size_t(0), size_t(3), size_t(4095), size_t(4096), FileHasher::READ_BUFFER_SIZE + 3, size_t(5000000)}) {
+
+        // Rewrite the file with new content.
+        data.resize(size);
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = size == 3 ? uint8_t('a' + i) : uint8_t(i * 7 + i / 1000);
+        }
+        if (::ftruncate(fd, 0) < 0 || ::pwrite(fd, data.data(), size, 0) != ssize_t(size)) {
+            perror("write");
+            return EXIT_FAILURE;
+        }
+
+        for (const auto& known : known_abc) {
+            std::unique_ptr<Hasher> hasher(Hasher::Create(known.name));
+            const std::string expected(size == 3 ? std::string(known.hash) : hash_data(known.name, data));
+            const bool mmap_ok = hash_file(fh, *hasher, fd, FileHasher::MMAP) == expected && fh.mapped() == (size > 0);
+            const bool read_ok = hash_file(fh, *hasher, fd, FileHasher::READ) == expected && !fh.mapped();
+            const bool async_ok = hash_file(fh, *hasher, fd, FileHasher::ASYNC) == expected &&
+                                  hash_file(small, *hasher, fd, FileHasher::ASYNC) == expected && small.size() == size;
+            const bool pipe_ok = hash_pipe(fh, *hasher, data, FileHasher::READ) == expected && fh.size() == size &&
+                                 hash_pipe(small, *hasher, data, FileHasher::ASYNC) == expected && small.size() == size;
+            std::cout << std::setw(7) << size << " bytes, " << std::setw(10) << known.name
+                      << ", mmap: " << (mmap_ok ? "passed" : "FAILED")
+                      << ", read: " << (read_ok ? "passed" : "FAILED")
+                      << ", async: " << (async_ok ? "passed" : "FAILED")
+                      << ", pipe: " << (pipe_ok ? "passed" : "FAILED") << std::endl;
+        }
+    }
+    ::close(fd);
+    return EXIT_SUCCESS;
+}
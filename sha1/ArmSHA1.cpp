@@ -11,6 +11,76 @@
 
 #include "ArmSHA1.h"
 #include <arm_neon.h>
+#include <utility>
+
+// Constants may be used by reference.
+const size_t ArmSHA1::MAX_LANES;
+
+namespace {
+
+    const uint32_t H0[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    const uint32_t K[4] = {0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xCA62C1D6};
+
+    // One message in progress in the multi-buffer hashing. The complete blocks are
+    // compressed from the message, the padded final blocks from the lane buffer.
+    struct Lane
+    {
+        size_t         index;     // Index of the message.
+        const uint8_t* data;      // Next block to compress.
+        size_t         blocks;    // Remaining complete blocks in the message.
+        size_t         padded;    // Remaining padded blocks in 'last' (1 or 2).
+        uint8_t        last[2 * ArmSHA1::BLOCK_SIZE];
+        uint32_t       state[5];
+
+        // Start a new message.
+        void start(size_t msg_index, const void* msg, size_t size)
+        {
+            const size_t rest = size % ArmSHA1::BLOCK_SIZE;
+            index = msg_index;
+            data = reinterpret_cast<const uint8_t*>(msg);
+            blocks = size / ArmSHA1::BLOCK_SIZE;
+            padded = rest + 9 <= ArmSHA1::BLOCK_SIZE ? 1 : 2;
+            ::memcpy(state, H0, sizeof(state));
+
+            // Trailing bytes, '1' bit, zeroes, 64-bit message length in bits.
+            const size_t last_size = padded * ArmSHA1::BLOCK_SIZE;
+            if (rest > 0) {
+                ::memcpy(last, data + blocks * ArmSHA1::BLOCK_SIZE, rest);
+            }
+            last[rest] = 0x80;
+            bzero(last + rest + 1, last_size - rest - 9);
+            PutUInt64(last + last_size - 8, uint64_t(size) * 8);
+            if (blocks == 0) {
+                data = last;
+            }
+        }
+
+        bool done() const { return blocks == 0 && padded == 0; }
+
+        // Get the next block to compress. After the complete blocks, continue in 'last'.
+        const uint8_t* next()
+        {
+            const uint8_t* block = data;
+            data += ArmSHA1::BLOCK_SIZE;
+            if (blocks > 0) {
+                if (--blocks == 0) {
+                    data = last;
+                }
+            }
+            else {
+                padded--;
+            }
+            return block;
+        }
+    };
+
+    // Rotate left the 4 lanes of a vector.
+    template <int N>
+    inline __attribute__((always_inline)) uint32x4_t rotl(uint32x4_t x)
+    {
+        return vsliq_n_u32(vshrq_n_u32(x, 32 - N), x, N);
+    }
+}
 
 
 //----------------------------------------------------------------------------
@@ -19,12 +89,25 @@
 
 ArmSHA1::ArmSHA1() :
     _length(0),
-    _curlen(0)
+    _curlen(0),
+    _compress(accelerated() ? compressArm : compressPortable),
+    _block_by_block(false)
 {
     init();
 }
 
 
+//----------------------------------------------------------------------------
+// Check if the SHA-1 instructions are present.
+//----------------------------------------------------------------------------
+
+bool ArmSHA1::accelerated()
+{
+    static const bool accel = HasCPUFeatures(CPU_SHA1);
+    return accel;
+}
+
+
 //----------------------------------------------------------------------------
 // Reinitialize the computation of the hash.
 // Return true on success, false on error.
@@ -43,170 +126,399 @@ bool ArmSHA1::init()
 }
 
 
+//----------------------------------------------------------------------------
+// Compress consecutive blocks without the SHA-1 instructions.
+//----------------------------------------------------------------------------
+
+void ArmSHA1::compressPortable(uint32_t* state, const uint8_t* buf, size_t count)
+{
+    for (; count > 0; --count, buf += BLOCK_SIZE) {
+        SHA1::compress(state, buf);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Compress part of message
 //----------------------------------------------------------------------------
 
-void ArmSHA1::compress(const uint8_t* buf)
+TARGET_SHA2 void ArmSHA1::compressArm(uint32_t* state, const uint8_t* buf, size_t count)
 {
     // Copy state
-    uint32x4_t ABCD = vld1q_u32(_state);
-    uint32_t E = _state[4];
+    uint32x4_t ABCD = vld1q_u32(state);
+    uint32_t E = state[4];
 
     const uint32x4_t C0 = vdupq_n_u32(0x5A827999);
     const uint32x4_t C1 = vdupq_n_u32(0x6ED9EBA1);
     const uint32x4_t C2 = vdupq_n_u32(0x8F1BBCDC);
     const uint32x4_t C3 = vdupq_n_u32(0xCA62C1D6);
 
-    const uint32_t* buf32 = reinterpret_cast<const uint32_t*>(buf);
-    uint32x4_t MSG0 = vld1q_u32(buf32 + 0);
-    uint32x4_t MSG1 = vld1q_u32(buf32 + 4);
-    uint32x4_t MSG2 = vld1q_u32(buf32 + 8);
-    uint32x4_t MSG3 = vld1q_u32(buf32 + 12);
-
-    MSG0 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(MSG0)));
-    MSG1 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(MSG1)));
-    MSG2 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(MSG2)));
-    MSG3 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(MSG3)));
-
-    uint32x4_t TMP0 = vaddq_u32(MSG0, C0);
-    uint32x4_t TMP1 = vaddq_u32(MSG1, C0);
-
-    // Rounds 0-3
-    uint32_t E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1cq_u32(ABCD, E, TMP0);
-    TMP0 = vaddq_u32(MSG2, C0);
-    MSG0 = vsha1su0q_u32(MSG0, MSG1, MSG2);
-
-    // Rounds 4-7
-    E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1cq_u32(ABCD, E1, TMP1);
-    TMP1 = vaddq_u32(MSG3, C0);
-    MSG0 = vsha1su1q_u32(MSG0, MSG3);
-    MSG1 = vsha1su0q_u32(MSG1, MSG2, MSG3);
-
-    // Rounds 8-11
-    E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1cq_u32(ABCD, E, TMP0);
-    TMP0 = vaddq_u32(MSG0, C0);
-    MSG1 = vsha1su1q_u32(MSG1, MSG0);
-    MSG2 = vsha1su0q_u32(MSG2, MSG3, MSG0);
-
-    // Rounds 12-15
-    E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1cq_u32(ABCD, E1, TMP1);
-    TMP1 = vaddq_u32(MSG1, C1);
-    MSG2 = vsha1su1q_u32(MSG2, MSG1);
-    MSG3 = vsha1su0q_u32(MSG3, MSG0, MSG1);
-
-    // Rounds 16-19
-    E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1cq_u32(ABCD, E, TMP0);
-    TMP0 = vaddq_u32(MSG2, C1);
-    MSG3 = vsha1su1q_u32(MSG3, MSG2);
-    MSG0 = vsha1su0q_u32(MSG0, MSG1, MSG2);
-
-    // Rounds 20-23
-    E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1pq_u32(ABCD, E1, TMP1);
-    TMP1 = vaddq_u32(MSG3, C1);
-    MSG0 = vsha1su1q_u32(MSG0, MSG3);
-    MSG1 = vsha1su0q_u32(MSG1, MSG2, MSG3);
-
-    // Rounds 24-27
-    E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1pq_u32(ABCD, E, TMP0);
-    TMP0 = vaddq_u32(MSG0, C1);
-    MSG1 = vsha1su1q_u32(MSG1, MSG0);
-    MSG2 = vsha1su0q_u32(MSG2, MSG3, MSG0);
-
-    // Rounds 28-31
-    E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1pq_u32(ABCD, E1, TMP1);
-    TMP1 = vaddq_u32(MSG1, C1);
-    MSG2 = vsha1su1q_u32(MSG2, MSG1);
-    MSG3 = vsha1su0q_u32(MSG3, MSG0, MSG1);
-
-    // Rounds 32-35
-    E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1pq_u32(ABCD, E, TMP0);
-    TMP0 = vaddq_u32(MSG2, C2);
-    MSG3 = vsha1su1q_u32(MSG3, MSG2);
-    MSG0 = vsha1su0q_u32(MSG0, MSG1, MSG2);
-
-    // Rounds 36-39
-    E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1pq_u32(ABCD, E1, TMP1);
-    TMP1 = vaddq_u32(MSG3, C2);
-    MSG0 = vsha1su1q_u32(MSG0, MSG3);
-    MSG1 = vsha1su0q_u32(MSG1, MSG2, MSG3);
-
-    // Rounds 40-43
-    E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1mq_u32(ABCD, E, TMP0);
-    TMP0 = vaddq_u32(MSG0, C2);
-    MSG1 = vsha1su1q_u32(MSG1, MSG0);
-    MSG2 = vsha1su0q_u32(MSG2, MSG3, MSG0);
-
-    // Rounds 44-47
-    E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1mq_u32(ABCD, E1, TMP1);
-    TMP1 = vaddq_u32(MSG1, C2);
-    MSG2 = vsha1su1q_u32(MSG2, MSG1);
-    MSG3 = vsha1su0q_u32(MSG3, MSG0, MSG1);
-
-    // Rounds 48-51
-    E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1mq_u32(ABCD, E, TMP0);
-    TMP0 = vaddq_u32(MSG2, C2);
-    MSG3 = vsha1su1q_u32(MSG3, MSG2);
-    MSG0 = vsha1su0q_u32(MSG0, MSG1, MSG2);
-
-    // Rounds 52-55
-    E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1mq_u32(ABCD, E1, TMP1);
-    TMP1 = vaddq_u32(MSG3, C3);
-    MSG0 = vsha1su1q_u32(MSG0, MSG3);
-    MSG1 = vsha1su0q_u32(MSG1, MSG2, MSG3);
-
-    // Rounds 56-59
-    E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1mq_u32(ABCD, E, TMP0);
-    TMP0 = vaddq_u32(MSG0, C3);
-    MSG1 = vsha1su1q_u32(MSG1, MSG0);
-    MSG2 = vsha1su0q_u32(MSG2, MSG3, MSG0);
-
-    // Rounds 60-63
-    E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1pq_u32(ABCD, E1, TMP1);
-    TMP1 = vaddq_u32(MSG1, C3);
-    MSG2 = vsha1su1q_u32(MSG2, MSG1);
-    MSG3 = vsha1su0q_u32(MSG3, MSG0, MSG1);
-
-    // Rounds 64-67
-    E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1pq_u32(ABCD, E, TMP0);
-    TMP0 = vaddq_u32(MSG2, C3);
-    MSG3 = vsha1su1q_u32(MSG3, MSG2);
-    // MSG0 = vsha1su0q_u32(MSG0, MSG1, MSG2);
-
-    // Rounds 68-71
-    E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1pq_u32(ABCD, E1, TMP1);
-    TMP1 = vaddq_u32(MSG3, C3);
-    // MSG0 = vsha1su1q_u32(MSG0, MSG3);
-
-    // Rounds 72-75
-    E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1pq_u32(ABCD, E, TMP0);
-
-    // Rounds 76-79
-    E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
-    ABCD = vsha1pq_u32(ABCD, E1, TMP1);
-
-    // Store state: add ABCD E to state 0..5 
-    vst1q_u32(_state, vaddq_u32(vld1q_u32(_state), ABCD));
-    _state[4] += E;
+    // Compress all blocks, the state remains in registers between blocks.
+    for (; count > 0; --count, buf += BLOCK_SIZE) {
+        // Save current state.
+        const uint32x4_t previous_ABCD = ABCD;
+        const uint32_t previous_E = E;
+
+        const uint32_t* buf32 = reinterpret_cast<const uint32_t*>(buf);
+        uint32x4_t MSG0 = vld1q_u32(buf32 + 0);
+        uint32x4_t MSG1 = vld1q_u32(buf32 + 4);
+        uint32x4_t MSG2 = vld1q_u32(buf32 + 8);
+        uint32x4_t MSG3 = vld1q_u32(buf32 + 12);
+
+        MSG0 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(MSG0)));
+        MSG1 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(MSG1)));
+        MSG2 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(MSG2)));
+        MSG3 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(MSG3)));
+
+        uint32x4_t TMP0 = vaddq_u32(MSG0, C0);
+        uint32x4_t TMP1 = vaddq_u32(MSG1, C0);
+
+        // Rounds 0-3
+        uint32_t E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1cq_u32(ABCD, E, TMP0);
+        TMP0 = vaddq_u32(MSG2, C0);
+        MSG0 = vsha1su0q_u32(MSG0, MSG1, MSG2);
+
+        // Rounds 4-7
+        E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1cq_u32(ABCD, E1, TMP1);
+        TMP1 = vaddq_u32(MSG3, C0);
+        MSG0 = vsha1su1q_u32(MSG0, MSG3);
+        MSG1 = vsha1su0q_u32(MSG1, MSG2, MSG3);
+
+        // Rounds 8-11
+        E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1cq_u32(ABCD, E, TMP0);
+        TMP0 = vaddq_u32(MSG0, C0);
+        MSG1 = vsha1su1q_u32(MSG1, MSG0);
+        MSG2 = vsha1su0q_u32(MSG2, MSG3, MSG0);
+
+        // Rounds 12-15
+        E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1cq_u32(ABCD, E1, TMP1);
+        TMP1 = vaddq_u32(MSG1, C1);
+        MSG2 = vsha1su1q_u32(MSG2, MSG1);
+        MSG3 = vsha1su0q_u32(MSG3, MSG0, MSG1);
+
+        // Rounds 16-19
+        E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1cq_u32(ABCD, E, TMP0);
+        TMP0 = vaddq_u32(MSG2, C1);
+        MSG3 = vsha1su1q_u32(MSG3, MSG2);
+        MSG0 = vsha1su0q_u32(MSG0, MSG1, MSG2);
+
+        // Rounds 20-23
+        E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1pq_u32(ABCD, E1, TMP1);
+        TMP1 = vaddq_u32(MSG3, C1);
+        MSG0 = vsha1su1q_u32(MSG0, MSG3);
+        MSG1 = vsha1su0q_u32(MSG1, MSG2, MSG3);
+
+        // Rounds 24-27
+        E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1pq_u32(ABCD, E, TMP0);
+        TMP0 = vaddq_u32(MSG0, C1);
+        MSG1 = vsha1su1q_u32(MSG1, MSG0);
+        MSG2 = vsha1su0q_u32(MSG2, MSG3, MSG0);
+
+        // Rounds 28-31
+        E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1pq_u32(ABCD, E1, TMP1);
+        TMP1 = vaddq_u32(MSG1, C1);
+        MSG2 = vsha1su1q_u32(MSG2, MSG1);
+        MSG3 = vsha1su0q_u32(MSG3, MSG0, MSG1);
+
+        // Rounds 32-35
+        E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1pq_u32(ABCD, E, TMP0);
+        TMP0 = vaddq_u32(MSG2, C2);
+        MSG3 = vsha1su1q_u32(MSG3, MSG2);
+        MSG0 = vsha1su0q_u32(MSG0, MSG1, MSG2);
+
+        // Rounds 36-39
+        E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1pq_u32(ABCD, E1, TMP1);
+        TMP1 = vaddq_u32(MSG3, C2);
+        MSG0 = vsha1su1q_u32(MSG0, MSG3);
+        MSG1 = vsha1su0q_u32(MSG1, MSG2, MSG3);
+
+        // Rounds 40-43
+        E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1mq_u32(ABCD, E, TMP0);
+        TMP0 = vaddq_u32(MSG0, C2);
+        MSG1 = vsha1su1q_u32(MSG1, MSG0);
+        MSG2 = vsha1su0q_u32(MSG2, MSG3, MSG0);
+
+        // Rounds 44-47
+        E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1mq_u32(ABCD, E1, TMP1);
+        TMP1 = vaddq_u32(MSG1, C2);
+        MSG2 = vsha1su1q_u32(MSG2, MSG1);
+        MSG3 = vsha1su0q_u32(MSG3, MSG0, MSG1);
+
+        // Rounds 48-51
+        E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1mq_u32(ABCD, E, TMP0);
+        TMP0 = vaddq_u32(MSG2, C2);
+        MSG3 = vsha1su1q_u32(MSG3, MSG2);
+        MSG0 = vsha1su0q_u32(MSG0, MSG1, MSG2);
+
+        // Rounds 52-55
+        E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1mq_u32(ABCD, E1, TMP1);
+        TMP1 = vaddq_u32(MSG3, C3);
+        MSG0 = vsha1su1q_u32(MSG0, MSG3);
+        MSG1 = vsha1su0q_u32(MSG1, MSG2, MSG3);
+
+        // Rounds 56-59
+        E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1mq_u32(ABCD, E, TMP0);
+        TMP0 = vaddq_u32(MSG0, C3);
+        MSG1 = vsha1su1q_u32(MSG1, MSG0);
+        MSG2 = vsha1su0q_u32(MSG2, MSG3, MSG0);
+
+        // Rounds 60-63
+        E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1pq_u32(ABCD, E1, TMP1);
+        TMP1 = vaddq_u32(MSG1, C3);
+        MSG2 = vsha1su1q_u32(MSG2, MSG1);
+        MSG3 = vsha1su0q_u32(MSG3, MSG0, MSG1);
+
+        // Rounds 64-67
+        E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1pq_u32(ABCD, E, TMP0);
+        TMP0 = vaddq_u32(MSG2, C3);
+        MSG3 = vsha1su1q_u32(MSG3, MSG2);
+        // MSG0 = vsha1su0q_u32(MSG0, MSG1, MSG2);
+
+        // Rounds 68-71
+        E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1pq_u32(ABCD, E1, TMP1);
+        TMP1 = vaddq_u32(MSG3, C3);
+        // MSG0 = vsha1su1q_u32(MSG0, MSG3);
+
+        // Rounds 72-75
+        E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1pq_u32(ABCD, E, TMP0);
+
+        // Rounds 76-79
+        E = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+        ABCD = vsha1pq_u32(ABCD, E1, TMP1);
+
+        // Add back to state
+        ABCD = vaddq_u32(ABCD, previous_ABCD);
+        E += previous_E;
+    }
+
+    // Save state
+    vst1q_u32(state, ABCD);
+    state[4] = E;
+}
+
+
+//----------------------------------------------------------------------------
+// Compress one block in each of N independent states. This is the same
+// sequence as compressArm(), each group of 4 rounds is done on all states
+// before the next group. The N chains are independent and fill the latency
+// of the SHA-1 instructions. The loops on lanes are fully unrolled.
+//----------------------------------------------------------------------------
+
+template <size_t N>
+TARGET_SHA2 void ArmSHA1::compressLanes(uint32_t* const* states, const uint8_t* const* blocks)
+{
+    uint32x4_t abcd[N], msg[4][N];
+    uint32_t e[N];
+
+    #pragma GCC unroll 4
+    for (size_t l = 0; l < N; ++l) {
+        abcd[l] = vld1q_u32(states[l]);
+        e[l] = states[l][4];
+        const uint32_t* buf32 = reinterpret_cast<const uint32_t*>(blocks[l]);
+        #pragma GCC unroll 4
+        for (size_t i = 0; i < 4; ++i) {
+            msg[i][l] = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(vld1q_u32(buf32 + 4 * i))));
+        }
+    }
+
+    // 20 groups of 4 rounds: SHA1C, SHA1P, SHA1M, SHA1P, 5 groups each.
+    // The message schedule is updated in the first 16 groups.
+    #pragma GCC unroll 20
+    for (size_t g = 0; g < 20; ++g) {
+        const uint32x4_t k = vdupq_n_u32(K[g / 5]);
+        #pragma GCC unroll 4
+        for (size_t l = 0; l < N; ++l) {
+            const uint32x4_t msg_k = vaddq_u32(msg[g%4][l], k);
+            const uint32_t e_next = vsha1h_u32(vgetq_lane_u32(abcd[l], 0));
+            if (g < 5) {
+                abcd[l] = vsha1cq_u32(abcd[l], e[l], msg_k);
+            }
+            else if (g >= 10 && g < 15) {
+                abcd[l] = vsha1mq_u32(abcd[l], e[l], msg_k);
+            }
+            else {
+                abcd[l] = vsha1pq_u32(abcd[l], e[l], msg_k);
+            }
+            e[l] = e_next;
+            if (g < 16) {
+                msg[g%4][l] = vsha1su1q_u32(vsha1su0q_u32(msg[g%4][l], msg[(g+1)%4][l], msg[(g+2)%4][l]), msg[(g+3)%4][l]);
+            }
+        }
+    }
+
+    #pragma GCC unroll 4
+    for (size_t l = 0; l < N; ++l) {
+        vst1q_u32(states[l], vaddq_u32(vld1q_u32(states[l]), abcd[l]));
+        states[l][4] += e[l];
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Compress one block in each of 4 independent states, without the SHA-1
+// instructions. Each NEON vector contains the same variable of the 4 states,
+// one per lane, and the 80 rounds are done as in the portable code.
+//----------------------------------------------------------------------------
+
+void ArmSHA1::compressNeon4(uint32_t* const* states, const uint8_t* const* blocks)
+{
+    // Transpose the states and the message words: lane l is message l.
+    uint32_t tmp[16][4];
+    for (size_t l = 0; l < 4; ++l) {
+        for (size_t t = 0; t < 16; ++t) {
+            tmp[t][l] = GetUInt32(blocks[l] + 4 * t);
+        }
+    }
+    uint32x4_t w[16];
+    for (size_t t = 0; t < 16; ++t) {
+        w[t] = vld1q_u32(tmp[t]);
+    }
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t l = 0; l < 4; ++l) {
+            tmp[i][l] = states[l][i];
+        }
+    }
+    const uint32x4_t a0 = vld1q_u32(tmp[0]);
+    const uint32x4_t b0 = vld1q_u32(tmp[1]);
+    const uint32x4_t c0 = vld1q_u32(tmp[2]);
+    const uint32x4_t d0 = vld1q_u32(tmp[3]);
+    const uint32x4_t e0 = vld1q_u32(tmp[4]);
+    uint32x4_t a = a0, b = b0, c = c0, d = d0, e = e0;
+
+    for (size_t t = 0; t < 80; ++t) {
+        // Message schedule, in a circular buffer of 16 words.
+        if (t >= 16) {
+            w[t % 16] = rotl<1>(veorq_u32(veorq_u32(w[(t - 3) % 16], w[(t - 8) % 16]), veorq_u32(w[(t - 14) % 16], w[t % 16])));
+        }
+        uint32x4_t f;
+        if (t < 20) {
+            f = vbslq_u32(b, c, d);                     // Ch
+        }
+        else if (t >= 40 && t < 60) {
+            f = vbslq_u32(veorq_u32(b, c), d, b);       // Maj
+        }
+        else {
+            f = veorq_u32(veorq_u32(b, c), d);          // Parity
+        }
+        const uint32x4_t temp = vaddq_u32(vaddq_u32(rotl<5>(a), f), vaddq_u32(vaddq_u32(e, w[t % 16]), vdupq_n_u32(K[t / 20])));
+        e = d;
+        d = c;
+        c = rotl<30>(b);
+        b = a;
+        a = temp;
+    }
+
+    vst1q_u32(tmp[0], vaddq_u32(a, a0));
+    vst1q_u32(tmp[1], vaddq_u32(b, b0));
+    vst1q_u32(tmp[2], vaddq_u32(c, c0));
+    vst1q_u32(tmp[3], vaddq_u32(d, d0));
+    vst1q_u32(tmp[4], vaddq_u32(e, e0));
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t l = 0; l < 4; ++l) {
+            states[l][i] = tmp[i][l];
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Multi-buffer hashing of independent messages.
+//----------------------------------------------------------------------------
+
+bool ArmSHA1::hashMulti(const void* const* messages, const size_t* sizes, size_t count, void* hashes, size_t hashes_size, size_t lanes)
+{
+    if (hashes_size < count * HASH_SIZE || lanes == 0) {
+        return false;
+    }
+    const bool accel = accelerated();
+    lanes = std::min(lanes, MAX_LANES);
+    uint8_t* out = reinterpret_cast<uint8_t*>(hashes);
+
+    // Active lanes, the first 'active' pointers in 'lane'.
+    Lane lane_data[MAX_LANES];
+    Lane* lane[MAX_LANES];
+    size_t active = 0;
+    size_t next_msg = 0;
+    while (active < lanes && next_msg < count) {
+        lane[active] = &lane_data[active];
+        lane[active]->start(next_msg, messages[next_msg], sizes[next_msg]);
+        active++;
+        next_msg++;
+    }
+
+    while (active > 0) {
+        // Compress one block in each active lane.
+        uint32_t* states[MAX_LANES];
+        const uint8_t* blocks[MAX_LANES];
+        for (size_t l = 0; l < active; ++l) {
+            states[l] = lane[l]->state;
+            blocks[l] = lane[l]->next();
+        }
+        size_t l = 0;
+        if (accel) {
+            // By groups of 4, 2, 1.
+            for (; l + 4 <= active; l += 4) {
+                compressLanes<4>(states + l, blocks + l);
+            }
+            for (; l + 2 <= active; l += 2) {
+                compressLanes<2>(states + l, blocks + l);
+            }
+            for (; l < active; ++l) {
+                compressArm(states[l], blocks[l], 1);
+            }
+        }
+        else if (active == 1) {
+            SHA1::compress(states[0], blocks[0]);
+        }
+        else {
+            // Unused NEON lanes work on a scratch state.
+            uint32_t scratch[5] = {};
+            for (l = active; l < 4; ++l) {
+                states[l] = scratch;
+                blocks[l] = blocks[0];
+            }
+            compressNeon4(states, blocks);
+        }
+
+        // Output the finished messages. Their lanes start the next messages, if any.
+        for (l = 0; l < active; ) {
+            if (!lane[l]->done()) {
+                l++;
+                continue;
+            }
+            for (size_t i = 0; i < 5; i++) {
+                PutUInt32(out + lane[l]->index * HASH_SIZE + 4*i, lane[l]->state[i]);
+            }
+            if (next_msg < count) {
+                lane[l]->start(next_msg, messages[next_msg], sizes[next_msg]);
+                next_msg++;
+                l++;
+            }
+            else {
+                std::swap(lane[l], lane[--active]);
+            }
+        }
+    }
+    return true;
 }
 
 
@@ -222,27 +534,43 @@ bool ArmSHA1::add(const void* data, size_t size)
     }
 
     const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
-    while (size > 0) {
-        if (_curlen == 0 && size >= BLOCK_SIZE) {
-            // Compress one 512-bit block directly from user's buffer.
-            compress(in);
-            _length += BLOCK_SIZE * 8;
-            in += BLOCK_SIZE;
-            size -= BLOCK_SIZE;
+
+    // Complete a partial block from a previous call.
+    if (_curlen > 0 && size > 0) {
+        const size_t n = std::min(size, (BLOCK_SIZE - _curlen));
+        ::memcpy(_buf + _curlen, in, n);
+        _curlen += n;
+        in += n;
+        size -= n;
+        if (_curlen < BLOCK_SIZE) {
+            return true;
         }
-        else {
-            // Partial block, Accumulate input data in internal buffer.
-            const size_t n = std::min(size, (BLOCK_SIZE - _curlen));
-            ::memcpy(_buf + _curlen, in, n);
-            _curlen += n;
-            in += n;
-            size -= n;
-            if (_curlen == BLOCK_SIZE) {
-                compress(_buf);
-                _length += 8 * BLOCK_SIZE;
-                _curlen = 0;
+        _compress(_state, _buf, 1);
+        _length += 8 * BLOCK_SIZE;
+        _curlen = 0;
+    }
+
+    // Compress all complete 512-bit blocks directly from user's buffer, in one call.
+    // The buffer does not need to be aligned, the data are never copied.
+    const size_t count = size / BLOCK_SIZE;
+    if (count > 0) {
+        if (_block_by_block) {
+            for (size_t i = 0; i < count; ++i) {
+                _compress(_state, in + BLOCK_SIZE * i, 1);
             }
         }
+        else {
+            _compress(_state, in, count);
+        }
+        _length += 8 * BLOCK_SIZE * count;
+        in += BLOCK_SIZE * count;
+        size -= BLOCK_SIZE * count;
+    }
+
+    // Keep the last partial block in internal buffer.
+    if (size > 0) {
+        ::memcpy(_buf, in, size);
+        _curlen = size;
     }
     return true;
 }
@@ -270,14 +598,14 @@ bool ArmSHA1::getHash(void* hash, size_t bufsize, size_t* retsize)
     // If the length is currently above 56 bytes (no room for message length), append zeroes then compress.
     if (_curlen > 56) {
         bzero(_buf + _curlen, 64 - _curlen);
-        compress(_buf);
+        _compress(_state, _buf, 1);
         _curlen = 0;
     }
 
     // Pad up to 56 bytes with zeroes and append 64-bit message length in bits.
     bzero(_buf + _curlen, 56 - _curlen);
     PutUInt64(_buf + 56, _length);
-    compress(_buf);
+    _compress(_state, _buf, 1);
 
     // Copy output
     uint8_t* out = reinterpret_cast<uint8_t*>(hash);
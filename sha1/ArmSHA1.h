@@ -9,7 +9,7 @@
 //----------------------------------------------------------------------------
 
 #pragma once
-#include "platform.h"
+#include "SHA1.h"
 
 class ArmSHA1
 {
@@ -22,12 +22,42 @@ public:
     bool add(const void* data, size_t size);
     bool getHash(void* hash, size_t bufsize, size_t* retsize = nullptr);
 
+    // Make add() compress the complete blocks with one call per block, as the previous
+    // implementation did. For comparison in sha1_perf only, the default is one call.
+    void setBlockByBlock(bool on) { _block_by_block = on; }
+
+    // Check if the SHA-1 instructions are present, detected once at run time.
+    // When they are not, the portable compression function of class SHA1 is used.
+    static bool accelerated();
+
+    // Multi-buffer hashing of count independent messages. Up to 'lanes' messages (1 to 4)
+    // are hashed together. With the SHA-1 instructions, the compressions of the lanes are
+    // interleaved in the same loop to hide the latency of the instructions. Without them,
+    // 4 messages are hashed in parallel in the 4 lanes of NEON vectors. Each lane takes
+    // the next message as soon as its own one is finished. The hash of message i is
+    // stored at hashes + i * HASH_SIZE.
+    static const size_t MAX_LANES = 4;
+    static bool hashMulti(const void* const* messages, const size_t* sizes, size_t count,
+                          void* hashes, size_t hashes_size, size_t lanes = MAX_LANES);
+
 private:
     uint64_t _length;                 // Total message size in bits (already hashed, ie. excluding _buf)
     uint32_t _state[HASH_SIZE / 4];   // Current hash value (160 bits)
     size_t   _curlen;                 // Used bytes in _buf
     uint8_t  _buf[BLOCK_SIZE];        // Current block to hash (512 bits)
 
-    // Compress one 512-bit block, accumulate hash in _state.
-    void compress(const uint8_t* buf);
+    // Compress count consecutive 512-bit blocks, accumulate hash in state.
+    // The function is selected once, using the SHA-1 instructions when present.
+    typedef void (*CompressFunction)(uint32_t* state, const uint8_t* buf, size_t count);
+    CompressFunction _compress;
+    bool _block_by_block;             // One call to _compress per block in add() (comparison only)
+    static void compressArm(uint32_t* state, const uint8_t* buf, size_t count) TARGET_SHA2;  // SHA-1 is in the same target feature
+    static void compressPortable(uint32_t* state, const uint8_t* buf, size_t count);
+
+    // Compress one block in each of N independent states, in the same loop.
+    template <size_t N>
+    static void compressLanes(uint32_t* const* states, const uint8_t* const* blocks) TARGET_SHA2;
+
+    // Compress one block in each of 4 independent states, using NEON only (no SHA-1 instruction).
+    static void compressNeon4(uint32_t* const* states, const uint8_t* const* blocks);
 };
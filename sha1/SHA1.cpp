@@ -45,14 +45,14 @@ bool SHA1::init()
 // Compress part of message
 //----------------------------------------------------------------------------
 
-void SHA1::compress(const uint8_t* buf)
+void SHA1::compress(uint32_t* state, const uint8_t* buf)
 {
     // Copy state
-    uint32_t a = _state[0];
-    uint32_t b = _state[1];
-    uint32_t c = _state[2];
-    uint32_t d = _state[3];
-    uint32_t e = _state[4];
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
 
     // Copy input block (512 bits, 64 bytes, 16 uint32) into W[0..15]
     uint32_t i, W[80];
@@ -124,11 +124,11 @@ void SHA1::compress(const uint8_t* buf)
     #undef F3
 
     // Store
-    _state[0] += a;
-    _state[1] += b;
-    _state[2] += c;
-    _state[3] += d;
-    _state[4] += e;
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
 }
 
 
@@ -147,7 +147,7 @@ bool SHA1::add(const void* data, size_t size)
     while (size > 0) {
         if (_curlen == 0 && size >= BLOCK_SIZE) {
             // Compress one 512-bit block directly from user's buffer.
-            compress(in);
+            compress(_state, in);
             _length += BLOCK_SIZE * 8;
             in += BLOCK_SIZE;
             size -= BLOCK_SIZE;
@@ -160,7 +160,7 @@ bool SHA1::add(const void* data, size_t size)
             in += n;
             size -= n;
             if (_curlen == BLOCK_SIZE) {
-                compress(_buf);
+                compress(_state, _buf);
                 _length += 8 * BLOCK_SIZE;
                 _curlen = 0;
             }
@@ -192,14 +192,14 @@ bool SHA1::getHash(void* hash, size_t bufsize, size_t* retsize)
     // If the length is currently above 56 bytes (no room for message length), append zeroes then compress.
     if (_curlen > 56) {
         bzero(_buf + _curlen, 64 - _curlen);
-        compress(_buf);
+        compress(_state, _buf);
         _curlen = 0;
     }
 
     // Pad up to 56 bytes with zeroes and append 64-bit message length in bits.
     bzero(_buf + _curlen, 56 - _curlen);
     PutUInt64(_buf + 56, _length);
-    compress(_buf);
+    compress(_state, _buf);
 
     // Copy output
     uint8_t* out = reinterpret_cast<uint8_t*>(hash);
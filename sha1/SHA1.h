@@ -22,12 +22,13 @@ public:
     bool add(const void* data, size_t size);
     bool getHash(void* hash, size_t bufsize, size_t* retsize = nullptr);
 
+    // Compress one block, accumulate hash in state. Also used by ArmSHA1 when
+    // the SHA-1 instructions are not present.
+    static void compress(uint32_t* state, const uint8_t* buf);
+
 private:
     uint64_t _length;                 // Total message size in bits (already hashed, ie. excluding _buf)
     uint32_t _state[HASH_SIZE / 4];   // Current hash value (160 bits)
     size_t   _curlen;                 // Used bytes in _buf
     uint8_t  _buf[BLOCK_SIZE];        // Current block to hash (512 bits)
-
-    // Compress one 512-bit block, accumulate hash in _state.
-    void compress(const uint8_t* buf);
 };
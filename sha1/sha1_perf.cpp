@@ -11,13 +11,16 @@
 
 #include "SHA1.h"
 #include "ArmSHA1.h"
+#include "HMACSHA1.h"
 #include <ios>
 #include <iomanip>
 #include <iostream>
 #include <cstdlib>
+#include <vector>
 #include <sys/resource.h>
 
 #define DEFAULT_ITERATIONS 10000000
+#define CHUNKS_SIZE        (1024 * 1024)
 
 static const uint8_t test_data[256] = {
     0x8F, 0xAA, 0xF6, 0x60, 0x79, 0x8C, 0x25, 0x3A, 0xF7, 0x51, 0x5D, 0x80, 0x8B, 0x3F, 0x7D, 0x71,
@@ -54,6 +57,174 @@ uint64_t get_user_ms()
 }
 
 
+//----------------------------------------------------------------------------
+// Number of messages per second, for a given time in milliseconds.
+//----------------------------------------------------------------------------
+
+uint64_t get_per_second(uint64_t count, uint64_t ms)
+{
+    return ms > 0 ? count * 1000 / ms : 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Hash many small messages, one by one or using the multi-buffer hashing.
+//----------------------------------------------------------------------------
+
+void perf_multi(uint64_t total_bytes)
+{
+    static const size_t batch = 1024;  // messages per call to hashMulti()
+
+    std::cout << std::endl << "Small messages, messages/second, ArmSHA1 one by one / hashMulti 2 lanes / 4 lanes" << std::endl;
+    for (size_t size : {64, 256, 1024}) {
+        // Independent messages in one buffer.
+        std::vector<uint8_t> data(batch * size);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = test_data[i % sizeof(test_data)] ^ uint8_t(i / size);
+        }
+        std::vector<const void*> msgs(batch);
+        std::vector<size_t> sizes(batch, size);
+        for (size_t i = 0; i < batch; ++i) {
+            msgs[i] = &data[i * size];
+        }
+        std::vector<uint8_t> hashes1(batch * ArmSHA1::HASH_SIZE);
+        std::vector<uint8_t> hashes2(hashes1.size());
+        std::vector<uint8_t> hashes4(hashes1.size());
+        const uint64_t loops = std::max<uint64_t>(1, total_bytes / data.size());
+        const uint64_t count = loops * batch;
+
+        ArmSHA1 sha;
+        uint64_t start = get_user_ms();
+        for (uint64_t n = 0; n < loops; ++n) {
+            for (size_t i = 0; i < batch; ++i) {
+                sha.init();
+                sha.add(msgs[i], size);
+                sha.getHash(&hashes1[i * ArmSHA1::HASH_SIZE], ArmSHA1::HASH_SIZE);
+            }
+        }
+        const uint64_t time1 = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (uint64_t n = 0; n < loops; ++n) {
+            ArmSHA1::hashMulti(msgs.data(), sizes.data(), batch, hashes2.data(), hashes2.size(), 2);
+        }
+        const uint64_t time2 = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (uint64_t n = 0; n < loops; ++n) {
+            ArmSHA1::hashMulti(msgs.data(), sizes.data(), batch, hashes4.data(), hashes4.size(), 4);
+        }
+        const uint64_t time4 = get_user_ms() - start;
+
+        std::cout << "  " << std::setw(4) << size << " bytes: " << get_per_second(count, time1)
+                  << " / " << get_per_second(count, time2) << " / " << get_per_second(count, time4)
+                  << (hashes1 == hashes2 && hashes1 == hashes4 ? "" : " (INVALID HASH)") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Compute MAC's of packets, recomputing the padded keys for each MAC or
+// using the precomputed inner and outer states.
+//----------------------------------------------------------------------------
+
+void perf_hmac(uint64_t total_bytes)
+{
+    static const uint8_t key[32] = {0x4B, 0x65, 0x79, 0x20, 0x66, 0x6F, 0x72, 0x20, 0x48, 0x4D, 0x41, 0x43};
+
+    std::cout << std::endl << "HMACSHA1, MACs/second, key set for each MAC / precomputed key" << std::endl;
+    for (size_t size : {64, 256, 1500}) {
+        std::vector<uint8_t> packet(size);
+        for (size_t i = 0; i < size; ++i) {
+            packet[i] = test_data[i % sizeof(test_data)];
+        }
+        uint8_t mac1[HMACSHA1::MAC_SIZE];
+        uint8_t mac2[HMACSHA1::MAC_SIZE];
+        const uint64_t count = std::max<uint64_t>(1, total_bytes / size);
+
+        uint64_t start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            packet[0] = uint8_t(n);
+            HMACSHA1::mac(key, sizeof(key), packet.data(), size, mac1, sizeof(mac1));
+        }
+        const uint64_t time1 = get_user_ms() - start;
+
+        HMACSHA1 hmac(key, sizeof(key));
+        start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            packet[0] = uint8_t(n);
+            hmac.mac(packet.data(), size, mac2, sizeof(mac2));
+        }
+        const uint64_t time2 = get_user_ms() - start;
+
+        std::cout << "  " << std::setw(4) << size << " bytes: " << get_per_second(count, time1)
+                  << " / " << get_per_second(count, time2)
+                  << (::memcmp(mac1, mac2, sizeof(mac1)) == 0 ? "" : " (INVALID MAC)") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Streaming throughput in MB/s when a message is added in chunks of
+// pseudo-random sizes. Most chunks start at an unaligned address.
+//----------------------------------------------------------------------------
+
+template <class HASH>
+uint64_t get_chunks_mbps(HASH& sha, const std::vector<uint8_t>& data, const std::vector<size_t>& chunks, uint64_t loops, uint8_t* hash)
+{
+    const uint64_t start = get_user_ms();
+    for (uint64_t n = 0; n < loops; ++n) {
+        sha.init();
+        const uint8_t* in = data.data();
+        for (size_t size : chunks) {
+            sha.add(in, size);
+            in += size;
+        }
+        sha.getHash(hash, HASH::HASH_SIZE);
+    }
+    const uint64_t ms = get_user_ms() - start;
+    return ms > 0 ? loops * data.size() / (ms * 1000) : 0;
+}
+
+void perf_chunks(uint64_t total_bytes)
+{
+    std::vector<uint8_t> data(CHUNKS_SIZE);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = test_data[i % sizeof(test_data)] ^ uint8_t(i >> 8);
+    }
+    const std::vector<size_t> whole(1, data.size());
+    const uint64_t loops = std::max<uint64_t>(1, total_bytes / data.size());
+
+    std::cout << std::endl << "Random chunk sizes, " << data.size() << "-byte messages, MB/s, SHA1 / ArmSHA1 one call per block (previous) / ArmSHA1 (ArmSHA1 with one add)" << std::endl;
+    for (size_t max_chunk : {64, 4096, 65536}) {
+        // Chunks of 1 to max_chunk bytes, the same sequence in each run.
+        std::vector<size_t> chunks;
+        uint32_t seed = 12345;
+        for (size_t total = 0; total < data.size(); total += chunks.back()) {
+            seed = seed * 1103515245 + 12345;
+            chunks.push_back(std::min<size_t>(1 + (seed >> 8) % max_chunk, data.size() - total));
+        }
+
+        SHA1 s1;
+        ArmSHA1 s2;
+        s2.setBlockByBlock(true);
+        ArmSHA1 s3;
+        uint8_t hash1[SHA1::HASH_SIZE];
+        uint8_t hash2[SHA1::HASH_SIZE];
+        uint8_t hash3[SHA1::HASH_SIZE];
+        uint8_t hash4[SHA1::HASH_SIZE];
+        const uint64_t mbps1 = get_chunks_mbps(s1, data, chunks, loops, hash1);
+        const uint64_t mbps2 = get_chunks_mbps(s2, data, chunks, loops, hash2);
+        const uint64_t mbps3 = get_chunks_mbps(s3, data, chunks, loops, hash3);
+        const uint64_t mbps4 = get_chunks_mbps(s3, data, whole, loops, hash4);
+
+        std::cout << "  1 to " << std::setw(5) << max_chunk << " bytes: " << mbps1 << " / " << mbps2 << " / " << mbps3 << " (" << mbps4 << ")"
+                  << (::memcmp(hash1, hash4, sizeof(hash1)) == 0 && ::memcmp(hash2, hash4, sizeof(hash2)) == 0 &&
+                      ::memcmp(hash3, hash4, sizeof(hash3)) == 0 ? "" : " (INVALID HASH)") << std::endl;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Program entry point.
 //----------------------------------------------------------------------------
@@ -63,6 +234,7 @@ int main(int argc, char* argv[])
     const int iterations = argc > 1 ? std::atoi(argv[1]) : DEFAULT_ITERATIONS;
 
     std::cout << "SHA-1 performance test, " << iterations << " iterations, " << sizeof(test_data) << " bytes" << std::endl;
+    std::cout << "ArmSHA1 implementation: " << (ArmSHA1::accelerated() ? "Arm64 SHA1 instructions" : "portable") << std::endl;
 
     SHA1 sha;
     ArmSHA1 arm_sha;
@@ -96,5 +268,9 @@ int main(int argc, char* argv[])
         std::cout << "Performance ratio: " << (double(time1) / double(time2)) << std::endl;
     }
 
+    perf_multi(uint64_t(iterations) * sizeof(test_data));
+    perf_chunks(uint64_t(iterations) * sizeof(test_data));
+    perf_hmac(uint64_t(iterations) * sizeof(test_data));
+
     return EXIT_SUCCESS;
 }
@@ -11,9 +11,12 @@
 
 #include "SHA1.h"
 #include "ArmSHA1.h"
+#include "HMACSHA1.h"
 #include <ios>
 #include <iomanip>
 #include <iostream>
+#include <vector>
+#include <string>
 
 struct TestData {
     size_t size;
@@ -57,6 +60,143 @@ static const TestData test_data[] = {
 };
 
 
+//----------------------------------------------------------------------------
+// Test the streaming hashing of a message added in chunks of pseudo-random
+// sizes, at any alignment, compared with the portable implementation.
+//----------------------------------------------------------------------------
+
+void test_chunks()
+{
+    std::vector<uint8_t> msg(20000);
+    for (size_t i = 0; i < msg.size(); ++i) {
+        msg[i] = uint8_t(i * 13 + (i >> 8));
+    }
+    uint8_t expected[SHA1::HASH_SIZE];
+    SHA1 sha;
+    sha.add(msg.data(), msg.size());
+    sha.getHash(expected, sizeof(expected));
+
+    for (size_t max_chunk : {1, 7, 63, 64, 65, 192, 4000}) {
+        // Chunks of 0 to max_chunk bytes, around the block size and larger.
+        uint32_t seed = 12345;
+        uint8_t hash[SHA1::HASH_SIZE];
+        ArmSHA1 arm_sha;
+        ArmSHA1 block_sha;  // previous add(), one compression call per block
+        block_sha.setBlockByBlock(true);
+        for (size_t total = 0; total < msg.size(); ) {
+            seed = seed * 1103515245 + 12345;
+            const size_t size = std::min<size_t>((seed >> 8) % (max_chunk + 1), msg.size() - total);
+            arm_sha.add(msg.data() + total, size);
+            block_sha.add(msg.data() + total, size);
+            total += size;
+        }
+        arm_sha.getHash(hash, sizeof(hash));
+        uint8_t block_hash[sizeof(hash)];
+        block_sha.getHash(block_hash, sizeof(block_hash));
+        const bool ok = ::memcmp(hash, expected, sizeof(hash)) == 0 && ::memcmp(block_hash, expected, sizeof(block_hash)) == 0;
+        std::cout << msg.size() << " bytes, ArmSHA1, chunks of 0 to " << max_chunk << " bytes: " << (ok ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test the multi-buffer hashing: messages of all sizes around the padding
+// limits, compared with the portable implementation, with 1 to 4 lanes.
+// Without the SHA-1 instructions, this tests the NEON 4-lane compression.
+//----------------------------------------------------------------------------
+
+void test_multi()
+{
+    std::vector<std::vector<uint8_t>> msgs;
+    for (size_t size = 0; size < 300; ++size) {
+        msgs.emplace_back(size);
+    }
+    for (size_t size : {1000, 4096, 10000}) {
+        msgs.emplace_back(size);
+    }
+    std::vector<const void*> ptrs;
+    std::vector<size_t> sizes;
+    std::vector<uint8_t> expected;
+    for (auto& msg : msgs) {
+        for (size_t i = 0; i < msg.size(); ++i) {
+            msg[i] = uint8_t(i * 11 + msg.size());
+        }
+        ptrs.push_back(msg.data());
+        sizes.push_back(msg.size());
+        uint8_t hash[SHA1::HASH_SIZE];
+        SHA1 sha;
+        sha.add(msg.data(), msg.size());
+        sha.getHash(hash, sizeof(hash));
+        expected.insert(expected.end(), hash, hash + sizeof(hash));
+    }
+
+    for (size_t lanes = 1; lanes <= ArmSHA1::MAX_LANES; ++lanes) {
+        std::vector<uint8_t> hashes(msgs.size() * SHA1::HASH_SIZE);
+        const bool ok = ArmSHA1::hashMulti(ptrs.data(), sizes.data(), msgs.size(), hashes.data(), hashes.size(), lanes) &&
+                        hashes == expected;
+        std::cout << msgs.size() << " messages, ArmSHA1::hashMulti, " << lanes << " lanes: " << (ok ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test HMAC-SHA-1 with the test cases 1, 2 and 6 of RFC 2202 (a key larger
+// than the block size in the last one), using the incremental and the one-shot
+// computations.
+//----------------------------------------------------------------------------
+
+void test_hmac()
+{
+    struct HMACTestData {
+        std::string key;
+        std::string message;
+        uint8_t mac[HMACSHA1::MAC_SIZE];
+    };
+    static const HMACTestData hmac_data[] = {
+        {
+            std::string(20, char(0x0B)),
+            "Hi There",
+            {0xB6, 0x17, 0x31, 0x86, 0x55, 0x05, 0x72, 0x64, 0xE2, 0x8B, 0xC0, 0xB6, 0xFB, 0x37, 0x8C, 0x8E,
+             0xF1, 0x46, 0xBE, 0x00}
+        },
+        {
+            "Jefe",
+            "what do ya want for nothing?",
+            {0xEF, 0xFC, 0xDF, 0x6A, 0xE5, 0xEB, 0x2F, 0xA2, 0xD2, 0x74, 0x16, 0xD5, 0xF1, 0x84, 0xDF, 0x9C,
+             0x25, 0x9A, 0x7C, 0x79}
+        },
+        {
+            std::string(80, char(0xAA)),
+            "Test Using Larger Than Block-Size Key - Hash Key First",
+            {0xAA, 0x4A, 0xE5, 0xE1, 0x52, 0x72, 0xD0, 0x0E, 0x95, 0x70, 0x56, 0x37, 0xCE, 0x8A, 0x3B, 0x55,
+             0xED, 0x40, 0x21, 0x12}
+        }
+    };
+
+    for (const auto& test : hmac_data) {
+        uint8_t mac1[HMACSHA1::MAC_SIZE];
+        uint8_t mac2[HMACSHA1::MAC_SIZE];
+        uint8_t mac3[HMACSHA1::MAC_SIZE];
+        HMACSHA1 hmac(test.key.data(), test.key.size());
+        // Incremental, in two parts.
+        const size_t half = test.message.size() / 2;
+        const bool ok1 = hmac.add(test.message.data(), half) &&
+                         hmac.add(test.message.data() + half, test.message.size() - half) &&
+                         !hmac.getMAC(mac1, sizeof(mac1) - 1) &&   // rejected, state unchanged
+                         !hmac.getMAC(nullptr, sizeof(mac1)) &&
+                         hmac.getMAC(mac1, sizeof(mac1)) &&
+                         ::memcmp(mac1, test.mac, sizeof(mac1)) == 0;
+        // One-shot with the precomputed key, twice, then with the key.
+        const bool ok2 = hmac.mac(test.message.data(), test.message.size(), mac2, sizeof(mac2)) &&
+                         hmac.mac(test.message.data(), test.message.size(), mac2, sizeof(mac2)) &&
+                         ::memcmp(mac2, test.mac, sizeof(mac2)) == 0;
+        const bool ok3 = HMACSHA1::mac(test.key.data(), test.key.size(), test.message.data(), test.message.size(), mac3, sizeof(mac3)) &&
+                         ::memcmp(mac3, test.mac, sizeof(mac3)) == 0;
+        std::cout << std::setw(3) << test.key.size() << "-byte key, HMACSHA1: " << (ok1 && ok2 && ok3 ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Program entry point.
 //----------------------------------------------------------------------------
@@ -67,6 +207,8 @@ int main(int argc, char* argv[])
     ArmSHA1 arm_sha;
     uint8_t hash[SHA1::HASH_SIZE];
 
+    std::cout << "ArmSHA1 implementation: " << (ArmSHA1::accelerated() ? "Arm64 SHA1 instructions" : "portable") << std::endl;
+
     for (auto test = test_data; test->size > 0; ++test) {
 
         bzero(hash, sizeof(hash));
@@ -87,5 +229,8 @@ int main(int argc, char* argv[])
                   << std::endl;
     }
 
+    test_chunks();
+    test_multi();
+    test_hmac();
     return EXIT_SUCCESS;
 }
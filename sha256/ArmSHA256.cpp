@@ -11,6 +11,10 @@
 
 #include "ArmSHA256.h"
 #include <arm_neon.h>
+#include <utility>
+
+// Constants may be used by reference.
+const size_t ArmSHA256Core::MAX_LANES;
 
 
 //----------------------------------------------------------------------------
@@ -36,183 +40,405 @@ namespace {
         0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
         0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
     };
+
+    // One message in progress in the multi-buffer hashing. The complete blocks are
+    // compressed from the message, the padded final blocks from the lane buffer.
+    struct Lane
+    {
+        size_t         index;     // Index of the message.
+        const uint8_t* data;      // Next block to compress.
+        size_t         blocks;    // Remaining complete blocks in the message.
+        size_t         padded;    // Remaining padded blocks in 'last' (1 or 2).
+        uint32_t       state[8];
+        uint8_t        last[2 * ArmSHA256Core::BLOCK_SIZE];
+
+        // Start a new message.
+        void start(size_t msg_index, const void* msg, size_t size)
+        {
+            const size_t rest = size % ArmSHA256Core::BLOCK_SIZE;
+            index = msg_index;
+            data = reinterpret_cast<const uint8_t*>(msg);
+            blocks = size / ArmSHA256Core::BLOCK_SIZE;
+            padded = rest + 9 <= ArmSHA256Core::BLOCK_SIZE ? 1 : 2;
+            ::memcpy(state, SHA256Policy::IV, sizeof(state));
+
+            // Trailing bytes, '1' bit, zeroes, 64-bit message length in bits.
+            const size_t last_size = padded * ArmSHA256Core::BLOCK_SIZE;
+            if (rest > 0) {
+                ::memcpy(last, data + blocks * ArmSHA256Core::BLOCK_SIZE, rest);
+            }
+            last[rest] = 0x80;
+            bzero(last + rest + 1, last_size - rest - 9);
+            PutUInt64(last + last_size - 8, uint64_t(size) * 8);
+            if (blocks == 0) {
+                data = last;
+            }
+        }
+
+        bool done() const { return blocks == 0 && padded == 0; }
+
+        // Get the next block to compress. After the complete blocks, continue in 'last'.
+        const uint8_t* next()
+        {
+            const uint8_t* block = data;
+            data += ArmSHA256Core::BLOCK_SIZE;
+            if (blocks > 0) {
+                if (--blocks == 0) {
+                    data = last;
+                }
+            }
+            else {
+                padded--;
+            }
+            return block;
+        }
+    };
 }
 
 
+//----------------------------------------------------------------------------
+// Initial values of the variants.
+//----------------------------------------------------------------------------
+
+const uint32_t SHA256Policy::IV[8] = {
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+    0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+};
+
+const uint32_t SHA224Policy::IV[8] = {
+    0xC1059ED8, 0x367CD507, 0x3070DD17, 0xF70E5939,
+    0xFFC00B31, 0x68581511, 0x64F98FA7, 0xBEFA4FA4,
+};
+
+
 //----------------------------------------------------------------------------
 // Constructor
 //----------------------------------------------------------------------------
 
-ArmSHA256::ArmSHA256() :
+template <class POLICY>
+ArmSHA256Family<POLICY>::ArmSHA256Family() :
     _length(0),
-    _curlen(0)
+    _curlen(0),
+    _compress(accelerated() ? compressArm : compressPortable),
+    _block_by_block(false)
 {
     init();
 }
 
 
+//----------------------------------------------------------------------------
+// Check if the SHA-256 instructions are present.
+//----------------------------------------------------------------------------
+
+bool ArmSHA256Core::accelerated()
+{
+    static const bool accel = HasCPUFeatures(CPU_SHA2);
+    return accel;
+}
+
+
 //----------------------------------------------------------------------------
 // Reinitialize the computation of the hash.
 //----------------------------------------------------------------------------
 
-bool ArmSHA256::init()
+template <class POLICY>
+bool ArmSHA256Family<POLICY>::init()
 {
     _curlen = 0;
     _length = 0;
-    _state[0] = 0x6A09E667UL;
-    _state[1] = 0xBB67AE85UL;
-    _state[2] = 0x3C6EF372UL;
-    _state[3] = 0xA54FF53AUL;
-    _state[4] = 0x510E527FUL;
-    _state[5] = 0x9B05688CUL;
-    _state[6] = 0x1F83D9ABUL;
-    _state[7] = 0x5BE0CD19UL;
+    ::memcpy(_state, POLICY::IV, sizeof(_state));
     return true;
 }
 
 
+//----------------------------------------------------------------------------
+// Compress consecutive blocks without the SHA-256 instructions.
+//----------------------------------------------------------------------------
+
+void ArmSHA256Core::compressPortable(uint32_t* state, const uint8_t* buf, size_t count)
+{
+    for (; count > 0; --count, buf += BLOCK_SIZE) {
+        SHA256::compress(state, buf);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Compress part of message
 //----------------------------------------------------------------------------
 
-void ArmSHA256::compress(const uint8_t* buf)
+TARGET_SHA2 void ArmSHA256Core::compressArm(uint32_t* state, const uint8_t* buf, size_t count)
 {
     // Load initial values.
-    uint32x4_t state0 = vld1q_u32(&_state[0]);
-    uint32x4_t state1 = vld1q_u32(&_state[4]);
-
-    // Save current state.
-    const uint32x4_t previous_state0 = state0;
-    const uint32x4_t previous_state1 = state1;
-
-    // Load input block.
-    const uint32_t* buf32 = reinterpret_cast<const uint32_t*>(buf);
-    uint32x4_t msg0 = vld1q_u32(buf32 + 0);
-    uint32x4_t msg1 = vld1q_u32(buf32 + 4);
-    uint32x4_t msg2 = vld1q_u32(buf32 + 8);
-    uint32x4_t msg3 = vld1q_u32(buf32 + 12);
-
-    // Swap bytes on little endian Arm64.
-    msg0 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(msg0)));
-    msg1 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(msg1)));
-    msg2 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(msg2)));
-    msg3 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(msg3)));
-
-    // Rounds 0-3
-    uint32x4_t msg_k = vaddq_u32(msg0, vld1q_u32(&K[4*0]));
-    uint32x4_t tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-    msg0 = vsha256su1q_u32(vsha256su0q_u32(msg0, msg1), msg2, msg3);
-
-    // Rounds 4-7
-    msg_k = vaddq_u32(msg1, vld1q_u32(&K[4*1]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-    msg1 = vsha256su1q_u32(vsha256su0q_u32(msg1, msg2), msg3, msg0);
-
-    // Rounds 8-11
-    msg_k = vaddq_u32(msg2, vld1q_u32(&K[4*2]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-    msg2 = vsha256su1q_u32(vsha256su0q_u32(msg2, msg3), msg0, msg1);
-
-    // Rounds 12-15
-    msg_k = vaddq_u32(msg3, vld1q_u32(&K[4*3]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-    msg3 = vsha256su1q_u32(vsha256su0q_u32(msg3, msg0), msg1, msg2);
-
-    // Rounds 16-19
-    msg_k = vaddq_u32(msg0, vld1q_u32(&K[4*4]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-    msg0 = vsha256su1q_u32(vsha256su0q_u32(msg0, msg1), msg2, msg3);
-
-    // Rounds 20-23
-    msg_k = vaddq_u32(msg1, vld1q_u32(&K[4*5]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-    msg1 = vsha256su1q_u32(vsha256su0q_u32(msg1, msg2), msg3, msg0);
-
-    // Rounds 24-27
-    msg_k = vaddq_u32(msg2, vld1q_u32(&K[4*6]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-    msg2 = vsha256su1q_u32(vsha256su0q_u32(msg2, msg3), msg0, msg1);
-
-    // Rounds 28-31
-    msg_k = vaddq_u32(msg3, vld1q_u32(&K[4*7]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-    msg3 = vsha256su1q_u32(vsha256su0q_u32(msg3, msg0), msg1, msg2);
-
-    // Rounds 32-35
-    msg_k = vaddq_u32(msg0, vld1q_u32(&K[4*8]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-    msg0 = vsha256su1q_u32(vsha256su0q_u32(msg0, msg1), msg2, msg3);
-
-    // Rounds 36-39
-    msg_k = vaddq_u32(msg1, vld1q_u32(&K[4*9]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-    msg1 = vsha256su1q_u32(vsha256su0q_u32(msg1, msg2), msg3, msg0);
-
-    // Rounds 40-43
-    msg_k = vaddq_u32(msg2, vld1q_u32(&K[4*10]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-    msg2 = vsha256su1q_u32(vsha256su0q_u32(msg2, msg3), msg0, msg1);
-
-    // Rounds 44-47
-    msg_k = vaddq_u32(msg3, vld1q_u32(&K[4*11]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-    msg3 = vsha256su1q_u32(vsha256su0q_u32(msg3, msg0), msg1, msg2);
-
-    // Rounds 48-51
-    msg_k = vaddq_u32(msg0, vld1q_u32(&K[4*12]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-
-    // Rounds 52-55
-    msg_k = vaddq_u32(msg1, vld1q_u32(&K[4*13]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-
-    // Rounds 56-59
-    msg_k = vaddq_u32(msg2, vld1q_u32(&K[4*14]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-
-    // Rounds 60-63
-    msg_k = vaddq_u32(msg3, vld1q_u32(&K[4*15]));
-    tmp_state = vsha256hq_u32(state0, state1, msg_k);
-    state1 = vsha256h2q_u32(state1, state0, msg_k);
-    state0 = tmp_state;
-
-    // Add back to state
-    state0 = vaddq_u32(state0, previous_state0);
-    state1 = vaddq_u32(state1, previous_state1);
+    uint32x4_t state0 = vld1q_u32(&state[0]);
+    uint32x4_t state1 = vld1q_u32(&state[4]);
+
+    // Compress all blocks, the state remains in registers between blocks.
+    for (; count > 0; --count, buf += BLOCK_SIZE) {
+        // Save current state.
+        const uint32x4_t previous_state0 = state0;
+        const uint32x4_t previous_state1 = state1;
+
+        // Load input block.
+        const uint32_t* buf32 = reinterpret_cast<const uint32_t*>(buf);
+        uint32x4_t msg0 = vld1q_u32(buf32 + 0);
+        uint32x4_t msg1 = vld1q_u32(buf32 + 4);
+        uint32x4_t msg2 = vld1q_u32(buf32 + 8);
+        uint32x4_t msg3 = vld1q_u32(buf32 + 12);
+
+        // Swap bytes on little endian Arm64.
+        msg0 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(msg0)));
+        msg1 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(msg1)));
+        msg2 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(msg2)));
+        msg3 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(msg3)));
+
+        // Rounds 0-3
+        uint32x4_t msg_k = vaddq_u32(msg0, vld1q_u32(&K[4*0]));
+        uint32x4_t tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+        msg0 = vsha256su1q_u32(vsha256su0q_u32(msg0, msg1), msg2, msg3);
+
+        // Rounds 4-7
+        msg_k = vaddq_u32(msg1, vld1q_u32(&K[4*1]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+        msg1 = vsha256su1q_u32(vsha256su0q_u32(msg1, msg2), msg3, msg0);
+
+        // Rounds 8-11
+        msg_k = vaddq_u32(msg2, vld1q_u32(&K[4*2]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+        msg2 = vsha256su1q_u32(vsha256su0q_u32(msg2, msg3), msg0, msg1);
+
+        // Rounds 12-15
+        msg_k = vaddq_u32(msg3, vld1q_u32(&K[4*3]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+        msg3 = vsha256su1q_u32(vsha256su0q_u32(msg3, msg0), msg1, msg2);
+
+        // Rounds 16-19
+        msg_k = vaddq_u32(msg0, vld1q_u32(&K[4*4]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+        msg0 = vsha256su1q_u32(vsha256su0q_u32(msg0, msg1), msg2, msg3);
+
+        // Rounds 20-23
+        msg_k = vaddq_u32(msg1, vld1q_u32(&K[4*5]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+        msg1 = vsha256su1q_u32(vsha256su0q_u32(msg1, msg2), msg3, msg0);
+
+        // Rounds 24-27
+        msg_k = vaddq_u32(msg2, vld1q_u32(&K[4*6]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+        msg2 = vsha256su1q_u32(vsha256su0q_u32(msg2, msg3), msg0, msg1);
+
+        // Rounds 28-31
+        msg_k = vaddq_u32(msg3, vld1q_u32(&K[4*7]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+        msg3 = vsha256su1q_u32(vsha256su0q_u32(msg3, msg0), msg1, msg2);
+
+        // Rounds 32-35
+        msg_k = vaddq_u32(msg0, vld1q_u32(&K[4*8]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+        msg0 = vsha256su1q_u32(vsha256su0q_u32(msg0, msg1), msg2, msg3);
+
+        // Rounds 36-39
+        msg_k = vaddq_u32(msg1, vld1q_u32(&K[4*9]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+        msg1 = vsha256su1q_u32(vsha256su0q_u32(msg1, msg2), msg3, msg0);
+
+        // Rounds 40-43
+        msg_k = vaddq_u32(msg2, vld1q_u32(&K[4*10]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+        msg2 = vsha256su1q_u32(vsha256su0q_u32(msg2, msg3), msg0, msg1);
+
+        // Rounds 44-47
+        msg_k = vaddq_u32(msg3, vld1q_u32(&K[4*11]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+        msg3 = vsha256su1q_u32(vsha256su0q_u32(msg3, msg0), msg1, msg2);
+
+        // Rounds 48-51
+        msg_k = vaddq_u32(msg0, vld1q_u32(&K[4*12]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+
+        // Rounds 52-55
+        msg_k = vaddq_u32(msg1, vld1q_u32(&K[4*13]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+
+        // Rounds 56-59
+        msg_k = vaddq_u32(msg2, vld1q_u32(&K[4*14]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+
+        // Rounds 60-63
+        msg_k = vaddq_u32(msg3, vld1q_u32(&K[4*15]));
+        tmp_state = vsha256hq_u32(state0, state1, msg_k);
+        state1 = vsha256h2q_u32(state1, state0, msg_k);
+        state0 = tmp_state;
+
+        // Add back to state
+        state0 = vaddq_u32(state0, previous_state0);
+        state1 = vaddq_u32(state1, previous_state1);
+    }
 
     // Save state
-    vst1q_u32(&_state[0], state0);
-    vst1q_u32(&_state[4], state1);
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+}
+
+
+//----------------------------------------------------------------------------
+// Compress one block in each of N independent states. This is the same
+// sequence as compressArm(), each group of 4 rounds is done on all states
+// before the next group. The N chains are independent and fill the latency
+// of the SHA-256 instructions. The loops on lanes are fully unrolled.
+//----------------------------------------------------------------------------
+
+template <size_t N>
+TARGET_SHA2 void ArmSHA256Core::compressLanes(uint32_t* const* states, const uint8_t* const* blocks)
+{
+    uint32x4_t state0[N], state1[N], msg[4][N];
+
+    #pragma GCC unroll 4
+    for (size_t l = 0; l < N; ++l) {
+        state0[l] = vld1q_u32(&states[l][0]);
+        state1[l] = vld1q_u32(&states[l][4]);
+        const uint32_t* buf32 = reinterpret_cast<const uint32_t*>(blocks[l]);
+        #pragma GCC unroll 4
+        for (size_t i = 0; i < 4; ++i) {
+            msg[i][l] = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(vld1q_u32(buf32 + 4 * i))));
+        }
+    }
+
+    // 16 groups of 4 rounds. The message schedule is updated in the first 12 groups.
+    #pragma GCC unroll 16
+    for (size_t g = 0; g < 16; ++g) {
+        const uint32x4_t k = vld1q_u32(&K[4*g]);
+        #pragma GCC unroll 4
+        for (size_t l = 0; l < N; ++l) {
+            const uint32x4_t msg_k = vaddq_u32(msg[g%4][l], k);
+            const uint32x4_t tmp_state = vsha256hq_u32(state0[l], state1[l], msg_k);
+            state1[l] = vsha256h2q_u32(state1[l], state0[l], msg_k);
+            state0[l] = tmp_state;
+            if (g < 12) {
+                msg[g%4][l] = vsha256su1q_u32(vsha256su0q_u32(msg[g%4][l], msg[(g+1)%4][l]), msg[(g+2)%4][l], msg[(g+3)%4][l]);
+            }
+        }
+    }
+
+    // Add back to state.
+    #pragma GCC unroll 4
+    for (size_t l = 0; l < N; ++l) {
+        vst1q_u32(&states[l][0], vaddq_u32(state0[l], vld1q_u32(&states[l][0])));
+        vst1q_u32(&states[l][4], vaddq_u32(state1[l], vld1q_u32(&states[l][4])));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Compress one block in each of count independent states.
+//----------------------------------------------------------------------------
+
+void ArmSHA256Core::compressMulti(uint32_t* const* states, const uint8_t* const* blocks, size_t count)
+{
+    size_t l = 0;
+    if (accelerated()) {
+        for (; l + 4 <= count; l += 4) {
+            compressLanes<4>(states + l, blocks + l);
+        }
+        for (; l + 2 <= count; l += 2) {
+            compressLanes<2>(states + l, blocks + l);
+        }
+        for (; l < count; ++l) {
+            compressArm(states[l], blocks[l], 1);
+        }
+    }
+    else {
+        for (; l < count; ++l) {
+            SHA256::compress(states[l], blocks[l]);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Multi-buffer hashing of independent messages.
+//----------------------------------------------------------------------------
+
+bool ArmSHA256Core::hashMulti(const void* const* messages, const size_t* sizes, size_t count, void* hashes, size_t hashes_size, size_t lanes)
+{
+    if (hashes_size < count * SHA256Policy::HASH_SIZE || lanes == 0) {
+        return false;
+    }
+    lanes = accelerated() ? std::min(lanes, MAX_LANES) : 1;
+    uint8_t* out = reinterpret_cast<uint8_t*>(hashes);
+
+    // Active lanes, the first 'active' pointers in 'lane'.
+    Lane lane_data[MAX_LANES];
+    Lane* lane[MAX_LANES];
+    size_t active = 0;
+    size_t next_msg = 0;
+    while (active < lanes && next_msg < count) {
+        lane[active] = &lane_data[active];
+        lane[active]->start(next_msg, messages[next_msg], sizes[next_msg]);
+        active++;
+        next_msg++;
+    }
+
+    while (active > 0) {
+        // Compress one block in each active lane, by groups of 4, 2, 1.
+        uint32_t* states[MAX_LANES];
+        const uint8_t* blocks[MAX_LANES];
+        for (size_t l = 0; l < active; ++l) {
+            states[l] = lane[l]->state;
+            blocks[l] = lane[l]->next();
+        }
+        compressMulti(states, blocks, active);
+
+        // Output the finished messages. Their lanes start the next messages, if any.
+        for (size_t l = 0; l < active; ) {
+            if (!lane[l]->done()) {
+                l++;
+                continue;
+            }
+            for (size_t i = 0; i < 8; i++) {
+                PutUInt32(out + lane[l]->index * SHA256Policy::HASH_SIZE + 4*i, lane[l]->state[i]);
+            }
+            if (next_msg < count) {
+                lane[l]->start(next_msg, messages[next_msg], sizes[next_msg]);
+                next_msg++;
+                l++;
+            }
+            else {
+                std::swap(lane[l], lane[--active]);
+            }
+        }
+    }
+    return true;
 }
 
 
@@ -220,7 +446,8 @@ void ArmSHA256::compress(const uint8_t* buf)
 // Add some part of the message to hash. Can be called several times.
 //----------------------------------------------------------------------------
 
-bool ArmSHA256::add(const void* data, size_t size)
+template <class POLICY>
+bool ArmSHA256Family<POLICY>::add(const void* data, size_t size)
 {
     // Filter invalid internal state.
     if (_curlen >= sizeof(_buf)) {
@@ -228,27 +455,43 @@ bool ArmSHA256::add(const void* data, size_t size)
     }
 
     const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
-    while (size > 0) {
-        if (_curlen == 0 && size >= BLOCK_SIZE) {
-            // Compress one 512-bit block directly from user's buffer.
-            compress(in);
-            _length += BLOCK_SIZE * 8;
-            in += BLOCK_SIZE;
-            size -= BLOCK_SIZE;
+
+    // Complete a partial block from a previous call.
+    if (_curlen > 0 && size > 0) {
+        const size_t n = std::min(size, (BLOCK_SIZE - _curlen));
+        ::memcpy(_buf + _curlen, in, n);
+        _curlen += n;
+        in += n;
+        size -= n;
+        if (_curlen < BLOCK_SIZE) {
+            return true;
         }
-        else {
-            // Partial block, Accumulate input data in internal buffer.
-            size_t n = std::min(size, (BLOCK_SIZE - _curlen));
-            ::memcpy(_buf + _curlen, in, n);
-            _curlen += n;
-            in += n;
-            size -= n;
-            if (_curlen == BLOCK_SIZE) {
-                compress(_buf);
-                _length += 8 * BLOCK_SIZE;
-                _curlen = 0;
+        _compress(_state, _buf, 1);
+        _length += 8 * BLOCK_SIZE;
+        _curlen = 0;
+    }
+
+    // Compress all complete 512-bit blocks directly from user's buffer, in one call.
+    // The buffer does not need to be aligned, the data are never copied.
+    const size_t count = size / BLOCK_SIZE;
+    if (count > 0) {
+        if (_block_by_block) {
+            for (size_t i = 0; i < count; ++i) {
+                _compress(_state, in + BLOCK_SIZE * i, 1);
             }
         }
+        else {
+            _compress(_state, in, count);
+        }
+        _length += 8 * BLOCK_SIZE * count;
+        in += BLOCK_SIZE * count;
+        size -= BLOCK_SIZE * count;
+    }
+
+    // Keep the last partial block in internal buffer.
+    if (size > 0) {
+        ::memcpy(_buf, in, size);
+        _curlen = size;
     }
     return true;
 }
@@ -258,7 +501,8 @@ bool ArmSHA256::add(const void* data, size_t size)
 // Get the resulting hash value.
 //----------------------------------------------------------------------------
 
-bool ArmSHA256::getHash(void* hash, size_t bufsize, size_t* retsize)
+template <class POLICY>
+bool ArmSHA256Family<POLICY>::getHash(void* hash, size_t bufsize, size_t* retsize)
 {
     // Filter invalid internal state or invalid input.
     if (_curlen >= sizeof(_buf) || bufsize < HASH_SIZE) {
@@ -275,18 +519,18 @@ bool ArmSHA256::getHash(void* hash, size_t bufsize, size_t* retsize)
     // If the length is currently above 56 bytes (no room for message length), append zeroes then compress.
     if (_curlen > 56) {
         bzero(_buf + _curlen, 64 - _curlen);
-        compress(_buf);
+        _compress(_state, _buf, 1);
         _curlen = 0;
     }
 
     // Pad up to 56 bytes with zeroes and append 64-bit message length in bits.
     bzero(_buf + _curlen, 56 - _curlen);
     PutUInt64(_buf + 56, _length);
-    compress(_buf);
+    _compress(_state, _buf, 1);
 
-    // Copy output
+    // Copy output, truncated to the hash size of the variant.
     uint8_t* out = reinterpret_cast<uint8_t*> (hash);
-    for (size_t i = 0; i < 8; i++) {
+    for (size_t i = 0; i < HASH_SIZE / 4; i++) {
         PutUInt32(out + 4*i, _state[i]);
     }
 
@@ -295,3 +539,6 @@ bool ArmSHA256::getHash(void* hash, size_t bufsize, size_t* retsize)
     }
     return true;
 }
+
+template class ArmSHA256Family<SHA256Policy>;
+template class ArmSHA256Family<SHA224Policy>;
@@ -9,25 +9,88 @@
 //----------------------------------------------------------------------------
 
 #pragma once
-#include "platform.h"
+#include "SHA256.h"
 
-class ArmSHA256
+// Parameters of the SHA-2 variants with 32-bit words. They use the same compression
+// function, only the initial value and the size of the truncated output are different.
+struct SHA256Policy
+{
+    static const size_t HASH_SIZE = 32;  //!< SHA-256 hash size in bytes.
+    static const uint32_t IV[8];         //!< Initial hash value.
+};
+
+struct SHA224Policy
+{
+    static const size_t HASH_SIZE = 28;  //!< SHA-224 hash size in bytes.
+    static const uint32_t IV[8];         //!< Initial hash value.
+};
+
+// Compression functions, common to all variants.
+class ArmSHA256Core
 {
 public:
-    static const size_t HASH_SIZE  = 32;  //!< SHA-256 hash size in bytes.
     static const size_t BLOCK_SIZE = 64;  //!< SHA-256 block size in bytes.
 
-    ArmSHA256();
+    // Check if the SHA-256 instructions are present, detected once at run time.
+    // When they are not, the portable compression function of class SHA256 is used.
+    static bool accelerated();
+
+    // Multi-buffer SHA-256 hashing of count independent messages. Up to 'lanes' messages
+    // (1, 2 or 4) are hashed together, their compressions are interleaved in the same loop
+    // to hide the latency of the SHA-256 instructions. Each lane takes the next message as
+    // soon as its own one is finished. The hash of message i is stored at hashes + i * 32.
+    // Without SHA-256 instructions, the messages are hashed one by one.
+    static const size_t MAX_LANES = 4;
+    static bool hashMulti(const void* const* messages, const size_t* sizes, size_t count,
+                          void* hashes, size_t hashes_size, size_t lanes = MAX_LANES);
+
+protected:
+    // Compress count consecutive 512-bit blocks, accumulate hash in state.
+    typedef void (*CompressFunction)(uint32_t* state, const uint8_t* buf, size_t count);
+    static void compressArm(uint32_t* state, const uint8_t* buf, size_t count) TARGET_SHA2;
+    static void compressPortable(uint32_t* state, const uint8_t* buf, size_t count);
+
+    // Compress one block in each of N independent states, in the same loop.
+    template <size_t N>
+    static void compressLanes(uint32_t* const* states, const uint8_t* const* blocks) TARGET_SHA2;
+
+    // Compress one block in each of count independent states, by groups of 4, 2, 1 lanes,
+    // or one by one with the portable compression function.
+    static void compressMulti(uint32_t* const* states, const uint8_t* const* blocks, size_t count);
+
+    // PBKDF2 uses the compression functions directly.
+    friend class PBKDF2SHA256;
+};
+
+// SHA-256 and SHA-224 hash computation.
+template <class POLICY>
+class ArmSHA256Family : public ArmSHA256Core
+{
+public:
+    static const size_t HASH_SIZE = POLICY::HASH_SIZE;
+
+    ArmSHA256Family();
     bool init();
     bool add(const void* data, size_t size);
     bool getHash(void* hash, size_t bufsize, size_t* retsize = nullptr);
 
+    // Make add() compress the complete blocks with one call per block, as the previous
+    // implementation did. For comparison in sha256_perf only, the default is one call.
+    void setBlockByBlock(bool on) { _block_by_block = on; }
+
 private:
     uint64_t _length;                 // Total message size in bits (already hashed, ie. excluding _buf)
-    uint32_t _state[HASH_SIZE / 4];   // Current hash value (160 bits)
+    uint32_t _state[8];               // Current hash value (256 bits, truncated in the final hash)
     size_t   _curlen;                 // Used bytes in _buf
     uint8_t  _buf[BLOCK_SIZE];        // Current block to hash (512 bits)
 
-    // Compress one 512-bit block, accumulate hash in _state.
-    void compress(const uint8_t* buf);
+    // The compression function is selected once, using the SHA-256 instructions when present.
+    CompressFunction _compress;
+    bool _block_by_block;             // One call to _compress per block in add() (comparison only)
+
+    // PBKDF2 uses the states directly.
+    friend class PBKDF2SHA256;
 };
+
+typedef ArmSHA256Family<SHA256Policy> ArmSHA256;
+typedef ArmSHA256Family<SHA224Policy> ArmSHA224;
@@ -0,0 +1,104 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Implementation of HKDF-SHA-256 (RFC 5869) using class HMACSHA256.
+//
+//----------------------------------------------------------------------------
+
+#include "HKDFSHA256.h"
+
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+HKDFSHA256::HKDFSHA256() :
+    _hmac()
+{
+}
+
+HKDFSHA256::HKDFSHA256(const void* prk, size_t prk_size) :
+    _hmac(prk, prk_size)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// HKDF-Extract: PRK = HMAC(salt, IKM). A missing salt is the same as a
+// string of zeroes, as the key of the HMAC is padded with zeroes.
+//----------------------------------------------------------------------------
+
+bool HKDFSHA256::extract(const void* salt, size_t salt_size, const void* ikm, size_t ikm_size, void* prk, size_t prk_size)
+{
+    uint8_t key[PRK_SIZE];
+    if (prk != nullptr && prk_size < PRK_SIZE) {
+        return false;
+    }
+    if (!HMACSHA256::mac(salt, salt_size, ikm, ikm_size, key, sizeof(key)) || !_hmac.setKey(key, sizeof(key))) {
+        return false;
+    }
+    if (prk != nullptr) {
+        ::memcpy(prk, key, sizeof(key));
+    }
+    bzero(key, sizeof(key));
+    return true;
+}
+
+bool HKDFSHA256::setPRK(const void* prk, size_t prk_size)
+{
+    return _hmac.setKey(prk, prk_size);
+}
+
+
+//----------------------------------------------------------------------------
+// HKDF-Expand: T(i) = HMAC(PRK, T(i-1) | info | i), OKM = T(1) | T(2) | ...
+//----------------------------------------------------------------------------
+
+bool HKDFSHA256::expand(const void* info, size_t info_size, void* okm, size_t okm_size)
+{
+    if (okm_size > MAX_OUTPUT_SIZE) {
+        return false;
+    }
+
+    uint8_t* out = reinterpret_cast<uint8_t*>(okm);
+    const uint8_t* previous = nullptr;
+    for (uint8_t index = 1; okm_size > 0; ++index) {
+        _hmac.init();
+        if (previous != nullptr) {
+            _hmac.add(previous, PRK_SIZE);
+        }
+        _hmac.add(info, info_size);
+        _hmac.add(&index, 1);
+        if (okm_size >= PRK_SIZE) {
+            // Complete block, directly in the output, used as T(i-1) in the next one.
+            _hmac.getMAC(out, PRK_SIZE);
+            previous = out;
+            out += PRK_SIZE;
+            okm_size -= PRK_SIZE;
+        }
+        else {
+            // Last truncated block.
+            uint8_t last[PRK_SIZE];
+            _hmac.getMAC(last, sizeof(last));
+            ::memcpy(out, last, okm_size);
+            bzero(last, sizeof(last));
+            okm_size = 0;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// One-shot extract and expand.
+//----------------------------------------------------------------------------
+
+bool HKDFSHA256::derive(const void* salt, size_t salt_size, const void* ikm, size_t ikm_size,
+                        const void* info, size_t info_size, void* okm, size_t okm_size)
+{
+    HKDFSHA256 hkdf;
+    return hkdf.extract(salt, salt_size, ikm, ikm_size) && hkdf.expand(info, info_size, okm, okm_size);
+}
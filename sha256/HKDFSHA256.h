@@ -0,0 +1,41 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Implementation of HKDF-SHA-256 (RFC 5869) using class HMACSHA256.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "HMACSHA256.h"
+
+class HKDFSHA256
+{
+public:
+    static const size_t PRK_SIZE        = HMACSHA256::MAC_SIZE;        //!< Pseudorandom key size in bytes.
+    static const size_t MAX_OUTPUT_SIZE = 255 * HMACSHA256::MAC_SIZE;  //!< Maximum size of an expanded key.
+
+    HKDFSHA256();
+    HKDFSHA256(const void* prk, size_t prk_size);
+
+    // HKDF-Extract: compute the pseudorandom key from a salt and the input keying material.
+    // The PRK is used by the next expand() operations. It is also returned when prk is not null.
+    bool extract(const void* salt, size_t salt_size, const void* ikm, size_t ikm_size, void* prk = nullptr, size_t prk_size = 0);
+
+    // Use an existing pseudorandom key, typically from a previous extract().
+    bool setPRK(const void* prk, size_t prk_size);
+
+    // HKDF-Expand: compute okm_size bytes of output keying material. The HMAC states of
+    // the PRK are computed once in extract() or setPRK() and reused for all output blocks
+    // and all calls to expand(). The output blocks are directly written in okm.
+    bool expand(const void* info, size_t info_size, void* okm, size_t okm_size);
+
+    // One-shot extract and expand.
+    static bool derive(const void* salt, size_t salt_size, const void* ikm, size_t ikm_size,
+                       const void* info, size_t info_size, void* okm, size_t okm_size);
+
+private:
+    HMACSHA256 _hmac;  // HMAC with the PRK as key.
+};
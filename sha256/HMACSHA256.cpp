@@ -0,0 +1,123 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Implementation of HMAC-SHA-256 (RFC 2104) using class ArmSHA256.
+//
+//----------------------------------------------------------------------------
+
+#include "HMACSHA256.h"
+
+
+//----------------------------------------------------------------------------
+// Constructors
+//----------------------------------------------------------------------------
+
+HMACSHA256::HMACSHA256() :
+    HMACSHA256(nullptr, 0)
+{
+}
+
+HMACSHA256::HMACSHA256(const void* key, size_t key_size) :
+    _inner_init(),
+    _outer_init(),
+    _inner()
+{
+    setKey(key, key_size);
+}
+
+
+//----------------------------------------------------------------------------
+// Set a new key, compute the inner and outer initial states.
+//----------------------------------------------------------------------------
+
+bool HMACSHA256::setKey(const void* key, size_t key_size)
+{
+    // Keys larger than the block size are hashed first.
+    uint8_t pad[BLOCK_SIZE];
+    bzero(pad, sizeof(pad));
+    if (key_size > BLOCK_SIZE) {
+        _inner.init();
+        _inner.add(key, key_size);
+        _inner.getHash(pad, sizeof(pad));
+    }
+    else if (key_size > 0) {
+        ::memcpy(pad, key, key_size);
+    }
+
+    // Inner padded key: key XOR 0x36, outer padded key: key XOR 0x5C.
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        pad[i] ^= 0x36;
+    }
+    _inner_init.init();
+    _inner_init.add(pad, sizeof(pad));
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        pad[i] ^= 0x36 ^ 0x5C;
+    }
+    _outer_init.init();
+    _outer_init.add(pad, sizeof(pad));
+    bzero(pad, sizeof(pad));
+
+    return init();
+}
+
+
+//----------------------------------------------------------------------------
+// Incremental computation of the MAC.
+//----------------------------------------------------------------------------
+
+bool HMACSHA256::init()
+{
+    _inner = _inner_init;
+    return true;
+}
+
+bool HMACSHA256::add(const void* data, size_t size)
+{
+    return _inner.add(data, size);
+}
+
+bool HMACSHA256::getMAC(void* mac, size_t bufsize, size_t* retsize)
+{
+    if (!finish(_inner, mac, bufsize)) {
+        return false;
+    }
+    if (retsize != nullptr) {
+        *retsize = MAC_SIZE;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// One-shot computation of the MAC.
+//----------------------------------------------------------------------------
+
+bool HMACSHA256::mac(const void* data, size_t size, void* mac, size_t bufsize) const
+{
+    ArmSHA256 inner(_inner_init);
+    return inner.add(data, size) && finish(inner, mac, bufsize);
+}
+
+bool HMACSHA256::mac(const void* key, size_t key_size, const void* data, size_t size, void* mac, size_t bufsize)
+{
+    return HMACSHA256(key, key_size).mac(data, size, mac, bufsize);
+}
+
+
+//----------------------------------------------------------------------------
+// Complete the outer hash from the inner hash.
+//----------------------------------------------------------------------------
+
+bool HMACSHA256::finish(ArmSHA256& inner, void* mac, size_t bufsize) const
+{
+    // Check the output buffer first, a failed call must not finalize the inner hash.
+    if (mac == nullptr || bufsize < MAC_SIZE) {
+        return false;
+    }
+    uint8_t hash[MAC_SIZE];
+    ArmSHA256 outer(_outer_init);
+    return inner.getHash(hash, sizeof(hash)) && outer.add(hash, sizeof(hash)) && outer.getHash(mac, bufsize);
+}
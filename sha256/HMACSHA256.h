@@ -0,0 +1,50 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Implementation of HMAC-SHA-256 (RFC 2104) using class ArmSHA256.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "ArmSHA256.h"
+
+class HMACSHA256
+{
+public:
+    static const size_t MAC_SIZE   = ArmSHA256::HASH_SIZE;   //!< HMAC-SHA-256 size in bytes.
+    static const size_t BLOCK_SIZE = ArmSHA256::BLOCK_SIZE;  //!< SHA-256 block size in bytes.
+
+    HMACSHA256();
+    HMACSHA256(const void* key, size_t key_size);
+
+    // Set a new key. The inner and outer padded keys are compressed once here, each
+    // MAC then only costs the compression of the message and of one outer block.
+    bool setKey(const void* key, size_t key_size);
+
+    // Incremental computation of a MAC with the current key.
+    bool init();
+    bool add(const void* data, size_t size);
+    bool getMAC(void* mac, size_t bufsize, size_t* retsize = nullptr);
+
+    // One-shot computation of the MAC of a message with the current key. The
+    // incremental computation in progress, if any, is not modified. All complete
+    // blocks of the message are compressed directly from the user's buffer.
+    bool mac(const void* data, size_t size, void* mac, size_t bufsize) const;
+
+    // One-shot computation of the MAC of a message with a given key.
+    static bool mac(const void* key, size_t key_size, const void* data, size_t size, void* mac, size_t bufsize);
+
+private:
+    ArmSHA256 _inner_init;  // State after the inner padded key (key XOR ipad).
+    ArmSHA256 _outer_init;  // State after the outer padded key (key XOR opad).
+    ArmSHA256 _inner;       // Inner hash in progress.
+
+    // Complete the outer hash from the inner hash.
+    bool finish(ArmSHA256& inner, void* mac, size_t bufsize) const;
+
+    // PBKDF2 uses the inner and outer initial states directly.
+    friend class PBKDF2SHA256;
+};
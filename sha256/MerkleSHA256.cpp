@@ -0,0 +1,274 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Parallel Merkle tree hashing of large buffers using class ArmSHA256.
+//
+//----------------------------------------------------------------------------
+
+#include "MerkleSHA256.h"
+
+// Constants may be used by reference.
+const size_t MerkleSHA256::HASH_SIZE;
+const size_t MerkleSHA256::DEFAULT_LEAF_SIZE;
+
+namespace {
+    const uint8_t LEAF_PREFIX = 0x00;
+    const uint8_t NODE_PREFIX = 0x01;
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+MerkleSHA256::MerkleSHA256(size_t leaf_size, size_t threads) :
+    _leaf_size(std::max<size_t>(1, leaf_size)),
+    _threads(1),
+    _size(0),
+    _levels(),
+    _workers(),
+    _mutex(),
+    _start(),
+    _done(),
+    _job_id(0),
+    _running(0),
+    _terminate(false),
+    _job_data(nullptr),
+    _job_leaves(nullptr),
+    _job_next(0)
+{
+    setThreads(threads);
+}
+
+MerkleSHA256::~MerkleSHA256()
+{
+    stopWorkers();
+}
+
+// The pool is restarted with the new size on next use.
+void MerkleSHA256::setThreads(size_t threads)
+{
+    const size_t count = threads > 0 ? threads : std::max<size_t>(1, std::thread::hardware_concurrency());
+    if (count != _threads) {
+        stopWorkers();
+        _threads = count;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Start and stop the pool of worker threads.
+//----------------------------------------------------------------------------
+
+void MerkleSHA256::startWorkers()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _terminate = false;
+    while (_workers.size() + 1 < _threads) {
+        _workers.emplace_back(&MerkleSHA256::workerMain, this, _job_id);
+    }
+}
+
+void MerkleSHA256::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _terminate = true;
+    }
+    _start.notify_all();
+    for (auto& th : _workers) {
+        th.join();
+    }
+    _workers.clear();
+}
+
+// Each worker waits for a job more recent than the last one it processed.
+void MerkleSHA256::workerMain(uint64_t job_id)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        _start.wait(lock, [this, job_id]() { return _terminate || _job_id != job_id; });
+        if (_terminate) {
+            return;
+        }
+        job_id = _job_id;
+        lock.unlock();
+        hashJobLeaves();
+        lock.lock();
+        if (--_running == 0) {
+            _done.notify_one();
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Hash a complete buffer.
+//----------------------------------------------------------------------------
+
+bool MerkleSHA256::hash(const void* data, size_t size)
+{
+    if (data == nullptr && size > 0) {
+        return false;
+    }
+
+    // Allocate all levels, each one has half the nodes of the previous one, rounded up.
+    size_t count = std::max<size_t>(1, (size + _leaf_size - 1) / _leaf_size);
+    _size = size;
+    _levels.clear();
+    _levels.emplace_back(count * HASH_SIZE);
+    while (count > 1) {
+        count = (count + 1) / 2;
+        _levels.emplace_back(count * HASH_SIZE);
+    }
+
+    // All nodes of all levels.
+    std::vector<size_t> nodes(leafCount());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        nodes[i] = i;
+    }
+    hashLeaves(reinterpret_cast<const uint8_t*>(data), nodes);
+    for (size_t level = 1; level < _levels.size(); ++level) {
+        nodes.resize(_levels[level].size() / HASH_SIZE);
+        hashNodes(level, nodes);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Incremental re-hash after a modification.
+//----------------------------------------------------------------------------
+
+bool MerkleSHA256::update(const void* data, size_t size, size_t offset, size_t length)
+{
+    if (_levels.empty() || size != _size) {
+        return hash(data, size);
+    }
+    if ((data == nullptr && size > 0) || offset > size || length > size - offset) {
+        return false;
+    }
+    if (length == 0) {
+        return true;
+    }
+
+    // Modified leaves, then their parents at each level.
+    std::vector<size_t> nodes;
+    for (size_t i = offset / _leaf_size; i <= (offset + length - 1) / _leaf_size; ++i) {
+        nodes.push_back(i);
+    }
+    hashLeaves(reinterpret_cast<const uint8_t*>(data), nodes);
+    for (size_t level = 1; level < _levels.size(); ++level) {
+        size_t count = 0;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (count == 0 || nodes[count - 1] != nodes[i] / 2) {
+                nodes[count++] = nodes[i] / 2;
+            }
+        }
+        nodes.resize(count);
+        hashNodes(level, nodes);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the root hash.
+//----------------------------------------------------------------------------
+
+bool MerkleSHA256::getRoot(void* hash, size_t bufsize) const
+{
+    if (_levels.empty() || bufsize < HASH_SIZE) {
+        return false;
+    }
+    ::memcpy(hash, _levels.back().data(), HASH_SIZE);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Hash leaves in parallel. Each thread of the pool takes the next leaf in the
+// list. The calling thread is one of the workers and waits for the others.
+//----------------------------------------------------------------------------
+
+void MerkleSHA256::hashLeaves(const uint8_t* data, const std::vector<size_t>& leaves)
+{
+    _job_data = data;
+    _job_leaves = &leaves;
+    _job_next = 0;
+
+    if (_threads > 1 && leaves.size() > 1) {
+        if (_workers.empty()) {
+            startWorkers();
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running = _workers.size();
+            _job_id++;
+        }
+        _start.notify_all();
+        hashJobLeaves();
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this]() { return _running == 0; });
+    }
+    else {
+        hashJobLeaves();
+    }
+    _job_leaves = nullptr;
+}
+
+void MerkleSHA256::hashJobLeaves()
+{
+    ArmSHA256 sha;
+    const std::vector<size_t>& leaves(*_job_leaves);
+    for (size_t i = _job_next++; i < leaves.size(); i = _job_next++) {
+        const size_t start = leaves[i] * _leaf_size;
+        sha.init();
+        sha.add(&LEAF_PREFIX, 1);
+        sha.add(_job_data + start, std::min(_leaf_size, _size - start));
+        sha.getHash(&_levels[0][leaves[i] * HASH_SIZE], HASH_SIZE);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Recompute nodes of a level from the level below.
+//----------------------------------------------------------------------------
+
+void MerkleSHA256::hashNodes(size_t level, const std::vector<size_t>& nodes)
+{
+    const std::vector<uint8_t>& below(_levels[level - 1]);
+    std::vector<uint8_t>& current(_levels[level]);
+    const size_t below_count = below.size() / HASH_SIZE;
+    const size_t msg_size = 1 + 2 * HASH_SIZE;
+
+    // Build the messages of the nodes with two children. A node without sibling is promoted.
+    std::vector<uint8_t> buffer(nodes.size() * msg_size);
+    std::vector<const void*> messages;
+    std::vector<size_t> indexes;
+    for (size_t node : nodes) {
+        if (2 * node + 1 < below_count) {
+            uint8_t* msg = &buffer[messages.size() * msg_size];
+            msg[0] = NODE_PREFIX;
+            ::memcpy(msg + 1, &below[2 * node * HASH_SIZE], 2 * HASH_SIZE);
+            messages.push_back(msg);
+            indexes.push_back(node);
+        }
+        else {
+            ::memcpy(&current[node * HASH_SIZE], &below[2 * node * HASH_SIZE], HASH_SIZE);
+        }
+    }
+
+    // Hash all messages, several at a time, then dispatch the results.
+    if (!messages.empty()) {
+        const std::vector<size_t> sizes(messages.size(), msg_size);
+        std::vector<uint8_t> hashes(messages.size() * HASH_SIZE);
+        ArmSHA256::hashMulti(messages.data(), sizes.data(), messages.size(), hashes.data(), hashes.size());
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            ::memcpy(&current[indexes[i] * HASH_SIZE], &hashes[i * HASH_SIZE], HASH_SIZE);
+        }
+    }
+}
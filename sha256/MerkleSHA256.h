@@ -0,0 +1,89 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Parallel Merkle tree hashing of large buffers using class ArmSHA256.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "ArmSHA256.h"
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// The buffer is split in leaves of a fixed size, the last one may be shorter.
+// The leaves are hashed in parallel by a pool of worker threads, then the
+// interior nodes are combined bottom-up, two children per node. The worker
+// threads are started on first use and kept until the object is destroyed
+// or the number of threads is changed, all hash() and update() reuse them. With domain
+// separation as in RFC 6962 (Certificate Transparency):
+// - leaf hash = SHA-256(0x00 || leaf data)
+// - node hash = SHA-256(0x01 || left hash || right hash)
+// The last node of a level without sibling is promoted unchanged to the next
+// level. The root hash only depends on the data and the leaf size, not on the
+// number of threads. An empty buffer has one empty leaf.
+class MerkleSHA256
+{
+public:
+    static const size_t HASH_SIZE = ArmSHA256::HASH_SIZE;  //!< Size of all node hashes.
+    static const size_t DEFAULT_LEAF_SIZE = 1024 * 1024;   //!< Default leaf size in bytes.
+
+    // Zero threads means one per CPU core.
+    MerkleSHA256(size_t leaf_size = DEFAULT_LEAF_SIZE, size_t threads = 0);
+    ~MerkleSHA256();
+    void setThreads(size_t threads);
+    size_t threads() const { return _threads; }
+    size_t leafSize() const { return _leaf_size; }
+    size_t leafCount() const { return _levels.empty() ? 0 : _levels[0].size() / HASH_SIZE; }
+
+    // Hash a complete buffer, compute all leaves and nodes.
+    bool hash(const void* data, size_t size);
+
+    // Incremental re-hash of the same buffer after a modification of 'length' bytes at 'offset'.
+    // Only the modified leaves and their ancestors are recomputed. If the size of the buffer
+    // changed since the previous hash, the complete tree is recomputed.
+    bool update(const void* data, size_t size, size_t offset, size_t length);
+
+    // Get the root hash.
+    bool getRoot(void* hash, size_t bufsize) const;
+
+private:
+    size_t _leaf_size;
+    size_t _threads;
+    size_t _size;  // Size of the last hashed buffer
+    std::vector<std::vector<uint8_t>> _levels;  // Hashes of each level, leaves first, root last
+
+    // Pool of worker threads (_threads - 1, the calling thread is one of the workers).
+    std::vector<std::thread> _workers;
+    std::mutex              _mutex;
+    std::condition_variable _start;        // A new job is ready or the workers shall terminate
+    std::condition_variable _done;         // A worker finished its part of the job
+    uint64_t                _job_id;       // Incremented for each job
+    size_t                  _running;      // Number of workers still in the current job
+    bool                    _terminate;    // The workers shall terminate
+
+    // Current job: leaves to hash, the next one is taken by the first available thread.
+    const uint8_t*             _job_data;
+    const std::vector<size_t>* _job_leaves;
+    std::atomic<size_t>        _job_next;
+
+    // Start and stop the worker threads.
+    void startWorkers();
+    void stopWorkers();
+    void workerMain(uint64_t job_id);
+
+    // Hash the given leaves (sorted indexes) in parallel.
+    void hashLeaves(const uint8_t* data, const std::vector<size_t>& leaves);
+
+    // Hash leaves of the current job until there is none left, in all threads.
+    void hashJobLeaves();
+
+    // Recompute the given nodes (sorted indexes) of a level from the level below.
+    // The nodes with two children are hashed together using ArmSHA256::hashMulti().
+    void hashNodes(size_t level, const std::vector<size_t>& nodes);
+};
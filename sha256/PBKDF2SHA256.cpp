@@ -0,0 +1,107 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Implementation of PBKDF2-HMAC-SHA-256 (RFC 8018) using the compression
+// functions of class ArmSHA256 directly.
+//
+//----------------------------------------------------------------------------
+
+#include "PBKDF2SHA256.h"
+
+// Constants may be used by reference.
+const size_t PBKDF2SHA256::MAX_LANES;
+
+
+//----------------------------------------------------------------------------
+// Derive a key from a password.
+//----------------------------------------------------------------------------
+
+bool PBKDF2SHA256::derive(const void* password, size_t password_size, const void* salt, size_t salt_size,
+                          size_t iterations, void* key, size_t key_size, size_t lanes)
+{
+    static const size_t HASH_SIZE = ArmSHA256::HASH_SIZE;
+    static const size_t BLOCK_SIZE = ArmSHA256::BLOCK_SIZE;
+    static const size_t WORDS = HASH_SIZE / 4;
+
+    if (iterations == 0) {
+        return false;
+    }
+    lanes = std::max<size_t>(1, std::min(lanes, MAX_LANES));
+    uint8_t* out = reinterpret_cast<uint8_t*>(key);
+
+    // The inner and outer states after the padded password are computed once.
+    HMACSHA256 hmac(password, password_size);
+    const uint32_t* inner_init = hmac._inner_init._state;
+    const uint32_t* outer_init = hmac._outer_init._state;
+
+    // After the first iteration, the inner and outer hashes are computed on one block, after
+    // the padded password. The block contains the previous hash, then a constant padding.
+    uint8_t block[MAX_LANES][BLOCK_SIZE];
+    uint32_t state[MAX_LANES][WORDS];
+    uint32_t result[MAX_LANES][WORDS];
+    uint32_t* states[MAX_LANES];
+    const uint8_t* blocks[MAX_LANES];
+    for (size_t l = 0; l < lanes; ++l) {
+        bzero(block[l], BLOCK_SIZE);
+        block[l][HASH_SIZE] = 0x80;
+        PutUInt64(block[l] + BLOCK_SIZE - 8, 8 * (BLOCK_SIZE + HASH_SIZE));
+        states[l] = state[l];
+        blocks[l] = block[l];
+    }
+
+    // Compute 'lanes' output blocks at a time, the last group may be shorter.
+    for (uint32_t index = 1; key_size > 0; ) {
+        const size_t count = std::min(lanes, (key_size + HASH_SIZE - 1) / HASH_SIZE);
+
+        // First iteration: HMAC of the salt and big-endian block index.
+        for (size_t l = 0; l < count; ++l) {
+            uint8_t be_index[4];
+            PutUInt32(be_index, index + uint32_t(l));
+            hmac.init();
+            hmac.add(salt, salt_size);
+            hmac.add(be_index, sizeof(be_index));
+            hmac.getMAC(block[l], HASH_SIZE);
+            for (size_t i = 0; i < WORDS; ++i) {
+                result[l][i] = GetUInt32(block[l] + 4 * i);
+            }
+        }
+
+        // Next iterations: HMAC of the previous one, the padding is already in the blocks.
+        for (size_t n = 1; n < iterations; ++n) {
+            for (size_t l = 0; l < count; ++l) {
+                ::memcpy(state[l], inner_init, sizeof(state[l]));
+            }
+            ArmSHA256::compressMulti(states, blocks, count);
+            for (size_t l = 0; l < count; ++l) {
+                for (size_t i = 0; i < WORDS; ++i) {
+                    PutUInt32(block[l] + 4 * i, state[l][i]);
+                }
+                ::memcpy(state[l], outer_init, sizeof(state[l]));
+            }
+            ArmSHA256::compressMulti(states, blocks, count);
+            for (size_t l = 0; l < count; ++l) {
+                for (size_t i = 0; i < WORDS; ++i) {
+                    PutUInt32(block[l] + 4 * i, state[l][i]);
+                    result[l][i] ^= state[l][i];
+                }
+            }
+        }
+
+        // Output blocks, the last one may be truncated.
+        for (size_t l = 0; l < count; ++l) {
+            uint8_t hash[HASH_SIZE];
+            for (size_t i = 0; i < WORDS; ++i) {
+                PutUInt32(hash + 4 * i, result[l][i]);
+            }
+            const size_t size = std::min(key_size, HASH_SIZE);
+            ::memcpy(out, hash, size);
+            out += size;
+            key_size -= size;
+        }
+        index += uint32_t(count);
+    }
+    return true;
+}
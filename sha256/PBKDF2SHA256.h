@@ -0,0 +1,25 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Implementation of PBKDF2-HMAC-SHA-256 (RFC 8018) using the compression
+// functions of class ArmSHA256 directly.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "HMACSHA256.h"
+
+class PBKDF2SHA256
+{
+public:
+    static const size_t MAX_LANES = ArmSHA256::MAX_LANES;
+
+    // Derive key_size bytes from a password and a salt, with the given number of iterations.
+    // Up to 'lanes' output blocks of 32 bytes are computed together, their compressions are
+    // interleaved in the same loop when the SHA-256 instructions are present.
+    static bool derive(const void* password, size_t password_size, const void* salt, size_t salt_size,
+                       size_t iterations, void* key, size_t key_size, size_t lanes = MAX_LANES);
+};
@@ -56,13 +56,13 @@ bool SHA256::init()
 // Compress part of message
 //----------------------------------------------------------------------------
 
-void SHA256::compress(const uint8_t* buf)
+void SHA256::compress(uint32_t* state, const uint8_t* buf)
 {
     uint32_t S[8], W[64];
 
     // Copy state into S
     for (size_t i = 0; i < 8; i++) {
-        S[i] = _state[i];
+        S[i] = state[i];
     }
 
     // Copy the state into 512-bits into W[0..15]
@@ -152,7 +152,7 @@ void SHA256::compress(const uint8_t* buf)
 
     // Feedback
     for (size_t i = 0; i < 8; i++) {
-        _state[i] = _state[i] + S[i];
+        state[i] = state[i] + S[i];
     }
 }
 
@@ -172,7 +172,7 @@ bool SHA256::add(const void* data, size_t size)
     while (size > 0) {
         if (_curlen == 0 && size >= BLOCK_SIZE) {
             // Compress one 512-bit block directly from user's buffer.
-            compress(in);
+            compress(_state, in);
             _length += BLOCK_SIZE * 8;
             in += BLOCK_SIZE;
             size -= BLOCK_SIZE;
@@ -185,7 +185,7 @@ bool SHA256::add(const void* data, size_t size)
             in += n;
             size -= n;
             if (_curlen == BLOCK_SIZE) {
-                compress(_buf);
+                compress(_state, _buf);
                 _length += 8 * BLOCK_SIZE;
                 _curlen = 0;
             }
@@ -216,14 +216,14 @@ bool SHA256::getHash(void* hash, size_t bufsize, size_t* retsize)
     // If the length is currently above 56 bytes (no room for message length), append zeroes then compress.
     if (_curlen > 56) {
         bzero(_buf + _curlen, 64 - _curlen);
-        compress(_buf);
+        compress(_state, _buf);
         _curlen = 0;
     }
 
     // Pad up to 56 bytes with zeroes and append 64-bit message length in bits.
     bzero(_buf + _curlen, 56 - _curlen);
     PutUInt64(_buf + 56, _length);
-    compress(_buf);
+    compress(_state, _buf);
 
     // Copy output
     uint8_t* out = reinterpret_cast<uint8_t*> (hash);
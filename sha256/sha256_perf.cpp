@@ -5,19 +5,32 @@
 // BSD-2-Clause license, see the LICENSE file.
 //
 // Comparative performance test on SHA-256 (portable vs. Arm64 instructions).
-// Specify the number of iterations on the command line.
+// Specify the number of iterations on the command line, optionally followed by
+// a file name for the Merkle tree hashing (default: a synthetic 256 MB buffer).
 //
 //----------------------------------------------------------------------------
 
 #include "SHA256.h"
 #include "ArmSHA256.h"
+#include "HMACSHA256.h"
+#include "PBKDF2SHA256.h"
+#include "HKDFSHA256.h"
+#include "MerkleSHA256.h"
 #include <ios>
 #include <iomanip>
 #include <iostream>
 #include <cstdlib>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <thread>
 #include <sys/resource.h>
 
 #define DEFAULT_ITERATIONS 10000000
+#define PBKDF2_ITERATIONS  10000
+#define MERKLE_SIZE        (256 * 1024 * 1024)
+#define CHUNKS_SIZE        (1024 * 1024)
 
 static const uint8_t test_data[256] = {
     0x8F, 0xAA, 0xF6, 0x60, 0x79, 0x8C, 0x25, 0x3A, 0xF7, 0x51, 0x5D, 0x80, 0x8B, 0x3F, 0x7D, 0x71,
@@ -54,6 +67,393 @@ uint64_t get_user_ms()
 }
 
 
+//----------------------------------------------------------------------------
+// Number of messages per second, for a given time in milliseconds.
+//----------------------------------------------------------------------------
+
+uint64_t get_per_second(uint64_t count, uint64_t ms)
+{
+    return ms > 0 ? count * 1000 / ms : 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Hash many small messages, one by one or using the multi-buffer hashing.
+//----------------------------------------------------------------------------
+
+void perf_multi(uint64_t total_bytes)
+{
+    static const size_t batch = 1024;  // messages per call to hashMulti()
+
+    std::cout << std::endl << "Small messages, messages/second, ArmSHA256 one by one / hashMulti 2 lanes / 4 lanes" << std::endl;
+    for (size_t size : {64, 256, 1024}) {
+        // Independent messages in one buffer.
+        std::vector<uint8_t> data(batch * size);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = test_data[i % sizeof(test_data)] ^ uint8_t(i / size);
+        }
+        std::vector<const void*> msgs(batch);
+        std::vector<size_t> sizes(batch, size);
+        for (size_t i = 0; i < batch; ++i) {
+            msgs[i] = &data[i * size];
+        }
+        std::vector<uint8_t> hashes1(batch * ArmSHA256::HASH_SIZE);
+        std::vector<uint8_t> hashes2(hashes1.size());
+        std::vector<uint8_t> hashes4(hashes1.size());
+        const uint64_t loops = std::max<uint64_t>(1, total_bytes / data.size());
+        const uint64_t count = loops * batch;
+
+        ArmSHA256 sha;
+        uint64_t start = get_user_ms();
+        for (uint64_t n = 0; n < loops; ++n) {
+            for (size_t i = 0; i < batch; ++i) {
+                sha.init();
+                sha.add(msgs[i], size);
+                sha.getHash(&hashes1[i * ArmSHA256::HASH_SIZE], ArmSHA256::HASH_SIZE);
+            }
+        }
+        const uint64_t time1 = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (uint64_t n = 0; n < loops; ++n) {
+            ArmSHA256::hashMulti(msgs.data(), sizes.data(), batch, hashes2.data(), hashes2.size(), 2);
+        }
+        const uint64_t time2 = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (uint64_t n = 0; n < loops; ++n) {
+            ArmSHA256::hashMulti(msgs.data(), sizes.data(), batch, hashes4.data(), hashes4.size(), 4);
+        }
+        const uint64_t time4 = get_user_ms() - start;
+
+        std::cout << "  " << std::setw(4) << size << " bytes: " << get_per_second(count, time1)
+                  << " / " << get_per_second(count, time2) << " / " << get_per_second(count, time4)
+                  << (hashes1 == hashes2 && hashes1 == hashes4 ? "" : " (INVALID HASH)") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Compute MAC's of packets, recomputing the padded keys for each MAC or
+// using the precomputed inner and outer states.
+//----------------------------------------------------------------------------
+
+void perf_hmac(uint64_t total_bytes)
+{
+    static const uint8_t key[32] = {0x4B, 0x65, 0x79, 0x20, 0x66, 0x6F, 0x72, 0x20, 0x48, 0x4D, 0x41, 0x43};
+
+    std::cout << std::endl << "HMACSHA256, MACs/second, key set for each MAC / precomputed key" << std::endl;
+    for (size_t size : {64, 256, 1500}) {
+        std::vector<uint8_t> packet(size);
+        for (size_t i = 0; i < size; ++i) {
+            packet[i] = test_data[i % sizeof(test_data)];
+        }
+        uint8_t mac1[HMACSHA256::MAC_SIZE];
+        uint8_t mac2[HMACSHA256::MAC_SIZE];
+        const uint64_t count = std::max<uint64_t>(1, total_bytes / size);
+
+        uint64_t start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            packet[0] = uint8_t(n);
+            HMACSHA256::mac(key, sizeof(key), packet.data(), size, mac1, sizeof(mac1));
+        }
+        const uint64_t time1 = get_user_ms() - start;
+
+        HMACSHA256 hmac(key, sizeof(key));
+        start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            packet[0] = uint8_t(n);
+            hmac.mac(packet.data(), size, mac2, sizeof(mac2));
+        }
+        const uint64_t time2 = get_user_ms() - start;
+
+        std::cout << "  " << std::setw(4) << size << " bytes: " << get_per_second(count, time1)
+                  << " / " << get_per_second(count, time2)
+                  << (::memcmp(mac1, mac2, sizeof(mac1)) == 0 ? "" : " (INVALID MAC)") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Reference PBKDF2, a loop on HMAC computations with the password as key.
+//----------------------------------------------------------------------------
+
+void naive_pbkdf2(const std::string& password, const std::string& salt, size_t iterations, uint8_t* key, size_t key_size)
+{
+    for (uint32_t index = 1; key_size > 0; ++index) {
+        uint8_t u[HMACSHA256::MAC_SIZE];
+        uint8_t t[HMACSHA256::MAC_SIZE];
+        uint8_t be_index[4];
+        PutUInt32(be_index, index);
+        const std::string msg(salt + std::string(reinterpret_cast<char*>(be_index), sizeof(be_index)));
+        HMACSHA256::mac(password.data(), password.size(), msg.data(), msg.size(), u, sizeof(u));
+        ::memcpy(t, u, sizeof(t));
+        for (size_t n = 1; n < iterations; ++n) {
+            HMACSHA256::mac(password.data(), password.size(), u, sizeof(u), u, sizeof(u));
+            for (size_t i = 0; i < sizeof(t); ++i) {
+                t[i] ^= u[i];
+            }
+        }
+        const size_t size = std::min(key_size, sizeof(t));
+        ::memcpy(key, t, size);
+        key += size;
+        key_size -= size;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Key derivations, using the naive HMAC loop or PBKDF2SHA256.
+//----------------------------------------------------------------------------
+
+void perf_pbkdf2(uint64_t count)
+{
+    const std::string password("correct horse battery staple");
+    const std::string salt("key-management-node-salt");
+
+    std::cout << std::endl << "PBKDF2, " << PBKDF2_ITERATIONS << " iterations, derivations/second, HMAC loop / PBKDF2SHA256 1 lane / "
+              << PBKDF2SHA256::MAX_LANES << " lanes" << std::endl;
+    for (size_t blocks : {1, 4}) {
+        const size_t size = blocks * HMACSHA256::MAC_SIZE;
+        std::vector<uint8_t> key1(size), key2(size), key3(size);
+
+        uint64_t start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            naive_pbkdf2(password, salt, PBKDF2_ITERATIONS, key1.data(), size);
+        }
+        const uint64_t time1 = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            PBKDF2SHA256::derive(password.data(), password.size(), salt.data(), salt.size(), PBKDF2_ITERATIONS, key2.data(), size, 1);
+        }
+        const uint64_t time2 = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            PBKDF2SHA256::derive(password.data(), password.size(), salt.data(), salt.size(), PBKDF2_ITERATIONS, key3.data(), size);
+        }
+        const uint64_t time3 = get_user_ms() - start;
+
+        // Use milli-derivations per second for more precision.
+        std::cout << "  " << std::setw(4) << size << "-byte key: " << (double(get_per_second(1000 * count, time1)) / 1000.0)
+                  << " / " << (double(get_per_second(1000 * count, time2)) / 1000.0)
+                  << " / " << (double(get_per_second(1000 * count, time3)) / 1000.0)
+                  << (key1 == key2 && key1 == key3 ? "" : " (INVALID KEY)") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// HKDF key derivations: complete extract and expand, or expand only with the
+// same pseudorandom key, as in the key schedule of a session setup.
+//----------------------------------------------------------------------------
+
+void perf_hkdf(uint64_t count)
+{
+    const std::string secret("shared secret from the key exchange");
+    const std::string salt("handshake salt");
+    const std::string info("tls13 key, session traffic");
+
+    std::cout << std::endl << "HKDFSHA256, keys/second, extract and expand / expand only" << std::endl;
+    for (size_t size : {size_t(16), size_t(32), 3 * HKDFSHA256::PRK_SIZE}) {
+        uint8_t key1[3 * HKDFSHA256::PRK_SIZE];
+        uint8_t key2[3 * HKDFSHA256::PRK_SIZE];
+
+        uint64_t start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            HKDFSHA256::derive(salt.data(), salt.size(), secret.data(), secret.size(), info.data(), info.size(), key1, size);
+        }
+        const uint64_t time1 = get_user_ms() - start;
+
+        HKDFSHA256 hkdf;
+        hkdf.extract(salt.data(), salt.size(), secret.data(), secret.size());
+        start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            hkdf.expand(info.data(), info.size(), key2, size);
+        }
+        const uint64_t time2 = get_user_ms() - start;
+
+        std::cout << "  " << std::setw(4) << size << "-byte key: " << get_per_second(count, time1)
+                  << " / " << get_per_second(count, time2)
+                  << (::memcmp(key1, key2, size) == 0 ? "" : " (INVALID KEY)") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Throughput in MB/s of a hash variant, on messages of a given size.
+//----------------------------------------------------------------------------
+
+template <class HASH>
+uint64_t get_mbps(size_t size, uint64_t total_bytes)
+{
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = test_data[i % sizeof(test_data)];
+    }
+    uint8_t hash[HASH::HASH_SIZE];
+    const uint64_t count = std::max<uint64_t>(1, total_bytes / size);
+
+    HASH sha;
+    const uint64_t start = get_user_ms();
+    for (uint64_t n = 0; n < count; ++n) {
+        sha.init();
+        sha.add(data.data(), size);
+        sha.getHash(hash, sizeof(hash));
+    }
+    const uint64_t ms = get_user_ms() - start;
+    return ms > 0 ? count * size / (ms * 1000) : 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Throughput of the variants by message size. Compare with the output of
+// sha512_perf on the same system for the SHA-256 / SHA-512/256 crossover.
+//----------------------------------------------------------------------------
+
+void perf_variants(uint64_t total_bytes)
+{
+    std::cout << std::endl << "Throughput by message size, MB/s, SHA-256 / SHA-224" << std::endl;
+    for (size_t size : {16, 64, 256, 1024, 4096, 16384}) {
+        std::cout << "  " << std::setw(5) << size << " bytes: " << get_mbps<ArmSHA256>(size, total_bytes) << " / " << get_mbps<ArmSHA224>(size, total_bytes) << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Merkle tree hashing of a large file, scaling with the number of threads.
+// The elapsed time is used, the user CPU time includes all threads.
+//----------------------------------------------------------------------------
+
+double merkle_seconds(MerkleSHA256& tree, const std::vector<uint8_t>& data, size_t threads, uint8_t* root)
+{
+    tree.setThreads(threads);
+    const auto start = std::chrono::steady_clock::now();
+    tree.hash(data.data(), data.size());
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    tree.getRoot(root, MerkleSHA256::HASH_SIZE);
+    return seconds;
+}
+
+void perf_merkle(const char* filename)
+{
+    std::vector<uint8_t> data;
+    if (filename != nullptr) {
+        // One read of the complete file into a buffer of the file size.
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        const std::streamoff size = file ? std::streamoff(file.tellg()) : -1;
+        if (size >= 0) {
+            data.resize(size_t(size));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(data.data()), size);
+        }
+        if (!file || size < 0) {
+            std::cerr << "error reading " << filename << std::endl;
+            return;
+        }
+    }
+    else {
+        data.resize(MERKLE_SIZE);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = test_data[i % sizeof(test_data)] ^ uint8_t(i >> 16);
+        }
+    }
+
+    MerkleSHA256 tree;
+    std::cout << std::endl << "Merkle tree, " << (filename != nullptr ? filename : "synthetic data") << ", " << data.size()
+              << " bytes, " << (MerkleSHA256::DEFAULT_LEAF_SIZE / 1024) << " kB leaves, GB/s by number of threads" << std::endl;
+
+    // Number of threads: 1, 2, 4, ... and all cores.
+    const size_t max_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    std::vector<size_t> counts;
+    for (size_t n = 1; n < max_threads; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(max_threads);
+
+    uint8_t root1[MerkleSHA256::HASH_SIZE];
+    uint8_t root[MerkleSHA256::HASH_SIZE];
+    for (size_t n : counts) {
+        const double seconds = merkle_seconds(tree, data, n, n == 1 ? root1 : root);
+        std::cout << "  " << std::setw(3) << n << (n > 1 ? " threads: " : " thread:  ")
+                  << (seconds > 0 ? double(data.size()) / (seconds * 1000000000.0) : 0.0) << " GB/s"
+                  << (n == 1 || ::memcmp(root, root1, sizeof(root)) == 0 ? "" : " (DIFFERENT ROOT)") << std::endl;
+    }
+
+    // Incremental re-hash after a one-byte modification in the middle.
+    if (!data.empty()) {
+        data[data.size() / 2] ^= 0xFF;
+        const auto start = std::chrono::steady_clock::now();
+        tree.update(data.data(), data.size(), data.size() / 2, 1);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  update of one byte: " << uint64_t(seconds * 1000000.0) << " microseconds, "
+                  << tree.leafCount() << " leaves" << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Streaming throughput in MB/s when a message is added in chunks of
+// pseudo-random sizes. Most chunks start at an unaligned address.
+//----------------------------------------------------------------------------
+
+template <class HASH>
+uint64_t get_chunks_mbps(HASH& sha, const std::vector<uint8_t>& data, const std::vector<size_t>& chunks, uint64_t loops, uint8_t* hash)
+{
+    const uint64_t start = get_user_ms();
+    for (uint64_t n = 0; n < loops; ++n) {
+        sha.init();
+        const uint8_t* in = data.data();
+        for (size_t size : chunks) {
+            sha.add(in, size);
+            in += size;
+        }
+        sha.getHash(hash, HASH::HASH_SIZE);
+    }
+    const uint64_t ms = get_user_ms() - start;
+    return ms > 0 ? loops * data.size() / (ms * 1000) : 0;
+}
+
+void perf_chunks(uint64_t total_bytes)
+{
+    std::vector<uint8_t> data(CHUNKS_SIZE);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = test_data[i % sizeof(test_data)] ^ uint8_t(i >> 8);
+    }
+    const std::vector<size_t> whole(1, data.size());
+    const uint64_t loops = std::max<uint64_t>(1, total_bytes / data.size());
+
+    std::cout << std::endl << "Random chunk sizes, " << data.size() << "-byte messages, MB/s, SHA256 / ArmSHA256 one call per block (previous) / ArmSHA256 (ArmSHA256 with one add)" << std::endl;
+    for (size_t max_chunk : {64, 4096, 65536}) {
+        // Chunks of 1 to max_chunk bytes, the same sequence in each run.
+        std::vector<size_t> chunks;
+        uint32_t seed = 12345;
+        for (size_t total = 0; total < data.size(); total += chunks.back()) {
+            seed = seed * 1103515245 + 12345;
+            chunks.push_back(std::min<size_t>(1 + (seed >> 8) % max_chunk, data.size() - total));
+        }
+
+        SHA256 s1;
+        ArmSHA256 s2;
+        s2.setBlockByBlock(true);
+        ArmSHA256 s3;
+        uint8_t hash1[SHA256::HASH_SIZE];
+        uint8_t hash2[SHA256::HASH_SIZE];
+        uint8_t hash3[SHA256::HASH_SIZE];
+        uint8_t hash4[SHA256::HASH_SIZE];
+        const uint64_t mbps1 = get_chunks_mbps(s1, data, chunks, loops, hash1);
+        const uint64_t mbps2 = get_chunks_mbps(s2, data, chunks, loops, hash2);
+        const uint64_t mbps3 = get_chunks_mbps(s3, data, chunks, loops, hash3);
+        const uint64_t mbps4 = get_chunks_mbps(s3, data, whole, loops, hash4);
+
+        std::cout << "  1 to " << std::setw(5) << max_chunk << " bytes: " << mbps1 << " / " << mbps2 << " / " << mbps3 << " (" << mbps4 << ")"
+                  << (::memcmp(hash1, hash4, sizeof(hash1)) == 0 && ::memcmp(hash2, hash4, sizeof(hash2)) == 0 &&
+                      ::memcmp(hash3, hash4, sizeof(hash3)) == 0 ? "" : " (INVALID HASH)") << std::endl;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Program entry point.
 //----------------------------------------------------------------------------
@@ -63,6 +463,7 @@ int main(int argc, char* argv[])
     const int iterations = argc > 1 ? std::atoi(argv[1]) : DEFAULT_ITERATIONS;
 
     std::cout << "SHA-256 performance test, " << iterations << " iterations, " << sizeof(test_data) << " bytes" << std::endl;
+    std::cout << "ArmSHA256 implementation: " << (ArmSHA256::accelerated() ? "Arm64 SHA256 instructions" : "portable") << std::endl;
 
     SHA256 sha;
     ArmSHA256 arm_sha;
@@ -96,5 +497,13 @@ int main(int argc, char* argv[])
         std::cout << "Performance ratio: " << (double(time1) / double(time2)) << std::endl;
     }
 
+    perf_multi(uint64_t(iterations) * sizeof(test_data));
+    perf_variants(uint64_t(iterations) * sizeof(test_data));
+    perf_chunks(uint64_t(iterations) * sizeof(test_data));
+    perf_hmac(uint64_t(iterations) * sizeof(test_data));
+    perf_pbkdf2(std::max<uint64_t>(1, iterations / 1000000));
+    perf_hkdf(std::max<uint64_t>(1, iterations / 10));
+    perf_merkle(argc > 2 ? argv[2] : nullptr);
+
     return EXIT_SUCCESS;
 }
@@ -11,9 +11,15 @@
 
 #include "SHA256.h"
 #include "ArmSHA256.h"
+#include "HMACSHA256.h"
+#include "PBKDF2SHA256.h"
+#include "HKDFSHA256.h"
+#include "MerkleSHA256.h"
 #include <ios>
 #include <iomanip>
 #include <iostream>
+#include <vector>
+#include <string>
 
 struct TestData {
     size_t size;
@@ -60,6 +66,438 @@ static const TestData test_data[] = {
 };
 
 
+//----------------------------------------------------------------------------
+// Test the streaming hashing of a message added in chunks of pseudo-random
+// sizes, at any alignment, compared with the portable implementation.
+//----------------------------------------------------------------------------
+
+void test_chunks()
+{
+    std::vector<uint8_t> msg(20000);
+    for (size_t i = 0; i < msg.size(); ++i) {
+        msg[i] = uint8_t(i * 13 + (i >> 8));
+    }
+    uint8_t expected[SHA256::HASH_SIZE];
+    SHA256 sha;
+    sha.add(msg.data(), msg.size());
+    sha.getHash(expected, sizeof(expected));
+
+    for (size_t max_chunk : {1, 7, 63, 64, 65, 192, 4000}) {
+        // Chunks of 0 to max_chunk bytes, around the block size and larger.
+        uint32_t seed = 12345;
+        uint8_t hash[SHA256::HASH_SIZE];
+        ArmSHA256 arm_sha;
+        ArmSHA256 block_sha;  // previous add(), one compression call per block
+        block_sha.setBlockByBlock(true);
+        for (size_t total = 0; total < msg.size(); ) {
+            seed = seed * 1103515245 + 12345;
+            const size_t size = std::min<size_t>((seed >> 8) % (max_chunk + 1), msg.size() - total);
+            arm_sha.add(msg.data() + total, size);
+            block_sha.add(msg.data() + total, size);
+            total += size;
+        }
+        arm_sha.getHash(hash, sizeof(hash));
+        uint8_t block_hash[sizeof(hash)];
+        block_sha.getHash(block_hash, sizeof(block_hash));
+        const bool ok = ::memcmp(hash, expected, sizeof(hash)) == 0 && ::memcmp(block_hash, expected, sizeof(block_hash)) == 0;
+        std::cout << msg.size() << " bytes, ArmSHA256, chunks of 0 to " << max_chunk << " bytes: " << (ok ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test the multi-buffer hashing: messages of all sizes around the padding
+// limits, compared with the portable implementation, with 1 to 4 lanes.
+//----------------------------------------------------------------------------
+
+void test_multi()
+{
+    std::vector<std::vector<uint8_t>> msgs;
+    for (size_t size = 0; size < 300; ++size) {
+        msgs.emplace_back(size);
+    }
+    for (size_t size : {1000, 4096, 10000}) {
+        msgs.emplace_back(size);
+    }
+    std::vector<const void*> ptrs;
+    std::vector<size_t> sizes;
+    std::vector<uint8_t> expected;
+    for (auto& msg : msgs) {
+        for (size_t i = 0; i < msg.size(); ++i) {
+            msg[i] = uint8_t(i * 11 + msg.size());
+        }
+        ptrs.push_back(msg.data());
+        sizes.push_back(msg.size());
+        uint8_t hash[SHA256::HASH_SIZE];
+        SHA256 sha;
+        sha.add(msg.data(), msg.size());
+        sha.getHash(hash, sizeof(hash));
+        expected.insert(expected.end(), hash, hash + sizeof(hash));
+    }
+
+    for (size_t lanes = 1; lanes <= ArmSHA256::MAX_LANES; ++lanes) {
+        std::vector<uint8_t> hashes(msgs.size() * SHA256::HASH_SIZE);
+        const bool ok = ArmSHA256::hashMulti(ptrs.data(), sizes.data(), msgs.size(), hashes.data(), hashes.size(), lanes) &&
+                        hashes == expected;
+        std::cout << msgs.size() << " messages, ArmSHA256::hashMulti, " << lanes << " lanes: " << (ok ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test HMAC-SHA-256 with the test cases 1, 2 and 6 of RFC 4231 (a key larger
+// than the block size in the last one), using the incremental and the one-shot
+// computations.
+//----------------------------------------------------------------------------
+
+void test_hmac()
+{
+    struct HMACTestData {
+        std::string key;
+        std::string message;
+        uint8_t mac[HMACSHA256::MAC_SIZE];
+    };
+    static const HMACTestData hmac_data[] = {
+        {
+            std::string(20, char(0x0B)),
+            "Hi There",
+            {0xB0, 0x34, 0x4C, 0x61, 0xD8, 0xDB, 0x38, 0x53, 0x5C, 0xA8, 0xAF, 0xCE, 0xAF, 0x0B, 0xF1, 0x2B,
+             0x88, 0x1D, 0xC2, 0x00, 0xC9, 0x83, 0x3D, 0xA7, 0x26, 0xE9, 0x37, 0x6C, 0x2E, 0x32, 0xCF, 0xF7}
+        },
+        {
+            "Jefe",
+            "what do ya want for nothing?",
+            {0x5B, 0xDC, 0xC1, 0x46, 0xBF, 0x60, 0x75, 0x4E, 0x6A, 0x04, 0x24, 0x26, 0x08, 0x95, 0x75, 0xC7,
+             0x5A, 0x00, 0x3F, 0x08, 0x9D, 0x27, 0x39, 0x83, 0x9D, 0xEC, 0x58, 0xB9, 0x64, 0xEC, 0x38, 0x43}
+        },
+        {
+            std::string(131, char(0xAA)),
+            "Test Using Larger Than Block-Size Key - Hash Key First",
+            {0x60, 0xE4, 0x31, 0x59, 0x1E, 0xE0, 0xB6, 0x7F, 0x0D, 0x8A, 0x26, 0xAA, 0xCB, 0xF5, 0xB7, 0x7F,
+             0x8E, 0x0B, 0xC6, 0x21, 0x37, 0x28, 0xC5, 0x14, 0x05, 0x46, 0x04, 0x0F, 0x0E, 0xE3, 0x7F, 0x54}
+        }
+    };
+
+    for (const auto& test : hmac_data) {
+        uint8_t mac1[HMACSHA256::MAC_SIZE];
+        uint8_t mac2[HMACSHA256::MAC_SIZE];
+        uint8_t mac3[HMACSHA256::MAC_SIZE];
+        HMACSHA256 hmac(test.key.data(), test.key.size());
+        // Incremental, in two parts.
+        const size_t half = test.message.size() / 2;
+        const bool ok1 = hmac.add(test.message.data(), half) &&
+                         hmac.add(test.message.data() + half, test.message.size() - half) &&
+                         !hmac.getMAC(mac1, sizeof(mac1) - 1) &&   // rejected, state unchanged
+                         !hmac.getMAC(nullptr, sizeof(mac1)) &&
+                         hmac.getMAC(mac1, sizeof(mac1)) &&
+                         ::memcmp(mac1, test.mac, sizeof(mac1)) == 0;
+        // One-shot with the precomputed key, twice, then with the key.
+        const bool ok2 = hmac.mac(test.message.data(), test.message.size(), mac2, sizeof(mac2)) &&
+                         hmac.mac(test.message.data(), test.message.size(), mac2, sizeof(mac2)) &&
+                         ::memcmp(mac2, test.mac, sizeof(mac2)) == 0;
+        const bool ok3 = HMACSHA256::mac(test.key.data(), test.key.size(), test.message.data(), test.message.size(), mac3, sizeof(mac3)) &&
+                         ::memcmp(mac3, test.mac, sizeof(mac3)) == 0;
+        std::cout << std::setw(3) << test.key.size() << "-byte key, HMACSHA256: " << (ok1 && ok2 && ok3 ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test PBKDF2-HMAC-SHA-256, with the passwords and salts of RFC 6070 and
+// RFC 7914. The last one has a password larger than the block size and several
+// groups of output blocks. Check all numbers of lanes.
+//----------------------------------------------------------------------------
+
+void test_pbkdf2()
+{
+    struct PBKDF2TestData {
+        std::string password;
+        std::string salt;
+        size_t iterations;
+        size_t size;
+        uint8_t key[200];
+    };
+    static const PBKDF2TestData pbkdf2_data[] = {
+        {
+            "passwd",
+            "salt",
+            1,
+            64,
+            {0x55, 0xAC, 0x04, 0x6E, 0x56, 0xE3, 0x08, 0x9F, 0xEC, 0x16, 0x91, 0xC2, 0x25, 0x44, 0xB6, 0x05,
+             0xF9, 0x41, 0x85, 0x21, 0x6D, 0xDE, 0x04, 0x65, 0xE6, 0x8B, 0x9D, 0x57, 0xC2, 0x0D, 0xAC, 0xBC,
+             0x49, 0xCA, 0x9C, 0xCC, 0xF1, 0x79, 0xB6, 0x45, 0x99, 0x16, 0x64, 0xB3, 0x9D, 0x77, 0xEF, 0x31,
+             0x7C, 0x71, 0xB8, 0x45, 0xB1, 0xE3, 0x0B, 0xD5, 0x09, 0x11, 0x20, 0x41, 0xD3, 0xA1, 0x97, 0x83}
+        },
+        {
+            "Password",
+            "NaCl",
+            80000,
+            64,
+            {0x4D, 0xDC, 0xD8, 0xF6, 0x0B, 0x98, 0xBE, 0x21, 0x83, 0x0C, 0xEE, 0x5E, 0xF2, 0x27, 0x01, 0xF9,
+             0x64, 0x1A, 0x44, 0x18, 0xD0, 0x4C, 0x04, 0x14, 0xAE, 0xFF, 0x08, 0x87, 0x6B, 0x34, 0xAB, 0x56,
+             0xA1, 0xD4, 0x25, 0xA1, 0x22, 0x58, 0x33, 0x54, 0x9A, 0xDB, 0x84, 0x1B, 0x51, 0xC9, 0xB3, 0x17,
+             0x6A, 0x27, 0x2B, 0xDE, 0xBB, 0xA1, 0xD0, 0x78, 0x47, 0x8F, 0x62, 0xB3, 0x97, 0xF3, 0x3C, 0x8D}
+        },
+        {
+            "password",
+            "salt",
+            4096,
+            20,
+            {0xC5, 0xE4, 0x78, 0xD5, 0x92, 0x88, 0xC8, 0x41, 0xAA, 0x53, 0x0D, 0xB6, 0x84, 0x5C, 0x4C, 0x8D,
+             0x96, 0x28, 0x93, 0xA0}
+        },
+        {
+            "passwordPASSWORDpassword" "passwordPASSWORDpassword" "passwordPASSWORDpassword" "passwordPASSWORDpassword"
+            "passwordPASSWORDpassword" "passwordPASSWORDpassword" "passwordPASSWORDpassword" "passwordPASSWORDpassword",
+            "saltSALTsaltSALTsaltSALTsaltSALTsalt",
+            1000,
+            200,
+            {0x18, 0x1F, 0xD4, 0x1F, 0x0C, 0x44, 0x19, 0xD0, 0x40, 0x51, 0xA9, 0x2F, 0x69, 0x23, 0x12, 0x28,
+             0xCE, 0xB3, 0x76, 0xD0, 0x77, 0xBB, 0xE1, 0x8E, 0xA7, 0x84, 0x7C, 0x94, 0xB4, 0x4E, 0xFB, 0xBA,
+             0xBD, 0x9C, 0xEC, 0x63, 0xC3, 0xBA, 0xDF, 0xAF, 0x2C, 0x66, 0x9A, 0x03, 0x24, 0xED, 0x3E, 0x31,
+             0xA7, 0x91, 0xAF, 0xE8, 0x30, 0xA0, 0x30, 0x3D, 0xA1, 0xED, 0x50, 0x0A, 0x00, 0x1F, 0x89, 0xB3,
+             0x1B, 0x6E, 0x9B, 0x64, 0x28, 0x75, 0xC7, 0x84, 0xFE, 0x29, 0x07, 0x7C, 0xBC, 0x49, 0x9B, 0x5D,
+             0xFA, 0xCB, 0x00, 0x59, 0xEF, 0x55, 0xF1, 0x2F, 0xBB, 0x6B, 0x2D, 0xB3, 0x03, 0x1C, 0xDD, 0x3F,
+             0x10, 0x83, 0x3E, 0x98, 0xC3, 0x5F, 0x0B, 0x25, 0x1A, 0x7A, 0x28, 0x39, 0xE9, 0x5A, 0x55, 0x80,
+             0xEF, 0x7A, 0x33, 0x76, 0x23, 0x1F, 0x7A, 0x68, 0xAA, 0xCC, 0xB7, 0x73, 0xAE, 0xA6, 0x55, 0xCD,
+             0x1E, 0x14, 0xC4, 0x46, 0xA3, 0x20, 0x6A, 0x42, 0x95, 0xE8, 0x6D, 0xDC, 0x09, 0xD6, 0x30, 0x46,
+             0xFA, 0x29, 0xDA, 0x51, 0x8A, 0x2E, 0x20, 0x62, 0xA6, 0x17, 0xBC, 0x42, 0x86, 0xDF, 0xE6, 0x67,
+             0x21, 0x79, 0x36, 0x32, 0x15, 0x29, 0x22, 0x22, 0x80, 0x72, 0x20, 0xA9, 0x9C, 0x6B, 0x7F, 0xE4,
+             0x23, 0x68, 0x0B, 0x0C, 0xC1, 0x25, 0xED, 0x4D, 0x79, 0xAF, 0x21, 0xA1, 0x80, 0x3E, 0x28, 0x0F,
+             0xE8, 0xDB, 0x40, 0x5E, 0x21, 0x93, 0xD1, 0x93}
+        }
+    };
+
+    for (const auto& test : pbkdf2_data) {
+        bool ok = true;
+        for (size_t lanes = 1; lanes <= PBKDF2SHA256::MAX_LANES; ++lanes) {
+            uint8_t key[sizeof(test.key)];
+            ok = PBKDF2SHA256::derive(test.password.data(), test.password.size(), test.salt.data(), test.salt.size(),
+                                     test.iterations, key, test.size, lanes) &&
+                 ::memcmp(key, test.key, test.size) == 0 && ok;
+        }
+        std::cout << std::setw(5) << test.iterations << " iterations, " << std::setw(3) << test.size
+                  << " bytes, PBKDF2SHA256: " << (ok ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test HKDF-SHA-256 with RFC 5869 (test cases 1 to 3),
+// using the extract and expand steps, then the one-shot derivation.
+//----------------------------------------------------------------------------
+
+void test_hkdf()
+{
+    struct HKDFTestData {
+        size_t ikm_size;
+        uint8_t ikm[80];
+        size_t salt_size;
+        uint8_t salt[80];
+        size_t info_size;
+        uint8_t info[80];
+        uint8_t prk[HKDFSHA256::PRK_SIZE];
+        size_t okm_size;
+        uint8_t okm[82];
+    };
+    static const HKDFTestData hkdf_data[] = {
+        {
+            22, {0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B,
+                 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B},
+            13, {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C},
+            10, {0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9},
+            {0x07, 0x77, 0x09, 0x36, 0x2C, 0x2E, 0x32, 0xDF, 0x0D, 0xDC, 0x3F, 0x0D, 0xC4, 0x7B, 0xBA, 0x63,
+             0x90, 0xB6, 0xC7, 0x3B, 0xB5, 0x0F, 0x9C, 0x31, 0x22, 0xEC, 0x84, 0x4A, 0xD7, 0xC2, 0xB3, 0xE5},
+            42, {0x3C, 0xB2, 0x5F, 0x25, 0xFA, 0xAC, 0xD5, 0x7A, 0x90, 0x43, 0x4F, 0x64, 0xD0, 0x36, 0x2F, 0x2A,
+                 0x2D, 0x2D, 0x0A, 0x90, 0xCF, 0x1A, 0x5A, 0x4C, 0x5D, 0xB0, 0x2D, 0x56, 0xEC, 0xC4, 0xC5, 0xBF,
+                 0x34, 0x00, 0x72, 0x08, 0xD5, 0xB8, 0x87, 0x18, 0x58, 0x65}
+        },
+        {
+            80, {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+                 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+                 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
+                 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
+                 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F},
+            80, {0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
+                 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,
+                 0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
+                 0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F,
+                 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF},
+            80, {0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+                 0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+                 0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+                 0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
+                 0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF},
+            {0x06, 0xA6, 0xB8, 0x8C, 0x58, 0x53, 0x36, 0x1A, 0x06, 0x10, 0x4C, 0x9C, 0xEB, 0x35, 0xB4, 0x5C,
+             0xEF, 0x76, 0x00, 0x14, 0x90, 0x46, 0x71, 0x01, 0x4A, 0x19, 0x3F, 0x40, 0xC1, 0x5F, 0xC2, 0x44},
+            82, {0xB1, 0x1E, 0x39, 0x8D, 0xC8, 0x03, 0x27, 0xA1, 0xC8, 0xE7, 0xF7, 0x8C, 0x59, 0x6A, 0x49, 0x34,
+                 0x4F, 0x01, 0x2E, 0xDA, 0x2D, 0x4E, 0xFA, 0xD8, 0xA0, 0x50, 0xCC, 0x4C, 0x19, 0xAF, 0xA9, 0x7C,
+                 0x59, 0x04, 0x5A, 0x99, 0xCA, 0xC7, 0x82, 0x72, 0x71, 0xCB, 0x41, 0xC6, 0x5E, 0x59, 0x0E, 0x09,
+                 0xDA, 0x32, 0x75, 0x60, 0x0C, 0x2F, 0x09, 0xB8, 0x36, 0x77, 0x93, 0xA9, 0xAC, 0xA3, 0xDB, 0x71,
+                 0xCC, 0x30, 0xC5, 0x81, 0x79, 0xEC, 0x3E, 0x87, 0xC1, 0x4C, 0x01, 0xD5, 0xC1, 0xF3, 0x43, 0x4F,
+                 0x1D, 0x87}
+        },
+        {
+            22, {0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B,
+                 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B},
+            0, {},
+            0, {},
+            {0x19, 0xEF, 0x24, 0xA3, 0x2C, 0x71, 0x7B, 0x16, 0x7F, 0x33, 0xA9, 0x1D, 0x6F, 0x64, 0x8B, 0xDF,
+             0x96, 0x59, 0x67, 0x76, 0xAF, 0xDB, 0x63, 0x77, 0xAC, 0x43, 0x4C, 0x1C, 0x29, 0x3C, 0xCB, 0x04},
+            42, {0x8D, 0xA4, 0xE7, 0x75, 0xA5, 0x63, 0xC1, 0x8F, 0x71, 0x5F, 0x80, 0x2A, 0x06, 0x3C, 0x5A, 0x31,
+                 0xB8, 0xA1, 0x1F, 0x5C, 0x5E, 0xE1, 0x87, 0x9E, 0xC3, 0x45, 0x4E, 0x5F, 0x3C, 0x73, 0x8D, 0x2D,
+                 0x9D, 0x20, 0x13, 0x95, 0xFA, 0xA4, 0xB6, 0x1A, 0x96, 0xC8}
+        }
+    };
+
+    for (const auto& test : hkdf_data) {
+        uint8_t prk[HKDFSHA256::PRK_SIZE];
+        uint8_t okm1[sizeof(test.okm)];
+        uint8_t okm2[sizeof(test.okm)];
+        HKDFSHA256 hkdf;
+        const bool ok1 = hkdf.extract(test.salt, test.salt_size, test.ikm, test.ikm_size, prk, sizeof(prk)) &&
+                         ::memcmp(prk, test.prk, sizeof(prk)) == 0 &&
+                         hkdf.expand(test.info, test.info_size, okm1, test.okm_size) &&
+                         ::memcmp(okm1, test.okm, test.okm_size) == 0;
+        const bool ok2 = HKDFSHA256::derive(test.salt, test.salt_size, test.ikm, test.ikm_size, test.info, test.info_size, okm2, test.okm_size) &&
+                         ::memcmp(okm2, test.okm, test.okm_size) == 0;
+        std::cout << std::setw(3) << test.okm_size << "-byte output, HKDFSHA256: " << (ok1 && ok2 ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test the SHA-224 variants, on the messages "abc", the 448-bit
+// message of FIPS 180, then 1000 bytes (i * 7).
+//----------------------------------------------------------------------------
+
+template <class HASH>
+bool check_hash(const void* data, size_t size, const uint8_t* expected)
+{
+    uint8_t hash[HASH::HASH_SIZE];
+    size_t retsize = 0;
+    HASH sha;
+    return sha.add(data, size) && sha.getHash(hash, sizeof(hash), &retsize) &&
+           retsize == HASH::HASH_SIZE && ::memcmp(hash, expected, HASH::HASH_SIZE) == 0;
+}
+
+void test_variants()
+{
+    struct VariantTestData {
+        const char* message;  // Null: i * 7
+        size_t size;
+        uint8_t sha224[ArmSHA224::HASH_SIZE];
+    };
+    static const VariantTestData variant_data[] = {
+        {
+            "abc", 3,
+            {0x23, 0x09, 0x7D, 0x22, 0x34, 0x05, 0xD8, 0x22, 0x86, 0x42, 0xA4, 0x77, 0xBD, 0xA2, 0x55, 0xB3,
+             0x2A, 0xAD, 0xBC, 0xE4, 0xBD, 0xA0, 0xB3, 0xF7, 0xE3, 0x6C, 0x9D, 0xA7}
+        },
+        {
+            "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 56,
+            {0x75, 0x38, 0x8B, 0x16, 0x51, 0x27, 0x76, 0xCC, 0x5D, 0xBA, 0x5D, 0xA1, 0xFD, 0x89, 0x01, 0x50,
+             0xB0, 0xC6, 0x45, 0x5C, 0xB4, 0xF5, 0x8B, 0x19, 0x52, 0x52, 0x25, 0x25}
+        },
+        {
+            nullptr, 1000,
+            {0x4C, 0x33, 0x4C, 0xC5, 0xA6, 0x65, 0x46, 0x20, 0x43, 0x12, 0x04, 0x34, 0x78, 0xBD, 0x53, 0xC4,
+             0xDF, 0x71, 0x29, 0x02, 0x0E, 0x5D, 0xBB, 0x41, 0x8D, 0x8F, 0x08, 0x8F}
+        }
+    };
+
+    for (const auto& test : variant_data) {
+        std::string msg(test.message != nullptr ? test.message : "");
+        for (size_t i = 0; test.message == nullptr && i < test.size; ++i) {
+            msg.push_back(char(i * 7));
+        }
+        std::cout << std::setw(5) << test.size << " bytes, ArmSHA224: " << (check_hash<ArmSHA224>(msg.data(), msg.size(), test.sha224) ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test the Merkle tree hashing against a naive sequential computation with the
+// portable SHA256, with various numbers of threads, then after modifications.
+//----------------------------------------------------------------------------
+
+// Naive reference: hash the leaves, then combine the levels until one hash remains.
+std::vector<uint8_t> naive_merkle(const std::vector<uint8_t>& data, size_t leaf_size)
+{
+    std::vector<uint8_t> level;
+    size_t start = 0;
+    do {
+        const uint8_t prefix = 0x00;
+        const size_t size = std::min(leaf_size, data.size() - start);
+        uint8_t hash[SHA256::HASH_SIZE];
+        SHA256 sha;
+        sha.add(&prefix, 1);
+        sha.add(data.data() + start, size);
+        sha.getHash(hash, sizeof(hash));
+        level.insert(level.end(), hash, hash + sizeof(hash));
+        start += size;
+    } while (start < data.size());
+
+    while (level.size() > SHA256::HASH_SIZE) {
+        std::vector<uint8_t> next;
+        for (size_t i = 0; i < level.size(); i += 2 * SHA256::HASH_SIZE) {
+            if (i + SHA256::HASH_SIZE == level.size()) {
+                next.insert(next.end(), level.begin() + i, level.end());
+            }
+            else {
+                const uint8_t prefix = 0x01;
+                uint8_t hash[SHA256::HASH_SIZE];
+                SHA256 sha;
+                sha.add(&prefix, 1);
+                sha.add(&level[i], 2 * SHA256::HASH_SIZE);
+                sha.getHash(hash, sizeof(hash));
+                next.insert(next.end(), hash, hash + sizeof(hash));
+            }
+        }
+        level.swap(next);
+    }
+    return level;
+}
+
+void test_merkle()
+{
+    static const size_t leaf_size = 4096;
+    static const size_t threads[] = {1, 2, 4, 7};
+
+    for (size_t size : {size_t(0), size_t(100), leaf_size, 5 * leaf_size, size_t(1000003)}) {
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = uint8_t(i * 7 + i / 1000);
+        }
+        const std::vector<uint8_t> expected(naive_merkle(data, leaf_size));
+        uint8_t root[MerkleSHA256::HASH_SIZE];
+
+        bool ok = true;
+        MerkleSHA256 tree(leaf_size);
+        for (size_t th : threads) {
+            tree.setThreads(th);
+            ok = tree.hash(data.data(), data.size()) && tree.getRoot(root, sizeof(root)) &&
+                 ::memcmp(root, expected.data(), sizeof(root)) == 0 && ok;
+        }
+
+        // Modify one byte, then a range over several leaves, then nothing.
+        bool update_ok = true;
+        for (size_t len : {size_t(1), 3 * leaf_size + 10, size_t(0)}) {
+            const size_t offset = size / 3;
+            len = std::min(len, size - offset);
+            for (size_t i = offset; i < offset + len; ++i) {
+                data[i] ^= 0x5A;
+            }
+            update_ok = tree.update(data.data(), data.size(), offset, len) && tree.getRoot(root, sizeof(root)) &&
+                        ::memcmp(root, naive_merkle(data, leaf_size).data(), sizeof(root)) == 0 && update_ok;
+        }
+
+        std::cout << std::setw(7) << size << " bytes, " << tree.leafCount() << " leaves, MerkleSHA256: "
+                  << (ok ? "passed" : "FAILED") << ", update: " << (update_ok ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Program entry point.
 //----------------------------------------------------------------------------
@@ -70,6 +508,8 @@ int main(int argc, char* argv[])
     ArmSHA256 arm_sha;
     uint8_t hash[SHA256::HASH_SIZE];
 
+    std::cout << "ArmSHA256 implementation: " << (ArmSHA256::accelerated() ? "Arm64 SHA256 instructions" : "portable") << std::endl;
+
     for (auto test = test_data; test->size > 0; ++test) {
 
         bzero(hash, sizeof(hash));
@@ -90,5 +530,12 @@ int main(int argc, char* argv[])
                   << std::endl;
     }
 
+    test_chunks();
+    test_multi();
+    test_hmac();
+    test_pbkdf2();
+    test_hkdf();
+    test_variants();
+    test_merkle();
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,382 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Implementation of Keccak-f[1600], SHA-3 and SHAKE using the Arm64 SHA3
+// instructions (Armv8.2): EOR3, RAX1, XAR, BCAX.
+//
+//----------------------------------------------------------------------------
+
+#include "ArmSHA3.h"
+#include <arm_neon.h>
+
+// Constants may be used by reference.
+template <class POLICY> const size_t ArmSHA3x2<POLICY>::LANES;
+
+namespace {
+
+    // The 24 rounds of Keccak-f[1600] on 25 lanes, each lane in one NEON register.
+    // Each half of the registers is an independent state. The SHA3 instructions
+    // are designed for Keccak:
+    // - EOR3: 3-way XOR, for the column parities of theta.
+    // - RAX1: rotate by one and XOR, for the theta effect D[x] = C[x-1] ^ ROL(C[x+1], 1).
+    // - XAR:  XOR and rotate, for theta, rho and pi in one instruction per lane.
+    // - BCAX: bit clear and XOR, for chi.
+    inline __attribute__((always_inline)) TARGET_SHA3 void keccakRounds(uint64x2_t* A)
+    {
+        uint64x2_t B[Keccak::LANES], C[5], D[5];
+
+        for (size_t round = 0; round < Keccak::ROUNDS; ++round) {
+            // Theta
+            C[0] = veor3q_u64(veor3q_u64(A[0], A[5], A[10]), A[15], A[20]);
+            C[1] = veor3q_u64(veor3q_u64(A[1], A[6], A[11]), A[16], A[21]);
+            C[2] = veor3q_u64(veor3q_u64(A[2], A[7], A[12]), A[17], A[22]);
+            C[3] = veor3q_u64(veor3q_u64(A[3], A[8], A[13]), A[18], A[23]);
+            C[4] = veor3q_u64(veor3q_u64(A[4], A[9], A[14]), A[19], A[24]);
+            D[0] = vrax1q_u64(C[4], C[1]);
+            D[1] = vrax1q_u64(C[0], C[2]);
+            D[2] = vrax1q_u64(C[1], C[3]);
+            D[3] = vrax1q_u64(C[2], C[4]);
+            D[4] = vrax1q_u64(C[3], C[0]);
+
+            // Theta (end), rho and pi: XAR rotates right, by 64 minus the rho offset.
+            B[ 0] = veorq_u64(A[ 0], D[0]);
+            B[10] = vxarq_u64(A[ 1], D[1], 63);
+            B[20] = vxarq_u64(A[ 2], D[2],  2);
+            B[ 5] = vxarq_u64(A[ 3], D[3], 36);
+            B[15] = vxarq_u64(A[ 4], D[4], 37);
+            B[16] = vxarq_u64(A[ 5], D[0], 28);
+            B[ 1] = vxarq_u64(A[ 6], D[1], 20);
+            B[11] = vxarq_u64(A[ 7], D[2], 58);
+            B[21] = vxarq_u64(A[ 8], D[3],  9);
+            B[ 6] = vxarq_u64(A[ 9], D[4], 44);
+            B[ 7] = vxarq_u64(A[10], D[0], 61);
+            B[17] = vxarq_u64(A[11], D[1], 54);
+            B[ 2] = vxarq_u64(A[12], D[2], 21);
+            B[12] = vxarq_u64(A[13], D[3], 39);
+            B[22] = vxarq_u64(A[14], D[4], 25);
+            B[23] = vxarq_u64(A[15], D[0], 23);
+            B[ 8] = vxarq_u64(A[16], D[1], 19);
+            B[18] = vxarq_u64(A[17], D[2], 49);
+            B[ 3] = vxarq_u64(A[18], D[3], 43);
+            B[13] = vxarq_u64(A[19], D[4], 56);
+            B[14] = vxarq_u64(A[20], D[0], 46);
+            B[24] = vxarq_u64(A[21], D[1], 62);
+            B[ 9] = vxarq_u64(A[22], D[2],  3);
+            B[19] = vxarq_u64(A[23], D[3],  8);
+            B[ 4] = vxarq_u64(A[24], D[4], 50);
+
+            // Chi: A[x] = B[x] ^ (~B[x+1] & B[x+2]), on each row.
+            for (size_t y = 0; y < Keccak::LANES; y += 5) {
+                A[y + 0] = vbcaxq_u64(B[y + 0], B[y + 2], B[y + 1]);
+                A[y + 1] = vbcaxq_u64(B[y + 1], B[y + 3], B[y + 2]);
+                A[y + 2] = vbcaxq_u64(B[y + 2], B[y + 4], B[y + 3]);
+                A[y + 3] = vbcaxq_u64(B[y + 3], B[y + 0], B[y + 4]);
+                A[y + 4] = vbcaxq_u64(B[y + 4], B[y + 1], B[y + 0]);
+            }
+
+            // Iota
+            A[0] = veorq_u64(A[0], vdupq_n_u64(Keccak::RC[round]));
+        }
+    }
+
+    // XOR one block (rate bytes) into the lanes of a state. Assume a little-endian CPU.
+    inline void absorbBlock(uint64_t* state, const uint8_t* block, size_t rate)
+    {
+        for (size_t i = 0; i < rate / 8; ++i) {
+            uint64_t w;
+            ::memcpy(&w, block + 8 * i, sizeof(w));
+            state[i] ^= w;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check if the SHA3 instructions are present.
+//----------------------------------------------------------------------------
+
+bool ArmKeccak::accelerated()
+{
+    static const bool accel = HasCPUFeatures(CPU_SHA3);
+    return accel;
+}
+
+
+//----------------------------------------------------------------------------
+// Keccak-f[1600] permutation on one or two states.
+//----------------------------------------------------------------------------
+
+TARGET_SHA3 void ArmKeccak::permuteArm(uint64_t* state)
+{
+    uint64x2_t A[Keccak::LANES];
+    for (size_t i = 0; i < Keccak::LANES; ++i) {
+        A[i] = vdupq_n_u64(state[i]);
+    }
+    keccakRounds(A);
+    for (size_t i = 0; i < Keccak::LANES; ++i) {
+        state[i] = vgetq_lane_u64(A[i], 0);
+    }
+}
+
+TARGET_SHA3 void ArmKeccak::permuteArm2(uint64_t* state0, uint64_t* state1)
+{
+    uint64x2_t A[Keccak::LANES];
+    for (size_t i = 0; i < Keccak::LANES; ++i) {
+        A[i] = vcombine_u64(vcreate_u64(state0[i]), vcreate_u64(state1[i]));
+    }
+    keccakRounds(A);
+    for (size_t i = 0; i < Keccak::LANES; ++i) {
+        state0[i] = vgetq_lane_u64(A[i], 0);
+        state1[i] = vgetq_lane_u64(A[i], 1);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// SHA-3 and SHAKE, same as SHA3Family with a selected permutation.
+//----------------------------------------------------------------------------
+
+template <class POLICY>
+ArmSHA3Family<POLICY>::ArmSHA3Family() :
+    _curlen(0),
+    _squeezing(false),
+    _permute(ArmKeccak::accelerated() ? ArmKeccak::permuteArm : Keccak::permute)
+{
+    init();
+}
+
+template <class POLICY>
+bool ArmSHA3Family<POLICY>::init()
+{
+    bzero(_state, sizeof(_state));
+    _curlen = 0;
+    _squeezing = false;
+    return true;
+}
+
+template <class POLICY>
+bool ArmSHA3Family<POLICY>::add(const void* data, size_t size)
+{
+    // Filter invalid internal state.
+    if (_squeezing || _curlen >= sizeof(_buf)) {
+        return false;
+    }
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
+    while (size > 0) {
+        if (_curlen == 0 && size >= BLOCK_SIZE) {
+            // Absorb one block directly from user's buffer.
+            absorbBlock(_state, in, BLOCK_SIZE);
+            _permute(_state);
+            in += BLOCK_SIZE;
+            size -= BLOCK_SIZE;
+        }
+        else {
+            // Partial block, Accumulate input data in internal buffer.
+            size_t n = std::min(size, (BLOCK_SIZE - _curlen));
+            ::memcpy(_buf + _curlen, in, n);
+            _curlen += n;
+            in += n;
+            size -= n;
+            if (_curlen == BLOCK_SIZE) {
+                absorbBlock(_state, _buf, BLOCK_SIZE);
+                _permute(_state);
+                _curlen = 0;
+            }
+        }
+    }
+    return true;
+}
+
+template <class POLICY>
+bool ArmSHA3Family<POLICY>::getHash(void* hash, size_t bufsize, size_t* retsize)
+{
+    if (_squeezing || bufsize < HASH_SIZE || !squeeze(hash, HASH_SIZE)) {
+        return false;
+    }
+    if (retsize != nullptr) {
+        *retsize = HASH_SIZE;
+    }
+    return true;
+}
+
+template <class POLICY>
+bool ArmSHA3Family<POLICY>::squeeze(void* out, size_t size)
+{
+    // Filter invalid internal state.
+    if (_curlen > sizeof(_buf)) {
+        return false;
+    }
+
+    // On first call, pad the last block: domain bits and first '1' bit, zeroes, final '1' bit.
+    if (!_squeezing) {
+        bzero(_buf + _curlen, BLOCK_SIZE - _curlen);
+        _buf[_curlen] = POLICY::DOMAIN;
+        _buf[BLOCK_SIZE - 1] |= 0x80;
+        absorbBlock(_state, _buf, BLOCK_SIZE);
+        _permute(_state);
+        _curlen = 0;
+        _squeezing = true;
+    }
+
+    uint8_t* data = reinterpret_cast<uint8_t*>(out);
+    while (size > 0) {
+        if (_curlen == BLOCK_SIZE) {
+            _permute(_state);
+            _curlen = 0;
+        }
+        const size_t n = std::min(size, BLOCK_SIZE - _curlen);
+        ::memcpy(data, reinterpret_cast<const uint8_t*>(_state) + _curlen, n);
+        _curlen += n;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Two-way SHA-3 and SHAKE.
+//----------------------------------------------------------------------------
+
+template <class POLICY>
+ArmSHA3x2<POLICY>::ArmSHA3x2() :
+    _squeezing(false)
+{
+    init();
+}
+
+template <class POLICY>
+bool ArmSHA3x2<POLICY>::init()
+{
+    bzero(_state, sizeof(_state));
+    bzero(_curlen, sizeof(_curlen));
+    _squeezing = false;
+    return true;
+}
+
+// Permute the non-null states, in the same loop when there are two of them.
+template <class POLICY>
+void ArmSHA3x2<POLICY>::permute(uint64_t* state0, uint64_t* state1)
+{
+    if (state0 != nullptr && state1 != nullptr && ArmKeccak::accelerated()) {
+        ArmKeccak::permuteArm2(state0, state1);
+    }
+    else {
+        for (uint64_t* state : {state0, state1}) {
+            if (state != nullptr) {
+                if (ArmKeccak::accelerated()) {
+                    ArmKeccak::permuteArm(state);
+                }
+                else {
+                    Keccak::permute(state);
+                }
+            }
+        }
+    }
+}
+
+template <class POLICY>
+bool ArmSHA3x2<POLICY>::add(const void* const* data, const size_t* sizes)
+{
+    // Filter invalid internal state.
+    if (_squeezing || _curlen[0] >= BLOCK_SIZE || _curlen[1] >= BLOCK_SIZE) {
+        return false;
+    }
+
+    const uint8_t* in[LANES];
+    size_t size[LANES];
+    for (size_t l = 0; l < LANES; ++l) {
+        in[l] = reinterpret_cast<const uint8_t*>(data[l]);
+        size[l] = sizes[l];
+    }
+
+    // In each iteration, absorb one complete block per lane, when available.
+    for (;;) {
+        uint64_t* states[LANES] = {nullptr, nullptr};
+        for (size_t l = 0; l < LANES; ++l) {
+            if (_curlen[l] == 0 && size[l] >= BLOCK_SIZE) {
+                // Absorb one block directly from user's buffer.
+                absorbBlock(_state[l], in[l], BLOCK_SIZE);
+                states[l] = _state[l];
+                in[l] += BLOCK_SIZE;
+                size[l] -= BLOCK_SIZE;
+            }
+            else if (size[l] > 0) {
+                // Partial block, accumulate input data in internal buffer.
+                const size_t n = std::min(size[l], BLOCK_SIZE - _curlen[l]);
+                ::memcpy(_buf[l] + _curlen[l], in[l], n);
+                _curlen[l] += n;
+                in[l] += n;
+                size[l] -= n;
+                if (_curlen[l] == BLOCK_SIZE) {
+                    absorbBlock(_state[l], _buf[l], BLOCK_SIZE);
+                    states[l] = _state[l];
+                    _curlen[l] = 0;
+                }
+            }
+        }
+        if (states[0] == nullptr && states[1] == nullptr) {
+            break;
+        }
+        permute(states[0], states[1]);
+    }
+    return true;
+}
+
+template <class POLICY>
+bool ArmSHA3x2<POLICY>::getHash(void* const* hashes, size_t bufsize)
+{
+    return !_squeezing && bufsize >= HASH_SIZE && squeeze(hashes, HASH_SIZE);
+}
+
+template <class POLICY>
+bool ArmSHA3x2<POLICY>::squeeze(void* const* out, size_t size)
+{
+    // Filter invalid internal state.
+    if (_curlen[0] > BLOCK_SIZE || _curlen[1] > BLOCK_SIZE) {
+        return false;
+    }
+
+    // On first call, pad the last block of each lane, then permute both states.
+    if (!_squeezing) {
+        for (size_t l = 0; l < LANES; ++l) {
+            bzero(_buf[l] + _curlen[l], BLOCK_SIZE - _curlen[l]);
+            _buf[l][_curlen[l]] = POLICY::DOMAIN;
+            _buf[l][BLOCK_SIZE - 1] |= 0x80;
+            absorbBlock(_state[l], _buf[l], BLOCK_SIZE);
+            _curlen[l] = 0;
+        }
+        permute(_state[0], _state[1]);
+        _squeezing = true;
+    }
+
+    // Both lanes squeeze the same number of bytes, _curlen[0] == _curlen[1].
+    size_t done = 0;
+    while (done < size) {
+        if (_curlen[0] == BLOCK_SIZE) {
+            permute(_state[0], _state[1]);
+            _curlen[0] = _curlen[1] = 0;
+        }
+        const size_t n = std::min(size - done, BLOCK_SIZE - _curlen[0]);
+        for (size_t l = 0; l < LANES; ++l) {
+            ::memcpy(reinterpret_cast<uint8_t*>(out[l]) + done, reinterpret_cast<const uint8_t*>(_state[l]) + _curlen[l], n);
+            _curlen[l] += n;
+        }
+        done += n;
+    }
+    return true;
+}
+
+template class ArmSHA3Family<SHA3_256Policy>;
+template class ArmSHA3Family<SHA3_512Policy>;
+template class ArmSHA3Family<SHAKE128Policy>;
+template class ArmSHA3Family<SHAKE256Policy>;
+
+template class ArmSHA3x2<SHA3_256Policy>;
+template class ArmSHA3x2<SHA3_512Policy>;
+template class ArmSHA3x2<SHAKE128Policy>;
+template class ArmSHA3x2<SHAKE256Policy>;
@@ -0,0 +1,98 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Implementation of Keccak-f[1600], SHA-3 and SHAKE using the Arm64 SHA3
+// instructions (Armv8.2): EOR3, RAX1, XAR, BCAX.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "SHA3.h"
+
+// Keccak-f[1600] permutation using the SHA3 instructions.
+class ArmKeccak
+{
+public:
+    // Check if the SHA3 instructions are present, detected once at run time.
+    // When they are not, the portable permutation of class Keccak is used.
+    static bool accelerated();
+
+    // Permute one state (25 lanes of 64 bits), using the low half of the NEON registers.
+    static void permuteArm(uint64_t* state) TARGET_SHA3;
+
+    // Permute two independent states in the same loop, one per half of the NEON registers.
+    static void permuteArm2(uint64_t* state0, uint64_t* state1) TARGET_SHA3;
+};
+
+// SHA-3 and SHAKE hash computation, same interface as SHA3Family.
+template <class POLICY>
+class ArmSHA3Family
+{
+public:
+    static const size_t HASH_SIZE  = POLICY::HASH_SIZE;
+    static const size_t BLOCK_SIZE = POLICY::RATE;
+
+    ArmSHA3Family();
+    bool init();
+    bool add(const void* data, size_t size);
+    bool getHash(void* hash, size_t bufsize, size_t* retsize = nullptr);
+    bool squeeze(void* out, size_t size);
+
+private:
+    typedef void (*PermuteFunction)(uint64_t* state);
+
+    uint64_t _state[Keccak::LANES];
+    size_t   _curlen;     // Used bytes in _buf, or bytes already read in the state when squeezing
+    bool     _squeezing;  // Padding done, no more input
+    uint8_t  _buf[BLOCK_SIZE];
+
+    // The permutation is selected once, using the SHA3 instructions when present.
+    PermuteFunction _permute;
+};
+
+typedef ArmSHA3Family<SHA3_256Policy> ArmSHA3_256;
+typedef ArmSHA3Family<SHA3_512Policy> ArmSHA3_512;
+typedef ArmSHA3Family<SHAKE128Policy> ArmSHAKE128;
+typedef ArmSHA3Family<SHAKE256Policy> ArmSHAKE256;
+
+// Two-way SHA-3 or SHAKE: two independent hashes (lanes) in the same object.
+// Each lane has the same semantics as an ArmSHA3Family instance. When both lanes
+// have a complete block to absorb, or are squeezing, the two states are permuted
+// in the same loop, one per half of the NEON registers.
+template <class POLICY>
+class ArmSHA3x2
+{
+public:
+    static const size_t HASH_SIZE  = POLICY::HASH_SIZE;
+    static const size_t BLOCK_SIZE = POLICY::RATE;
+    static const size_t LANES      = 2;
+
+    ArmSHA3x2();
+    bool init();
+
+    // Add data[i] (sizes[i] bytes) in lane i, for each lane.
+    bool add(const void* const* data, const size_t* sizes);
+
+    // Get the hash of lane i in hashes[i], for each lane, each buffer with bufsize bytes.
+    bool getHash(void* const* hashes, size_t bufsize);
+
+    // Get the next 'size' bytes of output of lane i in out[i], for each lane (SHAKE).
+    bool squeeze(void* const* out, size_t size);
+
+private:
+    uint64_t _state[LANES][Keccak::LANES];
+    size_t   _curlen[LANES];
+    bool     _squeezing;
+    uint8_t  _buf[LANES][BLOCK_SIZE];
+
+    // Permute the states with a non-null pointer.
+    static void permute(uint64_t* state0, uint64_t* state1);
+};
+
+typedef ArmSHA3x2<SHA3_256Policy> ArmSHA3_256x2;
+typedef ArmSHA3x2<SHA3_512Policy> ArmSHA3_512x2;
+typedef ArmSHA3x2<SHAKE128Policy> ArmSHAKE128x2;
+typedef ArmSHA3x2<SHAKE256Policy> ArmSHAKE256x2;
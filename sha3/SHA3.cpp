@@ -0,0 +1,204 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Portable implementation of Keccak-f[1600], SHA-3 and SHAKE (FIPS 202).
+//
+//----------------------------------------------------------------------------
+
+#include "SHA3.h"
+
+// Constants may be used by reference.
+const size_t Keccak::LANES;
+const size_t Keccak::ROUNDS;
+
+const uint64_t Keccak::RC[ROUNDS] = {
+    TS_UCONST64(0x0000000000000001), TS_UCONST64(0x0000000000008082),
+    TS_UCONST64(0x800000000000808A), TS_UCONST64(0x8000000080008000),
+    TS_UCONST64(0x000000000000808B), TS_UCONST64(0x0000000080000001),
+    TS_UCONST64(0x8000000080008081), TS_UCONST64(0x8000000000008009),
+    TS_UCONST64(0x000000000000008A), TS_UCONST64(0x0000000000000088),
+    TS_UCONST64(0x0000000080008009), TS_UCONST64(0x000000008000000A),
+    TS_UCONST64(0x000000008000808B), TS_UCONST64(0x800000000000008B),
+    TS_UCONST64(0x8000000000008089), TS_UCONST64(0x8000000000008003),
+    TS_UCONST64(0x8000000000008002), TS_UCONST64(0x8000000000000080),
+    TS_UCONST64(0x000000000000800A), TS_UCONST64(0x800000008000000A),
+    TS_UCONST64(0x8000000080008081), TS_UCONST64(0x8000000000008080),
+    TS_UCONST64(0x0000000080000001), TS_UCONST64(0x8000000080008008),
+};
+
+namespace {
+    // Rotation offsets of the rho step, for lane x + 5 * y.
+    const int RHO[Keccak::LANES] = {
+         0,  1, 62, 28, 27,
+        36, 44,  6, 55, 20,
+         3, 10, 43, 25, 39,
+        41, 45, 15, 21,  8,
+        18,  2, 61, 56, 14,
+    };
+
+    inline __attribute__((always_inline)) uint64_t ROL64(uint64_t x, int n)
+    {
+        return n == 0 ? x : (x << n) | (x >> (64 - n));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Keccak-f[1600] permutation.
+//----------------------------------------------------------------------------
+
+void Keccak::permute(uint64_t* a)
+{
+    uint64_t b[LANES], c[5], d[5];
+
+    for (size_t round = 0; round < ROUNDS; ++round) {
+        // Theta
+        for (size_t x = 0; x < 5; ++x) {
+            c[x] = a[x] ^ a[x + 5] ^ a[x + 10] ^ a[x + 15] ^ a[x + 20];
+        }
+        for (size_t x = 0; x < 5; ++x) {
+            d[x] = c[(x + 4) % 5] ^ ROL64(c[(x + 1) % 5], 1);
+        }
+        // Rho and pi: lane (x, y) moves to (y, 2x + 3y).
+        for (size_t y = 0; y < 5; ++y) {
+            for (size_t x = 0; x < 5; ++x) {
+                b[y + 5 * ((2 * x + 3 * y) % 5)] = ROL64(a[x + 5 * y] ^ d[x], RHO[x + 5 * y]);
+            }
+        }
+        // Chi
+        for (size_t y = 0; y < 25; y += 5) {
+            for (size_t x = 0; x < 5; ++x) {
+                a[y + x] = b[y + x] ^ (~b[y + (x + 1) % 5] & b[y + (x + 2) % 5]);
+            }
+        }
+        // Iota
+        a[0] ^= RC[round];
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+template <class POLICY>
+SHA3Family<POLICY>::SHA3Family() :
+    _curlen(0),
+    _squeezing(false)
+{
+    init();
+}
+
+
+//----------------------------------------------------------------------------
+// Reinitialize the computation of the hash.
+//----------------------------------------------------------------------------
+
+template <class POLICY>
+bool SHA3Family<POLICY>::init()
+{
+    bzero(_state, sizeof(_state));
+    _curlen = 0;
+    _squeezing = false;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Add some part of the message to hash. Can be called several times.
+//----------------------------------------------------------------------------
+
+template <class POLICY>
+bool SHA3Family<POLICY>::add(const void* data, size_t size)
+{
+    // Filter invalid internal state.
+    if (_squeezing || _curlen >= sizeof(_buf)) {
+        return false;
+    }
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
+    while (size > 0) {
+        if (_curlen == 0 && size >= BLOCK_SIZE) {
+            // Absorb one block directly from user's buffer.
+            for (size_t i = 0; i < BLOCK_SIZE / 8; ++i) {
+                uint64_t w;
+                ::memcpy(&w, in + 8 * i, sizeof(w));
+                _state[i] ^= w;
+            }
+            Keccak::permute(_state);
+            in += BLOCK_SIZE;
+            size -= BLOCK_SIZE;
+        }
+        else {
+            // Partial block, Accumulate input data in internal buffer.
+            size_t n = std::min(size, (BLOCK_SIZE - _curlen));
+            ::memcpy(_buf + _curlen, in, n);
+            _curlen += n;
+            in += n;
+            size -= n;
+            if (_curlen == BLOCK_SIZE) {
+                _curlen = 0;
+                add(_buf, BLOCK_SIZE);
+            }
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the resulting hash value or the next bytes of output.
+//----------------------------------------------------------------------------
+
+template <class POLICY>
+bool SHA3Family<POLICY>::getHash(void* hash, size_t bufsize, size_t* retsize)
+{
+    if (_squeezing || bufsize < HASH_SIZE || !squeeze(hash, HASH_SIZE)) {
+        return false;
+    }
+    if (retsize != nullptr) {
+        *retsize = HASH_SIZE;
+    }
+    return true;
+}
+
+template <class POLICY>
+bool SHA3Family<POLICY>::squeeze(void* out, size_t size)
+{
+    // Filter invalid internal state.
+    if (_curlen > sizeof(_buf)) {
+        return false;
+    }
+
+    // On first call, pad the last block: domain bits and first '1' bit, zeroes, final '1' bit.
+    if (!_squeezing) {
+        bzero(_buf + _curlen, BLOCK_SIZE - _curlen);
+        _buf[_curlen] = POLICY::DOMAIN;
+        _buf[BLOCK_SIZE - 1] |= 0x80;
+        _curlen = 0;
+        add(_buf, BLOCK_SIZE);
+        _squeezing = true;
+    }
+
+    uint8_t* data = reinterpret_cast<uint8_t*>(out);
+    while (size > 0) {
+        if (_curlen == BLOCK_SIZE) {
+            Keccak::permute(_state);
+            _curlen = 0;
+        }
+        const size_t n = std::min(size, BLOCK_SIZE - _curlen);
+        ::memcpy(data, reinterpret_cast<const uint8_t*>(_state) + _curlen, n);
+        _curlen += n;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+template class SHA3Family<SHA3_256Policy>;
+template class SHA3Family<SHA3_512Policy>;
+template class SHA3Family<SHAKE128Policy>;
+template class SHA3Family<SHAKE256Policy>;
@@ -0,0 +1,85 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Portable implementation of Keccak-f[1600], SHA-3 and SHAKE (FIPS 202).
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "platform.h"
+
+// Parameters of the Keccak-based functions: rate (bytes which are absorbed or
+// squeezed per permutation), domain separation bits with the first padding bit,
+// hash size or, for SHAKE, default output size of getHash().
+struct SHA3_256Policy
+{
+    static const size_t  RATE = 136;
+    static const uint8_t DOMAIN = 0x06;
+    static const size_t  HASH_SIZE = 32;
+};
+
+struct SHA3_512Policy
+{
+    static const size_t  RATE = 72;
+    static const uint8_t DOMAIN = 0x06;
+    static const size_t  HASH_SIZE = 64;
+};
+
+struct SHAKE128Policy
+{
+    static const size_t  RATE = 168;
+    static const uint8_t DOMAIN = 0x1F;
+    static const size_t  HASH_SIZE = 32;
+};
+
+struct SHAKE256Policy
+{
+    static const size_t  RATE = 136;
+    static const uint8_t DOMAIN = 0x1F;
+    static const size_t  HASH_SIZE = 64;
+};
+
+// Keccak-f[1600] permutation. The state is made of 25 lanes of 64 bits, lane (x, y) is at index x + 5 * y.
+class Keccak
+{
+public:
+    static const size_t LANES = 25;   //!< State size in 64-bit lanes.
+    static const size_t ROUNDS = 24;  //!< Number of rounds.
+    static const uint64_t RC[ROUNDS]; //!< Round constants.
+
+    static void permute(uint64_t* state);
+};
+
+// SHA-3 and SHAKE. Assume a little-endian CPU: the bytes of the message are XOR'ed
+// into the lanes of the state and the output bytes are read from the lanes in memory.
+template <class POLICY>
+class SHA3Family
+{
+public:
+    static const size_t HASH_SIZE  = POLICY::HASH_SIZE;  //!< Hash size in bytes (default output size of SHAKE).
+    static const size_t BLOCK_SIZE = POLICY::RATE;       //!< Rate in bytes.
+
+    SHA3Family();
+    bool init();
+    bool add(const void* data, size_t size);
+    bool getHash(void* hash, size_t bufsize, size_t* retsize = nullptr);
+
+    // Extendable output (SHAKE): get the next 'size' bytes of output, can be called several
+    // times. No more data can be added after the first call. getHash() is the same as the
+    // first squeeze() of HASH_SIZE bytes.
+    bool squeeze(void* out, size_t size);
+
+private:
+    uint64_t _state[Keccak::LANES];
+    size_t   _curlen;     // Used bytes in _buf, or bytes already read in the state when squeezing
+    bool     _squeezing;  // Padding done, no more input
+    uint8_t  _buf[BLOCK_SIZE];
+};
+
+typedef SHA3Family<SHA3_256Policy> SHA3_256;
+typedef SHA3Family<SHA3_512Policy> SHA3_512;
+typedef SHA3Family<SHAKE128Policy> SHAKE128;
+typedef SHA3Family<SHAKE256Policy> SHAKE256;
@@ -0,0 +1,208 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Comparative performance test on SHA-3 and SHAKE (portable vs. Arm64 instructions).
+// Specify the number of iterations on the command line.
+//
+//----------------------------------------------------------------------------
+
+#include "SHA3.h"
+#include "ArmSHA3.h"
+#include <ios>
+#include <iomanip>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <sys/resource.h>
+
+#define DEFAULT_ITERATIONS 1000000
+
+static const uint8_t test_data[256] = {
+    0x8F, 0xAA, 0xF6, 0x60, 0x79, 0x8C, 0x25, 0x3A, 0xF7, 0x51, 0x5D, 0x80, 0x8B, 0x3F, 0x7D, 0x71,
+    0xAF, 0x18, 0xD8, 0x15, 0x57, 0x97, 0xD9, 0xFB, 0x89, 0x94, 0x4A, 0x46, 0x87, 0x4A, 0xF1, 0x16,
+    0xF0, 0xA8, 0x93, 0x25, 0xB0, 0x90, 0xE0, 0x19, 0xDD, 0x2F, 0xA1, 0x6B, 0x7D, 0xB0, 0x6D, 0x4D,
+    0xE8, 0x2F, 0x3F, 0x0B, 0x1A, 0x71, 0x03, 0x13, 0xE3, 0xB8, 0x37, 0xBA, 0x2C, 0xA4, 0x07, 0xB4,
+    0xBD, 0x94, 0xFE, 0xDC, 0x17, 0xE0, 0xA6, 0x1A, 0xAB, 0x11, 0x9A, 0x0A, 0x77, 0xCE, 0x5E, 0x0E,
+    0xE8, 0xD1, 0x37, 0x72, 0xAC, 0x8C, 0x46, 0x03, 0xE5, 0x24, 0x09, 0x9E, 0x63, 0xB4, 0x2B, 0x01,
+    0x74, 0xE3, 0x3D, 0xB7, 0xAB, 0x72, 0xFF, 0x88, 0x04, 0x96, 0xF1, 0x17, 0xDC, 0x55, 0x55, 0x77,
+    0x10, 0xFA, 0x3C, 0x38, 0xEE, 0x97, 0x60, 0xA1, 0x12, 0xD6, 0x1E, 0xCA, 0x8E, 0x01, 0xD1, 0xA2,
+    0x2F, 0x5B, 0xE2, 0xD6, 0x83, 0x9F, 0x26, 0xD9, 0x03, 0xCE, 0xE8, 0xE1, 0x98, 0xE3, 0xF0, 0x4C,
+    0xE3, 0x0A, 0x7B, 0x05, 0x88, 0x1C, 0x63, 0x38, 0xB0, 0xAE, 0x94, 0xD1, 0xF2, 0x7F, 0x9C, 0x4B,
+    0x55, 0x27, 0x6D, 0x34, 0x8F, 0x1A, 0x6D, 0x87, 0xD8, 0xBF, 0x2C, 0x15, 0xD1, 0xD7, 0x69, 0x37,
+    0x19, 0xB2, 0xA1, 0x8D, 0xB4, 0xEE, 0xDB, 0x1F, 0xA7, 0xCE, 0xD2, 0x53, 0x14, 0x5E, 0x43, 0x90,
+    0xDB, 0x39, 0x1A, 0xB9, 0xA8, 0x33, 0x02, 0x45, 0x24, 0x66, 0xED, 0xE0, 0xD9, 0x35, 0xC0, 0xA3,
+    0x8A, 0x76, 0x98, 0x16, 0x38, 0x3D, 0x6D, 0x77, 0xC4, 0x5D, 0x91, 0x41, 0xEF, 0x8B, 0x5F, 0x62,
+    0x58, 0xD5, 0xB7, 0xB0, 0x1E, 0x49, 0xC7, 0x3E, 0x8B, 0x05, 0xB4, 0x34, 0xBD, 0x49, 0xA1, 0x3E,
+    0x04, 0x10, 0x3F, 0xC1, 0x52, 0x5B, 0xD3, 0x24, 0xDB, 0xEB, 0x4D, 0x5A, 0x16, 0x57, 0x79, 0x8B,
+};
+
+
+//----------------------------------------------------------------------------
+// Get the CPU time in milliseconds in user space since the process started.
+//----------------------------------------------------------------------------
+
+uint64_t get_user_ms()
+{
+    ::rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) < 0) {
+        perror("getrusage");
+        ::exit(EXIT_FAILURE);
+    }
+    return uint64_t(usage.ru_utime.tv_sec) * 1000 + uint64_t(usage.ru_utime.tv_usec) / 1000;
+}
+
+
+//----------------------------------------------------------------------------
+// Number of messages per second, for a given time in milliseconds.
+//----------------------------------------------------------------------------
+
+uint64_t get_per_second(uint64_t count, uint64_t ms)
+{
+    return ms > 0 ? count * 1000 / ms : 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Throughput in MB/s of one hash class on a total number of bytes.
+//----------------------------------------------------------------------------
+
+template <class HASH>
+uint64_t get_mbps(uint64_t total_bytes, std::vector<uint8_t>& hash)
+{
+    const uint64_t loops = std::max<uint64_t>(1, total_bytes / sizeof(test_data));
+    HASH sha;
+    hash.resize(HASH::HASH_SIZE);
+    const uint64_t start = get_user_ms();
+    for (uint64_t n = 0; n < loops; ++n) {
+        sha.add(test_data, sizeof(test_data));
+    }
+    sha.getHash(hash.data(), hash.size());
+    const uint64_t ms = get_user_ms() - start;
+    return ms > 0 ? loops * sizeof(test_data) / (ms * 1000) : 0;
+}
+
+template <class HASH, class ARMHASH>
+void perf_variant(const char* name, uint64_t total_bytes)
+{
+    std::vector<uint8_t> hash;
+    std::vector<uint8_t> arm_hash;
+    const uint64_t mbps = get_mbps<HASH>(total_bytes, hash);
+    const uint64_t arm_mbps = get_mbps<ARMHASH>(total_bytes, arm_hash);
+    std::cout << "  " << std::setw(8) << name << ": " << mbps << " / " << arm_mbps << " MB/s"
+              << (hash == arm_hash ? "" : " (INVALID HASH)") << std::endl;
+}
+
+void perf_variants(uint64_t total_bytes)
+{
+    std::cout << std::endl << "Throughput, portable / Arm64" << std::endl;
+    perf_variant<SHA3_256, ArmSHA3_256>("SHA3_256", total_bytes);
+    perf_variant<SHA3_512, ArmSHA3_512>("SHA3_512", total_bytes);
+    perf_variant<SHAKE128, ArmSHAKE128>("SHAKE128", total_bytes);
+    perf_variant<SHAKE256, ArmSHAKE256>("SHAKE256", total_bytes);
+}
+
+
+//----------------------------------------------------------------------------
+// Hash independent messages, one by one or two at a time with ArmSHA3_256x2.
+//----------------------------------------------------------------------------
+
+void perf_x2(uint64_t total_bytes)
+{
+    static const size_t batch = 1024;  // messages per loop, multiple of 2
+
+    std::cout << std::endl << "Independent messages, messages/second, ArmSHA3_256 one by one / ArmSHA3_256x2" << std::endl;
+    for (size_t size : {256, 1024, 8192}) {
+        // Independent messages in one buffer.
+        std::vector<uint8_t> data(batch * size);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = test_data[i % sizeof(test_data)] ^ uint8_t(i / size);
+        }
+        std::vector<uint8_t> hashes1(batch * ArmSHA3_256::HASH_SIZE);
+        std::vector<uint8_t> hashes2(hashes1.size());
+        const uint64_t loops = std::max<uint64_t>(1, total_bytes / data.size());
+        const uint64_t count = loops * batch;
+
+        ArmSHA3_256 sha;
+        uint64_t start = get_user_ms();
+        for (uint64_t n = 0; n < loops; ++n) {
+            for (size_t i = 0; i < batch; ++i) {
+                sha.init();
+                sha.add(&data[i * size], size);
+                sha.getHash(&hashes1[i * ArmSHA3_256::HASH_SIZE], ArmSHA3_256::HASH_SIZE);
+            }
+        }
+        const uint64_t time1 = get_user_ms() - start;
+
+        ArmSHA3_256x2 sha2;
+        const size_t sizes[2] = {size, size};
+        start = get_user_ms();
+        for (uint64_t n = 0; n < loops; ++n) {
+            for (size_t i = 0; i < batch; i += 2) {
+                const void* in[2] = {&data[i * size], &data[(i + 1) * size]};
+                void* out[2] = {&hashes2[i * ArmSHA3_256::HASH_SIZE], &hashes2[(i + 1) * ArmSHA3_256::HASH_SIZE]};
+                sha2.init();
+                sha2.add(in, sizes);
+                sha2.getHash(out, ArmSHA3_256::HASH_SIZE);
+            }
+        }
+        const uint64_t time2 = get_user_ms() - start;
+
+        std::cout << "  " << std::setw(4) << size << " bytes: " << get_per_second(count, time1)
+                  << " / " << get_per_second(count, time2)
+                  << (hashes1 == hashes2 ? "" : " (INVALID HASH)") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Program entry point.
+//----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : DEFAULT_ITERATIONS;
+
+    std::cout << "SHA3-256 performance test, " << iterations << " iterations, " << sizeof(test_data) << " bytes" << std::endl;
+    std::cout << "ArmSHA3 implementation: " << (ArmKeccak::accelerated() ? "Arm64 SHA3 instructions" : "portable") << std::endl;
+
+    SHA3_256 sha;
+    ArmSHA3_256 arm_sha;
+    uint8_t hash[SHA3_256::HASH_SIZE];
+    uint8_t arm_hash[SHA3_256::HASH_SIZE];
+
+    bzero(hash, sizeof(hash));
+    sha.init();
+    uint64_t start = get_user_ms();
+    for (int i = 0; i < iterations; ++i) {
+        sha.add(test_data, sizeof(test_data));
+    }
+    const uint64_t time1 = get_user_ms() - start;
+    sha.getHash(hash, sizeof(hash));
+
+    std::cout << "Class SHA3_256:    time: " << time1 << " ms" << std::endl;
+
+    bzero(arm_hash, sizeof(arm_hash));
+    arm_sha.init();
+    start = get_user_ms();
+    for (int i = 0; i < iterations; ++i) {
+        arm_sha.add(test_data, sizeof(test_data));
+    }
+    const uint64_t time2 = get_user_ms() - start;
+    arm_sha.getHash(arm_hash, sizeof(arm_hash));
+    const bool ok = ::memcmp(hash, arm_hash, sizeof(hash)) == 0;
+
+    std::cout << "Class ArmSHA3_256: time: " << time2 << " ms, " << (ok ? "same hash" : "INVALID HASH") << std::endl;
+
+    if (time2 > 0) {
+        std::cout << "Performance ratio: " << (double(time1) / double(time2)) << std::endl;
+    }
+
+    perf_variants(uint64_t(iterations) * sizeof(test_data));
+    perf_x2(uint64_t(iterations) * sizeof(test_data));
+
+    return EXIT_SUCCESS;
+}
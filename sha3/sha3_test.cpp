@@ -0,0 +1,248 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Comparative results on SHA-3 and SHAKE (portable vs. Arm64 instructions).
+// Must be identical...
+//
+//----------------------------------------------------------------------------
+
+#include "SHA3.h"
+#include "ArmSHA3.h"
+#include <ios>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <string>
+
+struct TestData {
+    const char* message;  // Null: i * 7
+    size_t size;
+    uint8_t sha3_256[SHA3_256::HASH_SIZE];
+    uint8_t sha3_512[SHA3_512::HASH_SIZE];
+    uint8_t shake128[SHAKE128::HASH_SIZE];
+    uint8_t shake256[SHAKE256::HASH_SIZE];
+};
+
+static const TestData test_data[] = {
+    {
+        "", 0,
+        {0xA7, 0xFF, 0xC6, 0xF8, 0xBF, 0x1E, 0xD7, 0x66, 0x51, 0xC1, 0x47, 0x56, 0xA0, 0x61, 0xD6, 0x62,
+         0xF5, 0x80, 0xFF, 0x4D, 0xE4, 0x3B, 0x49, 0xFA, 0x82, 0xD8, 0x0A, 0x4B, 0x80, 0xF8, 0x43, 0x4A},
+        {0xA6, 0x9F, 0x73, 0xCC, 0xA2, 0x3A, 0x9A, 0xC5, 0xC8, 0xB5, 0x67, 0xDC, 0x18, 0x5A, 0x75, 0x6E,
+         0x97, 0xC9, 0x82, 0x16, 0x4F, 0xE2, 0x58, 0x59, 0xE0, 0xD1, 0xDC, 0xC1, 0x47, 0x5C, 0x80, 0xA6,
+         0x15, 0xB2, 0x12, 0x3A, 0xF1, 0xF5, 0xF9, 0x4C, 0x11, 0xE3, 0xE9, 0x40, 0x2C, 0x3A, 0xC5, 0x58,
+         0xF5, 0x00, 0x19, 0x9D, 0x95, 0xB6, 0xD3, 0xE3, 0x01, 0x75, 0x85, 0x86, 0x28, 0x1D, 0xCD, 0x26},
+        {0x7F, 0x9C, 0x2B, 0xA4, 0xE8, 0x8F, 0x82, 0x7D, 0x61, 0x60, 0x45, 0x50, 0x76, 0x05, 0x85, 0x3E,
+         0xD7, 0x3B, 0x80, 0x93, 0xF6, 0xEF, 0xBC, 0x88, 0xEB, 0x1A, 0x6E, 0xAC, 0xFA, 0x66, 0xEF, 0x26},
+        {0x46, 0xB9, 0xDD, 0x2B, 0x0B, 0xA8, 0x8D, 0x13, 0x23, 0x3B, 0x3F, 0xEB, 0x74, 0x3E, 0xEB, 0x24,
+         0x3F, 0xCD, 0x52, 0xEA, 0x62, 0xB8, 0x1B, 0x82, 0xB5, 0x0C, 0x27, 0x64, 0x6E, 0xD5, 0x76, 0x2F,
+         0xD7, 0x5D, 0xC4, 0xDD, 0xD8, 0xC0, 0xF2, 0x00, 0xCB, 0x05, 0x01, 0x9D, 0x67, 0xB5, 0x92, 0xF6,
+         0xFC, 0x82, 0x1C, 0x49, 0x47, 0x9A, 0xB4, 0x86, 0x40, 0x29, 0x2E, 0xAC, 0xB3, 0xB7, 0xC4, 0xBE}
+    },
+    {
+        "abc", 3,
+        {0x3A, 0x98, 0x5D, 0xA7, 0x4F, 0xE2, 0x25, 0xB2, 0x04, 0x5C, 0x17, 0x2D, 0x6B, 0xD3, 0x90, 0xBD,
+         0x85, 0x5F, 0x08, 0x6E, 0x3E, 0x9D, 0x52, 0x5B, 0x46, 0xBF, 0xE2, 0x45, 0x11, 0x43, 0x15, 0x32},
+        {0xB7, 0x51, 0x85, 0x0B, 0x1A, 0x57, 0x16, 0x8A, 0x56, 0x93, 0xCD, 0x92, 0x4B, 0x6B, 0x09, 0x6E,
+         0x08, 0xF6, 0x21, 0x82, 0x74, 0x44, 0xF7, 0x0D, 0x88, 0x4F, 0x5D, 0x02, 0x40, 0xD2, 0x71, 0x2E,
+         0x10, 0xE1, 0x16, 0xE9, 0x19, 0x2A, 0xF3, 0xC9, 0x1A, 0x7E, 0xC5, 0x76, 0x47, 0xE3, 0x93, 0x40,
+         0x57, 0x34, 0x0B, 0x4C, 0xF4, 0x08, 0xD5, 0xA5, 0x65, 0x92, 0xF8, 0x27, 0x4E, 0xEC, 0x53, 0xF0},
+        {0x58, 0x81, 0x09, 0x2D, 0xD8, 0x18, 0xBF, 0x5C, 0xF8, 0xA3, 0xDD, 0xB7, 0x93, 0xFB, 0xCB, 0xA7,
+         0x40, 0x97, 0xD5, 0xC5, 0x26, 0xA6, 0xD3, 0x5F, 0x97, 0xB8, 0x33, 0x51, 0x94, 0x0F, 0x2C, 0xC8},
+        {0x48, 0x33, 0x66, 0x60, 0x13, 0x60, 0xA8, 0x77, 0x1C, 0x68, 0x63, 0x08, 0x0C, 0xC4, 0x11, 0x4D,
+         0x8D, 0xB4, 0x45, 0x30, 0xF8, 0xF1, 0xE1, 0xEE, 0x4F, 0x94, 0xEA, 0x37, 0xE7, 0x8B, 0x57, 0x39,
+         0xD5, 0xA1, 0x5B, 0xEF, 0x18, 0x6A, 0x53, 0x86, 0xC7, 0x57, 0x44, 0xC0, 0x52, 0x7E, 0x1F, 0xAA,
+         0x9F, 0x87, 0x26, 0xE4, 0x62, 0xA1, 0x2A, 0x4F, 0xEB, 0x06, 0xBD, 0x88, 0x01, 0xE7, 0x51, 0xE4}
+    },
+    {
+        nullptr, 200,
+        {0x6E, 0x56, 0x43, 0x50, 0x2D, 0x1D, 0x7B, 0xDE, 0x0B, 0xE7, 0x1C, 0x01, 0x2F, 0x90, 0x55, 0x9C,
+         0xB4, 0x49, 0x5B, 0xF2, 0x7E, 0x53, 0xF1, 0x22, 0x0A, 0x8A, 0xA4, 0x64, 0xDC, 0xE2, 0xFD, 0x52},
+        {0xDE, 0x7B, 0x34, 0x1E, 0xFE, 0xBF, 0x8D, 0x99, 0xE2, 0x41, 0xEE, 0x00, 0xC2, 0x64, 0x00, 0xB3,
+         0x3B, 0xCE, 0xE6, 0x87, 0x82, 0xA1, 0x23, 0xAB, 0x08, 0xF2, 0x2D, 0x13, 0xC5, 0x18, 0x7E, 0x4D,
+         0x1A, 0x72, 0x1E, 0x6E, 0xE2, 0x61, 0xA7, 0x2D, 0xB4, 0xB4, 0x6E, 0xBC, 0x6E, 0xF0, 0x01, 0xCB,
+         0x54, 0x06, 0xF8, 0xBA, 0x00, 0x1C, 0x29, 0x1E, 0x79, 0x86, 0xB9, 0x25, 0xCA, 0x4B, 0xB7, 0x98},
+        {0x1A, 0x17, 0xA5, 0x3C, 0x3F, 0x08, 0x71, 0x0D, 0xD0, 0xD0, 0x2D, 0x42, 0xA7, 0xD5, 0xF9, 0x27,
+         0x83, 0xB6, 0x19, 0x15, 0xBC, 0xB7, 0xCE, 0x21, 0x60, 0x20, 0xF4, 0xFE, 0x99, 0x8E, 0x92, 0xB7},
+        {0xC7, 0x48, 0x66, 0x8A, 0x47, 0x3C, 0x84, 0x7E, 0xEE, 0x2F, 0x98, 0x5E, 0xFF, 0xEF, 0xC9, 0x66,
+         0x33, 0x74, 0xD7, 0xF8, 0x63, 0xAE, 0xB6, 0x45, 0x73, 0x4C, 0xC1, 0xB9, 0x0F, 0xBB, 0x2E, 0x88,
+         0x68, 0xD4, 0xE6, 0xFE, 0x5D, 0x05, 0xE1, 0x07, 0x67, 0xCE, 0x2E, 0x98, 0xEB, 0xFD, 0x8C, 0x7A,
+         0x97, 0x1C, 0xDC, 0x36, 0x3C, 0x56, 0xB2, 0x60, 0x41, 0x11, 0xF5, 0xD0, 0x08, 0x0C, 0x5B, 0x0F}
+    },
+    {
+        nullptr, 1000,
+        {0xDF, 0xF4, 0x6F, 0xF5, 0xED, 0x9E, 0x8D, 0x28, 0xB7, 0x04, 0x8F, 0x3A, 0x3E, 0x3A, 0xDB, 0xA1,
+         0xD3, 0xC5, 0xC7, 0x3A, 0xC1, 0x96, 0xB0, 0xDE, 0x15, 0xD8, 0x08, 0x19, 0x37, 0x37, 0x62, 0x79},
+        {0xFC, 0x78, 0x9F, 0x72, 0x6D, 0x84, 0xFA, 0x28, 0xAE, 0x1B, 0x29, 0x5D, 0x75, 0xE5, 0xC7, 0xF4,
+         0xC6, 0x12, 0x0F, 0xD4, 0x7C, 0x2D, 0x65, 0x5B, 0x1C, 0xE9, 0x5D, 0x1A, 0x98, 0xD0, 0x40, 0x8D,
+         0xEB, 0x8D, 0x2E, 0xBB, 0xC2, 0xFC, 0x41, 0xDA, 0xF4, 0xDA, 0x74, 0x88, 0xD1, 0x6F, 0x8B, 0xEC,
+         0xF1, 0xA2, 0xE4, 0x04, 0x0E, 0x95, 0x27, 0xF4, 0x76, 0xBC, 0x34, 0x41, 0x85, 0xB3, 0x85, 0xC6},
+        {0x36, 0x51, 0x4C, 0x82, 0x76, 0x83, 0xDD, 0x1B, 0x85, 0xC3, 0x30, 0x4D, 0x80, 0x79, 0x02, 0x1C,
+         0xDC, 0xCE, 0x28, 0x9A, 0x02, 0x57, 0xB8, 0xAC, 0xF0, 0x31, 0x7F, 0x7D, 0x8C, 0xE4, 0x55, 0xD4},
+        {0xEA, 0x7E, 0x0F, 0x63, 0x45, 0xCE, 0x92, 0x36, 0x91, 0x02, 0x51, 0xB2, 0x03, 0xE1, 0xB2, 0x28,
+         0xAA, 0x83, 0xBF, 0x8E, 0x2E, 0xA1, 0x81, 0x78, 0xC1, 0xF1, 0xE9, 0xDC, 0x08, 0x35, 0x24, 0x04,
+         0x0C, 0x47, 0xD6, 0x47, 0x64, 0x33, 0xC4, 0x48, 0xD0, 0xC2, 0x18, 0xBF, 0x22, 0x97, 0x74, 0xE5,
+         0xFF, 0xC2, 0x66, 0x18, 0x8F, 0xB2, 0x76, 0x3A, 0x34, 0x69, 0x41, 0x89, 0x1C, 0xD8, 0x1F, 0x85}
+    }
+};
+
+// Build the message of a test.
+std::string message(const char* text, size_t size)
+{
+    std::string msg(text != nullptr ? text : "");
+    for (size_t i = 0; text == nullptr && i < size; ++i) {
+        msg.push_back(char(i * 7));
+    }
+    return msg;
+}
+
+template <class HASH>
+bool check_hash(const std::string& msg, const uint8_t* expected)
+{
+    uint8_t hash[HASH::HASH_SIZE];
+    size_t retsize = 0;
+    HASH sha;
+    return sha.add(msg.data(), msg.size()) && sha.getHash(hash, sizeof(hash), &retsize) &&
+           retsize == HASH::HASH_SIZE && ::memcmp(hash, expected, HASH::HASH_SIZE) == 0;
+}
+
+// Display the result of a portable and an Arm class.
+template <class HASH, class ARMHASH>
+void test_hash(const char* name, const std::string& msg, const uint8_t* expected)
+{
+    std::cout << std::setw(5) << msg.size() << " bytes, " << name << ": "
+              << (check_hash<HASH>(msg, expected) ? "passed" : "FAILED")
+              << ", Arm" << name << ": " << (check_hash<ARMHASH>(msg, expected) ? "passed" : "FAILED")
+              << std::endl;
+}
+
+
+//----------------------------------------------------------------------------
+// Test the extendable output of SHAKE: 400 bytes on 1000 bytes (i * 7),
+// squeezed by chunks of various sizes, check the last 32 bytes.
+//----------------------------------------------------------------------------
+
+template <class HASH>
+bool check_xof(const std::string& msg, size_t chunk, const uint8_t* expected)
+{
+    uint8_t out[400];
+    HASH sha;
+    bool ok = sha.add(msg.data(), msg.size());
+    for (size_t done = 0; done < sizeof(out); done += chunk) {
+        ok = sha.squeeze(out + done, std::min(chunk, sizeof(out) - done)) && ok;
+    }
+    return ok && ::memcmp(out + sizeof(out) - 32, expected, 32) == 0;
+}
+
+template <class HASH, class ARMHASH>
+void test_xof(const char* name, const uint8_t* expected)
+{
+    static const size_t chunks[] = {1, 7, 32, 136, 168, 400};
+    const std::string msg(message(nullptr, 1000));
+    bool ok = true;
+    bool arm_ok = true;
+    for (size_t chunk : chunks) {
+        ok = check_xof<HASH>(msg, chunk, expected) && ok;
+        arm_ok = check_xof<ARMHASH>(msg, chunk, expected) && arm_ok;
+    }
+    std::cout << "  400 bytes output, " << name << ": " << (ok ? "passed" : "FAILED")
+              << ", Arm" << name << ": " << (arm_ok ? "passed" : "FAILED") << std::endl;
+}
+
+void test_xof()
+{
+    static const uint8_t shake128_tail[32] = {
+        0xB9, 0x51, 0x66, 0xE0, 0x04, 0xAE, 0xB0, 0x8C, 0x5F, 0x84, 0x35, 0x74, 0xCD, 0x0C, 0xCF, 0xFE,
+        0x80, 0x77, 0xEC, 0x04, 0x13, 0xBD, 0x8E, 0xE0, 0x48, 0xE5, 0x34, 0xFF, 0xA5, 0xB8, 0x29, 0xCE
+    };
+    static const uint8_t shake256_tail[32] = {
+        0xC6, 0x35, 0x19, 0xDF, 0x1F, 0x8D, 0x0A, 0x01, 0x55, 0xE4, 0x06, 0x44, 0xF3, 0xFA, 0x9B, 0x33,
+        0x5C, 0x7A, 0xB1, 0x68, 0x83, 0x00, 0xFC, 0x49, 0xD3, 0x5E, 0x86, 0x63, 0xD3, 0x3C, 0x0C, 0x3B
+    };
+    test_xof<SHAKE128, ArmSHAKE128>("SHAKE128", shake128_tail);
+    test_xof<SHAKE256, ArmSHAKE256>("SHAKE256", shake256_tail);
+}
+
+
+//----------------------------------------------------------------------------
+// Test the two-way class against the portable one, with distinct message
+// sizes and chunk sizes in the two lanes.
+//----------------------------------------------------------------------------
+
+template <class HASH, class HASHX2>
+void test_x2(const char* name)
+{
+    static const size_t sizes[] = {0, 1, 71, 72, 135, 136, 137, 167, 168, 300, 1000, 4096, 10000};
+    static const size_t chunks[] = {1, 7, 64, 136, 300, 100000};
+    const size_t count = sizeof(sizes) / sizeof(sizes[0]);
+
+    std::vector<std::string> msgs;
+    std::vector<uint8_t> expected;
+    for (size_t size : sizes) {
+        msgs.emplace_back();
+        for (size_t i = 0; i < size; ++i) {
+            msgs.back().push_back(char(i * 13 + size));
+        }
+        uint8_t hash[HASH::HASH_SIZE];
+        HASH sha;
+        sha.add(msgs.back().data(), size);
+        sha.getHash(hash, sizeof(hash));
+        expected.insert(expected.end(), hash, hash + sizeof(hash));
+    }
+
+    bool ok = true;
+    HASHX2 sha;
+    for (size_t first = 0; first < count; ++first) {
+        const size_t index[2] = {first, (first + 3) % count};
+        size_t done[2] = {0, 0};
+        sha.init();
+        for (bool more = true; more; ) {
+            const void* data[2];
+            size_t size[2];
+            more = false;
+            for (size_t l = 0; l < 2; ++l) {
+                const std::string& msg(msgs[index[l]]);
+                size[l] = std::min(chunks[(first + l) % 6], msg.size() - done[l]);
+                data[l] = msg.data() + done[l];
+                done[l] += size[l];
+                more = more || done[l] < msg.size();
+            }
+            ok = sha.add(data, size) && ok;
+        }
+        uint8_t hash[2][HASH::HASH_SIZE];
+        void* hashes[2] = {hash[0], hash[1]};
+        ok = sha.getHash(hashes, HASH::HASH_SIZE) && ok;
+        for (size_t l = 0; l < 2; ++l) {
+            ok = ok && ::memcmp(hash[l], &expected[index[l] * HASH::HASH_SIZE], HASH::HASH_SIZE) == 0;
+        }
+    }
+    std::cout << count << " messages, Arm" << name << "x2: " << (ok ? "passed" : "FAILED") << std::endl;
+}
+
+
+//----------------------------------------------------------------------------
+// Program entry point.
+//----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    std::cout << "ArmSHA3 implementation: " << (ArmKeccak::accelerated() ? "Arm64 SHA3 instructions" : "portable") << std::endl;
+
+    for (const auto& test : test_data) {
+        const std::string msg(message(test.message, test.size));
+        test_hash<SHA3_256, ArmSHA3_256>("SHA3_256", msg, test.sha3_256);
+        test_hash<SHA3_512, ArmSHA3_512>("SHA3_512", msg, test.sha3_512);
+        test_hash<SHAKE128, ArmSHAKE128>("SHAKE128", msg, test.shake128);
+        test_hash<SHAKE256, ArmSHAKE256>("SHAKE256", msg, test.shake256);
+    }
+
+    test_xof();
+    test_x2<SHA3_256, ArmSHA3_256x2>("SHA3_256");
+    test_x2<SHA3_512, ArmSHA3_512x2>("SHA3_512");
+    test_x2<SHAKE128, ArmSHAKE128x2>("SHAKE128");
+    test_x2<SHAKE256, ArmSHAKE256x2>("SHAKE256");
+    return EXIT_SUCCESS;
+}
@@ -72,210 +72,259 @@ namespace {
 }
 
 
+//----------------------------------------------------------------------------
+// Initial values of the variants.
+//----------------------------------------------------------------------------
+
+const uint64_t SHA512Policy::IV[8] = {
+    TS_UCONST64(0x6A09E667F3BCC908), TS_UCONST64(0xBB67AE8584CAA73B),
+    TS_UCONST64(0x3C6EF372FE94F82B), TS_UCONST64(0xA54FF53A5F1D36F1),
+    TS_UCONST64(0x510E527FADE682D1), TS_UCONST64(0x9B05688C2B3E6C1F),
+    TS_UCONST64(0x1F83D9ABFB41BD6B), TS_UCONST64(0x5BE0CD19137E2179),
+};
+
+const uint64_t SHA384Policy::IV[8] = {
+    TS_UCONST64(0xCBBB9D5DC1059ED8), TS_UCONST64(0x629A292A367CD507),
+    TS_UCONST64(0x9159015A3070DD17), TS_UCONST64(0x152FECD8F70E5939),
+    TS_UCONST64(0x67332667FFC00B31), TS_UCONST64(0x8EB44A8768581511),
+    TS_UCONST64(0xDB0C2E0D64F98FA7), TS_UCONST64(0x47B5481DBEFA4FA4),
+};
+
+const uint64_t SHA512_256Policy::IV[8] = {
+    TS_UCONST64(0x22312194FC2BF72C), TS_UCONST64(0x9F555FA3C84C64C2),
+    TS_UCONST64(0x2393B86B6F53B151), TS_UCONST64(0x963877195940EABD),
+    TS_UCONST64(0x96283EE2A88EFFE3), TS_UCONST64(0xBE5E1E2553863992),
+    TS_UCONST64(0x2B0199FC2C85B8AA), TS_UCONST64(0x0EB72DDC81C52CA2),
+};
+
+
 //----------------------------------------------------------------------------
 // Constructor
 //----------------------------------------------------------------------------
 
-ArmSHA512::ArmSHA512() :
+template <class POLICY>
+ArmSHA512Family<POLICY>::ArmSHA512Family() :
     _length(0),
-    _curlen(0)
+    _curlen(0),
+    _compress(accelerated() ? compressArm : compressPortable),
+    _block_by_block(false)
 {
     init();
 }
 
 
+//----------------------------------------------------------------------------
+// Check if the SHA-512 instructions are present.
+//----------------------------------------------------------------------------
+
+bool ArmSHA512Core::accelerated()
+{
+    static const bool accel = HasCPUFeatures(CPU_SHA512);
+    return accel;
+}
+
+
 //----------------------------------------------------------------------------
 // Reinitialize the computation of the hash.
 //----------------------------------------------------------------------------
 
-bool ArmSHA512::init()
+template <class POLICY>
+bool ArmSHA512Family<POLICY>::init()
 {
     _curlen = 0;
     _length = 0;
-    _state[0] = TS_UCONST64(0x6A09E667F3BCC908);
-    _state[1] = TS_UCONST64(0xBB67AE8584CAA73B);
-    _state[2] = TS_UCONST64(0x3C6EF372FE94F82B);
-    _state[3] = TS_UCONST64(0xA54FF53A5F1D36F1);
-    _state[4] = TS_UCONST64(0x510E527FADE682D1);
-    _state[5] = TS_UCONST64(0x9B05688C2B3E6C1F);
-    _state[6] = TS_UCONST64(0x1F83D9ABFB41BD6B);
-    _state[7] = TS_UCONST64(0x5BE0CD19137E2179);
+    ::memcpy(_state, POLICY::IV, sizeof(_state));
     return true;
 }
 
 
+//----------------------------------------------------------------------------
+// Compress consecutive blocks without the SHA-512 instructions.
+//----------------------------------------------------------------------------
+
+void ArmSHA512Core::compressPortable(uint64_t* state, const uint8_t* buf, size_t count)
+{
+    for (; count > 0; --count, buf += BLOCK_SIZE) {
+        SHA512::compress(state, buf);
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Compress part of message
 //----------------------------------------------------------------------------
 
-void ArmSHA512::compress(const uint8_t* buf)
+TARGET_SHA3 void ArmSHA512Core::compressArm(uint64_t* state, const uint8_t* buf, size_t count)
 {
     // Load initial values.
-    uint64x2_t ab = vld1q_u64(&_state[0]);
-    uint64x2_t cd = vld1q_u64(&_state[2]);
-    uint64x2_t ef = vld1q_u64(&_state[4]);
-    uint64x2_t gh = vld1q_u64(&_state[6]);
-
-    // Save current state.
-    uint64x2_t previous_ab = ab;
-    uint64x2_t previous_cd = cd;
-    uint64x2_t previous_ef = ef;
-    uint64x2_t previous_gh = gh;
-
-    // Load input block.
-    const uint8_t* buf8 = reinterpret_cast<const uint8_t*>(buf);
-    uint64x2_t s0 = uint64x2_t(vld1q_u8(buf8 + 16 * 0));
-    uint64x2_t s1 = uint64x2_t(vld1q_u8(buf8 + 16 * 1));
-    uint64x2_t s2 = uint64x2_t(vld1q_u8(buf8 + 16 * 2));
-    uint64x2_t s3 = uint64x2_t(vld1q_u8(buf8 + 16 * 3));
-    uint64x2_t s4 = uint64x2_t(vld1q_u8(buf8 + 16 * 4));
-    uint64x2_t s5 = uint64x2_t(vld1q_u8(buf8 + 16 * 5));
-    uint64x2_t s6 = uint64x2_t(vld1q_u8(buf8 + 16 * 6));
-    uint64x2_t s7 = uint64x2_t(vld1q_u8(buf8 + 16 * 7));
-
-    // Swap bytes if little endian Arm64.
-    s0 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s0)));
-    s1 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s1)));
-    s2 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s2)));
-    s3 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s3)));
-    s4 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s4)));
-    s5 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s5)));
-    s6 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s6)));
-    s7 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s7)));
-
-    // Rounds 0 and 1
-    uint64x2_t initial_sum = vaddq_u64(s0, vld1q_u64(&K[0]));
-    uint64x2_t sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), gh);
-    uint64x2_t intermed = vsha512hq_u64(sum, vextq_u64(ef, gh, 1), vextq_u64(cd, ef, 1));
-    gh = vsha512h2q_u64(intermed, cd, ab);
-    cd = vaddq_u64(cd, intermed);
-
-    // Rounds 2 and 3
-    initial_sum = vaddq_u64(s1, vld1q_u64(&K[2]));
-    sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), ef);
-    intermed = vsha512hq_u64(sum, vextq_u64(cd, ef, 1), vextq_u64(ab, cd, 1));
-    ef = vsha512h2q_u64(intermed, ab, gh);
-    ab = vaddq_u64(ab, intermed);
-
-    // Rounds 4 and 5
-    initial_sum = vaddq_u64(s2, vld1q_u64(&K[4]));
-    sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), cd);
-    intermed = vsha512hq_u64(sum, vextq_u64(ab, cd, 1), vextq_u64(gh, ab, 1));
-    cd = vsha512h2q_u64(intermed, gh, ef);
-    gh = vaddq_u64(gh, intermed);
-
-    // Rounds 6 and 7
-    initial_sum = vaddq_u64(s3, vld1q_u64(&K[6]));
-    sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), ab);
-    intermed = vsha512hq_u64(sum, vextq_u64(gh, ab, 1), vextq_u64(ef, gh, 1));
-    ab = vsha512h2q_u64(intermed, ef, cd);
-    ef = vaddq_u64(ef, intermed);
-
-    // Rounds 8 and 9
-    initial_sum = vaddq_u64(s4, vld1q_u64(&K[8]));
-    sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), gh);
-    intermed = vsha512hq_u64(sum, vextq_u64(ef, gh, 1), vextq_u64(cd, ef, 1));
-    gh = vsha512h2q_u64(intermed, cd, ab);
-    cd = vaddq_u64(cd, intermed);
-
-    // Rounds 10 and 11
-    initial_sum = vaddq_u64(s5, vld1q_u64(&K[10]));
-    sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), ef);
-    intermed = vsha512hq_u64(sum, vextq_u64(cd, ef, 1), vextq_u64(ab, cd, 1));
-    ef = vsha512h2q_u64(intermed, ab, gh);
-    ab = vaddq_u64(ab, intermed);
-
-    // Rounds 12 and 13
-    initial_sum = vaddq_u64(s6, vld1q_u64(&K[12]));
-    sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), cd);
-    intermed = vsha512hq_u64(sum, vextq_u64(ab, cd, 1), vextq_u64(gh, ab, 1));
-    cd = vsha512h2q_u64(intermed, gh, ef);
-    gh = vaddq_u64(gh, intermed);
-
-    // Rounds 14 and 15
-    initial_sum = vaddq_u64(s7, vld1q_u64(&K[14]));
-    sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), ab);
-    intermed = vsha512hq_u64(sum, vextq_u64(gh, ab, 1), vextq_u64(ef, gh, 1));
-    ab = vsha512h2q_u64(intermed, ef, cd);
-    ef = vaddq_u64(ef, intermed);
-
-    for (unsigned int t = 16; t < 80; t += 16) {
-        // Rounds t and t + 1
-        s0 = vsha512su1q_u64(vsha512su0q_u64(s0, s1), s7, vextq_u64(s4, s5, 1));
-        initial_sum = vaddq_u64(s0, vld1q_u64(&K[t]));
-        sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), gh);
-        intermed = vsha512hq_u64(sum, vextq_u64(ef, gh, 1), vextq_u64(cd, ef, 1));
+    uint64x2_t ab = vld1q_u64(&state[0]);
+    uint64x2_t cd = vld1q_u64(&state[2]);
+    uint64x2_t ef = vld1q_u64(&state[4]);
+    uint64x2_t gh = vld1q_u64(&state[6]);
+
+    // Compress all blocks, the state remains in registers between blocks.
+    for (; count > 0; --count, buf += BLOCK_SIZE) {
+        // Save current state.
+        uint64x2_t previous_ab = ab;
+        uint64x2_t previous_cd = cd;
+        uint64x2_t previous_ef = ef;
+        uint64x2_t previous_gh = gh;
+
+        // Load input block.
+        const uint8_t* buf8 = reinterpret_cast<const uint8_t*>(buf);
+        uint64x2_t s0 = uint64x2_t(vld1q_u8(buf8 + 16 * 0));
+        uint64x2_t s1 = uint64x2_t(vld1q_u8(buf8 + 16 * 1));
+        uint64x2_t s2 = uint64x2_t(vld1q_u8(buf8 + 16 * 2));
+        uint64x2_t s3 = uint64x2_t(vld1q_u8(buf8 + 16 * 3));
+        uint64x2_t s4 = uint64x2_t(vld1q_u8(buf8 + 16 * 4));
+        uint64x2_t s5 = uint64x2_t(vld1q_u8(buf8 + 16 * 5));
+        uint64x2_t s6 = uint64x2_t(vld1q_u8(buf8 + 16 * 6));
+        uint64x2_t s7 = uint64x2_t(vld1q_u8(buf8 + 16 * 7));
+
+        // Swap bytes if little endian Arm64.
+        s0 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s0)));
+        s1 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s1)));
+        s2 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s2)));
+        s3 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s3)));
+        s4 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s4)));
+        s5 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s5)));
+        s6 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s6)));
+        s7 = vreinterpretq_u64_u8(vrev64q_u8(vreinterpretq_u8_u64(s7)));
+
+        // Rounds 0 and 1
+        uint64x2_t initial_sum = vaddq_u64(s0, vld1q_u64(&K[0]));
+        uint64x2_t sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), gh);
+        uint64x2_t intermed = vsha512hq_u64(sum, vextq_u64(ef, gh, 1), vextq_u64(cd, ef, 1));
         gh = vsha512h2q_u64(intermed, cd, ab);
         cd = vaddq_u64(cd, intermed);
 
-        // Rounds t + 2 and t + 3
-        s1 = vsha512su1q_u64(vsha512su0q_u64(s1, s2), s0, vextq_u64(s5, s6, 1));
-        initial_sum = vaddq_u64(s1, vld1q_u64(&K[t + 2]));
+        // Rounds 2 and 3
+        initial_sum = vaddq_u64(s1, vld1q_u64(&K[2]));
         sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), ef);
         intermed = vsha512hq_u64(sum, vextq_u64(cd, ef, 1), vextq_u64(ab, cd, 1));
         ef = vsha512h2q_u64(intermed, ab, gh);
         ab = vaddq_u64(ab, intermed);
 
-        // Rounds t + 4 and t + 5
-        s2 = vsha512su1q_u64(vsha512su0q_u64(s2, s3), s1, vextq_u64(s6, s7, 1));
-        initial_sum = vaddq_u64(s2, vld1q_u64(&K[t + 4]));
+        // Rounds 4 and 5
+        initial_sum = vaddq_u64(s2, vld1q_u64(&K[4]));
         sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), cd);
         intermed = vsha512hq_u64(sum, vextq_u64(ab, cd, 1), vextq_u64(gh, ab, 1));
         cd = vsha512h2q_u64(intermed, gh, ef);
         gh = vaddq_u64(gh, intermed);
 
-        // Rounds t + 6 and t + 7
-        s3 = vsha512su1q_u64(vsha512su0q_u64(s3, s4), s2, vextq_u64(s7, s0, 1));
-        initial_sum = vaddq_u64(s3, vld1q_u64(&K[t + 6]));
+        // Rounds 6 and 7
+        initial_sum = vaddq_u64(s3, vld1q_u64(&K[6]));
         sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), ab);
         intermed = vsha512hq_u64(sum, vextq_u64(gh, ab, 1), vextq_u64(ef, gh, 1));
         ab = vsha512h2q_u64(intermed, ef, cd);
         ef = vaddq_u64(ef, intermed);
 
-        // Rounds t + 8 and t + 9
-        s4 = vsha512su1q_u64(vsha512su0q_u64(s4, s5), s3, vextq_u64(s0, s1, 1));
-        initial_sum = vaddq_u64(s4, vld1q_u64(&K[t + 8]));
+        // Rounds 8 and 9
+        initial_sum = vaddq_u64(s4, vld1q_u64(&K[8]));
         sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), gh);
         intermed = vsha512hq_u64(sum, vextq_u64(ef, gh, 1), vextq_u64(cd, ef, 1));
         gh = vsha512h2q_u64(intermed, cd, ab);
         cd = vaddq_u64(cd, intermed);
 
-        // Rounds t + 10 and t + 11
-        s5 = vsha512su1q_u64(vsha512su0q_u64(s5, s6), s4, vextq_u64(s1, s2, 1));
-        initial_sum = vaddq_u64(s5, vld1q_u64(&K[t + 10]));
+        // Rounds 10 and 11
+        initial_sum = vaddq_u64(s5, vld1q_u64(&K[10]));
         sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), ef);
         intermed = vsha512hq_u64(sum, vextq_u64(cd, ef, 1), vextq_u64(ab, cd, 1));
         ef = vsha512h2q_u64(intermed, ab, gh);
         ab = vaddq_u64(ab, intermed);
 
-        // Rounds t + 12 and t + 13
-        s6 = vsha512su1q_u64(vsha512su0q_u64(s6, s7), s5, vextq_u64(s2, s3, 1));
-        initial_sum = vaddq_u64(s6, vld1q_u64(&K[t + 12]));
+        // Rounds 12 and 13
+        initial_sum = vaddq_u64(s6, vld1q_u64(&K[12]));
         sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), cd);
         intermed = vsha512hq_u64(sum, vextq_u64(ab, cd, 1), vextq_u64(gh, ab, 1));
         cd = vsha512h2q_u64(intermed, gh, ef);
         gh = vaddq_u64(gh, intermed);
 
-        // Rounds t + 14 and t + 15
-        s7 = vsha512su1q_u64(vsha512su0q_u64(s7, s0), s6, vextq_u64(s3, s4, 1));
-        initial_sum = vaddq_u64(s7, vld1q_u64(&K[t + 14]));
+        // Rounds 14 and 15
+        initial_sum = vaddq_u64(s7, vld1q_u64(&K[14]));
         sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), ab);
         intermed = vsha512hq_u64(sum, vextq_u64(gh, ab, 1), vextq_u64(ef, gh, 1));
         ab = vsha512h2q_u64(intermed, ef, cd);
         ef = vaddq_u64(ef, intermed);
-    }
 
-    // Add back to state
-    ab = vaddq_u64(ab, previous_ab);
-    cd = vaddq_u64(cd, previous_cd);
-    ef = vaddq_u64(ef, previous_ef);
-    gh = vaddq_u64(gh, previous_gh);
+        for (unsigned int t = 16; t < 80; t += 16) {
+            // Rounds t and t + 1
+            s0 = vsha512su1q_u64(vsha512su0q_u64(s0, s1), s7, vextq_u64(s4, s5, 1));
+            initial_sum = vaddq_u64(s0, vld1q_u64(&K[t]));
+            sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), gh);
+            intermed = vsha512hq_u64(sum, vextq_u64(ef, gh, 1), vextq_u64(cd, ef, 1));
+            gh = vsha512h2q_u64(intermed, cd, ab);
+            cd = vaddq_u64(cd, intermed);
+
+            // Rounds t + 2 and t + 3
+            s1 = vsha512su1q_u64(vsha512su0q_u64(s1, s2), s0, vextq_u64(s5, s6, 1));
+            initial_sum = vaddq_u64(s1, vld1q_u64(&K[t + 2]));
+            sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), ef);
+            intermed = vsha512hq_u64(sum, vextq_u64(cd, ef, 1), vextq_u64(ab, cd, 1));
+            ef = vsha512h2q_u64(intermed, ab, gh);
+            ab = vaddq_u64(ab, intermed);
+
+            // Rounds t + 4 and t + 5
+            s2 = vsha512su1q_u64(vsha512su0q_u64(s2, s3), s1, vextq_u64(s6, s7, 1));
+            initial_sum = vaddq_u64(s2, vld1q_u64(&K[t + 4]));
+            sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), cd);
+            intermed = vsha512hq_u64(sum, vextq_u64(ab, cd, 1), vextq_u64(gh, ab, 1));
+            cd = vsha512h2q_u64(intermed, gh, ef);
+            gh = vaddq_u64(gh, intermed);
+
+            // Rounds t + 6 and t + 7
+            s3 = vsha512su1q_u64(vsha512su0q_u64(s3, s4), s2, vextq_u64(s7, s0, 1));
+            initial_sum = vaddq_u64(s3, vld1q_u64(&K[t + 6]));
+            sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), ab);
+            intermed = vsha512hq_u64(sum, vextq_u64(gh, ab, 1), vextq_u64(ef, gh, 1));
+            ab = vsha512h2q_u64(intermed, ef, cd);
+            ef = vaddq_u64(ef, intermed);
+
+            // Rounds t + 8 and t + 9
+            s4 = vsha512su1q_u64(vsha512su0q_u64(s4, s5), s3, vextq_u64(s0, s1, 1));
+            initial_sum = vaddq_u64(s4, vld1q_u64(&K[t + 8]));
+            sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), gh);
+            intermed = vsha512hq_u64(sum, vextq_u64(ef, gh, 1), vextq_u64(cd, ef, 1));
+            gh = vsha512h2q_u64(intermed, cd, ab);
+            cd = vaddq_u64(cd, intermed);
+
+            // Rounds t + 10 and t + 11
+            s5 = vsha512su1q_u64(vsha512su0q_u64(s5, s6), s4, vextq_u64(s1, s2, 1));
+            initial_sum = vaddq_u64(s5, vld1q_u64(&K[t + 10]));
+            sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), ef);
+            intermed = vsha512hq_u64(sum, vextq_u64(cd, ef, 1), vextq_u64(ab, cd, 1));
+            ef = vsha512h2q_u64(intermed, ab, gh);
+            ab = vaddq_u64(ab, intermed);
+
+            // Rounds t + 12 and t + 13
+            s6 = vsha512su1q_u64(vsha512su0q_u64(s6, s7), s5, vextq_u64(s2, s3, 1));
+            initial_sum = vaddq_u64(s6, vld1q_u64(&K[t + 12]));
+            sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), cd);
+            intermed = vsha512hq_u64(sum, vextq_u64(ab, cd, 1), vextq_u64(gh, ab, 1));
+            cd = vsha512h2q_u64(intermed, gh, ef);
+            gh = vaddq_u64(gh, intermed);
+
+            // Rounds t + 14 and t + 15
+            s7 = vsha512su1q_u64(vsha512su0q_u64(s7, s0), s6, vextq_u64(s3, s4, 1));
+            initial_sum = vaddq_u64(s7, vld1q_u64(&K[t + 14]));
+            sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), ab);
+            intermed = vsha512hq_u64(sum, vextq_u64(gh, ab, 1), vextq_u64(ef, gh, 1));
+            ab = vsha512h2q_u64(intermed, ef, cd);
+            ef = vaddq_u64(ef, intermed);
+        }
+
+        // Add back to state
+        ab = vaddq_u64(ab, previous_ab);
+        cd = vaddq_u64(cd, previous_cd);
+        ef = vaddq_u64(ef, previous_ef);
+        gh = vaddq_u64(gh, previous_gh);
+    }
 
     // Save state
-    vst1q_u64(&_state[0], ab);
-    vst1q_u64(&_state[2], cd);
-    vst1q_u64(&_state[4], ef);
-    vst1q_u64(&_state[6], gh);
+    vst1q_u64(&state[0], ab);
+    vst1q_u64(&state[2], cd);
+    vst1q_u64(&state[4], ef);
+    vst1q_u64(&state[6], gh);
 }
 
 
@@ -283,7 +332,8 @@ void ArmSHA512::compress(const uint8_t* buf)
 // Add some part of the message to hash. Can be called several times.
 //----------------------------------------------------------------------------
 
-bool ArmSHA512::add(const void* data, size_t size)
+template <class POLICY>
+bool ArmSHA512Family<POLICY>::add(const void* data, size_t size)
 {
     // Filter invalid internal state.
     if (_curlen >= sizeof(_buf)) {
@@ -291,27 +341,43 @@ bool ArmSHA512::add(const void* data, size_t size)
     }
 
     const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
-    while (size > 0) {
-        if (_curlen == 0 && size >= BLOCK_SIZE) {
-            // Compress one 1024-bit block directly from user's buffer.
-            compress(in);
-            _length += BLOCK_SIZE * 8;
-            in += BLOCK_SIZE;
-            size -= BLOCK_SIZE;
+
+    // Complete a partial block from a previous call.
+    if (_curlen > 0 && size > 0) {
+        const size_t n = std::min(size, (BLOCK_SIZE - _curlen));
+        ::memcpy(_buf + _curlen, in, n);
+        _curlen += n;
+        in += n;
+        size -= n;
+        if (_curlen < BLOCK_SIZE) {
+            return true;
         }
-        else {
-            // Partial block, Accumulate input data in internal buffer.
-            size_t n = std::min(size, (BLOCK_SIZE - _curlen));
-            ::memcpy(_buf + _curlen, in, n);
-            _curlen += n;
-            in += n;
-            size -= n;
-            if (_curlen == BLOCK_SIZE) {
-                compress(_buf);
-                _length += 8 * BLOCK_SIZE;
-                _curlen = 0;
+        _compress(_state, _buf, 1);
+        _length += 8 * BLOCK_SIZE;
+        _curlen = 0;
+    }
+
+    // Compress all complete 1024-bit blocks directly from user's buffer, in one call.
+    // The buffer does not need to be aligned, the data are never copied.
+    const size_t count = size / BLOCK_SIZE;
+    if (count > 0) {
+        if (_block_by_block) {
+            for (size_t i = 0; i < count; ++i) {
+                _compress(_state, in + BLOCK_SIZE * i, 1);
             }
         }
+        else {
+            _compress(_state, in, count);
+        }
+        _length += 8 * BLOCK_SIZE * count;
+        in += BLOCK_SIZE * count;
+        size -= BLOCK_SIZE * count;
+    }
+
+    // Keep the last partial block in internal buffer.
+    if (size > 0) {
+        ::memcpy(_buf, in, size);
+        _curlen = size;
     }
     return true;
 }
@@ -321,7 +387,8 @@ bool ArmSHA512::add(const void* data, size_t size)
 // Get the resulting hash value.
 //----------------------------------------------------------------------------
 
-bool ArmSHA512::getHash(void* hash, size_t bufsize, size_t* retsize)
+template <class POLICY>
+bool ArmSHA512Family<POLICY>::getHash(void* hash, size_t bufsize, size_t* retsize)
 {
     // Filter invalid internal state or invalid input.
     if (_curlen >= sizeof(_buf) || bufsize < HASH_SIZE) {
@@ -338,7 +405,7 @@ bool ArmSHA512::getHash(void* hash, size_t bufsize, size_t* retsize)
     // If the length is currently above 112 bytes (no room for message length), append zeroes then compress.
     if (_curlen > 112) {
         bzero(_buf + _curlen, 128 - _curlen);
-        compress(_buf);
+        _compress(_state, _buf, 1);
         _curlen = 0;
     }
 
@@ -346,11 +413,11 @@ bool ArmSHA512::getHash(void* hash, size_t bufsize, size_t* retsize)
     // Note: zeroes from 112 to 120 are the 64 MSB of the length. We assume that you won't hash > 2^64 bits of data.
     bzero(_buf + _curlen, 120 - _curlen);
     PutUInt64(_buf + 120, _length);
-    compress(_buf);
+    _compress(_state, _buf, 1);
 
-    // Copy output
+    // Copy output, truncated to the hash size of the variant.
     uint8_t* out = reinterpret_cast<uint8_t*>(hash);
-    for (size_t i = 0; i < 8; i++) {
+    for (size_t i = 0; i < HASH_SIZE / 8; i++) {
         PutUInt64(out + 8*i, _state[i]);
     }
 
@@ -359,3 +426,224 @@ bool ArmSHA512::getHash(void* hash, size_t bufsize, size_t* retsize)
     }
     return true;
 }
+
+
+template class ArmSHA512Family<SHA512Policy>;
+template class ArmSHA512Family<SHA384Policy>;
+template class ArmSHA512Family<SHA512_256Policy>;
+
+//----------------------------------------------------------------------------
+// Multi-buffer SHA-512: constructor and initialization.
+//----------------------------------------------------------------------------
+
+// Constants may be used by reference.
+const size_t ArmSHA512Multi::MAX_LANES;
+
+ArmSHA512Multi::ArmSHA512Multi(size_t lanes) :
+    _lanes(std::max<size_t>(1, std::min(lanes, MAX_LANES)))
+{
+    init();
+}
+
+bool ArmSHA512Multi::init()
+{
+    for (size_t l = 0; l < _lanes; ++l) {
+        _curlen[l] = 0;
+        _length[l] = 0;
+        ::memcpy(_state[l], SHA512Policy::IV, sizeof(_state[l]));
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Compress one block in each of N independent states. This is the same
+// sequence as compressArm(), each pair of rounds is done on all states
+// before the next pair. The loops on lanes and pairs are unrolled, the
+// roles of ab, cd, ef, gh rotate every pair of rounds, as in compressArm().
+//----------------------------------------------------------------------------
+
+template <size_t N>
+TARGET_SHA3 void ArmSHA512Multi::compressLanes(uint64_t* const* states, const uint8_t* const* blocks)
+{
+    uint64x2_t v[N][4];   // ab, cd, ef, gh
+    uint64x2_t s[N][8];   // message schedule
+
+    #pragma GCC unroll 4
+    for (size_t l = 0; l < N; ++l) {
+        #pragma GCC unroll 4
+        for (size_t i = 0; i < 4; ++i) {
+            v[l][i] = vld1q_u64(&states[l][2 * i]);
+        }
+        #pragma GCC unroll 8
+        for (size_t i = 0; i < 8; ++i) {
+            s[l][i] = vreinterpretq_u64_u8(vrev64q_u8(vld1q_u8(blocks[l] + 16 * i)));
+        }
+    }
+
+    // 5 groups of 16 rounds, 8 pairs of rounds per group.
+    for (size_t t = 0; t < 80; t += 16) {
+        #pragma GCC unroll 8
+        for (size_t k = 0; k < 8; ++k) {
+            // Register roles in this pair of rounds.
+            const size_t ab = (4 - k % 4) % 4;
+            const size_t cd = (ab + 1) % 4;
+            const size_t ef = (ab + 2) % 4;
+            const size_t gh = (ab + 3) % 4;
+            const uint64x2_t kk = vld1q_u64(&K[t + 2 * k]);
+            #pragma GCC unroll 4
+            for (size_t l = 0; l < N; ++l) {
+                if (t > 0) {
+                    s[l][k] = vsha512su1q_u64(vsha512su0q_u64(s[l][k], s[l][(k + 1) % 8]), s[l][(k + 7) % 8], vextq_u64(s[l][(k + 4) % 8], s[l][(k + 5) % 8], 1));
+                }
+                const uint64x2_t initial_sum = vaddq_u64(s[l][k], kk);
+                const uint64x2_t sum = vaddq_u64(vextq_u64(initial_sum, initial_sum, 1), v[l][gh]);
+                const uint64x2_t intermed = vsha512hq_u64(sum, vextq_u64(v[l][ef], v[l][gh], 1), vextq_u64(v[l][cd], v[l][ef], 1));
+                v[l][gh] = vsha512h2q_u64(intermed, v[l][cd], v[l][ab]);
+                v[l][cd] = vaddq_u64(v[l][cd], intermed);
+            }
+        }
+    }
+
+    #pragma GCC unroll 4
+    for (size_t l = 0; l < N; ++l) {
+        #pragma GCC unroll 4
+        for (size_t i = 0; i < 4; ++i) {
+            vst1q_u64(&states[l][2 * i], vaddq_u64(vld1q_u64(&states[l][2 * i]), v[l][i]));
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Compress a list of blocks in independent states.
+//----------------------------------------------------------------------------
+
+void ArmSHA512Multi::compress(uint64_t* const* states, const uint8_t* const* blocks, size_t count)
+{
+    size_t l = 0;
+    if (ArmSHA512::accelerated()) {
+        for (; l + 4 <= count; l += 4) {
+            compressLanes<4>(states + l, blocks + l);
+        }
+        for (; l + 2 <= count; l += 2) {
+            compressLanes<2>(states + l, blocks + l);
+        }
+        for (; l < count; ++l) {
+            compressLanes<1>(states + l, blocks + l);
+        }
+    }
+    else {
+        for (; l < count; ++l) {
+            SHA512::compress(states[l], blocks[l]);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Add some part of the message to hash in each lane. Can be called several times.
+//----------------------------------------------------------------------------
+
+bool ArmSHA512Multi::add(const void* const* data, const size_t* sizes)
+{
+    // Filter invalid internal state.
+    for (size_t l = 0; l < _lanes; ++l) {
+        if (_curlen[l] >= BLOCK_SIZE) {
+            return false;
+        }
+    }
+
+    const uint8_t* in[MAX_LANES];
+    size_t size[MAX_LANES];
+    for (size_t l = 0; l < _lanes; ++l) {
+        in[l] = reinterpret_cast<const uint8_t*>(data[l]);
+        size[l] = sizes[l];
+    }
+
+    // In each iteration, collect one complete block per lane, when available.
+    for (;;) {
+        uint64_t* states[MAX_LANES];
+        const uint8_t* blocks[MAX_LANES];
+        size_t count = 0;
+        for (size_t l = 0; l < _lanes; ++l) {
+            const uint8_t* block = nullptr;
+            if (_curlen[l] == 0 && size[l] >= BLOCK_SIZE) {
+                // Compress one 1024-bit block directly from user's buffer.
+                block = in[l];
+                in[l] += BLOCK_SIZE;
+                size[l] -= BLOCK_SIZE;
+            }
+            else if (size[l] > 0) {
+                // Partial block, accumulate input data in internal buffer.
+                const size_t n = std::min(size[l], BLOCK_SIZE - _curlen[l]);
+                ::memcpy(_buf[l] + _curlen[l], in[l], n);
+                _curlen[l] += n;
+                in[l] += n;
+                size[l] -= n;
+                if (_curlen[l] == BLOCK_SIZE) {
+                    block = _buf[l];
+                    _curlen[l] = 0;
+                }
+            }
+            if (block != nullptr) {
+                _length[l] += 8 * BLOCK_SIZE;
+                states[count] = _state[l];
+                blocks[count++] = block;
+            }
+        }
+        if (count == 0) {
+            return true;
+        }
+        compress(states, blocks, count);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the resulting hash value in each lane.
+//----------------------------------------------------------------------------
+
+bool ArmSHA512Multi::getHash(void* const* hashes, size_t bufsize)
+{
+    // Filter invalid internal state or invalid input.
+    if (bufsize < HASH_SIZE) {
+        return false;
+    }
+    for (size_t l = 0; l < _lanes; ++l) {
+        if (_curlen[l] >= BLOCK_SIZE) {
+            return false;
+        }
+    }
+
+    // Pad each lane in its buffer, same as ArmSHA512::getHash(). The padding
+    // uses two blocks when there is no room for the length after the '1' bit.
+    uint64_t* states[2][MAX_LANES];
+    const uint8_t* blocks[2][MAX_LANES];
+    size_t count[2] = {0, 0};
+    for (size_t l = 0; l < _lanes; ++l) {
+        const size_t size = _curlen[l] + 1 > 112 ? 2 * BLOCK_SIZE : BLOCK_SIZE;
+        _length[l] += _curlen[l] * 8;
+        _buf[l][_curlen[l]++] = 0x80;
+        bzero(_buf[l] + _curlen[l], size - 8 - _curlen[l]);
+        PutUInt64(_buf[l] + size - 8, _length[l]);
+        states[0][count[0]] = _state[l];
+        blocks[0][count[0]++] = _buf[l];
+        if (size > BLOCK_SIZE) {
+            states[1][count[1]] = _state[l];
+            blocks[1][count[1]++] = _buf[l] + BLOCK_SIZE;
+        }
+        _curlen[l] = 0;
+    }
+    compress(states[0], blocks[0], count[0]);
+    compress(states[1], blocks[1], count[1]);
+
+    // Copy output
+    for (size_t l = 0; l < _lanes; ++l) {
+        uint8_t* out = reinterpret_cast<uint8_t*>(hashes[l]);
+        for (size_t i = 0; i < 8; i++) {
+            PutUInt64(out + 8*i, _state[l][i]);
+        }
+    }
+    return true;
+}
@@ -9,24 +9,115 @@
 //----------------------------------------------------------------------------
 
 #pragma once
-#include "platform.h"
+#include "SHA512.h"
 
-class ArmSHA512
+// Parameters of the SHA-2 variants with 64-bit words. They use the same compression
+// function, only the initial value and the size of the truncated output are different.
+struct SHA512Policy
+{
+    static const size_t HASH_SIZE = 64;  //!< SHA-512 hash size in bytes.
+    static const uint64_t IV[8];         //!< Initial hash value.
+};
+
+struct SHA384Policy
+{
+    static const size_t HASH_SIZE = 48;  //!< SHA-384 hash size in bytes.
+    static const uint64_t IV[8];         //!< Initial hash value.
+};
+
+struct SHA512_256Policy
+{
+    static const size_t HASH_SIZE = 32;  //!< SHA-512/256 hash size in bytes.
+    static const uint64_t IV[8];         //!< Initial hash value.
+};
+
+// Compression function, common to all variants.
+class ArmSHA512Core
 {
 public:
-    static const size_t HASH_SIZE  =  64;  //!< SHA-512 hash size in bytes (512 bits).
     static const size_t BLOCK_SIZE = 128;  //!< SHA-512 block size in bytes (1024 bits).
 
-    ArmSHA512();
+    // Check if the SHA-512 instructions are present, detected once at run time.
+    // When they are not, the portable compression function of class SHA512 is used.
+    static bool accelerated();
+
+protected:
+    // Compress count consecutive 1024-bit blocks, accumulate hash in state.
+    typedef void (*CompressFunction)(uint64_t* state, const uint8_t* buf, size_t count);
+    static void compressArm(uint64_t* state, const uint8_t* buf, size_t count) TARGET_SHA3;
+    static void compressPortable(uint64_t* state, const uint8_t* buf, size_t count);
+};
+
+// SHA-512, SHA-384 and SHA-512/256 hash computation.
+template <class POLICY>
+class ArmSHA512Family : public ArmSHA512Core
+{
+public:
+    static const size_t HASH_SIZE = POLICY::HASH_SIZE;
+
+    ArmSHA512Family();
     bool init();
     bool add(const void* data, size_t size);
     bool getHash(void* hash, size_t bufsize, size_t* retsize = nullptr);
 
+    // Make add() compress the complete blocks with one call per block, as the previous
+    // implementation did. For comparison in sha512_perf only, the default is one call.
+    void setBlockByBlock(bool on) { _block_by_block = on; }
+
 private:
     uint64_t _length;                // Total message size in bits (already hashed, ie. excluding _buf)
     size_t   _curlen;                // Used bytes in _buf
-    uint64_t _state[HASH_SIZE / 8];  // Current hash value (512 bits, 64 bytes, 8 uint64)
+    uint64_t _state[8];              // Current hash value (512 bits, truncated in the final hash)
     uint8_t  _buf[BLOCK_SIZE];       // Current block to hash (1024 bits, 128 bytes)
 
-    void compress(const uint8_t* buf);
+    // The compression function is selected once, using the SHA-512 instructions when present.
+    CompressFunction _compress;
+    bool _block_by_block;            // One call to _compress per block in add() (comparison only)
+
+    // PBKDF2 uses the states directly.
+    friend class PBKDF2SHA512;
+};
+
+typedef ArmSHA512Family<SHA512Policy> ArmSHA512;
+typedef ArmSHA512Family<SHA384Policy> ArmSHA384;
+typedef ArmSHA512Family<SHA512_256Policy> ArmSHA512_256;
+
+// Multi-buffer SHA-512: up to 4 independent hashes (lanes) in the same object.
+// Each lane has the same semantics as an ArmSHA512 instance: add() can be called
+// several times, with distinct sizes per lane, possibly zero. When several lanes
+// have a complete block to compress, the blocks are compressed in the same loop
+// so that the SHA-512 instructions of the various lanes fill the latency gaps.
+class ArmSHA512Multi
+{
+public:
+    static const size_t HASH_SIZE  = SHA512Policy::HASH_SIZE;
+    static const size_t BLOCK_SIZE = ArmSHA512Core::BLOCK_SIZE;
+    static const size_t MAX_LANES  = 4;
+
+    ArmSHA512Multi(size_t lanes = MAX_LANES);
+    size_t lanes() const { return _lanes; }
+    bool init();
+
+    // Add data[i] (sizes[i] bytes) in lane i, for each lane.
+    bool add(const void* const* data, const size_t* sizes);
+
+    // Get the hash of lane i in hashes[i], for each lane, each buffer with bufsize bytes.
+    bool getHash(void* const* hashes, size_t bufsize);
+
+private:
+    size_t   _lanes;
+    uint64_t _length[MAX_LANES];     // Total message size in bits (already hashed, ie. excluding _buf)
+    size_t   _curlen[MAX_LANES];     // Used bytes in _buf
+    uint64_t _state[MAX_LANES][8];   // Current hash value of each lane
+    uint8_t  _buf[MAX_LANES][2 * BLOCK_SIZE];  // Current block, two for the padding at the end
+
+    // Compress the given blocks, accumulate hashes in states, by groups of 4, 2, 1.
+    static void compress(uint64_t* const* states, const uint8_t* const* blocks, size_t count);
+
+    // Compress one block in each of N independent states, in the same loop.
+    template <size_t N>
+    static void compressLanes(uint64_t* const* states, const uint8_t* const* blocks) TARGET_SHA3;
+
+    // PBKDF2 uses the multi-lane compression.
+    friend class PBKDF2SHA512;
 };
@@ -0,0 +1,25 @@
+//----------------------------------------------------------------------------
+//
+// Arm64 CPU system registers tools
+// Copyright (c) 2023, Thierry Lelegard
+// BSD-2-Clause license, see the LICENSE file.
+//
+// Implementation of PBKDF2-HMAC-SHA-512 (RFC 8018) using the compression
+// functions of class ArmSHA512 directly.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "HMACSHA512.h"
+
+class PBKDF2SHA512
+{
+public:
+    static const size_t MAX_LANES = ArmSHA512Multi::MAX_LANES;
+
+    // Derive key_size bytes from a password and a salt, with the given number of iterations.
+    // Up to 'lanes' output blocks of 64 bytes are computed together, their compressions are
+    // interleaved in the same loop when the SHA-512 instructions are present.
+    static bool derive(const void* password, size_t password_size, const void* salt, size_t salt_size,
+                       size_t iterations, void* key, size_t key_size, size_t lanes = MAX_LANES);
+};
@@ -106,13 +106,13 @@ bool SHA512::init()
 // Compress part of message
 //----------------------------------------------------------------------------
 
-void SHA512::compress(const uint8_t* buf)
+void SHA512::compress(uint64_t* state, const uint8_t* buf)
 {
     uint64_t S[8], W[80];
 
     // Copy state into S
     for (size_t i = 0; i < 8; i++) {
-        S[i] = _state[i];
+        S[i] = state[i];
     }
 
     // Copy the state into 1024-bits into W[0..15]
@@ -148,7 +148,7 @@ void SHA512::compress(const uint8_t* buf)
 
     // Feedback
     for (size_t i = 0; i < 8; i++) {
-        _state[i] = _state[i] + S[i];
+        state[i] = state[i] + S[i];
     }
 }
 
@@ -168,7 +168,7 @@ bool SHA512::add(const void* data, size_t size)
     while (size > 0) {
         if (_curlen == 0 && size >= BLOCK_SIZE) {
             // Compress one 1024-bit block directly from user's buffer.
-            compress(in);
+            compress(_state, in);
             _length += BLOCK_SIZE * 8;
             in += BLOCK_SIZE;
             size -= BLOCK_SIZE;
@@ -181,7 +181,7 @@ bool SHA512::add(const void* data, size_t size)
             in += n;
             size -= n;
             if (_curlen == BLOCK_SIZE) {
-                compress(_buf);
+                compress(_state, _buf);
                 _length += 8 * BLOCK_SIZE;
                 _curlen = 0;
             }
@@ -212,7 +212,7 @@ bool SHA512::getHash(void* hash, size_t bufsize, size_t* retsize)
     // If the length is currently above 112 bytes (no room for message length), append zeroes then compress.
     if (_curlen > 112) {
         bzero(_buf + _curlen, 128 - _curlen);
-        compress(_buf);
+        compress(_state, _buf);
         _curlen = 0;
     }
 
@@ -220,7 +220,7 @@ bool SHA512::getHash(void* hash, size_t bufsize, size_t* retsize)
     // Note: zeroes from 112 to 120 are the 64 MSB of the length. We assume that you won't hash > 2^64 bits of data.
     bzero(_buf + _curlen, 120 - _curlen);
     PutUInt64(_buf + 120, _length);
-    compress(_buf);
+    compress(_state, _buf);
 
     // Copy output
     uint8_t* out = reinterpret_cast<uint8_t*>(hash);
@@ -22,11 +22,13 @@ public:
     bool add(const void* data, size_t size);
     bool getHash(void* hash, size_t bufsize, size_t* retsize = nullptr);
 
+    // Compress one block, accumulate hash in state. Also used by ArmSHA512 when
+    // the SHA-512 instructions are not present.
+    static void compress(uint64_t* state, const uint8_t* buf);
+
 private:
     uint64_t _length;                // Total message size in bits (already hashed, ie. excluding _buf)
     size_t   _curlen;                // Used bytes in _buf
     uint64_t _state[HASH_SIZE / 8];  // Current hash value (512 bits, 64 bytes, 8 uint64)
     uint8_t  _buf[BLOCK_SIZE];       // Current block to hash (1024 bits, 128 bytes)
-
-    void compress(const uint8_t* buf);
 };
@@ -11,13 +11,20 @@
 
 #include "SHA512.h"
 #include "ArmSHA512.h"
+#include "HMACSHA512.h"
+#include "PBKDF2SHA512.h"
+#include "HKDFSHA512.h"
 #include <ios>
 #include <iomanip>
 #include <iostream>
 #include <cstdlib>
+#include <vector>
+#include <string>
 #include <sys/resource.h>
 
 #define DEFAULT_ITERATIONS 10000000
+#define PBKDF2_ITERATIONS  10000
+#define CHUNKS_SIZE        (1024 * 1024)
 
 static const uint8_t test_data[256] = {
     0x8F, 0xAA, 0xF6, 0x60, 0x79, 0x8C, 0x25, 0x3A, 0xF7, 0x51, 0x5D, 0x80, 0x8B, 0x3F, 0x7D, 0x71,
@@ -54,6 +61,335 @@ uint64_t get_user_ms()
 }
 
 
+//----------------------------------------------------------------------------
+// Number of messages per second, for a given time in milliseconds.
+//----------------------------------------------------------------------------
+
+uint64_t get_per_second(uint64_t count, uint64_t ms)
+{
+    return ms > 0 ? count * 1000 / ms : 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Hash independent messages with ArmSHA512Multi, 'lanes' at a time.
+//----------------------------------------------------------------------------
+
+uint64_t hash_lanes(const std::vector<const void*>& msgs, size_t size, size_t lanes, std::vector<uint8_t>& hashes, uint64_t loops)
+{
+    ArmSHA512Multi sha(lanes);
+    std::vector<size_t> sizes(lanes, size);
+    void* out[ArmSHA512Multi::MAX_LANES];
+
+    const uint64_t start = get_user_ms();
+    for (uint64_t n = 0; n < loops; ++n) {
+        for (size_t i = 0; i < msgs.size(); i += lanes) {
+            for (size_t l = 0; l < lanes; ++l) {
+                out[l] = &hashes[(i + l) * ArmSHA512Multi::HASH_SIZE];
+            }
+            sha.init();
+            sha.add(&msgs[i], sizes.data());
+            sha.getHash(out, ArmSHA512Multi::HASH_SIZE);
+        }
+    }
+    return get_user_ms() - start;
+}
+
+
+//----------------------------------------------------------------------------
+// Hash independent messages, one by one or using the multi-buffer hashing.
+//----------------------------------------------------------------------------
+
+void perf_multi(uint64_t total_bytes)
+{
+    static const size_t batch = 1024;  // messages per loop, multiple of 4
+
+    std::cout << std::endl << "Independent messages, messages/second, ArmSHA512 one by one / ArmSHA512Multi 2 lanes / 4 lanes" << std::endl;
+    for (size_t size : {256, 1024, 8192}) {
+        // Independent messages in one buffer.
+        std::vector<uint8_t> data(batch * size);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = test_data[i % sizeof(test_data)] ^ uint8_t(i / size);
+        }
+        std::vector<const void*> msgs(batch);
+        for (size_t i = 0; i < batch; ++i) {
+            msgs[i] = &data[i * size];
+        }
+        std::vector<uint8_t> hashes1(batch * ArmSHA512::HASH_SIZE);
+        std::vector<uint8_t> hashes2(hashes1.size());
+        std::vector<uint8_t> hashes4(hashes1.size());
+        const uint64_t loops = std::max<uint64_t>(1, total_bytes / data.size());
+        const uint64_t count = loops * batch;
+
+        ArmSHA512 sha;
+        const uint64_t start = get_user_ms();
+        for (uint64_t n = 0; n < loops; ++n) {
+            for (size_t i = 0; i < batch; ++i) {
+                sha.init();
+                sha.add(msgs[i], size);
+                sha.getHash(&hashes1[i * ArmSHA512::HASH_SIZE], ArmSHA512::HASH_SIZE);
+            }
+        }
+        const uint64_t time1 = get_user_ms() - start;
+        const uint64_t time2 = hash_lanes(msgs, size, 2, hashes2, loops);
+        const uint64_t time4 = hash_lanes(msgs, size, 4, hashes4, loops);
+
+        std::cout << "  " << std::setw(4) << size << " bytes: " << get_per_second(count, time1)
+                  << " / " << get_per_second(count, time2) << " / " << get_per_second(count, time4)
+                  << (hashes1 == hashes2 && hashes1 == hashes4 ? "" : " (INVALID HASH)") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Compute MAC's of packets, recomputing the padded keys for each MAC or
+// using the precomputed inner and outer states.
+//----------------------------------------------------------------------------
+
+void perf_hmac(uint64_t total_bytes)
+{
+    static const uint8_t key[32] = {0x4B, 0x65, 0x79, 0x20, 0x66, 0x6F, 0x72, 0x20, 0x48, 0x4D, 0x41, 0x43};
+
+    std::cout << std::endl << "HMACSHA512, MACs/second, key set for each MAC / precomputed key" << std::endl;
+    for (size_t size : {64, 256, 1500}) {
+        std::vector<uint8_t> packet(size);
+        for (size_t i = 0; i < size; ++i) {
+            packet[i] = test_data[i % sizeof(test_data)];
+        }
+        uint8_t mac1[HMACSHA512::MAC_SIZE];
+        uint8_t mac2[HMACSHA512::MAC_SIZE];
+        const uint64_t count = std::max<uint64_t>(1, total_bytes / size);
+
+        uint64_t start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            packet[0] = uint8_t(n);
+            HMACSHA512::mac(key, sizeof(key), packet.data(), size, mac1, sizeof(mac1));
+        }
+        const uint64_t time1 = get_user_ms() - start;
+
+        HMACSHA512 hmac(key, sizeof(key));
+        start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            packet[0] = uint8_t(n);
+            hmac.mac(packet.data(), size, mac2, sizeof(mac2));
+        }
+        const uint64_t time2 = get_user_ms() - start;
+
+        std::cout << "  " << std::setw(4) << size << " bytes: " << get_per_second(count, time1)
+                  << " / " << get_per_second(count, time2)
+                  << (::memcmp(mac1, mac2, sizeof(mac1)) == 0 ? "" : " (INVALID MAC)") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Reference PBKDF2, a loop on HMAC computations with the password as key.
+//----------------------------------------------------------------------------
+
+void naive_pbkdf2(const std::string& password, const std::string& salt, size_t iterations, uint8_t* key, size_t key_size)
+{
+    for (uint32_t index = 1; key_size > 0; ++index) {
+        uint8_t u[HMACSHA512::MAC_SIZE];
+        uint8_t t[HMACSHA512::MAC_SIZE];
+        uint8_t be_index[4];
+        PutUInt32(be_index, index);
+        const std::string msg(salt + std::string(reinterpret_cast<char*>(be_index), sizeof(be_index)));
+        HMACSHA512::mac(password.data(), password.size(), msg.data(), msg.size(), u, sizeof(u));
+        ::memcpy(t, u, sizeof(t));
+        for (size_t n = 1; n < iterations; ++n) {
+            HMACSHA512::mac(password.data(), password.size(), u, sizeof(u), u, sizeof(u));
+            for (size_t i = 0; i < sizeof(t); ++i) {
+                t[i] ^= u[i];
+            }
+        }
+        const size_t size = std::min(key_size, sizeof(t));
+        ::memcpy(key, t, size);
+        key += size;
+        key_size -= size;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Key derivations, using the naive HMAC loop or PBKDF2SHA512.
+//----------------------------------------------------------------------------
+
+void perf_pbkdf2(uint64_t count)
+{
+    const std::string password("correct horse battery staple");
+    const std::string salt("key-management-node-salt");
+
+    std::cout << std::endl << "PBKDF2, " << PBKDF2_ITERATIONS << " iterations, derivations/second, HMAC loop / PBKDF2SHA512 1 lane / "
+              << PBKDF2SHA512::MAX_LANES << " lanes" << std::endl;
+    for (size_t blocks : {1, 4}) {
+        const size_t size = blocks * HMACSHA512::MAC_SIZE;
+        std::vector<uint8_t> key1(size), key2(size), key3(size);
+
+        uint64_t start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            naive_pbkdf2(password, salt, PBKDF2_ITERATIONS, key1.data(), size);
+        }
+        const uint64_t time1 = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            PBKDF2SHA512::derive(password.data(), password.size(), salt.data(), salt.size(), PBKDF2_ITERATIONS, key2.data(), size, 1);
+        }
+        const uint64_t time2 = get_user_ms() - start;
+
+        start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            PBKDF2SHA512::derive(password.data(), password.size(), salt.data(), salt.size(), PBKDF2_ITERATIONS, key3.data(), size);
+        }
+        const uint64_t time3 = get_user_ms() - start;
+
+        // Use milli-derivations per second for more precision.
+        std::cout << "  " << std::setw(4) << size << "-byte key: " << (double(get_per_second(1000 * count, time1)) / 1000.0)
+                  << " / " << (double(get_per_second(1000 * count, time2)) / 1000.0)
+                  << " / " << (double(get_per_second(1000 * count, time3)) / 1000.0)
+                  << (key1 == key2 && key1 == key3 ? "" : " (INVALID KEY)") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// HKDF key derivations: complete extract and expand, or expand only with the
+// same pseudorandom key, as in the key schedule of a session setup.
+//----------------------------------------------------------------------------
+
+void perf_hkdf(uint64_t count)
+{
+    const std::string secret("shared secret from the key exchange");
+    const std::string salt("handshake salt");
+    const std::string info("tls13 key, session traffic");
+
+    std::cout << std::endl << "HKDFSHA512, keys/second, extract and expand / expand only" << std::endl;
+    for (size_t size : {size_t(16), size_t(32), 3 * HKDFSHA512::PRK_SIZE}) {
+        uint8_t key1[3 * HKDFSHA512::PRK_SIZE];
+        uint8_t key2[3 * HKDFSHA512::PRK_SIZE];
+
+        uint64_t start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            HKDFSHA512::derive(salt.data(), salt.size(), secret.data(), secret.size(), info.data(), info.size(), key1, size);
+        }
+        const uint64_t time1 = get_user_ms() - start;
+
+        HKDFSHA512 hkdf;
+        hkdf.extract(salt.data(), salt.size(), secret.data(), secret.size());
+        start = get_user_ms();
+        for (uint64_t n = 0; n < count; ++n) {
+            hkdf.expand(info.data(), info.size(), key2, size);
+        }
+        const uint64_t time2 = get_user_ms() - start;
+
+        std::cout << "  " << std::setw(4) << size << "-byte key: " << get_per_second(count, time1)
+                  << " / " << get_per_second(count, time2)
+                  << (::memcmp(key1, key2, size) == 0 ? "" : " (INVALID KEY)") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Throughput in MB/s of a hash variant, on messages of a given size.
+//----------------------------------------------------------------------------
+
+template <class HASH>
+uint64_t get_mbps(size_t size, uint64_t total_bytes)
+{
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = test_data[i % sizeof(test_data)];
+    }
+    uint8_t hash[HASH::HASH_SIZE];
+    const uint64_t count = std::max<uint64_t>(1, total_bytes / size);
+
+    HASH sha;
+    const uint64_t start = get_user_ms();
+    for (uint64_t n = 0; n < count; ++n) {
+        sha.init();
+        sha.add(data.data(), size);
+        sha.getHash(hash, sizeof(hash));
+    }
+    const uint64_t ms = get_user_ms() - start;
+    return ms > 0 ? count * size / (ms * 1000) : 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Throughput of the variants by message size. Compare with the output of
+// sha256_perf on the same system for the SHA-256 / SHA-512/256 crossover.
+//----------------------------------------------------------------------------
+
+void perf_variants(uint64_t total_bytes)
+{
+    std::cout << std::endl << "Throughput by message size, MB/s, SHA-512/256 / SHA-384 / SHA-512" << std::endl;
+    for (size_t size : {16, 64, 256, 1024, 4096, 16384}) {
+        std::cout << "  " << std::setw(5) << size << " bytes: " << get_mbps<ArmSHA512_256>(size, total_bytes) << " / " << get_mbps<ArmSHA384>(size, total_bytes) << " / " << get_mbps<ArmSHA512>(size, total_bytes) << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Streaming throughput in MB/s when a message is added in chunks of
+// pseudo-random sizes. Most chunks start at an unaligned address.
+//----------------------------------------------------------------------------
+
+template <class HASH>
+uint64_t get_chunks_mbps(HASH& sha, const std::vector<uint8_t>& data, const std::vector<size_t>& chunks, uint64_t loops, uint8_t* hash)
+{
+    const uint64_t start = get_user_ms();
+    for (uint64_t n = 0; n < loops; ++n) {
+        sha.init();
+        const uint8_t* in = data.data();
+        for (size_t size : chunks) {
+            sha.add(in, size);
+            in += size;
+        }
+        sha.getHash(hash, HASH::HASH_SIZE);
+    }
+    const uint64_t ms = get_user_ms() - start;
+    return ms > 0 ? loops * data.size() / (ms * 1000) : 0;
+}
+
+void perf_chunks(uint64_t total_bytes)
+{
+    std::vector<uint8_t> data(CHUNKS_SIZE);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = test_data[i % sizeof(test_data)] ^ uint8_t(i >> 8);
+    }
+    const std::vector<size_t> whole(1, data.size());
+    const uint64_t loops = std::max<uint64_t>(1, total_bytes / data.size());
+
+    std::cout << std::endl << "Random chunk sizes, " << data.size() << "-byte messages, MB/s, SHA512 / ArmSHA512 one call per block (previous) / ArmSHA512 (ArmSHA512 with one add)" << std::endl;
+    for (size_t max_chunk : {64, 4096, 65536}) {
+        // Chunks of 1 to max_chunk bytes, the same sequence in each run.
+        std::vector<size_t> chunks;
+        uint32_t seed = 12345;
+        for (size_t total = 0; total < data.size(); total += chunks.back()) {
+            seed = seed * 1103515245 + 12345;
+            chunks.push_back(std::min<size_t>(1 + (seed >> 8) % max_chunk, data.size() - total));
+        }
+
+        SHA512 s1;
+        ArmSHA512 s2;
+        s2.setBlockByBlock(true);
+        ArmSHA512 s3;
+        uint8_t hash1[SHA512::HASH_SIZE];
+        uint8_t hash2[SHA512::HASH_SIZE];
+        uint8_t hash3[SHA512::HASH_SIZE];
+        uint8_t hash4[SHA512::HASH_SIZE];
+        const uint64_t mbps1 = get_chunks_mbps(s1, data, chunks, loops, hash1);
+        const uint64_t mbps2 = get_chunks_mbps(s2, data, chunks, loops, hash2);
+        const uint64_t mbps3 = get_chunks_mbps(s3, data, chunks, loops, hash3);
+        const uint64_t mbps4 = get_chunks_mbps(s3, data, whole, loops, hash4);
+
+        std::cout << "  1 to " << std::setw(5) << max_chunk << " bytes: " << mbps1 << " / " << mbps2 << " / " << mbps3 << " (" << mbps4 << ")"
+                  << (::memcmp(hash1, hash4, sizeof(hash1)) == 0 && ::memcmp(hash2, hash4, sizeof(hash2)) == 0 &&
+                      ::memcmp(hash3, hash4, sizeof(hash3)) == 0 ? "" : " (INVALID HASH)") << std::endl;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Program entry point.
 //----------------------------------------------------------------------------
@@ -63,6 +399,7 @@ int main(int argc, char* argv[])
     const int iterations = argc > 1 ? std::atoi(argv[1]) : DEFAULT_ITERATIONS;
 
     std::cout << "SHA-512 performance test, " << iterations << " iterations, " << sizeof(test_data) << " bytes" << std::endl;
+    std::cout << "ArmSHA512 implementation: " << (ArmSHA512::accelerated() ? "Arm64 SHA512 instructions" : "portable") << std::endl;
 
     SHA512 sha;
     ArmSHA512 arm_sha;
@@ -96,5 +433,12 @@ int main(int argc, char* argv[])
         std::cout << "Performance ratio: " << (double(time1) / double(time2)) << std::endl;
     }
 
+    perf_multi(uint64_t(iterations) * sizeof(test_data));
+    perf_variants(uint64_t(iterations) * sizeof(test_data));
+    perf_chunks(uint64_t(iterations) * sizeof(test_data));
+    perf_hmac(uint64_t(iterations) * sizeof(test_data));
+    perf_pbkdf2(std::max<uint64_t>(1, iterations / 1000000));
+    perf_hkdf(std::max<uint64_t>(1, iterations / 10));
+
     return EXIT_SUCCESS;
 }
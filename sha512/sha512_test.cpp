@@ -11,9 +11,14 @@
 
 #include "SHA512.h"
 #include "ArmSHA512.h"
+#include "HMACSHA512.h"
+#include "PBKDF2SHA512.h"
+#include "HKDFSHA512.h"
 #include <ios>
 #include <iomanip>
 #include <iostream>
+#include <vector>
+#include <string>
 
 struct TestData {
     size_t size;
@@ -66,6 +71,405 @@ static const TestData test_data[] = {
 };
 
 
+//----------------------------------------------------------------------------
+// Test the streaming hashing of a message added in chunks of pseudo-random
+// sizes, at any alignment, compared with the portable implementation.
+//----------------------------------------------------------------------------
+
+void test_chunks()
+{
+    std::vector<uint8_t> msg(20000);
+    for (size_t i = 0; i < msg.size(); ++i) {
+        msg[i] = uint8_t(i * 13 + (i >> 8));
+    }
+    uint8_t expected[SHA512::HASH_SIZE];
+    SHA512 sha;
+    sha.add(msg.data(), msg.size());
+    sha.getHash(expected, sizeof(expected));
+
+    for (size_t max_chunk : {1, 7, 127, 128, 129, 384, 4000}) {
+        // Chunks of 0 to max_chunk bytes, around the block size and larger.
+        uint32_t seed = 12345;
+        uint8_t hash[SHA512::HASH_SIZE];
+        ArmSHA512 arm_sha;
+        ArmSHA512 block_sha;  // previous add(), one compression call per block
+        block_sha.setBlockByBlock(true);
+        for (size_t total = 0; total < msg.size(); ) {
+            seed = seed * 1103515245 + 12345;
+            const size_t size = std::min<size_t>((seed >> 8) % (max_chunk + 1), msg.size() - total);
+            arm_sha.add(msg.data() + total, size);
+            block_sha.add(msg.data() + total, size);
+            total += size;
+        }
+        arm_sha.getHash(hash, sizeof(hash));
+        uint8_t block_hash[sizeof(hash)];
+        block_sha.getHash(block_hash, sizeof(block_hash));
+        const bool ok = ::memcmp(hash, expected, sizeof(hash)) == 0 && ::memcmp(block_hash, expected, sizeof(block_hash)) == 0;
+        std::cout << msg.size() << " bytes, ArmSHA512, chunks of 0 to " << max_chunk << " bytes: " << (ok ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test the multi-buffer hashing: messages of distinct sizes in each lane,
+// added in chunks of various sizes, compared with the portable implementation.
+//----------------------------------------------------------------------------
+
+void test_multi()
+{
+    static const size_t sizes[] = {0, 1, 111, 112, 127, 128, 129, 239, 240, 256, 1000, 4096, 10000};
+    static const size_t chunks[] = {1, 7, 64, 128, 300, 100000};
+    const size_t count = sizeof(sizes) / sizeof(sizes[0]);
+
+    std::vector<std::vector<uint8_t>> msgs;
+    std::vector<uint8_t> expected;
+    for (size_t size : sizes) {
+        msgs.emplace_back(size);
+        for (size_t i = 0; i < size; ++i) {
+            msgs.back()[i] = uint8_t(i * 13 + size);
+        }
+        uint8_t hash[SHA512::HASH_SIZE];
+        SHA512 sha;
+        sha.add(msgs.back().data(), size);
+        sha.getHash(hash, sizeof(hash));
+        expected.insert(expected.end(), hash, hash + sizeof(hash));
+    }
+
+    for (size_t lanes = 1; lanes <= ArmSHA512Multi::MAX_LANES; ++lanes) {
+        bool ok = true;
+        ArmSHA512Multi sha(lanes);
+        // Rotate the messages over the lanes, each lane with its own chunk size.
+        for (size_t first = 0; first < count; ++first) {
+            size_t index[ArmSHA512Multi::MAX_LANES];
+            size_t done[ArmSHA512Multi::MAX_LANES];
+            for (size_t l = 0; l < lanes; ++l) {
+                index[l] = (first + 3 * l) % count;
+                done[l] = 0;
+            }
+            sha.init();
+            for (bool more = true; more; ) {
+                const void* data[ArmSHA512Multi::MAX_LANES];
+                size_t size[ArmSHA512Multi::MAX_LANES];
+                more = false;
+                for (size_t l = 0; l < lanes; ++l) {
+                    const std::vector<uint8_t>& msg(msgs[index[l]]);
+                    size[l] = std::min(chunks[(first + l) % 6], msg.size() - done[l]);
+                    data[l] = msg.data() + done[l];
+                    done[l] += size[l];
+                    more = more || done[l] < msg.size();
+                }
+                ok = sha.add(data, size) && ok;
+            }
+            uint8_t hash[ArmSHA512Multi::MAX_LANES][SHA512::HASH_SIZE];
+            void* hashes[ArmSHA512Multi::MAX_LANES];
+            for (size_t l = 0; l < lanes; ++l) {
+                hashes[l] = hash[l];
+            }
+            ok = sha.getHash(hashes, SHA512::HASH_SIZE) && ok;
+            for (size_t l = 0; l < lanes; ++l) {
+                ok = ok && ::memcmp(hash[l], &expected[index[l] * SHA512::HASH_SIZE], SHA512::HASH_SIZE) == 0;
+            }
+        }
+        std::cout << count << " messages, ArmSHA512Multi, " << lanes << " lanes: " << (ok ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test HMAC-SHA-512 with the test cases 1, 2 and 6 of RFC 4231 (a key larger
+// than the block size in the last one), using the incremental and the one-shot
+// computations.
+//----------------------------------------------------------------------------
+
+void test_hmac()
+{
+    struct HMACTestData {
+        std::string key;
+        std::string message;
+        uint8_t mac[HMACSHA512::MAC_SIZE];
+    };
+    static const HMACTestData hmac_data[] = {
+        {
+            std::string(20, char(0x0B)),
+            "Hi There",
+            {0x87, 0xAA, 0x7C, 0xDE, 0xA5, 0xEF, 0x61, 0x9D, 0x4F, 0xF0, 0xB4, 0x24, 0x1A, 0x1D, 0x6C, 0xB0,
+             0x23, 0x79, 0xF4, 0xE2, 0xCE, 0x4E, 0xC2, 0x78, 0x7A, 0xD0, 0xB3, 0x05, 0x45, 0xE1, 0x7C, 0xDE,
+             0xDA, 0xA8, 0x33, 0xB7, 0xD6, 0xB8, 0xA7, 0x02, 0x03, 0x8B, 0x27, 0x4E, 0xAE, 0xA3, 0xF4, 0xE4,
+             0xBE, 0x9D, 0x91, 0x4E, 0xEB, 0x61, 0xF1, 0x70, 0x2E, 0x69, 0x6C, 0x20, 0x3A, 0x12, 0x68, 0x54}
+        },
+        {
+            "Jefe",
+            "what do ya want for nothing?",
+            {0x16, 0x4B, 0x7A, 0x7B, 0xFC, 0xF8, 0x19, 0xE2, 0xE3, 0x95, 0xFB, 0xE7, 0x3B, 0x56, 0xE0, 0xA3,
+             0x87, 0xBD, 0x64, 0x22, 0x2E, 0x83, 0x1F, 0xD6, 0x10, 0x27, 0x0C, 0xD7, 0xEA, 0x25, 0x05, 0x54,
+             0x97, 0x58, 0xBF, 0x75, 0xC0, 0x5A, 0x99, 0x4A, 0x6D, 0x03, 0x4F, 0x65, 0xF8, 0xF0, 0xE6, 0xFD,
+             0xCA, 0xEA, 0xB1, 0xA3, 0x4D, 0x4A, 0x6B, 0x4B, 0x63, 0x6E, 0x07, 0x0A, 0x38, 0xBC, 0xE7, 0x37}
+        },
+        {
+            std::string(131, char(0xAA)),
+            "Test Using Larger Than Block-Size Key - Hash Key First",
+            {0x80, 0xB2, 0x42, 0x63, 0xC7, 0xC1, 0xA3, 0xEB, 0xB7, 0x14, 0x93, 0xC1, 0xDD, 0x7B, 0xE8, 0xB4,
+             0x9B, 0x46, 0xD1, 0xF4, 0x1B, 0x4A, 0xEE, 0xC1, 0x12, 0x1B, 0x01, 0x37, 0x83, 0xF8, 0xF3, 0x52,
+             0x6B, 0x56, 0xD0, 0x37, 0xE0, 0x5F, 0x25, 0x98, 0xBD, 0x0F, 0xD2, 0x21, 0x5D, 0x6A, 0x1E, 0x52,
+             0x95, 0xE6, 0x4F, 0x73, 0xF6, 0x3F, 0x0A, 0xEC, 0x8B, 0x91, 0x5A, 0x98, 0x5D, 0x78, 0x65, 0x98}
+        }
+    };
+
+    for (const auto& test : hmac_data) {
+        uint8_t mac1[HMACSHA512::MAC_SIZE];
+        uint8_t mac2[HMACSHA512::MAC_SIZE];
+        uint8_t mac3[HMACSHA512::MAC_SIZE];
+        HMACSHA512 hmac(test.key.data(), test.key.size());
+        // Incremental, in two parts.
+        const size_t half = test.message.size() / 2;
+        const bool ok1 = hmac.add(test.message.data(), half) &&
+                         hmac.add(test.message.data() + half, test.message.size() - half) &&
+                         !hmac.getMAC(mac1, sizeof(mac1) - 1) &&   // rejected, state unchanged
+                         !hmac.getMAC(nullptr, sizeof(mac1)) &&
+                         hmac.getMAC(mac1, sizeof(mac1)) &&
+                         ::memcmp(mac1, test.mac, sizeof(mac1)) == 0;
+        // One-shot with the precomputed key, twice, then with the key.
+        const bool ok2 = hmac.mac(test.message.data(), test.message.size(), mac2, sizeof(mac2)) &&
+                         hmac.mac(test.message.data(), test.message.size(), mac2, sizeof(mac2)) &&
+                         ::memcmp(mac2, test.mac, sizeof(mac2)) == 0;
+        const bool ok3 = HMACSHA512::mac(test.key.data(), test.key.size(), test.message.data(), test.message.size(), mac3, sizeof(mac3)) &&
+                         ::memcmp(mac3, test.mac, sizeof(mac3)) == 0;
+        std::cout << std::setw(3) << test.key.size() << "-byte key, HMACSHA512: " << (ok1 && ok2 && ok3 ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test PBKDF2-HMAC-SHA-512, with the passwords and salts of RFC 6070 and
+// RFC 7914. The last one has a password larger than the block size and several
+// groups of output blocks. Check all numbers of lanes.
+//----------------------------------------------------------------------------
+
+void test_pbkdf2()
+{
+    struct PBKDF2TestData {
+        std::string password;
+        std::string salt;
+        size_t iterations;
+        size_t size;
+        uint8_t key[200];
+    };
+    static const PBKDF2TestData pbkdf2_data[] = {
+        {
+            "passwd",
+            "salt",
+            1,
+            64,
+            {0xC7, 0x43, 0x19, 0xD9, 0x94, 0x99, 0xFC, 0x3E, 0x90, 0x13, 0xAC, 0xFF, 0x59, 0x7C, 0x23, 0xC5,
+             0xBA, 0xF0, 0xA0, 0xBE, 0xC5, 0x63, 0x4C, 0x46, 0xB8, 0x35, 0x2B, 0x79, 0x3E, 0x32, 0x47, 0x23,
+             0xD5, 0x5C, 0xAA, 0x76, 0xB2, 0xB2, 0x5C, 0x43, 0x40, 0x2D, 0xCF, 0xDC, 0x06, 0xCD, 0xCF, 0x66,
+             0xF9, 0x5B, 0x7D, 0x04, 0x29, 0x42, 0x0B, 0x39, 0x52, 0x00, 0x06, 0x74, 0x9C, 0x51, 0xA0, 0x4E}
+        },
+        {
+            "Password",
+            "NaCl",
+            80000,
+            64,
+            {0xE6, 0x33, 0x7D, 0x6F, 0xBE, 0xB6, 0x45, 0xC7, 0x94, 0xD4, 0xA9, 0xB5, 0xB7, 0x5B, 0x7B, 0x30,
+             0xDA, 0xC9, 0xAC, 0x50, 0x37, 0x6A, 0x91, 0xDF, 0x1F, 0x44, 0x60, 0xF6, 0x06, 0x0D, 0x5A, 0xDD,
+             0xB2, 0xC1, 0xFD, 0x1F, 0x84, 0x40, 0x9A, 0xBA, 0xCC, 0x67, 0xDE, 0x7E, 0xB4, 0x05, 0x6E, 0x6B,
+             0xB0, 0x6C, 0x2D, 0x82, 0xC3, 0xEF, 0x4C, 0xCD, 0x1B, 0xDE, 0xD0, 0xF6, 0x75, 0xED, 0x97, 0xC6}
+        },
+        {
+            "password",
+            "salt",
+            4096,
+            20,
+            {0xD1, 0x97, 0xB1, 0xB3, 0x3D, 0xB0, 0x14, 0x3E, 0x01, 0x8B, 0x12, 0xF3, 0xD1, 0xD1, 0x47, 0x9E,
+             0x6C, 0xDE, 0xBD, 0xCC}
+        },
+        {
+            "passwordPASSWORDpassword" "passwordPASSWORDpassword" "passwordPASSWORDpassword" "passwordPASSWORDpassword"
+            "passwordPASSWORDpassword" "passwordPASSWORDpassword" "passwordPASSWORDpassword" "passwordPASSWORDpassword",
+            "saltSALTsaltSALTsaltSALTsaltSALTsalt",
+            1000,
+            200,
+            {0x63, 0xFB, 0x3A, 0x46, 0x58, 0x95, 0x3C, 0x18, 0xF0, 0xC6, 0x3A, 0xBF, 0x25, 0x2B, 0xD4, 0xD6,
+             0xBE, 0xA4, 0x43, 0x34, 0xE0, 0x06, 0x6A, 0x7A, 0xF8, 0x91, 0x8E, 0x35, 0x8A, 0x43, 0xC3, 0x6C,
+             0x91, 0xE1, 0x85, 0x1A, 0x78, 0x90, 0xE2, 0xDA, 0x89, 0x25, 0x8D, 0x03, 0x94, 0x6F, 0x37, 0xAD,
+             0x25, 0xB6, 0xFC, 0x99, 0x65, 0xE0, 0x7E, 0x94, 0x56, 0xE0, 0xBD, 0x12, 0x46, 0x13, 0x16, 0x74,
+             0xB7, 0x1E, 0xEB, 0xEE, 0xB9, 0x0A, 0x02, 0xC8, 0xB6, 0x4B, 0x12, 0xA8, 0x6F, 0x95, 0x60, 0x69,
+             0xED, 0xB2, 0xAE, 0x2F, 0xAD, 0xC3, 0x60, 0xC6, 0x3E, 0x77, 0xFD, 0xCF, 0xE2, 0x8E, 0x00, 0x75,
+             0x48, 0xD6, 0x13, 0xB3, 0x66, 0x69, 0x74, 0x63, 0xB5, 0x2A, 0x17, 0xCB, 0xA6, 0x07, 0x52, 0x04,
+             0xDA, 0xA6, 0x80, 0x05, 0x65, 0xF8, 0xAE, 0x3C, 0x5F, 0xC0, 0xCE, 0x9F, 0xEC, 0x99, 0xDC, 0xB8,
+             0xB4, 0x3F, 0xC9, 0xFC, 0x4B, 0x5F, 0x11, 0x69, 0x02, 0x2A, 0xC1, 0xCA, 0xDA, 0xD6, 0xBF, 0xD6,
+             0x9C, 0x2E, 0x43, 0x8F, 0x67, 0xAA, 0x24, 0x7E, 0x21, 0x53, 0x97, 0x27, 0x5B, 0x40, 0x15, 0x45,
+             0x62, 0x6A, 0x36, 0x57, 0x65, 0xC0, 0xF8, 0x3A, 0x37, 0x3C, 0x18, 0x5E, 0x9B, 0xD8, 0x5F, 0x9C,
+             0x99, 0xB0, 0xD0, 0x13, 0xEF, 0x16, 0xDF, 0x6A, 0xAF, 0xCC, 0x78, 0x90, 0x9F, 0xDD, 0xF2, 0xBB,
+             0x18, 0x49, 0x17, 0x27, 0x77, 0x51, 0x8B, 0x91}
+        }
+    };
+
+    for (const auto& test : pbkdf2_data) {
+        bool ok = true;
+        for (size_t lanes = 1; lanes <= PBKDF2SHA512::MAX_LANES; ++lanes) {
+            uint8_t key[sizeof(test.key)];
+            ok = PBKDF2SHA512::derive(test.password.data(), test.password.size(), test.salt.data(), test.salt.size(),
+                                     test.iterations, key, test.size, lanes) &&
+                 ::memcmp(key, test.key, test.size) == 0 && ok;
+        }
+        std::cout << std::setw(5) << test.iterations << " iterations, " << std::setw(3) << test.size
+                  << " bytes, PBKDF2SHA512: " << (ok ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test HKDF-SHA-512 with the inputs of the RFC 5869 test cases 1 to 3,
+// using the extract and expand steps, then the one-shot derivation.
+//----------------------------------------------------------------------------
+
+void test_hkdf()
+{
+    struct HKDFTestData {
+        size_t ikm_size;
+        uint8_t ikm[80];
+        size_t salt_size;
+        uint8_t salt[80];
+        size_t info_size;
+        uint8_t info[80];
+        uint8_t prk[HKDFSHA512::PRK_SIZE];
+        size_t okm_size;
+        uint8_t okm[82];
+    };
+    static const HKDFTestData hkdf_data[] = {
+        {
+            22, {0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B,
+                 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B},
+            13, {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C},
+            10, {0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9},
+            {0x66, 0x57, 0x99, 0x82, 0x37, 0x37, 0xDE, 0xD0, 0x4A, 0x88, 0xE4, 0x7E, 0x54, 0xA5, 0x89, 0x0B,
+             0xB2, 0xC3, 0xD2, 0x47, 0xC7, 0xA4, 0x25, 0x4A, 0x8E, 0x61, 0x35, 0x07, 0x23, 0x59, 0x0A, 0x26,
+             0xC3, 0x62, 0x38, 0x12, 0x7D, 0x86, 0x61, 0xB8, 0x8C, 0xF8, 0x0E, 0xF8, 0x02, 0xD5, 0x7E, 0x2F,
+             0x7C, 0xEB, 0xCF, 0x1E, 0x00, 0xE0, 0x83, 0x84, 0x8B, 0xE1, 0x99, 0x29, 0xC6, 0x1B, 0x42, 0x37},
+            42, {0x83, 0x23, 0x90, 0x08, 0x6C, 0xDA, 0x71, 0xFB, 0x47, 0x62, 0x5B, 0xB5, 0xCE, 0xB1, 0x68, 0xE4,
+                 0xC8, 0xE2, 0x6A, 0x1A, 0x16, 0xED, 0x34, 0xD9, 0xFC, 0x7F, 0xE9, 0x2C, 0x14, 0x81, 0x57, 0x93,
+                 0x38, 0xDA, 0x36, 0x2C, 0xB8, 0xD9, 0xF9, 0x25, 0xD7, 0xCB}
+        },
+        {
+            80, {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+                 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+                 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
+                 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
+                 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F},
+            80, {0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
+                 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,
+                 0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
+                 0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F,
+                 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF},
+            80, {0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+                 0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+                 0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+                 0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
+                 0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF},
+            {0x35, 0x67, 0x25, 0x42, 0x90, 0x7D, 0x4E, 0x14, 0x2C, 0x00, 0xE8, 0x44, 0x99, 0xE7, 0x4E, 0x1D,
+             0xE0, 0x8B, 0xE8, 0x65, 0x35, 0xF9, 0x24, 0xE0, 0x22, 0x80, 0x4A, 0xD7, 0x75, 0xDD, 0xE2, 0x7E,
+             0xC8, 0x6C, 0xD1, 0xE5, 0xB7, 0xD1, 0x78, 0xC7, 0x44, 0x89, 0xBD, 0xBE, 0xB3, 0x07, 0x12, 0xBE,
+             0xB8, 0x2D, 0x4F, 0x97, 0x41, 0x6C, 0x5A, 0x94, 0xEA, 0x81, 0xEB, 0xDF, 0x3E, 0x62, 0x9E, 0x4A},
+            82, {0xCE, 0x6C, 0x97, 0x19, 0x28, 0x05, 0xB3, 0x46, 0xE6, 0x16, 0x1E, 0x82, 0x1E, 0xD1, 0x65, 0x67,
+                 0x3B, 0x84, 0xF4, 0x00, 0xA2, 0xB5, 0x14, 0xB2, 0xFE, 0x23, 0xD8, 0x4C, 0xD1, 0x89, 0xDD, 0xF1,
+                 0xB6, 0x95, 0xB4, 0x8C, 0xBD, 0x1C, 0x83, 0x88, 0x44, 0x11, 0x37, 0xB3, 0xCE, 0x28, 0xF1, 0x6A,
+                 0xA6, 0x4B, 0xA3, 0x3B, 0xA4, 0x66, 0xB2, 0x4D, 0xF6, 0xCF, 0xCB, 0x02, 0x1E, 0xCF, 0xF2, 0x35,
+                 0xF6, 0xA2, 0x05, 0x6C, 0xE3, 0xAF, 0x1D, 0xE4, 0x4D, 0x57, 0x20, 0x97, 0xA8, 0x50, 0x5D, 0x9E,
+                 0x7A, 0x93}
+        },
+        {
+            22, {0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B,
+                 0x0B, 0x0B, 0x0B, 0x0B, 0x0B, 0x0B},
+            0, {},
+            0, {},
+            {0xFD, 0x20, 0x0C, 0x49, 0x87, 0xAC, 0x49, 0x13, 0x13, 0xBD, 0x4A, 0x2A, 0x13, 0x28, 0x71, 0x21,
+             0x24, 0x72, 0x39, 0xE1, 0x1C, 0x9E, 0xF8, 0x28, 0x02, 0x04, 0x4B, 0x66, 0xEF, 0x35, 0x7E, 0x5B,
+             0x19, 0x44, 0x98, 0xD0, 0x68, 0x26, 0x11, 0x38, 0x23, 0x48, 0x57, 0x2A, 0x7B, 0x16, 0x11, 0xDE,
+             0x54, 0x76, 0x40, 0x94, 0x28, 0x63, 0x20, 0x57, 0x8A, 0x86, 0x3F, 0x36, 0x56, 0x2B, 0x0D, 0xF6},
+            42, {0xF5, 0xFA, 0x02, 0xB1, 0x82, 0x98, 0xA7, 0x2A, 0x8C, 0x23, 0x89, 0x8A, 0x87, 0x03, 0x47, 0x2C,
+                 0x6E, 0xB1, 0x79, 0xDC, 0x20, 0x4C, 0x03, 0x42, 0x5C, 0x97, 0x0E, 0x3B, 0x16, 0x4B, 0xF9, 0x0F,
+                 0xFF, 0x22, 0xD0, 0x48, 0x36, 0xD0, 0xE2, 0x34, 0x3B, 0xAC}
+        }
+    };
+
+    for (const auto& test : hkdf_data) {
+        uint8_t prk[HKDFSHA512::PRK_SIZE];
+        uint8_t okm1[sizeof(test.okm)];
+        uint8_t okm2[sizeof(test.okm)];
+        HKDFSHA512 hkdf;
+        const bool ok1 = hkdf.extract(test.salt, test.salt_size, test.ikm, test.ikm_size, prk, sizeof(prk)) &&
+                         ::memcmp(prk, test.prk, sizeof(prk)) == 0 &&
+                         hkdf.expand(test.info, test.info_size, okm1, test.okm_size) &&
+                         ::memcmp(okm1, test.okm, test.okm_size) == 0;
+        const bool ok2 = HKDFSHA512::derive(test.salt, test.salt_size, test.ikm, test.ikm_size, test.info, test.info_size, okm2, test.okm_size) &&
+                         ::memcmp(okm2, test.okm, test.okm_size) == 0;
+        std::cout << std::setw(3) << test.okm_size << "-byte output, HKDFSHA512: " << (ok1 && ok2 ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test the SHA-384 and SHA-512/256 variants, on the messages "abc", the 448-bit
+// message of FIPS 180, then 1000 bytes (i * 7).
+//----------------------------------------------------------------------------
+
+template <class HASH>
+bool check_hash(const void* data, size_t size, const uint8_t* expected)
+{
+    uint8_t hash[HASH::HASH_SIZE];
+    size_t retsize = 0;
+    HASH sha;
+    return sha.add(data, size) && sha.getHash(hash, sizeof(hash), &retsize) &&
+           retsize == HASH::HASH_SIZE && ::memcmp(hash, expected, HASH::HASH_SIZE) == 0;
+}
+
+void test_variants()
+{
+    struct VariantTestData {
+        const char* message;  // Null: i * 7
+        size_t size;
+        uint8_t sha384[ArmSHA384::HASH_SIZE];
+        uint8_t sha512_256[ArmSHA512_256::HASH_SIZE];
+    };
+    static const VariantTestData variant_data[] = {
+        {
+            "abc", 3,
+            {0xCB, 0x00, 0x75, 0x3F, 0x45, 0xA3, 0x5E, 0x8B, 0xB5, 0xA0, 0x3D, 0x69, 0x9A, 0xC6, 0x50, 0x07,
+             0x27, 0x2C, 0x32, 0xAB, 0x0E, 0xDE, 0xD1, 0x63, 0x1A, 0x8B, 0x60, 0x5A, 0x43, 0xFF, 0x5B, 0xED,
+             0x80, 0x86, 0x07, 0x2B, 0xA1, 0xE7, 0xCC, 0x23, 0x58, 0xBA, 0xEC, 0xA1, 0x34, 0xC8, 0x25, 0xA7},
+            {0x53, 0x04, 0x8E, 0x26, 0x81, 0x94, 0x1E, 0xF9, 0x9B, 0x2E, 0x29, 0xB7, 0x6B, 0x4C, 0x7D, 0xAB,
+             0xE4, 0xC2, 0xD0, 0xC6, 0x34, 0xFC, 0x6D, 0x46, 0xE0, 0xE2, 0xF1, 0x31, 0x07, 0xE7, 0xAF, 0x23}
+        },
+        {
+            "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 56,
+            {0x33, 0x91, 0xFD, 0xDD, 0xFC, 0x8D, 0xC7, 0x39, 0x37, 0x07, 0xA6, 0x5B, 0x1B, 0x47, 0x09, 0x39,
+             0x7C, 0xF8, 0xB1, 0xD1, 0x62, 0xAF, 0x05, 0xAB, 0xFE, 0x8F, 0x45, 0x0D, 0xE5, 0xF3, 0x6B, 0xC6,
+             0xB0, 0x45, 0x5A, 0x85, 0x20, 0xBC, 0x4E, 0x6F, 0x5F, 0xE9, 0x5B, 0x1F, 0xE3, 0xC8, 0x45, 0x2B},
+            {0xBD, 0xE8, 0xE1, 0xF9, 0xF1, 0x9B, 0xB9, 0xFD, 0x34, 0x06, 0xC9, 0x0E, 0xC6, 0xBC, 0x47, 0xBD,
+             0x36, 0xD8, 0xAD, 0xA9, 0xF1, 0x18, 0x80, 0xDB, 0xC8, 0xA2, 0x2A, 0x70, 0x78, 0xB6, 0xA4, 0x61}
+        },
+        {
+            nullptr, 1000,
+            {0x81, 0x00, 0x3A, 0x03, 0xBF, 0x67, 0xB8, 0x52, 0x3B, 0xA9, 0x61, 0x28, 0xE7, 0x11, 0xFA, 0xCA,
+             0xAC, 0x9F, 0x7A, 0x01, 0xAC, 0x06, 0x5D, 0x3A, 0x2A, 0x83, 0x83, 0x2E, 0xEF, 0x6A, 0x23, 0x78,
+             0x14, 0xD3, 0x6B, 0xA5, 0x06, 0x96, 0xE0, 0x9A, 0x31, 0x42, 0x4A, 0x2E, 0xAE, 0xDD, 0x9E, 0x57},
+            {0x9F, 0xCC, 0x4B, 0x1D, 0xB1, 0xBB, 0x5E, 0xDA, 0xFD, 0xAD, 0x4C, 0x6C, 0x54, 0xA1, 0xE6, 0xA5,
+             0x55, 0x2A, 0xB3, 0x0A, 0x7D, 0x5F, 0xBF, 0x82, 0xA6, 0x59, 0x7E, 0xD3, 0x29, 0x2C, 0x62, 0x90}
+        }
+    };
+
+    for (const auto& test : variant_data) {
+        std::string msg(test.message != nullptr ? test.message : "");
+        for (size_t i = 0; test.message == nullptr && i < test.size; ++i) {
+            msg.push_back(char(i * 7));
+        }
+        std::cout << std::setw(5) << test.size << " bytes, ArmSHA384: " << (check_hash<ArmSHA384>(msg.data(), msg.size(), test.sha384) ? "passed" : "FAILED") << std::endl;
+        std::cout << std::setw(5) << test.size << " bytes, ArmSHA512_256: " << (check_hash<ArmSHA512_256>(msg.data(), msg.size(), test.sha512_256) ? "passed" : "FAILED") << std::endl;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Program entry point.
 //----------------------------------------------------------------------------
@@ -76,6 +480,8 @@ int main(int argc, char* argv[])
     ArmSHA512 arm_sha;
     uint8_t hash[SHA512::HASH_SIZE];
 
+    std::cout << "ArmSHA512 implementation: " << (ArmSHA512::accelerated() ? "Arm64 SHA512 instructions" : "portable") << std::endl;
+
     for (auto test = test_data; test->size > 0; ++test) {
 
         bzero(hash, sizeof(hash));
@@ -96,5 +502,11 @@ int main(int argc, char* argv[])
                   << std::endl;
     }
 
+    test_chunks();
+    test_multi();
+    test_hmac();
+    test_pbkdf2();
+    test_hkdf();
+    test_variants();
     return EXIT_SUCCESS;
 }